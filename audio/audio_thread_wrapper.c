@@ -14,6 +14,7 @@
  *  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -325,3 +326,479 @@ error:
    audio_thread_free(thr);
    return false;
 }
+
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define AUDIO_OUTPUT_HAVE_ATOMICS
+#endif
+
+/* Reads a ring position while holding the lock. Without
+ * atomics, positions are only ever written under the lock. */
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+#define AUDIO_OUTPUT_LOAD_LOCKED(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#else
+#define AUDIO_OUTPUT_LOAD_LOCKED(p) (*(p))
+#endif
+
+/* Smallest amount of audio the ring holds, in frames. */
+#define AUDIO_OUTPUT_MIN_FRAMES 256
+
+/* How long the output thread sleeps when the wrapped
+ * driver accepts nothing, in microseconds. */
+#define AUDIO_OUTPUT_RETRY_USEC 1000
+
+/* Largest amount of audio handed to the wrapped driver
+ * in one go, as a fraction of the ring. Smaller writes
+ * return ring space to the producer sooner. */
+#define AUDIO_OUTPUT_WRITE_DIVISOR 8
+
+typedef struct audio_output_thread
+{
+   const audio_driver_t *driver;
+   void *driver_data;
+
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   scond_t *space_cond;
+
+   uint8_t *ring;
+   size_t ring_mask;
+   /* Bytes the producer may queue; at most the ring size,
+    * which is rounded up to a power of two. */
+   size_t ring_capacity;
+   /* Bytes buffered by the wrapped driver itself. */
+   size_t driver_buffer;
+   /* Free-running positions; written by the producer
+    * and the output thread respectively. */
+   size_t ring_write;
+   size_t ring_read;
+
+   /* Set while the output thread sleeps on an empty ring,
+    * so that the producer only locks when it must wake it. */
+   bool waiting;
+   bool alive;
+   bool stopped;
+   bool stopped_ack;
+   bool is_paused;
+   bool nonblock;
+   bool use_float;
+} audio_output_thread_t;
+
+static size_t audio_output_thread_load(
+      audio_output_thread_t *thr, size_t *pos)
+{
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+   return __atomic_load_n(pos, __ATOMIC_ACQUIRE);
+#else
+   size_t ret;
+   slock_lock(thr->lock);
+   ret = *pos;
+   slock_unlock(thr->lock);
+   return ret;
+#endif
+}
+
+static void audio_output_thread_store(
+      audio_output_thread_t *thr, size_t *pos, size_t val)
+{
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+   __atomic_store_n(pos, val, __ATOMIC_RELEASE);
+#else
+   slock_lock(thr->lock);
+   *pos = val;
+   slock_unlock(thr->lock);
+#endif
+}
+
+/* Wakes the output thread after new audio was queued. */
+static void audio_output_thread_wake(audio_output_thread_t *thr)
+{
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+   /* Orders the ring_write store before the load of
+    * waiting; pairs with the fence in the output thread. */
+   __atomic_thread_fence(__ATOMIC_SEQ_CST);
+   if (!__atomic_load_n(&thr->waiting, __ATOMIC_RELAXED))
+      return;
+#endif
+   slock_lock(thr->lock);
+   scond_signal(thr->cond);
+   slock_unlock(thr->lock);
+}
+
+static void audio_output_thread_loop(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   size_t ring_size           = thr->ring_mask + 1;
+   size_t max_write           = thr->ring_capacity / AUDIO_OUTPUT_WRITE_DIVISOR;
+
+   for (;;)
+   {
+      ssize_t ret;
+      size_t avail;
+      size_t offset;
+      size_t read_pos = thr->ring_read;
+
+      slock_lock(thr->lock);
+      for (;;)
+      {
+         if (!thr->alive)
+            break;
+
+         if (thr->stopped)
+         {
+            thr->stopped_ack = true;
+            scond_signal(thr->space_cond);
+         }
+         else
+         {
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+            __atomic_store_n(&thr->waiting, true, __ATOMIC_RELAXED);
+            __atomic_thread_fence(__ATOMIC_SEQ_CST);
+#endif
+            if (AUDIO_OUTPUT_LOAD_LOCKED(&thr->ring_write) != read_pos)
+               break;
+         }
+
+         scond_wait(thr->cond, thr->lock);
+      }
+#ifdef AUDIO_OUTPUT_HAVE_ATOMICS
+      __atomic_store_n(&thr->waiting, false, __ATOMIC_RELAXED);
+#endif
+
+      if (!thr->alive)
+      {
+         slock_unlock(thr->lock);
+         break;
+      }
+      slock_unlock(thr->lock);
+
+      offset = read_pos & thr->ring_mask;
+      avail  = audio_output_thread_load(thr, &thr->ring_write) - read_pos;
+      if (avail > ring_size - offset)
+         avail = ring_size - offset;
+      if (avail > max_write)
+         avail = max_write;
+
+      /* The wrapped driver is always blocking, so this
+       * paces the thread to the audio device. */
+      ret = thr->driver->write(thr->driver_data,
+            thr->ring + offset, avail);
+
+      if (ret > 0)
+         audio_output_thread_store(thr, &thr->ring_read,
+               read_pos + (size_t)ret);
+
+      slock_lock(thr->lock);
+      if (ret < 0)
+      {
+         RARCH_ERR("[Audio]: Output thread failed to write to audio driver.\n");
+         thr->alive = false;
+      }
+      else if (ret == 0 && thr->alive && !thr->stopped)
+      {
+         /* The driver is not ready for more audio; retry
+          * shortly instead of spinning on it. Stopping or
+          * freeing the driver still wakes us up at once. */
+         scond_wait_timeout(thr->cond, thr->lock,
+               AUDIO_OUTPUT_RETRY_USEC);
+      }
+      scond_signal(thr->space_cond);
+      slock_unlock(thr->lock);
+   }
+
+   slock_lock(thr->lock);
+   thr->stopped_ack = true;
+   scond_signal(thr->space_cond);
+   slock_unlock(thr->lock);
+}
+
+static void audio_output_thread_block(audio_output_thread_t *thr)
+{
+   if (thr->stopped)
+      return;
+
+   slock_lock(thr->lock);
+   thr->stopped_ack = false;
+   thr->stopped     = true;
+   scond_signal(thr->cond);
+
+   /* Wait until the output thread is no longer
+    * inside the wrapped driver. */
+   while (!thr->stopped_ack && thr->alive)
+      scond_wait(thr->space_cond, thr->lock);
+
+   slock_unlock(thr->lock);
+}
+
+static void audio_output_thread_unblock(audio_output_thread_t *thr)
+{
+   slock_lock(thr->lock);
+   thr->stopped = false;
+   scond_signal(thr->cond);
+   slock_unlock(thr->lock);
+}
+
+static void audio_output_thread_free(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+
+   if (!thr)
+      return;
+
+   if (thr->thread)
+   {
+      slock_lock(thr->lock);
+      thr->alive = false;
+      scond_signal(thr->cond);
+      slock_unlock(thr->lock);
+
+      sthread_join(thr->thread);
+   }
+
+   if (thr->driver_data)
+      thr->driver->free(thr->driver_data);
+
+   if (thr->lock)
+      slock_free(thr->lock);
+   if (thr->cond)
+      scond_free(thr->cond);
+   if (thr->space_cond)
+      scond_free(thr->space_cond);
+   free(thr->ring);
+   free(thr);
+}
+
+static bool audio_output_thread_alive(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   if (!thr)
+      return false;
+   return !thr->is_paused;
+}
+
+static bool audio_output_thread_stop(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+
+   if (!thr)
+      return false;
+
+   audio_output_thread_block(thr);
+   thr->is_paused = true;
+
+   return thr->driver->stop(thr->driver_data);
+}
+
+static bool audio_output_thread_start(void *data, bool is_shutdown)
+{
+   bool ret;
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+
+   if (!thr)
+      return false;
+
+   ret            = thr->driver->start(thr->driver_data, is_shutdown);
+   thr->is_paused = false;
+   audio_output_thread_unblock(thr);
+
+   return ret;
+}
+
+static void audio_output_thread_set_nonblock_state(void *data, bool state)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   if (thr)
+      thr->nonblock = state;
+}
+
+static bool audio_output_thread_use_float(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   if (!thr)
+      return false;
+   return thr->use_float;
+}
+
+static size_t audio_output_thread_write_avail(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   size_t read_pos            = audio_output_thread_load(thr, &thr->ring_read);
+   return thr->ring_capacity - (thr->ring_write - read_pos);
+}
+
+/* Only the ring is reported, to match write_avail. The
+ * wrapped driver is kept full by the output thread, and it
+ * cannot be queried from the caller's thread while the
+ * output thread writes to it. For the same reason there is
+ * no delay callback: rate control takes the ring's fill
+ * level from these two. */
+static size_t audio_output_thread_buffer_size(void *data)
+{
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   return thr->ring_capacity;
+}
+
+static ssize_t audio_output_thread_write(void *data,
+      const void *buf, size_t size)
+{
+   size_t written             = 0;
+   const uint8_t *in          = (const uint8_t*)buf;
+   audio_output_thread_t *thr = (audio_output_thread_t*)data;
+   size_t ring_size           = thr->ring_mask + 1;
+
+   while (written < size)
+   {
+      size_t write_pos = thr->ring_write;
+      size_t offset    = write_pos & thr->ring_mask;
+      size_t avail     = thr->ring_capacity - (write_pos -
+            audio_output_thread_load(thr, &thr->ring_read));
+
+      if (avail > size - written)
+         avail = size - written;
+
+      if (avail)
+      {
+         size_t first = ring_size - offset;
+
+         if (first > avail)
+            first = avail;
+
+         memcpy(thr->ring + offset, in + written, first);
+         memcpy(thr->ring, in + written + first, avail - first);
+         audio_output_thread_store(thr, &thr->ring_write,
+               write_pos + avail);
+         written += avail;
+
+         audio_output_thread_wake(thr);
+         continue;
+      }
+
+      if (thr->nonblock)
+         break;
+
+      /* Ring is full, wait for the output thread to drain it. */
+      slock_lock(thr->lock);
+      while (thr->alive && !thr->stopped &&
+            AUDIO_OUTPUT_LOAD_LOCKED(&thr->ring_read)
+            + thr->ring_capacity <= thr->ring_write)
+         scond_wait(thr->space_cond, thr->lock);
+      if (!thr->alive)
+      {
+         slock_unlock(thr->lock);
+         return -1;
+      }
+      slock_unlock(thr->lock);
+
+      if (thr->stopped)
+         break;
+   }
+
+   return written;
+}
+
+static const audio_driver_t audio_output_thread = {
+   NULL,
+   audio_output_thread_write,
+   audio_output_thread_stop,
+   audio_output_thread_start,
+   audio_output_thread_alive,
+   audio_output_thread_set_nonblock_state,
+   audio_output_thread_free,
+   audio_output_thread_use_float,
+   "audio-output-thread",
+   NULL,
+   NULL,
+   audio_output_thread_write_avail,
+   audio_output_thread_buffer_size,
+   NULL  /* delay */
+};
+
+/**
+ * audio_init_output_thread:
+ * @out_driver                : output driver
+ * @out_data                  : output audio data
+ * @driver                    : initialized audio driver to wrap
+ * @driver_data               : audio data of @driver
+ * @out_rate                  : output audio rate
+ * @latency                   : audio latency
+ *
+ * Moves writes to a blocking audio driver onto an output
+ * thread, fed through a single-producer/single-consumer ring.
+ * The ring holds whatever part of @latency the wrapped driver
+ * does not buffer itself, so @driver should be initialized
+ * with a fraction of @latency. Writes to the returned driver
+ * only copy into the ring; write_avail(), buffer_size() and
+ * delay() cover both the ring and the wrapped driver.
+ * On success, the returned driver takes ownership of @driver_data.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+bool audio_init_output_thread(const audio_driver_t **out_driver,
+      void **out_data, const audio_driver_t *drv, void *drv_data,
+      unsigned out_rate, unsigned latency)
+{
+   size_t ring_size           = 1;
+   size_t capacity            = 0;
+   size_t frame_size          = 2 * sizeof(int16_t);
+   audio_output_thread_t *thr = NULL;
+
+   if (!drv || !drv_data || !drv->write)
+      return false;
+
+   if (!(thr = (audio_output_thread_t*)calloc(1, sizeof(*thr))))
+      return false;
+
+   thr->driver       = drv;
+   thr->use_float    = drv->use_float && drv->use_float(drv_data);
+   if (thr->use_float)
+      frame_size     = 2 * sizeof(float);
+
+   /* Queue only what the wrapped driver leaves of the
+    * latency, so that the total stays at @latency. */
+   capacity          = (size_t)out_rate * latency / 1000 * frame_size;
+   if (drv->buffer_size)
+      thr->driver_buffer = drv->buffer_size(drv_data);
+   else
+      thr->driver_buffer = capacity / 2;
+   if (thr->driver_buffer < capacity)
+      capacity      -= thr->driver_buffer;
+   else
+      capacity       = 0;
+   capacity         -= capacity % frame_size;
+   if (capacity < AUDIO_OUTPUT_MIN_FRAMES * frame_size)
+      capacity       = AUDIO_OUTPUT_MIN_FRAMES * frame_size;
+
+   while (ring_size < capacity)
+      ring_size    <<= 1;
+
+   thr->ring_mask     = ring_size - 1;
+   thr->ring_capacity = capacity;
+   thr->alive        = true;
+
+   if (!(thr->ring = (uint8_t*)malloc(ring_size)))
+      goto error;
+   if (!(thr->cond = scond_new()))
+      goto error;
+   if (!(thr->space_cond = scond_new()))
+      goto error;
+   if (!(thr->lock = slock_new()))
+      goto error;
+
+   /* The output thread owns all writes from here on;
+    * keep the wrapped driver blocking. */
+   drv->set_nonblock_state(drv_data, false);
+   thr->driver_data  = drv_data;
+
+   if (!(thr->thread = sthread_create(audio_output_thread_loop, thr)))
+      goto error;
+
+   *out_driver       = &audio_output_thread;
+   *out_data         = thr;
+   return true;
+
+error:
+   /* Leave the wrapped driver to the caller. */
+   thr->driver_data  = NULL;
+   audio_output_thread_free(thr);
+   return false;
+}
@@ -42,4 +42,28 @@ bool audio_init_thread(const audio_driver_t **out_driver, void **out_data,
       unsigned block_frames,
       const audio_driver_t *driver);
 
+/**
+ * audio_init_output_thread:
+ * @out_driver                : output driver
+ * @out_data                  : output audio data
+ * @driver                    : initialized audio driver to wrap
+ * @driver_data               : audio data of @driver
+ * @out_rate                  : output audio rate
+ * @latency                   : audio latency
+ *
+ * Moves writes to a blocking audio driver onto an output thread,
+ * fed through a single-producer/single-consumer ring. Writes only
+ * take the lock when the output thread sleeps on an empty ring.
+ * The ring and @driver's own buffer share @latency, so @driver
+ * should be initialized with part of it. Unlike audio_init_thread,
+ * this is used for regular write-based audio, and reports the
+ * fill level and delay for rate control.
+ * On success, the returned driver owns @driver_data.
+ *
+ * Returns: true (1) if successful, otherwise false (0).
+ **/
+bool audio_init_output_thread(const audio_driver_t **out_driver,
+      void **out_data, const audio_driver_t *driver, void *driver_data,
+      unsigned out_rate, unsigned latency);
+
 #endif
@@ -356,6 +356,17 @@ static size_t alsa_buffer_size(void *data)
    return alsa->buffer_size;
 }
 
+static size_t alsa_delay(void *data)
+{
+   snd_pcm_sframes_t delay;
+   alsa_t *alsa = (alsa_t*)data;
+
+   if (snd_pcm_delay(alsa->pcm, &delay) < 0 || delay < 0)
+      return 0;
+
+   return FRAMES_TO_BYTES(delay, alsa->frame_bits);
+}
+
 static void *alsa_device_list_new(void *data)
 {
    void **hints, **n;
@@ -428,4 +439,5 @@ audio_driver_t audio_alsa = {
    alsa_device_list_free,
    alsa_write_avail,
    alsa_buffer_size,
+   alsa_delay,
 };
@@ -202,6 +202,19 @@ static size_t oss_buffer_size(void *data)
    return info.fragsize * info.fragstotal;
 }
 
+#ifdef SNDCTL_DSP_GETODELAY
+static size_t oss_delay(void *data)
+{
+   int delay              = 0;
+   oss_audio_t *ossaudio  = (oss_audio_t*)data;
+
+   if (ioctl(ossaudio->fd, SNDCTL_DSP_GETODELAY, &delay) < 0 || delay < 0)
+      return 0;
+
+   return delay;
+}
+#endif
+
 static bool oss_use_float(void *data)
 {
    (void)data;
@@ -222,4 +235,7 @@ audio_driver_t audio_oss = {
    NULL,
    oss_write_avail,
    oss_buffer_size,
+#ifdef SNDCTL_DSP_GETODELAY
+   oss_delay,
+#endif
 };
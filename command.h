@@ -237,6 +237,8 @@ enum event_command
    CMD_EVENT_DISCORD_UPDATE,
    CMD_EVENT_OSK_TOGGLE,
    CMD_EVENT_RECORDING_TOGGLE,
+   /* Writes out the replay buffer of the current recording. */
+   CMD_EVENT_RECORDING_REPLAY_SAVE,
    CMD_EVENT_STREAMING_TOGGLE,
    CMD_EVENT_RUNAHEAD_TOGGLE,
    CMD_EVENT_AI_SERVICE_TOGGLE,
@@ -286,6 +288,11 @@ bool command_network_send(const char *cmd_);
 #ifdef HAVE_BSV_MOVIE
 struct bsv_state
 {
+   /* Frames between keyframe states in new recordings.
+    * Zero records a plain BSV1 movie. */
+   unsigned keyframe_interval;
+   /* Frame to seek to when playback starts. */
+   unsigned seek_frame;
    /* Movie playback/recording support. */
    char movie_path[PATH_MAX_LENGTH];
    /* Immediate playback/recording. */
@@ -299,21 +306,44 @@ struct bsv_state
 
 };
 
+/* Frame index entry of a BSV2 movie, pointing at
+ * the keyframe state stored at the start of a frame. */
+struct bsv_keyframe
+{
+   uint32_t frame;
+   uint32_t offset;
+};
+
 struct bsv_movie
 {
    intfstream_t *file;
    uint8_t *state;
+   /* Scratch buffer for compressed keyframe states. */
+   uint8_t *keyframe_buf;
+   struct bsv_keyframe *keyframes;
    /* A ring buffer keeping track of positions
     * in the file for each frame. */
    size_t *frame_pos;
    size_t frame_mask;
    size_t frame_ptr;
+   size_t frame_count;
    size_t min_file_pos;
    size_t state_size;
+   size_t keyframes_count;
+   size_t keyframes_size;
+   /* End of the input data when playing back a BSV2
+    * movie with a frame index, zero otherwise. */
+   size_t data_end;
+   size_t seek_frame;
+   unsigned keyframe_interval;
 
    bool playback;
    bool first_rewind;
    bool did_rewind;
+   bool seek_pending;
+   /* Set once the file outgrows the 32-bit
+    * offsets of the frame index. */
+   bool keyframes_full;
 };
 
 typedef struct bsv_movie bsv_movie_t;
@@ -478,6 +508,7 @@ static const struct cmd_map map[] = {
    { "MENU_A",                 RETRO_DEVICE_ID_JOYPAD_A },
    { "MENU_B",                 RETRO_DEVICE_ID_JOYPAD_B },
    { "AI_SERVICE",             RARCH_AI_SERVICE },
+   { "REPLAY_SAVE",            RARCH_REPLAY_SAVE },
 };
 #endif
 
@@ -283,6 +283,15 @@
 /* Number of threads to use for video recording */
 #define DEFAULT_VIDEO_RECORD_THREADS 2
 
+/* Seconds of recording kept in memory until the
+ * replay buffer hotkey writes them out.
+ * 0 records straight to a file. */
+#define DEFAULT_VIDEO_RECORD_REPLAY_BUFFER 0
+
+/* Seconds after which recording continues in a new file.
+ * 0 records a single file. */
+#define DEFAULT_VIDEO_RECORD_SEGMENT_LENGTH 0
+
 #if defined(RARCH_CONSOLE) || defined(__APPLE__)
 #define DEFAULT_LOAD_DUMMY_ON_CORE_SHUTDOWN false
 #else
@@ -894,6 +903,11 @@ static const float message_bgcolor_opacity = 1.0f;
 /* Screenshots named automatically. */
 #define DEFAULT_AUTO_SCREENSHOT_FILENAME true
 
+/* PNG compression level of screenshots, from 0 (none,
+ * fastest) to 9 (smallest files, slowest). Levels below
+ * 6 use a fixed line filter, which is a lot faster. */
+#define DEFAULT_SCREENSHOT_COMPRESSION_LEVEL 6
+
 /* Record post-shaded GPU output instead of raw game footage if available. */
 #define DEFAULT_GPU_RECORD false
 
@@ -1033,6 +1047,15 @@ static const bool audio_enable_menu_bgm    = false;
 /* Will sync audio. (recommended) */
 #define DEFAULT_AUDIO_SYNC true
 
+/* Use a proportional-integral controller for audio rate
+ * control, which holds the audio buffer at half full on
+ * average and so copes with lower audio latency. */
+#define DEFAULT_RATE_CONTROL_PI false
+
+/* Write audio to the driver from a dedicated output thread,
+ * so that blocking audio drivers do not stall the main loop. */
+#define DEFAULT_AUDIO_OUTPUT_THREAD false
+
 /* Audio rate control. */
 #if !defined(RARCH_CONSOLE)
 #define DEFAULT_RATE_CONTROL true
@@ -1395,6 +1418,14 @@ static const unsigned menu_left_thumbnails_default = 0;
 
 static const unsigned gfx_thumbnail_upscale_threshold = 0;
 
+/* Memory budget in MB of the menu thumbnail
+ * texture cache (0 disables the cache) */
+#if defined(_3DS) || defined(PSP) || defined(PS2) || defined(GEKKO) || defined(DINGUX)
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 0
+#else
+#define DEFAULT_GFX_THUMBNAIL_CACHE_SIZE 64
+#endif
+
 #ifdef HAVE_MENU
 #if defined(RS90)
 /* The RS-90 has a hardware clock that is neither
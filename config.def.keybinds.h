@@ -577,6 +577,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_AI_SERVICE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE, RETROK_UNKNOWN,
+      RARCH_REPLAY_SAVE, NO_BTN, NO_BTN, 0,
+      true
+   },
 #elif defined(DINGUX)
    { 
       NULL, NULL,
@@ -1131,6 +1138,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_AI_SERVICE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE, RETROK_UNKNOWN,
+      RARCH_REPLAY_SAVE, NO_BTN, NO_BTN, 0,
+      true
+   },
 #else
    { 
       NULL, NULL,
@@ -1695,6 +1709,13 @@ static const struct retro_keybind retro_keybinds_1[] = {
       RARCH_AI_SERVICE, NO_BTN, NO_BTN, 0,
       true
    },
+   {
+      NULL, NULL,
+      AXIS_NONE, AXIS_NONE, AXIS_NONE,
+      MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE, RETROK_UNKNOWN,
+      RARCH_REPLAY_SAVE, NO_BTN, NO_BTN, 0,
+      true
+   },
 #endif
 };
 
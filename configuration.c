@@ -141,6 +141,7 @@ enum audio_resampler_driver_enum
    AUDIO_RESAMPLER_CC       = AUDIO_NULL + 1,
    AUDIO_RESAMPLER_SINC,
    AUDIO_RESAMPLER_NEAREST,
+   AUDIO_RESAMPLER_POLYPHASE,
    AUDIO_RESAMPLER_NULL
 };
 
@@ -351,6 +352,7 @@ const struct input_bind_map input_config_bind_map[RARCH_BIND_LIST_END_NULL] = {
    DECLARE_META_BIND(2, streaming_toggle,      RARCH_STREAMING_TOGGLE,       MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE),
    DECLARE_META_BIND(2, runahead_toggle,       RARCH_RUNAHEAD_TOGGLE,        MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE),
    DECLARE_META_BIND(2, ai_service,            RARCH_AI_SERVICE,             MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE),
+   DECLARE_META_BIND(2, replay_save,           RARCH_REPLAY_SAVE,            MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE),
 };
 
 #if defined(HAVE_METAL)
@@ -902,6 +904,8 @@ const char *config_get_default_audio_resampler(void)
          return "sinc";
       case AUDIO_RESAMPLER_NEAREST:
          return "nearest";
+      case AUDIO_RESAMPLER_POLYPHASE:
+         return "polyphase";
       case AUDIO_RESAMPLER_NULL:
          break;
    }
@@ -1370,6 +1374,7 @@ static struct config_array_setting *populate_settings_array(settings_t *settings
 
    /* Arrays */
    SETTING_ARRAY("video_driver",             settings->arrays.video_driver,   false, NULL, true);
+   SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_VIDEO_DRIVER);
    SETTING_ARRAY("record_driver",            settings->arrays.record_driver,  false, NULL, true);
    SETTING_ARRAY("camera_driver",            settings->arrays.camera_driver,  false, NULL, true);
    SETTING_ARRAY("bluetooth_driver",         settings->arrays.bluetooth_driver, false, NULL, true);
@@ -1388,9 +1393,12 @@ static struct config_array_setting *populate_settings_array(settings_t *settings
 #endif
    SETTING_ARRAY("video_context_driver",     settings->arrays.video_context_driver,   false, NULL, true);
    SETTING_ARRAY("audio_driver",             settings->arrays.audio_driver,           false, NULL, true);
+   SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_AUDIO_DRIVER);
    SETTING_ARRAY("audio_resampler",          settings->arrays.audio_resampler,        false, NULL, true);
    SETTING_ARRAY("input_driver",             settings->arrays.input_driver,           false, NULL, true);
+   SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_INPUT_DRIVER);
    SETTING_ARRAY("input_joypad_driver",      settings->arrays.input_joypad_driver,    false, NULL, true);
+   SETTING_OVERRIDE(RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER);
    SETTING_ARRAY("input_keyboard_layout",    settings->arrays.input_keyboard_layout,  false, NULL, true);
    SETTING_ARRAY("bundle_assets_src_path",   settings->arrays.bundle_assets_src, false, NULL, true);
    SETTING_ARRAY("bundle_assets_dst_path",   settings->arrays.bundle_assets_dst, false, NULL, true);
@@ -1928,6 +1936,8 @@ static struct config_bool_setting *populate_settings_bool(
 #endif
    SETTING_BOOL("input_sensors_enable",         &settings->bools.input_sensors_enable, true, DEFAULT_INPUT_SENSORS_ENABLE, false);
    SETTING_BOOL("audio_rate_control",           &settings->bools.audio_rate_control, true, DEFAULT_RATE_CONTROL, false);
+   SETTING_BOOL("audio_rate_control_pi",        &settings->bools.audio_rate_control_pi, true, DEFAULT_RATE_CONTROL_PI, false);
+   SETTING_BOOL("audio_output_thread",          &settings->bools.audio_output_thread, true, DEFAULT_AUDIO_OUTPUT_THREAD, false);
 #ifdef HAVE_WASAPI
    SETTING_BOOL("audio_wasapi_exclusive_mode",  &settings->bools.audio_wasapi_exclusive_mode, true, DEFAULT_WASAPI_EXCLUSIVE_MODE, false);
    SETTING_BOOL("audio_wasapi_float_format",    &settings->bools.audio_wasapi_float_format, true, DEFAULT_WASAPI_FLOAT_FORMAT, false);
@@ -2093,6 +2103,7 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("rewind_buffer_size_step",      &settings->uints.rewind_buffer_size_step, true, DEFAULT_REWIND_BUFFER_SIZE_STEP, false);
    SETTING_UINT("autosave_interval",            &settings->uints.autosave_interval,  true, DEFAULT_AUTOSAVE_INTERVAL, false);
    SETTING_UINT("savestate_max_keep",           &settings->uints.savestate_max_keep, true, DEFAULT_SAVESTATE_MAX_KEEP, false);
+   SETTING_UINT("screenshot_compression_level", &settings->uints.screenshot_compression_level, true, DEFAULT_SCREENSHOT_COMPRESSION_LEVEL, false);
    SETTING_UINT("frontend_log_level",           &settings->uints.frontend_log_level, true, DEFAULT_FRONTEND_LOG_LEVEL, false);
    SETTING_UINT("libretro_log_level",           &settings->uints.libretro_log_level, true, DEFAULT_LIBRETRO_LOG_LEVEL, false);
    SETTING_UINT("keyboard_gamepad_mapping_type",&settings->uints.input_keyboard_gamepad_mapping_type, true, 1, false);
@@ -2120,6 +2131,7 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("menu_thumbnails",              &settings->uints.gfx_thumbnails, true, gfx_thumbnails_default, false);
    SETTING_UINT("menu_left_thumbnails",         &settings->uints.menu_left_thumbnails, true, menu_left_thumbnails_default, false);
    SETTING_UINT("menu_thumbnail_upscale_threshold", &settings->uints.gfx_thumbnail_upscale_threshold, true, gfx_thumbnail_upscale_threshold, false);
+   SETTING_UINT("menu_thumbnail_cache_size",    &settings->uints.gfx_thumbnail_cache_size, true, DEFAULT_GFX_THUMBNAIL_CACHE_SIZE, false);
    SETTING_UINT("menu_timedate_style",          &settings->uints.menu_timedate_style, true, DEFAULT_MENU_TIMEDATE_STYLE, false);
    SETTING_UINT("menu_timedate_date_separator", &settings->uints.menu_timedate_date_separator, true, DEFAULT_MENU_TIMEDATE_DATE_SEPARATOR, false);
    SETTING_UINT("menu_ticker_type",             &settings->uints.menu_ticker_type, true, DEFAULT_MENU_TICKER_TYPE, false);
@@ -2238,6 +2250,8 @@ static struct config_uint_setting *populate_settings_uint(
    SETTING_UINT("ai_service_source_lang",            &settings->uints.ai_service_source_lang,    true, 0, false);
 
    SETTING_UINT("video_record_threads",            &settings->uints.video_record_threads,    true, DEFAULT_VIDEO_RECORD_THREADS, false);
+   SETTING_UINT("video_record_replay_buffer",      &settings->uints.video_record_replay_buffer, true, DEFAULT_VIDEO_RECORD_REPLAY_BUFFER, false);
+   SETTING_UINT("video_record_segment_length",     &settings->uints.video_record_segment_length, true, DEFAULT_VIDEO_RECORD_SEGMENT_LENGTH, false);
 
 #ifdef HAVE_LIBNX
    SETTING_UINT("libnx_overclock",  &settings->uints.libnx_overclock, true, SWITCH_DEFAULT_CPU_PROFILE, false);
@@ -3402,6 +3416,10 @@ static bool config_load_file(global_t *global,
    {
       if (!array_settings[i].handle)
          continue;
+      if (     array_settings[i].override
+            && retroarch_override_setting_is_set(
+               array_settings[i].override, NULL))
+         continue;
       config_get_array(conf, array_settings[i].ident,
             array_settings[i].ptr, PATH_MAX_LENGTH);
    }
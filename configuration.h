@@ -209,6 +209,7 @@ typedef struct settings
       unsigned rewind_buffer_size_step;
       unsigned autosave_interval;
       unsigned savestate_max_keep;
+      unsigned screenshot_compression_level;
       unsigned network_cmd_port;
       unsigned network_remote_base_port;
       unsigned keymapper_port;
@@ -260,6 +261,7 @@ typedef struct settings
       unsigned gfx_thumbnails;
       unsigned menu_left_thumbnails;
       unsigned gfx_thumbnail_upscale_threshold;
+      unsigned gfx_thumbnail_cache_size;
       unsigned menu_rgui_thumbnail_downscaler;
       unsigned menu_rgui_thumbnail_delay;
       unsigned menu_rgui_color_theme;
@@ -315,6 +317,8 @@ typedef struct settings
       unsigned window_auto_height_max;
 
       unsigned video_record_threads;
+      unsigned video_record_replay_buffer;
+      unsigned video_record_segment_length;
 
       unsigned libnx_overclock;
       unsigned ai_service_mode;
@@ -572,6 +576,8 @@ typedef struct settings
       bool audio_enable_menu_bgm;
       bool audio_sync;
       bool audio_rate_control;
+      bool audio_rate_control_pi;
+      bool audio_output_thread;
       bool audio_wasapi_exclusive_mode;
       bool audio_wasapi_float_format;
       bool audio_fastforward_mute;
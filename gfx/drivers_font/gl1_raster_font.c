@@ -157,6 +157,42 @@ static bool gl1_raster_font_upload_atlas(gl1_raster_t *font)
    return true;
 }
 
+/* Uploads only the part of the atlas that changed
+ * since the last upload */
+static void gl1_raster_font_update_atlas(gl1_raster_t *font)
+{
+   unsigned i, j, x, y, width, height;
+   uint8_t *tmp = NULL;
+
+   font_atlas_get_dirty(font->atlas, &x, &y, &width, &height);
+
+   if (!(tmp = (uint8_t*)malloc(width * height * 2)))
+   {
+      gl1_raster_font_upload_atlas(font);
+      return;
+   }
+
+   for (i = 0; i < height; ++i)
+   {
+      const uint8_t *src = &font->atlas->buffer[
+         (y + i) * font->atlas->width + x];
+      uint8_t       *dst = &tmp[i * width * 2];
+
+      for (j = 0; j < width; ++j)
+      {
+         *dst++ = 0xff;
+         *dst++ = *src++;
+      }
+   }
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+}
+
 static void *gl1_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -250,7 +286,7 @@ static void gl1_raster_font_draw_vertices(gl1_raster_t *font,
 
    if (font->atlas->dirty)
    {
-      gl1_raster_font_upload_atlas(font);
+      gl1_raster_font_update_atlas(font);
       font->atlas->dirty   = false;
    }
 
@@ -118,26 +118,41 @@ static bool gl_raster_font_upload_atlas_components_4(gl_raster_t *font)
 }
 #endif
 
-static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+static size_t gl_raster_font_get_format(gl_raster_t *font,
+      GLint *gl_internal, GLenum *gl_format)
 {
-   unsigned i, j;
-   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
-   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
-   size_t ncomponents                   = 2;
-   uint8_t       *tmp                   = NULL;
 #if defined(GL_VERSION_3_0)
    struct retro_hw_render_callback *hwr = video_driver_get_hw_context();
 
    if ((font->gl && font->gl->core_context_in_use) ||
          (hwr->context_type == RETRO_HW_CONTEXT_OPENGL &&
           hwr->version_major >= 3))
+   {
+      *gl_internal = GL_R8;
+      *gl_format   = GL_RED;
+      return 1;
+   }
+#endif
+
+   *gl_internal    = GL_LUMINANCE_ALPHA;
+   *gl_format      = GL_LUMINANCE_ALPHA;
+   return 2;
+}
+
+static bool gl_raster_font_upload_atlas(gl_raster_t *font)
+{
+   unsigned i, j;
+   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
+   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
+   size_t ncomponents                   = gl_raster_font_get_format(
+         font, &gl_internal, &gl_format);
+   uint8_t       *tmp                   = NULL;
+
+#if defined(GL_VERSION_3_0)
+   if (ncomponents == 1)
    {
       GLint swizzle[] = { GL_ONE, GL_ONE, GL_ONE, GL_RED };
       glTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_RGBA, swizzle);
-
-      gl_internal = GL_R8;
-      gl_format   = GL_RED;
-      ncomponents = 1;
    }
 #endif
 
@@ -178,6 +193,51 @@ static bool gl_raster_font_upload_atlas(gl_raster_t *font)
    return true;
 }
 
+/* Uploads only the part of the atlas that changed
+ * since the last upload */
+static void gl_raster_font_update_atlas(gl_raster_t *font)
+{
+   unsigned i, j, x, y, width, height;
+   GLint  gl_internal                   = GL_LUMINANCE_ALPHA;
+   GLenum gl_format                     = GL_LUMINANCE_ALPHA;
+   size_t ncomponents                   = gl_raster_font_get_format(
+         font, &gl_internal, &gl_format);
+   uint8_t       *tmp                   = NULL;
+
+   font_atlas_get_dirty(font->atlas, &x, &y, &width, &height);
+
+   if (!(tmp = (uint8_t*)malloc(width * height * ncomponents)))
+   {
+      gl_raster_font_upload_atlas(font);
+      return;
+   }
+
+   for (i = 0; i < height; ++i)
+   {
+      const uint8_t *src = &font->atlas->buffer[
+         (y + i) * font->atlas->width + x];
+      uint8_t       *dst = &tmp[i * width * ncomponents];
+
+      if (ncomponents == 1)
+         memcpy(dst, src, width);
+      else
+      {
+         for (j = 0; j < width; ++j)
+         {
+            *dst++ = 0xff;
+            *dst++ = *src++;
+         }
+      }
+   }
+
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         gl_format, GL_UNSIGNED_BYTE, tmp);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+   free(tmp);
+}
+
 static void *gl_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -265,7 +325,7 @@ static void gl_raster_font_draw_vertices(gl_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_raster_font_upload_atlas(font);
+      gl_raster_font_update_atlas(font);
       font->atlas->dirty   = false;
    }
 
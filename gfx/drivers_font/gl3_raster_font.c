@@ -96,6 +96,25 @@ static bool gl_core_raster_font_upload_atlas(gl_core_raster_t *font)
    return true;
 }
 
+/* Uploads only the part of the atlas that changed
+ * since the last upload, into the existing texture */
+static void gl_core_raster_font_update_atlas(gl_core_raster_t *font)
+{
+   unsigned x, y, width, height;
+
+   font_atlas_get_dirty(font->atlas, &x, &y, &width, &height);
+
+   glBindTexture(GL_TEXTURE_2D, font->tex);
+   glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, font->atlas->width);
+   glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+   glTexSubImage2D(GL_TEXTURE_2D, 0, x, y, width, height,
+         GL_RED, GL_UNSIGNED_BYTE,
+         font->atlas->buffer + y * font->atlas->width + x);
+   glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+   glBindTexture(GL_TEXTURE_2D, 0);
+}
+
 static void *gl_core_raster_font_init_font(void *data,
       const char *font_path, float font_size,
       bool is_threaded)
@@ -171,7 +190,7 @@ static void gl_core_raster_font_draw_vertices(gl_core_raster_t *font,
 {
    if (font->atlas->dirty)
    {
-      gl_core_raster_font_upload_atlas(font);
+      gl_core_raster_font_update_atlas(font);
       font->atlas->dirty   = false;
    }
 
@@ -55,10 +55,11 @@
 
 typedef struct freetype_atlas_slot
 {
-   struct freetype_atlas_slot* next;   /* ptr alignment */
-   struct font_glyph glyph;            /* unsigned alignment */
+   struct freetype_atlas_slot* next;     /* ptr alignment */
+   struct freetype_atlas_slot* lru_prev; /* ptr alignment */
+   struct freetype_atlas_slot* lru_next; /* ptr alignment */
+   struct font_glyph glyph;              /* unsigned alignment */
    unsigned charcode;
-   unsigned last_used;
 }freetype_atlas_slot_t;
 
 typedef struct freetype_renderer
@@ -68,9 +69,10 @@ typedef struct freetype_renderer
    struct font_atlas atlas;                          /* ptr alignment   */
    freetype_atlas_slot_t atlas_slots[FT_ATLAS_SIZE]; /* ptr alignment   */
    freetype_atlas_slot_t* uc_map[0x100];             /* ptr alignment   */
+   freetype_atlas_slot_t* lru_head;                  /* Most recently used  */
+   freetype_atlas_slot_t* lru_tail;                  /* Least recently used */
    unsigned max_glyph_width;
    unsigned max_glyph_height;
-   unsigned usage_counter;
    struct font_line_metrics line_metrics;            /* float alignment */
 } ft_font_renderer_t;
 
@@ -97,29 +99,44 @@ static void font_renderer_ft_free(void *data)
    free(handle);
 }
 
-static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
+/* Moves a slot to the front of the LRU list */
+static void font_renderer_ft_use_slot(ft_font_renderer_t *handle,
+      freetype_atlas_slot_t *slot)
 {
-   int i, map_id;
-   unsigned oldest = 0;
+   if (handle->lru_head == slot)
+      return;
+
+   slot->lru_prev->lru_next     = slot->lru_next;
+   if (slot->lru_next)
+      slot->lru_next->lru_prev  = slot->lru_prev;
+   else
+      handle->lru_tail          = slot->lru_prev;
+
+   slot->lru_prev               = NULL;
+   slot->lru_next               = handle->lru_head;
+   handle->lru_head->lru_prev   = slot;
+   handle->lru_head             = slot;
+}
 
-   for (i = 1; i < FT_ATLAS_SIZE; i++)
-      if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
+static freetype_atlas_slot_t* font_renderer_get_slot(ft_font_renderer_t *handle)
+{
+   int map_id;
+   freetype_atlas_slot_t *oldest = handle->lru_tail;
 
    /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if (handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
+   map_id = oldest->charcode & 0xFF;
+   if (handle->uc_map[map_id] == oldest)
+      handle->uc_map[map_id] = oldest->next;
    else if (handle->uc_map[map_id])
    {
       freetype_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while (ptr->next && ptr->next != &handle->atlas_slots[oldest])
+      while (ptr->next && ptr->next != oldest)
          ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
+      ptr->next = oldest->next;
    }
 
-   return &handle->atlas_slots[oldest];
+   font_renderer_ft_use_slot(handle, oldest);
+   return oldest;
 }
 
 static const struct font_glyph *font_renderer_ft_get_glyph(
@@ -141,7 +158,7 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
    {
       if (atlas_slot->charcode == charcode)
       {
-         atlas_slot->last_used = handle->usage_counter++;
+         font_renderer_ft_use_slot(handle, atlas_slot);
          return &atlas_slot->glyph;
       }
       atlas_slot = atlas_slot->next;
@@ -200,10 +217,13 @@ static const struct font_glyph *font_renderer_ft_get_glyph(
          memset(dst, 0, handle->max_glyph_width * sizeof(uint8_t));
          dst += handle->atlas.width;
       }
+
+      font_atlas_set_dirty(&handle->atlas,
+            atlas_slot->glyph.atlas_offset_x,
+            atlas_slot->glyph.atlas_offset_y,
+            handle->max_glyph_width, handle->max_glyph_height);
    }
 
-   handle->atlas.dirty = true;
-   atlas_slot->last_used = handle->usage_counter++;
    return &atlas_slot->glyph;
 }
 
@@ -241,6 +261,16 @@ static bool font_renderer_create_atlas(ft_font_renderer_t *handle, float font_si
       }
    }
 
+   /* Slots are first handed out in atlas order */
+   for (i = 0; i < FT_ATLAS_SIZE; i++)
+   {
+      slot           = &handle->atlas_slots[i];
+      slot->lru_prev = (i < FT_ATLAS_SIZE - 1) ? slot + 1 : NULL;
+      slot->lru_next = (i > 0)                 ? slot - 1 : NULL;
+   }
+   handle->lru_head = &handle->atlas_slots[FT_ATLAS_SIZE - 1];
+   handle->lru_tail = &handle->atlas_slots[0];
+
    for (i = 0; i < 256; i++)
       font_renderer_ft_get_glyph(handle, i);
 
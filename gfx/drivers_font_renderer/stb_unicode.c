@@ -50,9 +50,10 @@
 typedef struct stb_unicode_atlas_slot
 {
    struct stb_unicode_atlas_slot* next;
+   struct stb_unicode_atlas_slot* lru_prev;
+   struct stb_unicode_atlas_slot* lru_next;
    struct font_glyph glyph;      /* unsigned alignment */
    unsigned charcode;
-   unsigned last_used;
 }stb_unicode_atlas_slot_t;
 
 typedef struct
@@ -61,10 +62,11 @@ typedef struct
    struct font_atlas atlas;               /* ptr alignment */
    stb_unicode_atlas_slot_t* uc_map[0x100];
    stb_unicode_atlas_slot_t atlas_slots[STB_UNICODE_ATLAS_SIZE];
+   stb_unicode_atlas_slot_t* lru_head;    /* Most recently used */
+   stb_unicode_atlas_slot_t* lru_tail;    /* Least recently used */
    stbtt_fontinfo info;                   /* ptr alignment */
    int max_glyph_width;
    int max_glyph_height;
-   unsigned usage_counter;
    float scale_factor;
    struct font_line_metrics line_metrics; /* float alignment */
 } stb_unicode_font_renderer_t;
@@ -84,29 +86,44 @@ static void font_renderer_stb_unicode_free(void *data)
    free(self);
 }
 
-static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_font_renderer_t *handle)
+/* Moves a slot to the front of the LRU list */
+static void font_renderer_stb_unicode_use_slot(
+      stb_unicode_font_renderer_t *handle, stb_unicode_atlas_slot_t *slot)
 {
-   int i, map_id;
-   unsigned oldest = 0;
+   if (handle->lru_head == slot)
+      return;
+
+   slot->lru_prev->lru_next     = slot->lru_next;
+   if (slot->lru_next)
+      slot->lru_next->lru_prev  = slot->lru_prev;
+   else
+      handle->lru_tail          = slot->lru_prev;
+
+   slot->lru_prev               = NULL;
+   slot->lru_next               = handle->lru_head;
+   handle->lru_head->lru_prev   = slot;
+   handle->lru_head             = slot;
+}
 
-   for (i = 1; i < STB_UNICODE_ATLAS_SIZE; i++)
-      if ((handle->usage_counter - handle->atlas_slots[i].last_used) >
-         (handle->usage_counter - handle->atlas_slots[oldest].last_used))
-         oldest = i;
+static stb_unicode_atlas_slot_t* font_renderer_stb_unicode_get_slot(stb_unicode_font_renderer_t *handle)
+{
+   int map_id;
+   stb_unicode_atlas_slot_t *oldest = handle->lru_tail;
 
    /* remove from map */
-   map_id = handle->atlas_slots[oldest].charcode & 0xFF;
-   if (handle->uc_map[map_id] == &handle->atlas_slots[oldest])
-      handle->uc_map[map_id] = handle->atlas_slots[oldest].next;
+   map_id = oldest->charcode & 0xFF;
+   if (handle->uc_map[map_id] == oldest)
+      handle->uc_map[map_id] = oldest->next;
    else if (handle->uc_map[map_id])
    {
       stb_unicode_atlas_slot_t* ptr = handle->uc_map[map_id];
-      while (ptr->next && ptr->next != &handle->atlas_slots[oldest])
+      while (ptr->next && ptr->next != oldest)
          ptr = ptr->next;
-      ptr->next = handle->atlas_slots[oldest].next;
+      ptr->next = oldest->next;
    }
 
-   return &handle->atlas_slots[oldest];
+   font_renderer_stb_unicode_use_slot(handle, oldest);
+   return oldest;
 }
 
 static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
@@ -134,7 +151,7 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    {
       if (atlas_slot->charcode == charcode)
       {
-         atlas_slot->last_used = self->usage_counter++;
+         font_renderer_stb_unicode_use_slot(self, atlas_slot);
          return &atlas_slot->glyph;
       }
       atlas_slot = atlas_slot->next;
@@ -185,8 +202,10 @@ static const struct font_glyph *font_renderer_stb_unicode_get_glyph(
    atlas_slot->glyph.draw_offset_y  = (int)((glyph_draw_offset_y < 0.0f) ?
          floor((double)glyph_draw_offset_y) : ceil((double)glyph_draw_offset_y));
 
-   self->atlas.dirty = true;
-   atlas_slot->last_used = self->usage_counter++;
+   font_atlas_set_dirty(&self->atlas,
+         atlas_slot->glyph.atlas_offset_x,
+         atlas_slot->glyph.atlas_offset_y,
+         self->max_glyph_width, self->max_glyph_height);
    return &atlas_slot->glyph;
 }
 
@@ -220,6 +239,16 @@ static bool font_renderer_stb_unicode_create_atlas(
       }
    }
 
+   /* Slots are first handed out in atlas order */
+   for (i = 0; i < STB_UNICODE_ATLAS_SIZE; i++)
+   {
+      slot           = &self->atlas_slots[i];
+      slot->lru_prev = (i < STB_UNICODE_ATLAS_SIZE - 1) ? slot + 1 : NULL;
+      slot->lru_next = (i > 0)                          ? slot - 1 : NULL;
+   }
+   self->lru_head = &self->atlas_slots[STB_UNICODE_ATLAS_SIZE - 1];
+   self->lru_tail = &self->atlas_slots[0];
+
    for (i = 0; i < 256; i++)
       font_renderer_stb_unicode_get_glyph(self, i);
 
@@ -15,8 +15,12 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 
+#include <retro_miscellaneous.h>
+#include <string/stdstring.h>
+
 #ifdef HAVE_CONFIG_H
 #include "../config.h"
 #endif
@@ -24,9 +28,28 @@
 #include "font_driver.h"
 #include "video_thread_wrapper.h"
 
+#include "../msg_hash.h"
 #include "../retroarch.h"
 #include "../verbosity.h"
 
+#ifdef HAVE_LANGEXTRA
+/* Number of reshaped messages kept per font, so that
+ * labels drawn on every frame are only reshaped once */
+#define FONT_SHAPE_CACHE_SIZE 32
+
+struct font_shape_cache_entry
+{
+   char *msg;
+   char *shaped;
+   uint32_t hash;
+};
+
+struct font_shape_cache
+{
+   struct font_shape_cache_entry entries[FONT_SHAPE_CACHE_SIZE];
+};
+#endif
+
 static const font_renderer_driver_t *font_backends[] = {
 #ifdef HAVE_FREETYPE
    &freetype_font_renderer,
@@ -1128,8 +1151,132 @@ static char* font_driver_reshape_msg(const char* msg, unsigned char *buffer, siz
 
    return (char*)dst_buffer;
 }
+
+static bool font_driver_msg_has_rtl(const char *msg)
+{
+   const unsigned char *src = (const unsigned char*)msg;
+
+   for (; *src; src++)
+      if (IS_RTL(src))
+         return true;
+
+   return false;
+}
+
+/* Returns the reshaped message, from the shape cache of
+ * the font, or NULL if it could not be cached */
+static const char *font_driver_get_shaped_msg(font_data_t *font,
+      const char *msg)
+{
+   uint32_t hash;
+   char *shaped                         = NULL;
+   char *msg_copy                       = NULL;
+   struct font_shape_cache_entry *entry = NULL;
+
+   /* Nothing to reshape */
+   if (!font_driver_msg_has_rtl(msg))
+      return msg;
+
+   if (!font->shape_cache)
+      if (!(font->shape_cache = (struct font_shape_cache*)
+               calloc(1, sizeof(*font->shape_cache))))
+         return NULL;
+
+   hash  = msg_hash_calculate(msg);
+   entry = &font->shape_cache->entries[hash % FONT_SHAPE_CACHE_SIZE];
+
+   if (     entry->msg
+         && entry->hash == hash
+         && string_is_equal(entry->msg, msg))
+      return entry->shaped;
+
+   if (!(msg_copy = strdup(msg)))
+      return NULL;
+
+   if (!(shaped = font_driver_reshape_msg(msg, NULL, 0)))
+   {
+      free(msg_copy);
+      return NULL;
+   }
+
+   free(entry->msg);
+   free(entry->shaped);
+   entry->msg    = msg_copy;
+   entry->shaped = shaped;
+   entry->hash   = hash;
+
+   return shaped;
+}
+
+static void font_driver_free_shape_cache(font_data_t *font)
+{
+   unsigned i;
+
+   if (!font->shape_cache)
+      return;
+
+   for (i = 0; i < FONT_SHAPE_CACHE_SIZE; i++)
+   {
+      free(font->shape_cache->entries[i].msg);
+      free(font->shape_cache->entries[i].shaped);
+   }
+
+   free(font->shape_cache);
+   font->shape_cache = NULL;
+}
 #endif
 
+void font_atlas_set_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height)
+{
+   unsigned right, bottom;
+
+   if (!atlas || !width || !height)
+      return;
+
+   if (!atlas->dirty)
+   {
+      atlas->dirty_x      = x;
+      atlas->dirty_y      = y;
+      atlas->dirty_width  = width;
+      atlas->dirty_height = height;
+      atlas->dirty        = true;
+      return;
+   }
+
+   /* Whole atlas already */
+   if (!atlas->dirty_width || !atlas->dirty_height)
+      return;
+
+   right               = MAX(x + width,  atlas->dirty_x + atlas->dirty_width);
+   bottom              = MAX(y + height, atlas->dirty_y + atlas->dirty_height);
+   atlas->dirty_x      = MIN(x, atlas->dirty_x);
+   atlas->dirty_y      = MIN(y, atlas->dirty_y);
+   atlas->dirty_width  = right  - atlas->dirty_x;
+   atlas->dirty_height = bottom - atlas->dirty_y;
+}
+
+void font_atlas_get_dirty(const struct font_atlas *atlas,
+      unsigned *x, unsigned *y, unsigned *width, unsigned *height)
+{
+   if (     !atlas->dirty_width
+         || !atlas->dirty_height
+         || atlas->dirty_x >= atlas->width
+         || atlas->dirty_y >= atlas->height)
+   {
+      *x      = 0;
+      *y      = 0;
+      *width  = atlas->width;
+      *height = atlas->height;
+      return;
+   }
+
+   *x      = atlas->dirty_x;
+   *y      = atlas->dirty_y;
+   *width  = MIN(atlas->dirty_width,  atlas->width  - atlas->dirty_x);
+   *height = MIN(atlas->dirty_height, atlas->height - atlas->dirty_y);
+}
+
 void font_driver_render_msg(
       void *data,
       const char *msg,
@@ -1144,15 +1291,21 @@ void font_driver_render_msg(
    {
 #ifdef HAVE_LANGEXTRA
       unsigned char tmp_buffer[64];
-      char *new_msg = font_driver_reshape_msg(msg, tmp_buffer, sizeof(tmp_buffer));
+      char *tmp_msg       = NULL;
+      const char *new_msg = font_driver_get_shaped_msg(font, msg);
+
+      /* Could not be cached, reshape it for this call only */
+      if (!new_msg)
+         new_msg = tmp_msg = font_driver_reshape_msg(msg,
+               tmp_buffer, sizeof(tmp_buffer));
 #else
-      char *new_msg = (char*)msg;
+      const char *new_msg = msg;
 #endif
       font->renderer->render_msg(data,
             font->renderer_data, new_msg, params);
 #ifdef HAVE_LANGEXTRA
-      if (new_msg != (char*)tmp_buffer)
-         free(new_msg);
+      if (tmp_msg && tmp_msg != (char*)tmp_buffer)
+         free(tmp_msg);
 #endif
    }
 }
@@ -1266,6 +1419,10 @@ void font_driver_free(void *font_data)
       font->renderer      = NULL;
       font->renderer_data = NULL;
 
+#ifdef HAVE_LANGEXTRA
+      font_driver_free_shape_cache(font);
+#endif
+
       free(font);
    }
 }
@@ -1296,6 +1453,7 @@ font_data_t *font_driver_init_first(
       font_data_t *font   = (font_data_t*)malloc(sizeof(*font));
       font->renderer      = (const font_renderer_t*)font_driver;
       font->renderer_data = font_handle;
+      font->shape_cache   = NULL;
       font->size          = font_size;
       return font;
    }
@@ -60,6 +60,12 @@ struct font_atlas
    uint8_t *buffer; /* Alpha channel. */
    unsigned width;
    unsigned height;
+   /* Region changed since the last upload, when dirty.
+    * An empty region means the whole atlas. */
+   unsigned dirty_x;
+   unsigned dirty_y;
+   unsigned dirty_width;
+   unsigned dirty_height;
    bool dirty;
 };
 
@@ -128,10 +134,13 @@ typedef struct font_renderer_driver
    bool (*get_line_metrics)(void* data, struct font_line_metrics **metrics);
 } font_renderer_driver_t;
 
+struct font_shape_cache;
+
 typedef struct
 {
    const font_renderer_t *renderer;
    void *renderer_data;
+   struct font_shape_cache *shape_cache;
    float size;
 } font_data_t;
 
@@ -141,6 +150,14 @@ int font_renderer_create_default(
       void **handle,
       const char *font_path, unsigned font_size);
 
+/* Adds a region to the changed part of an atlas */
+void font_atlas_set_dirty(struct font_atlas *atlas,
+      unsigned x, unsigned y, unsigned width, unsigned height);
+
+/* Gets the changed part of a dirty atlas */
+void font_atlas_get_dirty(const struct font_atlas *atlas,
+      unsigned *x, unsigned *y, unsigned *width, unsigned *height);
+
 void font_driver_render_msg(void *data,
       const char *msg, const void *params, void *font_data);
 
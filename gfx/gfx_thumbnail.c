@@ -24,6 +24,8 @@
 #include <string.h>
 #include <ctype.h>
 
+#include <array/rhmap.h>
+#include <compat/strl.h>
 #include <features/features_cpu.h>
 #include <file/file_path.h>
 #include <string/stdstring.h>
@@ -38,14 +40,289 @@
 #define DEFAULT_GFX_THUMBNAIL_STREAM_DELAY  83.333333f
 #define DEFAULT_GFX_THUMBNAIL_FADE_DURATION 166.66667f
 
+/* Number of entries ahead of the view for which
+ * thumbnails are prefetched */
+#define GFX_THUMBNAIL_PREFETCH_COUNT 4
+
+/* Granularity of the maximum thumbnail size, so that
+ * resizing the window does not keep invalidating the
+ * thumbnails stored in the cache directory */
+#define GFX_THUMBNAIL_MAX_SIZE_STEP 256
+
 /* Utility structure, sent as userdata when pushing
- * an image load */
+ * an image load
+ * > 'thumbnail' is NULL when prefetching
+ * > 'cache_key' is NULL when the image is not to be
+ *   added to the texture cache */
 typedef struct
 {
    uint64_t list_id;
+   uint64_t cache_id;
    gfx_thumbnail_t *thumbnail;
+   char *cache_key;
 } gfx_thumbnail_tag_t;
 
+struct gfx_thumbnail_cache_entry
+{
+   gfx_thumbnail_cache_entry_t *prev; /* More recently used */
+   gfx_thumbnail_cache_entry_t *next; /* Less recently used */
+   char *key;
+   uintptr_t texture;
+   size_t size;
+   unsigned width;
+   unsigned height;
+   unsigned refs;
+   /* True while the image of a prefetched entry
+    * is being loaded (entry has no texture yet) */
+   bool pending;
+};
+
+/* Gets the largest size a thumbnail is drawn at.
+ * No menu draws a thumbnail larger than fullscreen,
+ * so this is the video output size, rounded up */
+static void gfx_thumbnail_get_max_size(unsigned *width, unsigned *height)
+{
+   *width  = 0;
+   *height = 0;
+
+   video_driver_get_size(width, height);
+
+   *width  = (*width  + GFX_THUMBNAIL_MAX_SIZE_STEP - 1)
+      / GFX_THUMBNAIL_MAX_SIZE_STEP * GFX_THUMBNAIL_MAX_SIZE_STEP;
+   *height = (*height + GFX_THUMBNAIL_MAX_SIZE_STEP - 1)
+      / GFX_THUMBNAIL_MAX_SIZE_STEP * GFX_THUMBNAIL_MAX_SIZE_STEP;
+}
+
+/* Texture cache */
+
+/* Builds the texture cache key of an image
+ * (the same image may be cached at several
+ * upscale thresholds) */
+static void gfx_thumbnail_cache_get_key(char *s, size_t len,
+      const char *path, unsigned upscale_threshold)
+{
+   size_t _len = snprintf(s, len, "%u|", upscale_threshold);
+   if (_len < len)
+      strlcpy(s + _len, path, len - _len);
+}
+
+static void gfx_thumbnail_cache_unlink(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   if (entry->prev)
+      entry->prev->next       = entry->next;
+   else
+      p_gfx_thumb->cache_head = entry->next;
+
+   if (entry->next)
+      entry->next->prev       = entry->prev;
+   else
+      p_gfx_thumb->cache_tail = entry->prev;
+
+   entry->prev = NULL;
+   entry->next = NULL;
+}
+
+/* Marks entry as most recently used */
+static void gfx_thumbnail_cache_touch(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   if (p_gfx_thumb->cache_head == entry)
+      return;
+
+   if (entry->prev || entry->next || (p_gfx_thumb->cache_tail == entry))
+      gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+
+   entry->next = p_gfx_thumb->cache_head;
+   if (p_gfx_thumb->cache_head)
+      p_gfx_thumb->cache_head->prev = entry;
+   p_gfx_thumb->cache_head = entry;
+
+   if (!p_gfx_thumb->cache_tail)
+      p_gfx_thumb->cache_tail = entry;
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_find(
+      gfx_thumbnail_state_t *p_gfx_thumb, const char *key)
+{
+   /* Lookups must not allocate the map */
+   if (!p_gfx_thumb->cache_map || !key)
+      return NULL;
+   return RHMAP_GET_STR(p_gfx_thumb->cache_map, key);
+}
+
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_add(
+      gfx_thumbnail_state_t *p_gfx_thumb, const char *key)
+{
+   gfx_thumbnail_cache_entry_t *entry = (gfx_thumbnail_cache_entry_t*)
+         calloc(1, sizeof(*entry));
+
+   if (!entry)
+      return NULL;
+
+   if (!(entry->key = strdup(key)))
+   {
+      free(entry);
+      return NULL;
+   }
+
+   RHMAP_SET_STR(p_gfx_thumb->cache_map, entry->key, entry);
+   gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+
+   return entry;
+}
+
+static void gfx_thumbnail_cache_remove(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry)
+{
+   gfx_thumbnail_cache_unlink(p_gfx_thumb, entry);
+   (void)RHMAP_DEL_STR(p_gfx_thumb->cache_map, entry->key);
+
+   if (entry->texture)
+   {
+      video_driver_texture_unload(&entry->texture);
+      p_gfx_thumb->cache_used -= entry->size;
+   }
+
+   free(entry->key);
+   free(entry);
+}
+
+/* Unloads least recently used textures that no
+ * thumbnail uses, until the cache is within budget */
+static void gfx_thumbnail_cache_evict(gfx_thumbnail_state_t *p_gfx_thumb)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_tail;
+
+   while (entry && (p_gfx_thumb->cache_used > p_gfx_thumb->cache_size))
+   {
+      gfx_thumbnail_cache_entry_t *prev = entry->prev;
+
+      if ((entry->refs == 0) && entry->texture)
+         gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+
+      entry = prev;
+   }
+}
+
+/* Releases the cached texture of a thumbnail
+ * > Thumbnails only hold the texture handle; the
+ *   cache is small enough for a linear search */
+static void gfx_thumbnail_cache_release(
+      gfx_thumbnail_state_t *p_gfx_thumb, uintptr_t texture)
+{
+   gfx_thumbnail_cache_entry_t *entry = p_gfx_thumb->cache_head;
+
+   for (; entry; entry = entry->next)
+   {
+      if (entry->texture != texture)
+         continue;
+
+      if (entry->refs > 0)
+         entry->refs--;
+
+      gfx_thumbnail_cache_evict(p_gfx_thumb);
+      return;
+   }
+
+   /* Texture not found: cache was flushed while
+    * the thumbnail was in use, and the texture is
+    * already unloaded */
+}
+
+/* Assigns the texture of a cache entry to a thumbnail */
+static void gfx_thumbnail_cache_assign(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_cache_entry_t *entry,
+      gfx_thumbnail_t *thumbnail)
+{
+   entry->refs++;
+   gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+
+   thumbnail->texture = entry->texture;
+   thumbnail->width   = entry->width;
+   thumbnail->height  = entry->height;
+   thumbnail->cached  = true;
+   thumbnail->status  = GFX_THUMBNAIL_STATUS_AVAILABLE;
+}
+
+/* Uploads a loaded image to the texture cache
+ * Returns cache entry holding the texture of the
+ * image, or NULL if the image could not be cached */
+static gfx_thumbnail_cache_entry_t *gfx_thumbnail_cache_upload(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_tag_t *thumbnail_tag,
+      struct texture_image *img)
+{
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+
+   /* Cache was flushed or disabled since the image
+    * load was pushed */
+   if (     (thumbnail_tag->cache_id != p_gfx_thumb->cache_id)
+         || (p_gfx_thumb->cache_size == 0))
+      return NULL;
+
+   entry = gfx_thumbnail_cache_find(p_gfx_thumb, thumbnail_tag->cache_key);
+
+   /* Image was already loaded by another request */
+   if (entry && entry->texture)
+      return entry;
+
+   if (!img || (img->width < 1) || (img->height < 1))
+      goto error;
+
+   if (!entry && !(entry = gfx_thumbnail_cache_add(
+         p_gfx_thumb, thumbnail_tag->cache_key)))
+      return NULL;
+
+   if (!video_driver_texture_load(
+            img, TEXTURE_FILTER_MIPMAP_LINEAR, &entry->texture))
+      goto error;
+
+   entry->width             = img->width;
+   entry->height            = img->height;
+   entry->size              = img->width * img->height * sizeof(uint32_t);
+   entry->pending           = false;
+   p_gfx_thumb->cache_used += entry->size;
+
+   gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+
+   return entry;
+
+error:
+   /* Drop pending entry of a failed prefetch */
+   if (entry)
+      gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+   return NULL;
+}
+
+/* Unloads all textures of the thumbnail texture cache
+ * >> **MUST** be called when the graphics context is
+ *    destroyed, since cached textures outlive the
+ *    thumbnails of the menu driver */
+void gfx_thumbnail_cache_flush(void)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   while (p_gfx_thumb->cache_head)
+      gfx_thumbnail_cache_remove(p_gfx_thumb, p_gfx_thumb->cache_head);
+
+   RHMAP_FREE(p_gfx_thumb->cache_map);
+
+   if (p_gfx_thumb->prefetch_path_data)
+      free(p_gfx_thumb->prefetch_path_data);
+
+   p_gfx_thumb->prefetch_path_data = NULL;
+   p_gfx_thumb->prefetch_playlist  = NULL;
+   p_gfx_thumb->prefetch_first     = 0;
+   p_gfx_thumb->prefetch_last      = 0;
+   p_gfx_thumb->cache_used         = 0;
+   p_gfx_thumb->cache_id++;
+}
+
 /* Setters */
 
 /* When streaming thumbnails, sets time in ms that an
@@ -82,6 +359,18 @@ void gfx_thumbnail_set_fade_missing(bool fade_missing)
    p_gfx_thumb->fade_missing = fade_missing;
 }
 
+/* Sets memory budget in bytes of the thumbnail
+ * texture cache
+ * > If 'size' is zero, the cache is disabled and
+ *   all unused textures are unloaded */
+void gfx_thumbnail_set_cache_size(size_t size)
+{
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   p_gfx_thumb->cache_size = size;
+   gfx_thumbnail_cache_evict(p_gfx_thumb);
+}
+
 /* Callbacks */
 
 /* Fade animation callback - simply resets thumbnail
@@ -142,12 +431,24 @@ static void gfx_thumbnail_handle_upload(
    gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
    struct texture_image *img          = (struct texture_image*)task_data;
    gfx_thumbnail_tag_t *thumbnail_tag = (gfx_thumbnail_tag_t*)user_data;
+   gfx_thumbnail_cache_entry_t *entry = NULL;
    bool fade_enabled                  = false;
 
    /* Sanity check */
    if (!thumbnail_tag)
       goto end;
 
+   /* Add image to texture cache, if required
+    * > This is done even if the image is no longer
+    *   wanted by the thumbnail, since it is likely
+    *   to be requested again when scrolling back */
+   if (thumbnail_tag->cache_key)
+      entry = gfx_thumbnail_cache_upload(p_gfx_thumb, thumbnail_tag, img);
+
+   /* Prefetched images have no thumbnail */
+   if (!thumbnail_tag->thumbnail)
+      goto end;
+
    /* Ensure that we are operating on the correct
     * thumbnail... */
    if (thumbnail_tag->list_id != p_gfx_thumb->list_id)
@@ -173,6 +474,14 @@ static void gfx_thumbnail_handle_upload(
     * thumbnail status and global configuration) */
    fade_enabled = true;
 
+   /* Use cached texture, if available */
+   if (entry)
+   {
+      gfx_thumbnail_cache_assign(p_gfx_thumb, entry,
+            thumbnail_tag->thumbnail);
+      goto end;
+   }
+
    /* Check we have a valid image */
    if (!img || (img->width < 1) || (img->height < 1))
       goto end;
@@ -205,8 +514,14 @@ end:
          gfx_thumbnail_init_fade(p_gfx_thumb,
                thumbnail_tag->thumbnail);
 
+      if (thumbnail_tag->cache_key)
+         free(thumbnail_tag->cache_key);
       free(thumbnail_tag);
    }
+
+   /* New texture may exceed cache budget */
+   if (entry)
+      gfx_thumbnail_cache_evict(p_gfx_thumb);
 }
 
 /* Core interface */
@@ -266,25 +581,58 @@ void gfx_thumbnail_request(
    /* Load thumbnail, if required */
    if (has_thumbnail)
    {
+      char cache_key[PATH_MAX_LENGTH + 16];
+      gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+
+      cache_key[0] = '\0';
+
+      /* Use cached texture, if available */
+      if (p_gfx_thumb->cache_size > 0)
+      {
+         gfx_thumbnail_cache_entry_t *entry = NULL;
+
+         gfx_thumbnail_cache_get_key(cache_key, sizeof(cache_key),
+               thumbnail_path, gfx_thumbnail_upscale_threshold);
+
+         entry = gfx_thumbnail_cache_find(p_gfx_thumb, cache_key);
+
+         if (entry && entry->texture)
+         {
+            gfx_thumbnail_cache_assign(p_gfx_thumb, entry, thumbnail);
+            goto end;
+         }
+      }
+
       if (path_is_valid(thumbnail_path))
       {
-         gfx_thumbnail_tag_t *thumbnail_tag =
-               (gfx_thumbnail_tag_t*)malloc(sizeof(gfx_thumbnail_tag_t));
+         unsigned max_width, max_height;
 
-         if (!thumbnail_tag)
+         if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)
+                  malloc(sizeof(gfx_thumbnail_tag_t))))
             goto end;
 
+         gfx_thumbnail_get_max_size(&max_width, &max_height);
+
          /* Configure user data */
          thumbnail_tag->thumbnail = thumbnail;
          thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+         thumbnail_tag->cache_id  = p_gfx_thumb->cache_id;
+         thumbnail_tag->cache_key = string_is_empty(cache_key) ?
+               NULL : strdup(cache_key);
 
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if (task_push_image_load(
+         if (task_push_image_load_cached(
                thumbnail_path, video_driver_supports_rgba(),
-               gfx_thumbnail_upscale_threshold,
+               gfx_thumbnail_upscale_threshold, max_width, max_height,
                gfx_thumbnail_handle_upload, thumbnail_tag))
             thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+         else
+         {
+            if (thumbnail_tag->cache_key)
+               free(thumbnail_tag->cache_key);
+            free(thumbnail_tag);
+         }
       }
 #ifdef HAVE_NETWORKING
       /* Handle on demand thumbnail downloads */
@@ -374,9 +722,14 @@ void gfx_thumbnail_request_file(
    if (!thumbnail_tag)
       return;
 
-   /* Configure user data */
+   /* Configure user data
+    * > Images loaded from specific files (e.g.
+    *   savestate images) change too often to be
+    *   worth caching */
    thumbnail_tag->thumbnail = thumbnail;
    thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   thumbnail_tag->cache_id  = p_gfx_thumb->cache_id;
+   thumbnail_tag->cache_key = NULL;
 
    /* Would like to cancel any existing image load tasks
     * here, but can't see how to do it... */
@@ -385,6 +738,8 @@ void gfx_thumbnail_request_file(
          gfx_thumbnail_upscale_threshold,
          gfx_thumbnail_handle_upload, thumbnail_tag))
       thumbnail->status = GFX_THUMBNAIL_STATUS_PENDING;
+   else
+      free(thumbnail_tag);
 }
 
 /* Resets (and free()s the current texture of) the
@@ -394,9 +749,16 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    if (!thumbnail)
       return;
 
-   /* Unload texture */
+   /* Unload texture (or hand it back to the
+    * texture cache) */
    if (thumbnail->texture)
-      video_driver_texture_unload(&thumbnail->texture);
+   {
+      if (thumbnail->cached)
+         gfx_thumbnail_cache_release(gfx_thumb_get_ptr(),
+               thumbnail->texture);
+      else
+         video_driver_texture_unload(&thumbnail->texture);
+   }
 
    /* Ensure any 'fade in' animation is killed */
    if (thumbnail->fade_active)
@@ -413,6 +775,7 @@ void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail)
    thumbnail->alpha       = 0.0f;
    thumbnail->delay_timer = 0.0f;
    thumbnail->fade_active = false;
+   thumbnail->cached      = false;
 }
 
 /* Stream processing */
@@ -611,6 +974,163 @@ void gfx_thumbnail_process_streams(
    }
 }
 
+/* Prefetching */
+
+/* Pushes a load of the specified thumbnail of the
+ * current content of 'path_data' into the texture
+ * cache, unless it is already cached */
+static void gfx_thumbnail_prefetch_image(
+      gfx_thumbnail_state_t *p_gfx_thumb,
+      gfx_thumbnail_path_data_t *path_data,
+      enum gfx_thumbnail_id thumbnail_id,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   char cache_key[PATH_MAX_LENGTH + 16];
+   unsigned max_width, max_height;
+   const char *thumbnail_path         = NULL;
+   gfx_thumbnail_cache_entry_t *entry = NULL;
+   gfx_thumbnail_tag_t *thumbnail_tag = NULL;
+
+   if (!gfx_thumbnail_is_enabled(path_data, thumbnail_id))
+      return;
+
+   if (     !gfx_thumbnail_update_path(path_data, thumbnail_id)
+         || !gfx_thumbnail_get_path(path_data, thumbnail_id, &thumbnail_path))
+      return;
+
+   gfx_thumbnail_cache_get_key(cache_key, sizeof(cache_key),
+         thumbnail_path, gfx_thumbnail_upscale_threshold);
+
+   /* Already cached (or being loaded)
+    * > Mark as recently used, so that it survives
+    *   until it comes into view */
+   if ((entry = gfx_thumbnail_cache_find(p_gfx_thumb, cache_key)))
+   {
+      gfx_thumbnail_cache_touch(p_gfx_thumb, entry);
+      return;
+   }
+
+   if (!path_is_valid(thumbnail_path))
+      return;
+
+   if (!(thumbnail_tag = (gfx_thumbnail_tag_t*)
+            malloc(sizeof(gfx_thumbnail_tag_t))))
+      return;
+
+   thumbnail_tag->thumbnail = NULL;
+   thumbnail_tag->list_id   = p_gfx_thumb->list_id;
+   thumbnail_tag->cache_id  = p_gfx_thumb->cache_id;
+   thumbnail_tag->cache_key = strdup(cache_key);
+
+   /* Entry is added in 'pending' state, so that
+    * the image is not loaded twice by subsequent
+    * prefetches */
+   if (     thumbnail_tag->cache_key
+         && (entry = gfx_thumbnail_cache_add(p_gfx_thumb, cache_key)))
+   {
+      entry->pending = true;
+
+      gfx_thumbnail_get_max_size(&max_width, &max_height);
+
+      if (task_push_image_load_cached(
+            thumbnail_path, video_driver_supports_rgba(),
+            gfx_thumbnail_upscale_threshold, max_width, max_height,
+            gfx_thumbnail_handle_upload, thumbnail_tag))
+         return;
+
+      gfx_thumbnail_cache_remove(p_gfx_thumb, entry);
+   }
+
+   if (thumbnail_tag->cache_key)
+      free(thumbnail_tag->cache_key);
+   free(thumbnail_tag);
+}
+
+/* Loads the thumbnails of the playlist entries about
+ * to come into view into the texture cache, so that
+ * they are available as soon as they are requested
+ * - 'first'/'last' are the playlist indices of the
+ *   first/last entry currently in view (identical
+ *   when only the selected entry has thumbnails)
+ * - Entries following 'last' are loaded when the
+ *   view moved down since the last call, entries
+ *   preceding 'first' when it moved up
+ * - 'right'/'left' select the thumbnails to load
+ * - Does nothing when the texture cache is disabled
+ * NOTE: Must be called *after* gfx_thumbnail_set_system() */
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, size_t first, size_t last,
+      bool right, bool left,
+      unsigned gfx_thumbnail_upscale_threshold)
+{
+   size_t i;
+   size_t num_entries;
+   bool forward                       = true;
+   gfx_thumbnail_state_t *p_gfx_thumb = gfx_thumb_get_ptr();
+
+   if (!path_data || !playlist || (!right && !left))
+      return;
+
+   if (p_gfx_thumb->cache_size == 0)
+      return;
+
+   /* Only act when the view has moved */
+   if (playlist == p_gfx_thumb->prefetch_playlist)
+   {
+      if (     (first == p_gfx_thumb->prefetch_first)
+            && (last  == p_gfx_thumb->prefetch_last))
+         return;
+
+      forward = (first > p_gfx_thumb->prefetch_first) ||
+                (last  > p_gfx_thumb->prefetch_last);
+   }
+
+   p_gfx_thumb->prefetch_playlist = playlist;
+   p_gfx_thumb->prefetch_first    = first;
+   p_gfx_thumb->prefetch_last     = last;
+
+   if (!p_gfx_thumb->prefetch_path_data &&
+       !(p_gfx_thumb->prefetch_path_data = gfx_thumbnail_path_init()))
+      return;
+
+   gfx_thumbnail_path_copy(p_gfx_thumb->prefetch_path_data, path_data);
+
+   num_entries = playlist_size(playlist);
+
+   for (i = 1; i <= GFX_THUMBNAIL_PREFETCH_COUNT; i++)
+   {
+      size_t idx;
+
+      if (forward)
+      {
+         if (last + i >= num_entries)
+            break;
+         idx = last + i;
+      }
+      else
+      {
+         if (first < i)
+            break;
+         idx = first - i;
+      }
+
+      if (!gfx_thumbnail_set_content_playlist(
+            p_gfx_thumb->prefetch_path_data, playlist, idx))
+         continue;
+
+      if (right)
+         gfx_thumbnail_prefetch_image(p_gfx_thumb,
+               p_gfx_thumb->prefetch_path_data, GFX_THUMBNAIL_RIGHT,
+               gfx_thumbnail_upscale_threshold);
+
+      if (left)
+         gfx_thumbnail_prefetch_image(p_gfx_thumb,
+               p_gfx_thumb->prefetch_path_data, GFX_THUMBNAIL_LEFT,
+               gfx_thumbnail_upscale_threshold);
+   }
+}
+
 /* Thumbnail rendering */
 
 /* Determines the actual screen dimensions of a
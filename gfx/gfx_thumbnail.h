@@ -74,6 +74,9 @@ typedef struct
    float delay_timer;
    enum gfx_thumbnail_status status;
    bool fade_active;
+   /* When true, 'texture' belongs to the thumbnail
+    * texture cache and is not unloaded on reset */
+   bool cached;
 } gfx_thumbnail_t;
 
 /* Holds all configuration parameters associated
@@ -93,10 +96,44 @@ typedef struct
    enum gfx_thumbnail_shadow_type type;
 } gfx_thumbnail_shadow_t;
 
+/* Texture cache entry, holding the texture of
+ * one thumbnail image at one upscale threshold */
+typedef struct gfx_thumbnail_cache_entry gfx_thumbnail_cache_entry_t;
+
 /* Structure containing all gfx_thumbnail
  * variables */
 struct gfx_thumbnail_state
 {
+   /* Texture cache, shared by all menu drivers
+    * > Entries are indexed by image path/upscale
+    *   threshold and linked in most recently used
+    *   order
+    * > Entries that no thumbnail uses are kept
+    *   resident until the total size of all cached
+    *   textures exceeds 'cache_size' */
+   gfx_thumbnail_cache_entry_t **cache_map;
+   gfx_thumbnail_cache_entry_t *cache_head;
+   gfx_thumbnail_cache_entry_t *cache_tail;
+
+   /* Path data used to look up the thumbnails of
+    * entries being prefetched, so that the path data
+    * of the menu driver is left untouched */
+   gfx_thumbnail_path_data_t *prefetch_path_data;
+   playlist_t *prefetch_playlist;
+   size_t prefetch_first;
+   size_t prefetch_last;
+
+   /* Memory budget and current size in bytes of
+    * the texture cache (a budget of zero disables
+    * the cache) */
+   size_t cache_size;
+   size_t cache_used;
+
+   /* Incremented whenever the texture cache is
+    * flushed, so that loads pushed beforehand are
+    * not added to it */
+   uint64_t cache_id;
+
    /* Due to the asynchronous nature of thumbnail
     * loading, it is quite possible to trigger a load
     * then navigate to a different menu list before
@@ -145,6 +182,12 @@ void gfx_thumbnail_set_fade_duration(float duration);
  *   any 'thumbnail unavailable' notifications */
 void gfx_thumbnail_set_fade_missing(bool fade_missing);
 
+/* Sets memory budget in bytes of the thumbnail
+ * texture cache
+ * > If 'size' is zero, the cache is disabled and
+ *   all unused textures are unloaded */
+void gfx_thumbnail_set_cache_size(size_t size);
+
 /* Core interface */
 
 /* When called, prevents the handling of any pending
@@ -190,6 +233,30 @@ void gfx_thumbnail_request_file(
  * specified thumbnail */
 void gfx_thumbnail_reset(gfx_thumbnail_t *thumbnail);
 
+/* Unloads all textures of the thumbnail texture cache
+ * >> **MUST** be called when the graphics context is
+ *    destroyed, since cached textures outlive the
+ *    thumbnails of the menu driver */
+void gfx_thumbnail_cache_flush(void);
+
+/* Loads the thumbnails of the playlist entries about
+ * to come into view into the texture cache, so that
+ * they are available as soon as they are requested
+ * - 'first'/'last' are the playlist indices of the
+ *   first/last entry currently in view (identical
+ *   when only the selected entry has thumbnails)
+ * - Entries following 'last' are loaded when the
+ *   view moved down since the last call, entries
+ *   preceding 'first' when it moved up
+ * - 'right'/'left' select the thumbnails to load
+ * - Does nothing when the texture cache is disabled
+ * NOTE: Must be called *after* gfx_thumbnail_set_system() */
+void gfx_thumbnail_prefetch(
+      gfx_thumbnail_path_data_t *path_data,
+      playlist_t *playlist, size_t first, size_t last,
+      bool right, bool left,
+      unsigned gfx_thumbnail_upscale_threshold);
+
 /* Stream processing */
 
 /* Handles streaming of the specified thumbnail as it moves
@@ -72,6 +72,16 @@ void gfx_thumbnail_path_reset(gfx_thumbnail_path_data_t *path_data)
    path_data->playlist_left_mode  = PLAYLIST_THUMBNAIL_MODE_DEFAULT;
 }
 
+/* Copies thumbnail path data */
+void gfx_thumbnail_path_copy(gfx_thumbnail_path_data_t *dst,
+      const gfx_thumbnail_path_data_t *src)
+{
+   if (!dst || !src || (dst == src))
+      return;
+
+   memcpy(dst, src, sizeof(*dst));
+}
+
 /* Initialisation */
 
 /* Creates new thumbnail path data container.
@@ -20,12 +20,31 @@
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation normal2x_get_implementation
 #define softfilter_thread_data normal2x_softfilter_thread_data
 #define filter_data normal2x_filter_data
 #endif
 
+/* Vectorized inner loops double pixels [x, width) of a row.
+ * Returns the first pixel left undoubled. */
+typedef unsigned (*normal2x_row_xrgb8888_t)(uint32_t *out,
+      const uint32_t *in, unsigned x, unsigned width);
+typedef unsigned (*normal2x_row_rgb565_t)(uint16_t *out,
+      const uint16_t *in, unsigned x, unsigned width);
+
 struct softfilter_thread_data
 {
    void *out_data;
@@ -44,8 +63,100 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   normal2x_row_xrgb8888_t row_xrgb8888;
+   normal2x_row_rgb565_t row_rgb565;
 };
 
+#if defined(__SSE2__)
+static unsigned normal2x_row_xrgb8888_sse2(uint32_t *out,
+      const uint32_t *in, unsigned x, unsigned width)
+{
+   for (; x + 4 <= width; x += 4)
+   {
+      __m128i color = _mm_loadu_si128((const __m128i*)(in + x));
+      _mm_storeu_si128((__m128i*)(out + 2 * x),     _mm_unpacklo_epi32(color, color));
+      _mm_storeu_si128((__m128i*)(out + 2 * x + 4), _mm_unpackhi_epi32(color, color));
+   }
+
+   return x;
+}
+
+static unsigned normal2x_row_rgb565_sse2(uint16_t *out,
+      const uint16_t *in, unsigned x, unsigned width)
+{
+   for (; x + 8 <= width; x += 8)
+   {
+      __m128i color = _mm_loadu_si128((const __m128i*)(in + x));
+      _mm_storeu_si128((__m128i*)(out + 2 * x),     _mm_unpacklo_epi16(color, color));
+      _mm_storeu_si128((__m128i*)(out + 2 * x + 8), _mm_unpackhi_epi16(color, color));
+   }
+
+   return x;
+}
+#endif
+
+#if defined(__AVX2__)
+/* Pixels are permuted across lanes up front, so that the
+ * in-lane unpacks leave them in order. */
+static unsigned normal2x_row_xrgb8888_avx2(uint32_t *out,
+      const uint32_t *in, unsigned x, unsigned width)
+{
+   for (; x + 8 <= width; x += 8)
+   {
+      __m256i color = _mm256_permute4x64_epi64(
+            _mm256_loadu_si256((const __m256i*)(in + x)), 0xd8);
+      _mm256_storeu_si256((__m256i*)(out + 2 * x),     _mm256_unpacklo_epi32(color, color));
+      _mm256_storeu_si256((__m256i*)(out + 2 * x + 8), _mm256_unpackhi_epi32(color, color));
+   }
+
+   return normal2x_row_xrgb8888_sse2(out, in, x, width);
+}
+
+static unsigned normal2x_row_rgb565_avx2(uint16_t *out,
+      const uint16_t *in, unsigned x, unsigned width)
+{
+   for (; x + 16 <= width; x += 16)
+   {
+      __m256i color = _mm256_permute4x64_epi64(
+            _mm256_loadu_si256((const __m256i*)(in + x)), 0xd8);
+      _mm256_storeu_si256((__m256i*)(out + 2 * x),      _mm256_unpacklo_epi16(color, color));
+      _mm256_storeu_si256((__m256i*)(out + 2 * x + 16), _mm256_unpackhi_epi16(color, color));
+   }
+
+   return normal2x_row_rgb565_sse2(out, in, x, width);
+}
+#endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+static unsigned normal2x_row_xrgb8888_neon(uint32_t *out,
+      const uint32_t *in, unsigned x, unsigned width)
+{
+   for (; x + 4 <= width; x += 4)
+   {
+      uint32x4x2_t color;
+      color.val[0] = vld1q_u32(in + x);
+      color.val[1] = color.val[0];
+      vst2q_u32(out + 2 * x, color);
+   }
+
+   return x;
+}
+
+static unsigned normal2x_row_rgb565_neon(uint16_t *out,
+      const uint16_t *in, unsigned x, unsigned width)
+{
+   for (; x + 8 <= width; x += 8)
+   {
+      uint16x8x2_t color;
+      color.val[0] = vld1q_u16(in + x);
+      color.val[1] = color.val[0];
+      vst2q_u16(out + 2 * x, color);
+   }
+
+   return x;
+}
+#endif
+
 static unsigned normal2x_generic_input_fmts(void)
 {
    return SOFTFILTER_FMT_XRGB8888 | SOFTFILTER_FMT_RGB565;
@@ -68,7 +179,6 @@ static void *normal2x_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
 
@@ -84,6 +194,31 @@ static void *normal2x_generic_create(const struct softfilter_config *config,
       free(filt);
       return NULL;
    }
+
+#if defined(__AVX2__)
+   if (simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->row_xrgb8888 = normal2x_row_xrgb8888_avx2;
+      filt->row_rgb565   = normal2x_row_rgb565_avx2;
+   }
+   else
+#endif
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->row_xrgb8888 = normal2x_row_xrgb8888_sse2;
+      filt->row_rgb565   = normal2x_row_rgb565_sse2;
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd & SOFTFILTER_SIMD_NEON)
+   {
+      filt->row_xrgb8888 = normal2x_row_xrgb8888_neon;
+      filt->row_rgb565   = normal2x_row_rgb565_neon;
+   }
+#else
+   (void)simd;
+#endif
+
    return filt;
 }
 
@@ -105,8 +240,11 @@ static void normal2x_generic_destroy(void *data)
    free(filt);
 }
 
+/* The first output row of each input row is doubled
+ * horizontally, and then copied to the second one. */
 static void normal2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    const uint32_t *input              = (const uint32_t*)thr->in_data;
    uint32_t *output                   = (uint32_t*)thr->out_data;
@@ -116,26 +254,20 @@ static void normal2x_work_cb_xrgb8888(void *data, void *thread_data)
 
    for (y = 0; y < thr->height; ++y)
    {
-      uint32_t *out_ptr = output;
-      for (x = 0; x < thr->width; ++x)
-      {
-         uint32_t *out_line_ptr = out_ptr;
-         uint32_t color         = *(input + x);
-         uint32_t row_color[2];
+      x = 0;
+      if (filt->row_xrgb8888)
+         x = filt->row_xrgb8888(output, input, x, thr->width);
 
-         row_color[0] = color;
-         row_color[1] = color;
-
-         /* Row 1 */
-         memcpy(out_line_ptr, row_color, sizeof(row_color));
-         out_line_ptr += out_stride;
-
-         /* Row 2 */
-         memcpy(out_line_ptr, row_color, sizeof(row_color));
-
-         out_ptr += 2;
+      for (; x < thr->width; ++x)
+      {
+         uint32_t color    = *(input + x);
+         output[2 * x]     = color;
+         output[2 * x + 1] = color;
       }
 
+      /* Row 2 */
+      memcpy(output + out_stride, output, thr->width * 2 * sizeof(uint32_t));
+
       input  += in_stride;
       output += out_stride << 1;
    }
@@ -143,35 +275,30 @@ static void normal2x_work_cb_xrgb8888(void *data, void *thread_data)
 
 static void normal2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    const uint16_t *input              = (const uint16_t*)thr->in_data;
    uint16_t *output                   = (uint16_t*)thr->out_data;
-   uint16_t in_stride                 = (uint16_t)(thr->in_pitch >> 1);
-   uint16_t out_stride                = (uint16_t)(thr->out_pitch >> 1);
-   uint16_t x, y;
+   uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
+   uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
+   uint32_t x, y;
 
    for (y = 0; y < thr->height; ++y)
    {
-      uint16_t *out_ptr = output;
-      for (x = 0; x < thr->width; ++x)
-      {
-         uint16_t *out_line_ptr = out_ptr;
-         uint16_t color         = *(input + x);
-         uint16_t row_color[2];
-
-         row_color[0] = color;
-         row_color[1] = color;
+      x = 0;
+      if (filt->row_rgb565)
+         x = filt->row_rgb565(output, input, x, thr->width);
 
-         /* Row 1 */
-         memcpy(out_line_ptr, row_color, sizeof(row_color));
-         out_line_ptr += out_stride;
-
-         /* Row 2 */
-         memcpy(out_line_ptr, row_color, sizeof(row_color));
-
-         out_ptr += 2;
+      for (; x < thr->width; ++x)
+      {
+         uint16_t color    = *(input + x);
+         output[2 * x]     = color;
+         output[2 * x + 1] = color;
       }
 
+      /* Row 2 */
+      memcpy(output + out_stride, output, thr->width * 2 * sizeof(uint16_t));
+
       input  += in_stride;
       output += out_stride << 1;
    }
@@ -19,6 +19,19 @@
 #include "softfilter.h"
 #include <stdlib.h>
 #include <string.h>
+#include <retro_inline.h>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
 
 #ifdef RARCH_INTERNAL
 #define softfilter_get_implementation scale2x_get_implementation
@@ -26,6 +39,16 @@
 #define filter_data scale2x_filter_data
 #endif
 
+/* Vectorized inner loops filter pixels [x, end) of a row,
+ * as long as they can read one pixel to the left and right
+ * of every pixel. Returns the first pixel left unfiltered. */
+typedef unsigned (*scale2x_row_xrgb8888_t)(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned x, unsigned end);
+typedef unsigned (*scale2x_row_rgb565_t)(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned x, unsigned end);
+
 struct softfilter_thread_data
 {
    void *out_data;
@@ -44,8 +67,218 @@ struct filter_data
    unsigned threads;
    struct softfilter_thread_data *workers;
    unsigned in_fmt;
+   scale2x_row_xrgb8888_t row_xrgb8888;
+   scale2x_row_rgb565_t row_rgb565;
 };
 
+#if defined(__SSE2__)
+static INLINE __m128i scale2x_select_sse2(__m128i mask, __m128i a, __m128i b)
+{
+   return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+static unsigned scale2x_row_xrgb8888_sse2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 4 <= end; x += 4)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(prev + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(cur  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(next + x));
+      /* A != E && B != D */
+      __m128i cond = _mm_andnot_si128(_mm_or_si128(
+               _mm_cmpeq_epi32(A, E), _mm_cmpeq_epi32(B, D)),
+            _mm_cmpeq_epi32(C, C));
+      __m128i e00  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi32(A, B)), A, C);
+      __m128i e01  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi32(A, D)), A, C);
+      __m128i e10  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi32(E, B)), E, C);
+      __m128i e11  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi32(E, D)), E, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi32(e00, e01));
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x + 4), _mm_unpackhi_epi32(e00, e01));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi32(e10, e11));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x + 4), _mm_unpackhi_epi32(e10, e11));
+   }
+
+   return x;
+}
+
+static unsigned scale2x_row_rgb565_sse2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 8 <= end; x += 8)
+   {
+      __m128i A    = _mm_loadu_si128((const __m128i*)(prev + x));
+      __m128i B    = _mm_loadu_si128((const __m128i*)(cur  + x - 1));
+      __m128i C    = _mm_loadu_si128((const __m128i*)(cur  + x));
+      __m128i D    = _mm_loadu_si128((const __m128i*)(cur  + x + 1));
+      __m128i E    = _mm_loadu_si128((const __m128i*)(next + x));
+      __m128i cond = _mm_andnot_si128(_mm_or_si128(
+               _mm_cmpeq_epi16(A, E), _mm_cmpeq_epi16(B, D)),
+            _mm_cmpeq_epi16(C, C));
+      __m128i e00  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi16(A, B)), A, C);
+      __m128i e01  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi16(A, D)), A, C);
+      __m128i e10  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi16(E, B)), E, C);
+      __m128i e11  = scale2x_select_sse2(
+            _mm_and_si128(cond, _mm_cmpeq_epi16(E, D)), E, C);
+
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x),     _mm_unpacklo_epi16(e00, e01));
+      _mm_storeu_si128((__m128i*)(out0 + 2 * x + 8), _mm_unpackhi_epi16(e00, e01));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x),     _mm_unpacklo_epi16(e10, e11));
+      _mm_storeu_si128((__m128i*)(out1 + 2 * x + 8), _mm_unpackhi_epi16(e10, e11));
+   }
+
+   return x;
+}
+#endif
+
+#if defined(__AVX2__)
+static INLINE __m256i scale2x_select_avx2(__m256i mask, __m256i a, __m256i b)
+{
+   return _mm256_blendv_epi8(b, a, mask);
+}
+
+/* Unpacking works within 128-bit lanes; the permutes put
+ * the doubled pixels back in order. */
+#define SCALE2X_STORE_AVX2(out, lo, hi) \
+   _mm256_storeu_si256((__m256i*)(out), \
+         _mm256_permute2x128_si256(lo, hi, 0x20)); \
+   _mm256_storeu_si256((__m256i*)(out) + 1, \
+         _mm256_permute2x128_si256(lo, hi, 0x31))
+
+static unsigned scale2x_row_xrgb8888_avx2(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 8 <= end; x += 8)
+   {
+      __m256i A    = _mm256_loadu_si256((const __m256i*)(prev + x));
+      __m256i B    = _mm256_loadu_si256((const __m256i*)(cur  + x - 1));
+      __m256i C    = _mm256_loadu_si256((const __m256i*)(cur  + x));
+      __m256i D    = _mm256_loadu_si256((const __m256i*)(cur  + x + 1));
+      __m256i E    = _mm256_loadu_si256((const __m256i*)(next + x));
+      __m256i cond = _mm256_andnot_si256(_mm256_or_si256(
+               _mm256_cmpeq_epi32(A, E), _mm256_cmpeq_epi32(B, D)),
+            _mm256_cmpeq_epi32(C, C));
+      __m256i e00  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi32(A, B)), A, C);
+      __m256i e01  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi32(A, D)), A, C);
+      __m256i e10  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi32(E, B)), E, C);
+      __m256i e11  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi32(E, D)), E, C);
+
+      SCALE2X_STORE_AVX2(out0 + 2 * x,
+            _mm256_unpacklo_epi32(e00, e01), _mm256_unpackhi_epi32(e00, e01));
+      SCALE2X_STORE_AVX2(out1 + 2 * x,
+            _mm256_unpacklo_epi32(e10, e11), _mm256_unpackhi_epi32(e10, e11));
+   }
+
+   return scale2x_row_xrgb8888_sse2(out0, out1, prev, cur, next, x, end);
+}
+
+static unsigned scale2x_row_rgb565_avx2(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 16 <= end; x += 16)
+   {
+      __m256i A    = _mm256_loadu_si256((const __m256i*)(prev + x));
+      __m256i B    = _mm256_loadu_si256((const __m256i*)(cur  + x - 1));
+      __m256i C    = _mm256_loadu_si256((const __m256i*)(cur  + x));
+      __m256i D    = _mm256_loadu_si256((const __m256i*)(cur  + x + 1));
+      __m256i E    = _mm256_loadu_si256((const __m256i*)(next + x));
+      __m256i cond = _mm256_andnot_si256(_mm256_or_si256(
+               _mm256_cmpeq_epi16(A, E), _mm256_cmpeq_epi16(B, D)),
+            _mm256_cmpeq_epi16(C, C));
+      __m256i e00  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi16(A, B)), A, C);
+      __m256i e01  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi16(A, D)), A, C);
+      __m256i e10  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi16(E, B)), E, C);
+      __m256i e11  = scale2x_select_avx2(
+            _mm256_and_si256(cond, _mm256_cmpeq_epi16(E, D)), E, C);
+
+      SCALE2X_STORE_AVX2(out0 + 2 * x,
+            _mm256_unpacklo_epi16(e00, e01), _mm256_unpackhi_epi16(e00, e01));
+      SCALE2X_STORE_AVX2(out1 + 2 * x,
+            _mm256_unpacklo_epi16(e10, e11), _mm256_unpackhi_epi16(e10, e11));
+   }
+
+   return scale2x_row_rgb565_sse2(out0, out1, prev, cur, next, x, end);
+}
+
+#undef SCALE2X_STORE_AVX2
+#endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+static unsigned scale2x_row_xrgb8888_neon(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 4 <= end; x += 4)
+   {
+      uint32x4x2_t row0, row1;
+      uint32x4_t A    = vld1q_u32(prev + x);
+      uint32x4_t B    = vld1q_u32(cur  + x - 1);
+      uint32x4_t C    = vld1q_u32(cur  + x);
+      uint32x4_t D    = vld1q_u32(cur  + x + 1);
+      uint32x4_t E    = vld1q_u32(next + x);
+      uint32x4_t cond = vmvnq_u32(vorrq_u32(vceqq_u32(A, E), vceqq_u32(B, D)));
+
+      row0.val[0]     = vbslq_u32(vandq_u32(cond, vceqq_u32(A, B)), A, C);
+      row0.val[1]     = vbslq_u32(vandq_u32(cond, vceqq_u32(A, D)), A, C);
+      row1.val[0]     = vbslq_u32(vandq_u32(cond, vceqq_u32(E, B)), E, C);
+      row1.val[1]     = vbslq_u32(vandq_u32(cond, vceqq_u32(E, D)), E, C);
+
+      /* Interleaving stores double the pixels */
+      vst2q_u32(out0 + 2 * x, row0);
+      vst2q_u32(out1 + 2 * x, row1);
+   }
+
+   return x;
+}
+
+static unsigned scale2x_row_rgb565_neon(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned x, unsigned end)
+{
+   for (; x + 8 <= end; x += 8)
+   {
+      uint16x8x2_t row0, row1;
+      uint16x8_t A    = vld1q_u16(prev + x);
+      uint16x8_t B    = vld1q_u16(cur  + x - 1);
+      uint16x8_t C    = vld1q_u16(cur  + x);
+      uint16x8_t D    = vld1q_u16(cur  + x + 1);
+      uint16x8_t E    = vld1q_u16(next + x);
+      uint16x8_t cond = vmvnq_u16(vorrq_u16(vceqq_u16(A, E), vceqq_u16(B, D)));
+
+      row0.val[0]     = vbslq_u16(vandq_u16(cond, vceqq_u16(A, B)), A, C);
+      row0.val[1]     = vbslq_u16(vandq_u16(cond, vceqq_u16(A, D)), A, C);
+      row1.val[0]     = vbslq_u16(vandq_u16(cond, vceqq_u16(E, B)), E, C);
+      row1.val[1]     = vbslq_u16(vandq_u16(cond, vceqq_u16(E, D)), E, C);
+
+      vst2q_u16(out0 + 2 * x, row0);
+      vst2q_u16(out1 + 2 * x, row1);
+   }
+
+   return x;
+}
+#endif
+
 static unsigned scale2x_generic_input_fmts(void)
 {
    return SOFTFILTER_FMT_XRGB8888 | SOFTFILTER_FMT_RGB565;
@@ -68,22 +301,44 @@ static void *scale2x_generic_create(const struct softfilter_config *config,
       unsigned threads, softfilter_simd_mask_t simd, void *userdata)
 {
    struct filter_data *filt = (struct filter_data*)calloc(1, sizeof(*filt));
-   (void)simd;
    (void)config;
    (void)userdata;
 
    if (!filt) {
       return NULL;
    }
-   /* Apparently the code is not thread-safe,
-    * so force single threaded operation... */
-   filt->workers = (struct softfilter_thread_data*)calloc(1, sizeof(struct softfilter_thread_data));
-   filt->threads = 1;
+   filt->workers = (struct softfilter_thread_data*)calloc(threads, sizeof(struct softfilter_thread_data));
+   filt->threads = threads;
    filt->in_fmt  = in_fmt;
    if (!filt->workers) {
       free(filt);
       return NULL;
    }
+
+#if defined(__AVX2__)
+   if (simd & SOFTFILTER_SIMD_AVX2)
+   {
+      filt->row_xrgb8888 = scale2x_row_xrgb8888_avx2;
+      filt->row_rgb565   = scale2x_row_rgb565_avx2;
+   }
+   else
+#endif
+#if defined(__SSE2__)
+   if (simd & SOFTFILTER_SIMD_SSE2)
+   {
+      filt->row_xrgb8888 = scale2x_row_xrgb8888_sse2;
+      filt->row_rgb565   = scale2x_row_rgb565_sse2;
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   if (simd & SOFTFILTER_SIMD_NEON)
+   {
+      filt->row_xrgb8888 = scale2x_row_xrgb8888_neon;
+      filt->row_rgb565   = scale2x_row_rgb565_neon;
+   }
+#else
+   (void)simd;
+#endif
+
    return filt;
 }
 
@@ -105,99 +360,132 @@ static void scale2x_generic_destroy(void *data)
    free(filt);
 }
 
+static INLINE void scale2x_pixel_xrgb8888(uint32_t *out0, uint32_t *out1,
+      const uint32_t *prev, const uint32_t *cur, const uint32_t *next,
+      unsigned x, unsigned width)
+{
+   /* Get sample points */
+   uint32_t A = prev[x];
+   uint32_t B = (x > 0) ? cur[x - 1] : cur[x];
+   uint32_t C = cur[x];
+   uint32_t D = (x < width - 1) ? cur[x + 1] : cur[x];
+   uint32_t E = next[x];
+
+   /* Apply pixel expansion algorithm */
+   if (A != E && B != D)
+   {
+      out0[2 * x]     = (A == B ? A : C);
+      out0[2 * x + 1] = (A == D ? A : C);
+      out1[2 * x]     = (E == B ? E : C);
+      out1[2 * x + 1] = (E == D ? E : C);
+   }
+   else
+   {
+      out0[2 * x]     = C;
+      out0[2 * x + 1] = C;
+      out1[2 * x]     = C;
+      out1[2 * x + 1] = C;
+   }
+}
+
+static INLINE void scale2x_pixel_rgb565(uint16_t *out0, uint16_t *out1,
+      const uint16_t *prev, const uint16_t *cur, const uint16_t *next,
+      unsigned x, unsigned width)
+{
+   /* Get sample points */
+   uint16_t A = prev[x];
+   uint16_t B = (x > 0) ? cur[x - 1] : cur[x];
+   uint16_t C = cur[x];
+   uint16_t D = (x < width - 1) ? cur[x + 1] : cur[x];
+   uint16_t E = next[x];
+
+   /* Apply pixel expansion algorithm */
+   if (A != E && B != D)
+   {
+      out0[2 * x]     = (A == B ? A : C);
+      out0[2 * x + 1] = (A == D ? A : C);
+      out1[2 * x]     = (E == B ? E : C);
+      out1[2 * x + 1] = (E == D ? E : C);
+   }
+   else
+   {
+      out0[2 * x]     = C;
+      out0[2 * x + 1] = C;
+      out1[2 * x]     = C;
+      out1[2 * x + 1] = C;
+   }
+}
+
+/* Rows of a thread's band may read the rows just outside
+ * of it; only the first and last row of the frame are
+ * their own neighbours. */
 static void scale2x_work_cb_xrgb8888(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 2);
    uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 2);
    const uint32_t *input              = (const uint32_t*)thr->in_data;
    uint32_t *output0                  = (uint32_t*)thr->out_data;
    uint32_t *output1                  = (uint32_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   unsigned x, y;
 
    for (y = 0; y < thr->height; y++)
    {
       /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint32_t A = *(input - line_prev);
-         uint32_t B = (x > 0) ? *(input - 1) : *input;
-         uint32_t C = *input;
-         uint32_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint32_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
-
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      uint32_t line_prev = (y == 0 && thr->first == 0)     ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1 && thr->last) ? 0 : in_stride;
+      const uint32_t *prev = input - line_prev;
+      const uint32_t *next = input + line_next;
+
+      scale2x_pixel_xrgb8888(output0, output1, prev, input, next, 0, thr->width);
+
+      x = 1;
+      if (filt->row_xrgb8888 && thr->width > 1)
+         x = filt->row_xrgb8888(output0, output1,
+               prev, input, next, x, thr->width - 1);
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_xrgb8888(output0, output1, prev, input, next, x, thr->width);
+
+      input   += in_stride;
+      output0 += out_stride << 1;
+      output1 += out_stride << 1;
    }
 }
 
 static void scale2x_work_cb_rgb565(void *data, void *thread_data)
 {
+   struct filter_data *filt           = (struct filter_data*)data;
    struct softfilter_thread_data *thr = (struct softfilter_thread_data*)thread_data;
    uint32_t in_stride                 = (uint32_t)(thr->in_pitch >> 1);
    uint32_t out_stride                = (uint32_t)(thr->out_pitch >> 1);
    const uint16_t *input              = (const uint16_t*)thr->in_data;
    uint16_t *output0                  = (uint16_t*)thr->out_data;
    uint16_t *output1                  = (uint16_t*)thr->out_data + out_stride;
-   uint16_t x, y;
+   unsigned x, y;
 
    for (y = 0; y < thr->height; y++)
    {
       /* Determine offsets of previous/next source lines */
-      uint32_t line_prev = (y == 0)               ? 0 : in_stride;
-      uint32_t line_next = (y == thr->height - 1) ? 0 : in_stride;
-
-      for (x = 0; x < thr->width; x++)
-      {
-         /* Get sample points */
-         uint16_t A = *(input - line_prev);
-         uint16_t B = (x > 0) ? *(input - 1) : *input;
-         uint16_t C = *input;
-         uint16_t D = (x < thr->width - 1) ? *(input + 1) : *input;
-         uint16_t E = *(input++ + line_next);
-
-         /* Apply pixel expansion algorithm */
-         if (A != E && B != D)
-         {
-            *output0++ = (A == B ? A : C);
-            *output0++ = (A == D ? A : C);
-            *output1++ = (E == B ? E : C);
-            *output1++ = (E == D ? E : C);
-         }
-         else
-         {
-            *output0++ = C;
-            *output0++ = C;
-            *output1++ = C;
-            *output1++ = C;
-         }
-      }
-
-      input   += in_stride - thr->width;
-      output0 += (out_stride << 1) - (thr->width << 1);
-      output1 += (out_stride << 1) - (thr->width << 1);
+      uint32_t line_prev = (y == 0 && thr->first == 0)     ? 0 : in_stride;
+      uint32_t line_next = (y == thr->height - 1 && thr->last) ? 0 : in_stride;
+      const uint16_t *prev = input - line_prev;
+      const uint16_t *next = input + line_next;
+
+      scale2x_pixel_rgb565(output0, output1, prev, input, next, 0, thr->width);
+
+      x = 1;
+      if (filt->row_rgb565 && thr->width > 1)
+         x = filt->row_rgb565(output0, output1,
+               prev, input, next, x, thr->width - 1);
+
+      for (; x < thr->width; x++)
+         scale2x_pixel_rgb565(output0, output1, prev, input, next, x, thr->width);
+
+      input   += in_stride;
+      output0 += out_stride << 1;
+      output1 += out_stride << 1;
    }
 }
 
@@ -206,27 +494,36 @@ static void scale2x_generic_packets(void *data,
       void *output, size_t output_stride,
       const void *input, unsigned width, unsigned height, size_t input_stride)
 {
-   /* We are guaranteed single threaded operation
-    * (filt->threads = 1) so we don't need to loop
-    * over threads and can cull some code. This only
-    * makes the tiniest performance difference, but
-    * every little helps when running on an o3DS... */
+   unsigned i;
    struct filter_data *filt = (struct filter_data*)data;
-   struct softfilter_thread_data *thr = (struct softfilter_thread_data*)&filt->workers[0];
-
-   thr->out_data = (uint8_t*)output;
-   thr->in_data = (const uint8_t*)input;
-   thr->out_pitch = output_stride;
-   thr->in_pitch = input_stride;
-   thr->width = width;
-   thr->height = height;
-
-   if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888) {
-      packets[0].work = scale2x_work_cb_xrgb8888;
-   } else if (filt->in_fmt == SOFTFILTER_FMT_RGB565) {
-      packets[0].work = scale2x_work_cb_rgb565;
+
+   for (i = 0; i < filt->threads; i++)
+   {
+      struct softfilter_thread_data *thr =
+         (struct softfilter_thread_data*)&filt->workers[i];
+
+      unsigned y_start = (height * i) / filt->threads;
+      unsigned y_end   = (height * (i + 1)) / filt->threads;
+
+      thr->out_data  = (uint8_t*)output + y_start * 2 * output_stride;
+      thr->in_data   = (const uint8_t*)input + y_start * input_stride;
+      thr->out_pitch = output_stride;
+      thr->in_pitch  = input_stride;
+      thr->width     = width;
+      thr->height    = y_end - y_start;
+
+      /* Workers need to know if they can access pixels
+       * outside their given buffer.
+       */
+      thr->first     = y_start;
+      thr->last      = y_end == height;
+
+      if (filt->in_fmt == SOFTFILTER_FMT_XRGB8888)
+         packets[i].work = scale2x_work_cb_xrgb8888;
+      else if (filt->in_fmt == SOFTFILTER_FMT_RGB565)
+         packets[i].work = scale2x_work_cb_rgb565;
+      packets[i].thread_data = thr;
    }
-   packets[0].thread_data = thr;
 }
 
 static const struct softfilter_implementation scale2x_generic = {
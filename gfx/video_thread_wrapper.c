@@ -29,6 +29,21 @@
 #include "../retroarch.h"
 #include "../verbosity.h"
 
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define VIDEO_THREAD_HAVE_ATOMICS
+#endif
+
+#define VIDEO_THREAD_FRAME_INDEX   0xff
+#define VIDEO_THREAD_FRAME_PENDING 0x100
+
+/* Reads the shared frame slot while holding thr->lock.
+ * Without atomics, it is only ever written under the lock. */
+#ifdef VIDEO_THREAD_HAVE_ATOMICS
+#define VIDEO_THREAD_LOAD_LOCKED(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#else
+#define VIDEO_THREAD_LOAD_LOCKED(p) (*(p))
+#endif
+
 static void *video_thread_init_never_call(const video_info_t *video,
       input_driver_t **input, void **input_data)
 {
@@ -402,6 +417,32 @@ static bool video_thread_handle_packet(
    return false;
 }
 
+/**
+ * video_thread_frame_exchange:
+ * @thr                       : threaded video handle
+ * @val                       : slot index, with VIDEO_THREAD_FRAME_PENDING
+ *                              set if it holds a new frame.
+ *
+ * Swaps @val into the slot shared between the core thread
+ * and the video thread. Must be called without thr->lock held.
+ *
+ * Returns: the previously shared slot.
+ **/
+static unsigned video_thread_frame_exchange(thread_video_t *thr,
+      unsigned val)
+{
+#ifdef VIDEO_THREAD_HAVE_ATOMICS
+   return __atomic_exchange_n(&thr->frame.shared, val, __ATOMIC_ACQ_REL);
+#else
+   unsigned ret;
+   slock_lock(thr->lock);
+   ret               = thr->frame.shared;
+   thr->frame.shared = val;
+   slock_unlock(thr->lock);
+   return ret;
+#endif
+}
+
 static void video_thread_loop(void *data)
 {
    thread_video_t *thr = (thread_video_t*)data;
@@ -409,13 +450,26 @@ static void video_thread_loop(void *data)
    for (;;)
    {
       thread_packet_t pkt;
+      thread_frame_slot_t dupe;
+      bool pending = false;
       bool updated = false;
 
       slock_lock(thr->lock);
-      while (thr->send_cmd == CMD_VIDEO_NONE && !thr->frame.updated)
+      while (     thr->send_cmd == CMD_VIDEO_NONE
+               && !thr->frame.dupe_pending
+               && !(VIDEO_THREAD_LOAD_LOCKED(&thr->frame.shared)
+                  & VIDEO_THREAD_FRAME_PENDING))
          scond_wait(thr->cond_thread, thr->lock);
-      if (thr->frame.updated)
-         updated = true;
+
+      pending = (VIDEO_THREAD_LOAD_LOCKED(&thr->frame.shared)
+            & VIDEO_THREAD_FRAME_PENDING) != 0;
+      updated = pending || thr->frame.dupe_pending;
+
+      if (thr->frame.dupe_pending)
+      {
+         dupe                    = thr->frame.dupe;
+         thr->frame.dupe_pending = false;
+      }
 
       /* To avoid race condition where send_cmd is updated
        * right after the switch is checked. */
@@ -429,11 +483,24 @@ static void video_thread_loop(void *data)
       if (updated)
       {
          struct video_viewport vp;
+         const thread_frame_slot_t *slot = &dupe;
+         const void *frame               = NULL;
          bool                 ret = false;
          bool               alive = false;
          bool               focus = false;
          bool        has_windowed = true;
 
+         /* Take the newest frame, handing back the one
+          * presented last time. Duplicate frames are passed
+          * on as NULL, leaving the last frame on screen. */
+         if (pending)
+         {
+            thr->frame.read = video_thread_frame_exchange(thr,
+                  thr->frame.read) & VIDEO_THREAD_FRAME_INDEX;
+            slot            = &thr->frame.slots[thr->frame.read];
+            frame           = slot->buffer;
+         }
+
          vp.x                     = 0;
          vp.y                     = 0;
          vp.width                 = 0;
@@ -453,9 +520,8 @@ static void video_thread_loop(void *data)
             video_driver_build_info(&video_info);
 
             ret = thr->driver->frame(thr->driver_data,
-                  thr->frame.buffer, thr->frame.width, thr->frame.height,
-                  thr->frame.count,
-                  thr->frame.pitch, *thr->frame.msg ? thr->frame.msg : NULL,
+                  frame, slot->width, slot->height, slot->count,
+                  slot->pitch, *slot->msg ? slot->msg : NULL,
                   &video_info);
          }
 
@@ -477,7 +543,9 @@ static void video_thread_loop(void *data)
          thr->alive         = alive;
          thr->focus         = focus;
          thr->has_windowed  = has_windowed;
-         thr->frame.updated = false;
+         thr->frame.updated = thr->frame.dupe_pending
+            || (VIDEO_THREAD_LOAD_LOCKED(&thr->frame.shared)
+                  & VIDEO_THREAD_FRAME_PENDING);
          thr->vp            = vp;
          scond_signal(thr->cond_cmd);
          slock_unlock(thr->lock);
@@ -547,8 +615,8 @@ static bool video_thread_frame(void *data, const void *frame_,
       unsigned pitch, const char *msg, video_frame_info_t *video_info)
 {
    unsigned copy_stride;
+   thread_frame_slot_t *slot           = NULL;
    const uint8_t *src                  = NULL;
-   uint8_t *dst                        = NULL;
    thread_video_t *thr                 = (thread_video_t*)data;
 
    /* If called from within read_viewport, we're actually in the
@@ -566,8 +634,8 @@ static bool video_thread_frame(void *data, const void *frame_,
    copy_stride = width * (thr->info.rgb32
          ? sizeof(uint32_t) : sizeof(uint16_t));
 
-   src = (const uint8_t*)frame_;
-   dst = thr->frame.buffer;
+   src  = (const uint8_t*)frame_;
+   slot = &thr->frame.slots[thr->frame.write];
 
    slock_lock(thr->lock);
 
@@ -592,41 +660,73 @@ static bool video_thread_frame(void *data, const void *frame_,
       }
    }
 
-   /* Drop frame if updated flag is still set, as thread is
-    * still working on last frame. */
-   if (!thr->frame.updated)
+   slock_unlock(thr->lock);
+
+   if (src)
    {
-      if (src)
+      unsigned prev;
+
+      /* Cores rendering into the buffer returned by
+       * GET_CURRENT_SOFTWARE_FRAMEBUFFER hand it back here,
+       * and need no copy. The copy otherwise goes to a slot
+       * owned by this thread, so no lock is held for it. */
+      if (src != slot->buffer)
       {
          unsigned h;
+         uint8_t *dst = slot->buffer;
+
          for (h = 0; h < height; h++, src += pitch, dst += copy_stride)
             memcpy(dst, src, copy_stride);
       }
 
-      thr->frame.updated = true;
-      thr->frame.width  = width;
-      thr->frame.height = height;
-      thr->frame.count  = frame_count;
-      thr->frame.pitch  = copy_stride;
+      slot->width  = width;
+      slot->height = height;
+      slot->count  = frame_count;
+      slot->pitch  = copy_stride;
 
       if (msg)
-         strlcpy(thr->frame.msg, msg, sizeof(thr->frame.msg));
+         strlcpy(slot->msg, msg, sizeof(slot->msg));
       else
-         *thr->frame.msg = '\0';
+         *slot->msg = '\0';
 
-      scond_signal(thr->cond_thread);
+      prev              = video_thread_frame_exchange(thr,
+            thr->frame.write | VIDEO_THREAD_FRAME_PENDING);
+      thr->frame.write  = prev & VIDEO_THREAD_FRAME_INDEX;
+
+      /* The video thread did not get to the previous
+       * frame before it was replaced. */
+      if (prev & VIDEO_THREAD_FRAME_PENDING)
+         thr->miss_count++;
+   }
+
+   slock_lock(thr->lock);
+
+   if (!src)
+   {
+      thr->frame.dupe.width   = width;
+      thr->frame.dupe.height  = height;
+      thr->frame.dupe.count   = frame_count;
+      thr->frame.dupe.pitch   = pitch;
+
+      if (msg)
+         strlcpy(thr->frame.dupe.msg, msg, sizeof(thr->frame.dupe.msg));
+      else
+         *thr->frame.dupe.msg = '\0';
+
+      thr->frame.dupe_pending = true;
+   }
+
+   thr->frame.updated = true;
+   scond_signal(thr->cond_thread);
 
 #if defined(HAVE_MENU)
-      if (thr->texture.enable)
-      {
-         while (thr->frame.updated)
-            scond_wait(thr->cond_cmd, thr->lock);
-      }
-#endif
-      thr->hit_count++;
+   if (thr->texture.enable)
+   {
+      while (thr->frame.updated)
+         scond_wait(thr->cond_cmd, thr->lock);
    }
-   else
-      thr->miss_count++;
+#endif
+   thr->hit_count++;
 
    slock_unlock(thr->lock);
 
@@ -647,6 +747,7 @@ static bool video_thread_init(thread_video_t *thr,
       const video_info_t info,
       input_driver_t **input, void **input_data)
 {
+   unsigned i;
    size_t max_size;
    thread_packet_t pkt;
 
@@ -668,16 +769,25 @@ static bool video_thread_init(thread_video_t *thr,
    max_size                  = info.input_scale * RARCH_SCALE_BASE;
    max_size                 *= max_size;
    max_size                 *= info.rgb32 ? sizeof(uint32_t) : sizeof(uint16_t);
+   thr->frame.max_size       = max_size;
+
+   for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+   {
 #ifdef _3DS
-   thr->frame.buffer         = linearMemAlign(max_size, 0x80);
+      thr->frame.slots[i].buffer = linearMemAlign(max_size, 0x80);
 #else
-   thr->frame.buffer         = (uint8_t*)malloc(max_size);
+      thr->frame.slots[i].buffer = (uint8_t*)malloc(max_size);
 #endif
 
-   if (!thr->frame.buffer)
-      return false;
+      if (!thr->frame.slots[i].buffer)
+         return false;
 
-   memset(thr->frame.buffer, 0x80, max_size);
+      memset(thr->frame.slots[i].buffer, 0x80, max_size);
+   }
+
+   thr->frame.write          = 0;
+   thr->frame.shared         = 1;
+   thr->frame.read           = 2;
 
    thr->last_time            = cpu_features_get_time_usec();
    thr->thread               = sthread_create(video_thread_loop, thr);
@@ -778,6 +888,7 @@ static bool video_thread_read_viewport(void *data,
 
 static void video_thread_free(void *data)
 {
+   unsigned i;
    thread_packet_t pkt;
    thread_video_t *thr = (thread_video_t*)data;
 
@@ -792,11 +903,14 @@ static void video_thread_free(void *data)
 #if defined(HAVE_MENU)
    free(thr->texture.frame);
 #endif
+   for (i = 0; i < VIDEO_THREAD_FRAME_SLOTS; i++)
+   {
 #ifdef _3DS
-   linearFree(thr->frame.buffer);
+      linearFree(thr->frame.slots[i].buffer);
 #else
-   free(thr->frame.buffer);
+      free(thr->frame.slots[i].buffer);
 #endif
+   }
    slock_free(thr->frame.lock);
    slock_free(thr->lock);
    scond_free(thr->cond_cmd);
@@ -1189,6 +1303,32 @@ static uint32_t thread_get_flags(void *data)
    return thr->poke->get_flags(thr->driver_data);
 }
 
+/* Hands out the slot the next frame will be written to,
+ * so that cores can render into it and pass it back to
+ * video_thread_frame() without a copy. */
+static bool thread_get_current_software_framebuffer(void *data,
+      struct retro_framebuffer *framebuffer)
+{
+   size_t pitch;
+   thread_video_t *thr = (thread_video_t*)data;
+
+   if (!thr || !framebuffer)
+      return false;
+
+   pitch = framebuffer->width * (thr->info.rgb32
+         ? sizeof(uint32_t) : sizeof(uint16_t));
+
+   if (!pitch || pitch * framebuffer->height > thr->frame.max_size)
+      return false;
+
+   framebuffer->data         = thr->frame.slots[thr->frame.write].buffer;
+   framebuffer->pitch        = pitch;
+   framebuffer->format       = video_driver_get_pixel_format();
+   framebuffer->memory_flags = RETRO_MEMORY_TYPE_CACHED;
+
+   return true;
+}
+
 static const video_poke_interface_t thread_poke = {
    thread_get_flags,
    thread_load_texture,
@@ -1211,7 +1351,7 @@ static const video_poke_interface_t thread_poke = {
    thread_grab_mouse_toggle,
 
    thread_get_current_shader,
-   NULL,                      /* get_current_software_framebuffer */
+   thread_get_current_software_framebuffer,
    NULL,                      /* get_hw_render_interface */
    thread_set_hdr_max_nits,
    thread_set_hdr_paper_white_nits,
@@ -167,6 +167,21 @@ struct thread_packet
    enum thread_cmd type;
 };
 
+/* Number of frame buffers cycled between the core thread
+ * and the video thread: one being written, one handed over
+ * and one being presented. */
+#define VIDEO_THREAD_FRAME_SLOTS 3
+
+typedef struct thread_frame_slot
+{
+   uint64_t count;
+   uint8_t *buffer;
+   unsigned width;
+   unsigned height;
+   unsigned pitch;
+   char msg[255];
+} thread_frame_slot_t;
+
 typedef struct thread_video
 {
    retro_time_t last_time;
@@ -223,14 +238,22 @@ typedef struct thread_video
 
    struct
    {
-      uint64_t count;
+      thread_frame_slot_t slots[VIDEO_THREAD_FRAME_SLOTS];
+      /* Duplicate frame (NULL data) to present, as the
+       * previous frame stays on screen. */
+      thread_frame_slot_t dupe;
       slock_t *lock;
-      uint8_t *buffer;
-      unsigned width;
-      unsigned height;
-      unsigned pitch;
-      char msg[255];
+      size_t max_size;
+      /* Slot being written by the core thread. */
+      unsigned write;
+      /* Slot being presented by the video thread. */
+      unsigned read;
+      /* Slot handed over between the two, exchanged
+       * atomically. Has VIDEO_THREAD_FRAME_PENDING set
+       * while it holds a frame not presented yet. */
+      unsigned shared;
       bool updated;
+      bool dupe_pending;
       bool within_thread;
    } frame;
 
@@ -121,6 +121,8 @@ enum
 
    RARCH_AI_SERVICE,
 
+   RARCH_REPLAY_SAVE,
+
    RARCH_BIND_LIST_END,
    RARCH_BIND_LIST_END_NULL
 };
@@ -130,6 +130,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
    "audio_rate_control_delta"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+   "audio_rate_control_pi"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER,
    "audio_resampler_driver"
@@ -150,6 +154,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_OUTPUT_SETTINGS,
    "audio_output_settings"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_OUTPUT_THREAD,
+   "audio_output_thread"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_SYNC,
    "audio_sync"
@@ -2760,6 +2768,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION,
    "savestate_file_compression"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL,
+   "screenshot_compression_level"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE,
    "savestate_auto_save"
@@ -3002,6 +3014,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "menu_thumbnail_upscale_threshold"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "menu_thumbnail_cache_size"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,
    "rgui_thumbnail_downscaler"
@@ -4190,6 +4206,10 @@ MSG_HASH(
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_CC,
    "cc"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_POLYPHASE,
+   "polyphase"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_INPUT_DRIVER_UDEV,
    "udev"
@@ -4780,6 +4800,14 @@ MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_RECORD_THREADS,
    "video_record_threads"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_RECORD_REPLAY_BUFFER,
+   "video_record_replay_buffer"
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VIDEO_RECORD_SEGMENT_LENGTH,
+   "video_record_segment_length"
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VIDEO_GPU_INDEX,
    "gpu_index"
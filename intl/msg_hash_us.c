@@ -977,6 +977,11 @@ int msg_hash_get_help_us_enum(enum msg_hash_enums msg, char *s, size_t len)
                            MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_CC)))
                   strlcpy(s,
                         "Convoluted Cosine implementation.", len);
+               else if (string_is_equal(lbl, msg_hash_to_str(
+                           MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_POLYPHASE)))
+                  strlcpy(s,
+                        "Polyphase FIR implementation, precomputed\n"
+                        "for the fixed input to output rate ratio.", len);
                else if (string_is_empty(s))
                   strlcpy(s, msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_INFORMATION_AVAILABLE), len);
             }
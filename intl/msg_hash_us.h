@@ -2015,6 +2015,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_LATENCY,
    "Desired audio latency in milliseconds. Might not be honored if the audio driver can't provide given latency."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_OUTPUT_THREAD,
+   "Threaded Audio Output"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_OUTPUT_THREAD,
+   "Write audio to the audio driver from a separate thread, so that waiting on the audio device does not stall emulation. Adds up to the audio latency on top of the driver's own buffer."
+   )
 
 /* Settings > Audio > Resampler */
 
@@ -2061,6 +2069,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA,
    "Helps smooth out imperfections in timing when synchronizing audio and video. Be aware that if disabled, proper synchronization is nearly impossible to obtain."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_PI,
+   "Integral Rate Control"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_PI,
+   "Correct for steady timing differences between audio and video over time, keeping the audio buffer half full instead of drifting towards one end. Allows lower audio latency without crackling."
+   )
 
 /* Settings > Audio > MIDI */
 
@@ -2776,6 +2792,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
    "Captures an image of the current content then translates and/or reads aloud any on-screen text.\n'AI Service' Must be enabled and configured."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE,
+   "Save Replay Buffer"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_INPUT_META_REPLAY_SAVE,
+   "Writes the last seconds kept by the replay buffer to a video file.\n'Replay Buffer Length' must be set and recording must be running."
+   )
 
 /* Settings > Input > Port # Controls */
 
@@ -3233,6 +3257,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION,
    "Write save state files in an archived format. Dramatically reduces file size at the expense of increased saving/loading times."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_SCREENSHOT_COMPRESSION_LEVEL,
+   "Screenshot Compression Level"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_SCREENSHOT_COMPRESSION_LEVEL,
+   "PNG compression level of screenshots and save state thumbnails. Lower levels save faster but make larger files. '0' writes uncompressed images."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_SORT_SCREENSHOTS_BY_CONTENT_ENABLE,
    "Sort Screenshots into Folders by Content Directory"
@@ -3479,6 +3511,22 @@ MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_THREADS,
    "Recording Threads"
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_REPLAY_BUFFER,
+   "Replay Buffer Length"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_RECORD_REPLAY_BUFFER,
+   "Keep the last seconds of a recording in memory instead of writing everything to a file. The 'Save Replay Buffer' hotkey writes them out. '0' records to a file as usual."
+   )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_SEGMENT_LENGTH,
+   "Recording Segment Length"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_VIDEO_RECORD_SEGMENT_LENGTH,
+   "Start a new recording file every number of seconds. '0' records a single file."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_VIDEO_POST_FILTER_RECORD,
    "Use Post Filter Recording"
@@ -4960,6 +5008,14 @@ MSG_HASH(
    MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,
    "Automatically upscale thumbnail images with a width/height smaller than the specified value. Improves picture quality. Has a moderate performance impact."
    )
+MSG_HASH(
+   MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+   "Thumbnail Cache Size (MB)"
+   )
+MSG_HASH(
+   MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE,
+   "Amount of video memory used to keep recently shown thumbnails loaded, and to load thumbnails of upcoming entries in advance. Makes thumbnails appear instantly when scrolling. Set to 0 to disable."
+   )
 MSG_HASH(
    MENU_ENUM_LABEL_VALUE_MENU_TICKER_TYPE,
    "Ticker Text Animation"
@@ -11341,6 +11397,14 @@ MSG_HASH(
    MSG_FAILED_TO_START_RECORDING,
    "Failed to start recording."
    )
+MSG_HASH(
+   MSG_REPLAY_BUFFER_SAVING,
+   "Saving replay buffer."
+   )
+MSG_HASH(
+   MSG_REPLAY_BUFFER_NOT_ACTIVE,
+   "Replay buffer is not active."
+   )
 MSG_HASH(
    MSG_FAILED_TO_TAKE_SCREENSHOT,
    "Failed to take screenshot."
@@ -11561,6 +11625,14 @@ MSG_HASH(
    MSG_READING_FIRST_DATA_TRACK,
    "Reading first data track..."
    )
+MSG_HASH(
+   MSG_READING_DIRECTORY,
+   "Reading directory..."
+   )
+MSG_HASH(
+   MSG_ERROR_READING_DIRECTORY,
+   "Error reading directory."
+   )
 MSG_HASH(
    MSG_RECORDING_TERMINATED_DUE_TO_RESIZE,
    "Recording terminated due to resize."
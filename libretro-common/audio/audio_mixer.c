@@ -37,6 +37,14 @@
 #include <string.h>
 #include <math.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
 #ifdef HAVE_STB_VORBIS
 #define STB_VORBIS_NO_PUSHDATA_API
 #define STB_VORBIS_NO_STDIO
@@ -63,6 +71,9 @@
 
 #define AUDIO_MIXER_MAX_VOICES      8
 #define AUDIO_MIXER_TEMP_BUFFER 8192
+/* Minimum size of the decoded PCM ring of a streamed voice,
+ * in samples (~340ms of stereo audio at 48kHz) */
+#define AUDIO_MIXER_RING_SAMPLES 32768
 
 struct audio_mixer_sound
 {
@@ -131,8 +142,6 @@ struct audio_mixer_voice
          void       *resampler_data;
          const retro_resampler_t *resampler;
          float      *buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } ogg;
@@ -145,8 +154,6 @@ struct audio_mixer_voice
          drflac      *stream;
          void        *resampler_data;
          const retro_resampler_t *resampler;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } flac;
@@ -159,8 +166,6 @@ struct audio_mixer_voice
          void        *resampler_data;
          const retro_resampler_t *resampler;
          float*      buffer;
-         unsigned    position;
-         unsigned    samples;
          unsigned    buf_samples;
          float       ratio;
       } mp3;
@@ -170,26 +175,59 @@ struct audio_mixer_voice
       struct
       {
          int*              buffer;
+         float*            pcm;
          struct replay*    stream;
          struct module*    module;
-         unsigned          position;
-         unsigned          samples;
          unsigned          buf_samples;
       } mod;
 #endif
    } types;
+   /* Decoded PCM of streamed voices. The decoder advances
+    * ring_write and the mixer advances ring_read; both run
+    * freely and wrap at ring_size, which is a power of two */
+   float    *ring;
    audio_mixer_sound_t *sound;
    audio_mixer_stop_cb_t stop_cb;
+   unsigned ring_size;
+   unsigned ring_read;
+   unsigned ring_write;
+   unsigned chunk_samples; /* most samples decoded at once */
+   unsigned repeats;       /* loops decoded but not yet reported */
    unsigned type;
    float    volume;
    bool     repeat;
-
+   bool     streaming;     /* the decoder may fill the ring */
+   bool     eos;           /* the decoder reached the end */
 };
 
 /* TODO/FIXME - static globals */
 static struct audio_mixer_voice s_voices[AUDIO_MIXER_MAX_VOICES] = {0};
 static unsigned s_rate = 0;
 
+#if defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+/* Scratch buffer of the decoder */
+static float s_decode_buffer[AUDIO_MIXER_TEMP_BUFFER];
+#endif
+
+#ifdef HAVE_THREADS
+/* Streamed voices are decoded ahead of playback on a
+ * separate thread. s_decode_lock is held while decoding
+ * and while voices are started or stopped; s_ring_lock
+ * only guards the ring positions and flags, so mixing
+ * never waits for a decode to finish */
+static sthread_t *s_decoder_thread = NULL;
+static slock_t   *s_decode_lock    = NULL;
+static slock_t   *s_ring_lock      = NULL;
+static scond_t   *s_decoder_cond   = NULL;
+static bool       s_decoder_quit   = false;
+
+#define AUDIO_MIXER_LOCK(lock)   slock_lock(lock)
+#define AUDIO_MIXER_UNLOCK(lock) slock_unlock(lock)
+#else
+#define AUDIO_MIXER_LOCK(lock)
+#define AUDIO_MIXER_UNLOCK(lock)
+#endif
+
 #ifdef HAVE_RWAV
 static bool wav_to_float(const rwav_t* wav, float** pcm, size_t samples_out)
 {
@@ -304,6 +342,10 @@ static bool one_shot_resample(const float* in, size_t samples_in,
 }
 #endif
 
+#ifdef HAVE_THREADS
+static void audio_mixer_decoder_thread(void *data);
+#endif
+
 void audio_mixer_init(unsigned rate)
 {
    unsigned i;
@@ -311,15 +353,71 @@ void audio_mixer_init(unsigned rate)
    s_rate = rate;
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      s_voices[i].type      = AUDIO_MIXER_TYPE_NONE;
+      s_voices[i].streaming = false;
+   }
+
+#ifdef HAVE_THREADS
+   if (!s_decode_lock)
+      s_decode_lock  = slock_new();
+   if (!s_ring_lock)
+      s_ring_lock    = slock_new();
+   if (!s_decoder_cond)
+      s_decoder_cond = scond_new();
+
+   /* Without a decoder thread, streams are decoded
+    * while mixing */
+   if (     !s_decoder_thread
+         && s_decode_lock
+         && s_ring_lock
+         && s_decoder_cond)
+   {
+      s_decoder_quit   = false;
+      s_decoder_thread = sthread_create(
+            audio_mixer_decoder_thread, NULL);
+   }
+#endif
 }
 
 void audio_mixer_done(void)
 {
    unsigned i;
 
+#ifdef HAVE_THREADS
+   if (s_decoder_thread)
+   {
+      slock_lock(s_ring_lock);
+      s_decoder_quit = true;
+      scond_signal(s_decoder_cond);
+      slock_unlock(s_ring_lock);
+
+      sthread_join(s_decoder_thread);
+      s_decoder_thread = NULL;
+   }
+
+   if (s_decoder_cond)
+      scond_free(s_decoder_cond);
+   if (s_ring_lock)
+      slock_free(s_ring_lock);
+   if (s_decode_lock)
+      slock_free(s_decode_lock);
+
+   s_decoder_cond = NULL;
+   s_ring_lock    = NULL;
+   s_decode_lock  = NULL;
+#endif
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
-      s_voices[i].type = AUDIO_MIXER_TYPE_NONE;
+   {
+      s_voices[i].type      = AUDIO_MIXER_TYPE_NONE;
+      s_voices[i].streaming = false;
+
+      if (s_voices[i].ring)
+         memalign_free(s_voices[i].ring);
+      s_voices[i].ring      = NULL;
+      s_voices[i].ring_size = 0;
+   }
 }
 
 audio_mixer_sound_t* audio_mixer_load_wav(void *buffer, int32_t size,
@@ -576,8 +674,7 @@ static bool audio_mixer_play_ogg(
    voice->types.ogg.buf_samples    = samples;
    voice->types.ogg.ratio          = ratio;
    voice->types.ogg.stream         = stb_vorbis;
-   voice->types.ogg.position       = 0;
-   voice->types.ogg.samples        = 0;
+   voice->chunk_samples            = samples + 4;
 
    return true;
 
@@ -599,6 +696,7 @@ static bool audio_mixer_play_mod(
    int buf_samples               = 0;
    int samples                   = 0;
    void *mod_buffer              = NULL;
+   float *mod_pcm                = NULL;
    struct module* module         = NULL;
    struct replay* replay         = NULL;
 
@@ -634,6 +732,15 @@ static bool audio_mixer_play_mod(
       goto error;
    }
 
+   mod_pcm     = (float*)memalign_alloc(16,
+         ((buf_samples + 15) & ~15) * sizeof(float));
+
+   if (!mod_pcm)
+   {
+      printf("audio_mixer_play_mod cannot allocate mod_pcm !\n");
+      goto error;
+   }
+
    samples = replay_calculate_duration(replay);
 
    if (!samples)
@@ -647,16 +754,20 @@ static bool audio_mixer_play_mod(
       dispose_replay(voice->types.mod.stream);
    if (voice->types.mod.buffer)
       memalign_free(voice->types.mod.buffer);
+   if (voice->types.mod.pcm)
+      memalign_free(voice->types.mod.pcm);
 
    voice->types.mod.buffer         = (int*)mod_buffer;
+   voice->types.mod.pcm            = mod_pcm;
    voice->types.mod.buf_samples    = buf_samples;
    voice->types.mod.stream         = replay;
-   voice->types.mod.position       = 0;
-   voice->types.mod.samples        = 0; /* samples; */
+   voice->chunk_samples            = buf_samples;
 
    return true;
 
 error:
+   if (mod_pcm)
+      memalign_free(mod_pcm);
    if (mod_buffer)
       memalign_free(mod_buffer);
    if (module)
@@ -724,8 +835,7 @@ static bool audio_mixer_play_flac(
    voice->types.flac.buf_samples    = samples;
    voice->types.flac.ratio          = ratio;
    voice->types.flac.stream         = dr_flac;
-   voice->types.flac.position       = 0;
-   voice->types.flac.samples        = 0;
+   voice->chunk_samples             = samples + 4;
 
    return true;
 
@@ -800,8 +910,7 @@ static bool audio_mixer_play_mp3(
    voice->types.mp3.buffer         = (float*)mp3_buffer;
    voice->types.mp3.buf_samples    = samples;
    voice->types.mp3.ratio          = ratio;
-   voice->types.mp3.position       = 0;
-   voice->types.mp3.samples        = 0;
+   voice->chunk_samples            = samples + 4;
 
    return true;
 
@@ -811,6 +920,270 @@ error:
 }
 #endif
 
+#if defined(HAVE_STB_VORBIS) || defined(HAVE_DR_FLAC) || defined(HAVE_DR_MP3)
+/* Resamples a chunk decoded into s_decode_buffer, if the
+ * stream rate differs from the output rate */
+static unsigned audio_mixer_resample_chunk(
+      const retro_resampler_t *resampler,
+      void *resampler_data, float ratio, float *buffer,
+      unsigned samples, const float **pcm)
+{
+   struct resampler_data info;
+
+   if (!resampler)
+   {
+      *pcm = s_decode_buffer;
+      return samples;
+   }
+
+   info.data_in       = s_decode_buffer;
+   info.data_out      = buffer;
+   info.input_frames  = samples / 2;
+   info.output_frames = 0;
+   info.ratio         = ratio;
+
+   resampler->process(resampler_data, &info);
+
+   *pcm = buffer;
+   return (unsigned)info.output_frames * 2;
+}
+#endif
+
+#ifdef HAVE_STB_VORBIS
+static unsigned audio_mixer_decode_ogg(audio_mixer_voice_t* voice,
+      const float **pcm, unsigned *repeats)
+{
+   unsigned temp_samples = 0;
+   bool rewound          = false;
+
+again:
+   temp_samples = stb_vorbis_get_samples_float_interleaved(
+         voice->types.ogg.stream, 2, s_decode_buffer,
+         AUDIO_MIXER_TEMP_BUFFER) * 2;
+
+   if (temp_samples == 0)
+   {
+      /* Give up on streams that are still empty once rewound */
+      if (!voice->repeat || rewound)
+         return 0;
+
+      stb_vorbis_seek_start(voice->types.ogg.stream);
+      (*repeats)++;
+      rewound = true;
+      goto again;
+   }
+
+   return audio_mixer_resample_chunk(voice->types.ogg.resampler,
+         voice->types.ogg.resampler_data, voice->types.ogg.ratio,
+         voice->types.ogg.buffer, temp_samples, pcm);
+}
+#endif
+
+#ifdef HAVE_IBXM
+static unsigned audio_mixer_decode_mod(audio_mixer_voice_t* voice,
+      const float **pcm, unsigned *repeats)
+{
+   unsigned i;
+   unsigned temp_samples = 0;
+   bool rewound          = false;
+
+again:
+   temp_samples = replay_get_audio(
+         voice->types.mod.stream, voice->types.mod.buffer, 0 ) * 2;
+
+   if (temp_samples == 0)
+   {
+      if (!voice->repeat || rewound)
+         return 0;
+
+      replay_seek( voice->types.mod.stream, 0);
+      (*repeats)++;
+      rewound = true;
+      goto again;
+   }
+
+   for (i = 0; i < temp_samples; i++)
+   {
+      float samplef             = ((float)voice->types.mod.buffer[i]
+            + 32768.0f) / 65535.0f;
+      voice->types.mod.pcm[i]   = samplef * 2.0f - 1.0f;
+   }
+
+   *pcm = voice->types.mod.pcm;
+   return temp_samples;
+}
+#endif
+
+#ifdef HAVE_DR_FLAC
+static unsigned audio_mixer_decode_flac(audio_mixer_voice_t* voice,
+      const float **pcm, unsigned *repeats)
+{
+   unsigned temp_samples = 0;
+   bool rewound          = false;
+
+again:
+   temp_samples = (unsigned)drflac_read_f32(
+         voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER,
+         s_decode_buffer);
+
+   if (temp_samples == 0)
+   {
+      if (!voice->repeat || rewound)
+         return 0;
+
+      drflac_seek_to_sample(voice->types.flac.stream,0);
+      (*repeats)++;
+      rewound = true;
+      goto again;
+   }
+
+   return audio_mixer_resample_chunk(voice->types.flac.resampler,
+         voice->types.flac.resampler_data, voice->types.flac.ratio,
+         voice->types.flac.buffer, temp_samples, pcm);
+}
+#endif
+
+#ifdef HAVE_DR_MP3
+static unsigned audio_mixer_decode_mp3(audio_mixer_voice_t* voice,
+      const float **pcm, unsigned *repeats)
+{
+   unsigned temp_samples = 0;
+   bool rewound          = false;
+
+again:
+   temp_samples = (unsigned)drmp3_read_f32(
+         &voice->types.mp3.stream,
+         AUDIO_MIXER_TEMP_BUFFER / 2, s_decode_buffer) * 2;
+
+   if (temp_samples == 0)
+   {
+      if (!voice->repeat || rewound)
+         return 0;
+
+      drmp3_seek_to_frame(&voice->types.mp3.stream,0);
+      (*repeats)++;
+      rewound = true;
+      goto again;
+   }
+
+   return audio_mixer_resample_chunk(voice->types.mp3.resampler,
+         voice->types.mp3.resampler_data, voice->types.mp3.ratio,
+         voice->types.mp3.buffer, temp_samples, pcm);
+}
+#endif
+
+/**
+ * audio_mixer_decode_chunk:
+ * @voice : streamed voice.
+ *
+ * Decodes the next chunk of @voice into its ring, which
+ * must have room for at least chunk_samples samples.
+ * Requires s_decode_lock.
+ **/
+static void audio_mixer_decode_chunk(audio_mixer_voice_t* voice)
+{
+   unsigned first;
+   const float *pcm  = NULL;
+   unsigned repeats  = 0;
+   unsigned samples  = 0;
+   unsigned pos      = voice->ring_write & (voice->ring_size - 1);
+
+   switch (voice->type)
+   {
+      case AUDIO_MIXER_TYPE_OGG:
+#ifdef HAVE_STB_VORBIS
+         samples = audio_mixer_decode_ogg(voice, &pcm, &repeats);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MOD:
+#ifdef HAVE_IBXM
+         samples = audio_mixer_decode_mod(voice, &pcm, &repeats);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_FLAC:
+#ifdef HAVE_DR_FLAC
+         samples = audio_mixer_decode_flac(voice, &pcm, &repeats);
+#endif
+         break;
+      case AUDIO_MIXER_TYPE_MP3:
+#ifdef HAVE_DR_MP3
+         samples = audio_mixer_decode_mp3(voice, &pcm, &repeats);
+#endif
+         break;
+      default:
+         break;
+   }
+
+   if (samples)
+   {
+      first = voice->ring_size - pos;
+      if (first > samples)
+         first = samples;
+
+      memcpy(voice->ring + pos, pcm, first * sizeof(float));
+      memcpy(voice->ring, pcm + first, (samples - first) * sizeof(float));
+   }
+
+   AUDIO_MIXER_LOCK(s_ring_lock);
+   voice->ring_write += samples;
+   voice->repeats    += repeats;
+   if (!samples)
+      voice->eos      = true;
+   AUDIO_MIXER_UNLOCK(s_ring_lock);
+}
+
+/**
+ * audio_mixer_start_stream:
+ * @voice : voice set up for a streamed sound.
+ *
+ * Prepares the ring of @voice and decodes its first chunk,
+ * so that playback does not have to wait for the decoder.
+ * Requires s_decode_lock.
+ *
+ * Returns: true if successful, false on allocation failure.
+ **/
+static bool audio_mixer_start_stream(audio_mixer_voice_t* voice)
+{
+   unsigned ring_size = AUDIO_MIXER_RING_SAMPLES;
+
+   while (ring_size < voice->chunk_samples * 4)
+      ring_size <<= 1;
+
+   if (voice->ring_size < ring_size)
+   {
+      float *ring = (float*)memalign_alloc(16,
+            ring_size * sizeof(float));
+
+      if (!ring)
+         return false;
+
+      if (voice->ring)
+         memalign_free(voice->ring);
+
+      voice->ring      = ring;
+      voice->ring_size = ring_size;
+   }
+
+   AUDIO_MIXER_LOCK(s_ring_lock);
+   voice->ring_read  = 0;
+   voice->ring_write = 0;
+   voice->repeats    = 0;
+   voice->eos        = false;
+   AUDIO_MIXER_UNLOCK(s_ring_lock);
+
+   audio_mixer_decode_chunk(voice);
+
+   AUDIO_MIXER_LOCK(s_ring_lock);
+   voice->streaming  = true;
+#ifdef HAVE_THREADS
+   if (s_decoder_thread)
+      scond_signal(s_decoder_cond);
+#endif
+   AUDIO_MIXER_UNLOCK(s_ring_lock);
+
+   return true;
+}
+
 audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
       bool repeat, float volume,
       const char *resampler_ident,
@@ -824,6 +1197,8 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
    if (!sound)
       return NULL;
 
+   AUDIO_MIXER_LOCK(s_decode_lock);
+
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
    {
       if (voice->type != AUDIO_MIXER_TYPE_NONE)
@@ -871,10 +1246,21 @@ audio_mixer_voice_t* audio_mixer_play(audio_mixer_sound_t* sound,
       voice->volume   = volume;
       voice->sound    = sound;
       voice->stop_cb  = stop_cb;
+
+      /* Compressed sounds are decoded ahead into a ring */
+      if (     sound->type != AUDIO_MIXER_TYPE_WAV
+            && !audio_mixer_start_stream(voice))
+      {
+         voice->type  = AUDIO_MIXER_TYPE_NONE;
+         res          = false;
+      }
    }
-   else
+
+   if (!res)
       voice = NULL;
 
+   AUDIO_MIXER_UNLOCK(s_decode_lock);
+
    return voice;
 }
 
@@ -888,18 +1274,42 @@ void audio_mixer_stop(audio_mixer_voice_t* voice)
       stop_cb     = voice->stop_cb;
       sound       = voice->sound;
 
-      voice->type = AUDIO_MIXER_TYPE_NONE;
+      /* Wait for any decode of this voice to finish, since
+       * the sound may be destroyed once it is stopped */
+      AUDIO_MIXER_LOCK(s_decode_lock);
+      AUDIO_MIXER_LOCK(s_ring_lock);
+      voice->streaming = false;
+      AUDIO_MIXER_UNLOCK(s_ring_lock);
+      voice->type      = AUDIO_MIXER_TYPE_NONE;
+      AUDIO_MIXER_UNLOCK(s_decode_lock);
 
       if (stop_cb)
          stop_cb(sound, AUDIO_MIXER_SOUND_STOPPED);
    }
 }
 
+/* Adds @samples samples of @pcm, scaled by @volume,
+ * to @buffer */
+static void audio_mixer_accumulate(float* buffer, const float* pcm,
+      unsigned samples, float volume)
+{
+   unsigned i = 0;
+#if defined(__SSE__)
+   __m128 vol = _mm_set1_ps(volume);
+
+   for (; i + 4 <= samples; i += 4)
+      _mm_storeu_ps(buffer + i, _mm_add_ps(_mm_loadu_ps(buffer + i),
+               _mm_mul_ps(_mm_loadu_ps(pcm + i), vol)));
+#endif
+
+   for (; i < samples; i++)
+      buffer[i] += pcm[i] * volume;
+}
+
 static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
    unsigned buf_free                = (unsigned)(num_frames * 2);
    const audio_mixer_sound_t* sound = voice->sound;
    unsigned pcm_available           = sound->types.wav.frames
@@ -910,8 +1320,8 @@ static void audio_mixer_mix_wav(float* buffer, size_t num_frames,
 again:
    if (pcm_available < buf_free)
    {
-      for (i = pcm_available; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mixer_accumulate(buffer, pcm, pcm_available, volume);
+      buffer += pcm_available;
 
       if (voice->repeat)
       {
@@ -932,297 +1342,129 @@ again:
    }
    else
    {
-      for (i = buf_free; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mixer_accumulate(buffer, pcm, buf_free, volume);
 
       voice->types.wav.position += buf_free;
    }
 }
 
-#ifdef HAVE_STB_VORBIS
-static void audio_mixer_mix_ogg(float* buffer, size_t num_frames,
+/**
+ * audio_mixer_mix_stream:
+ *
+ * Mixes already decoded samples of a streamed voice. Loops
+ * and the end of the stream are reported once playback
+ * catches up with the decoder.
+ **/
+static void audio_mixer_mix_stream(float* buffer, size_t num_frames,
       audio_mixer_voice_t* voice,
       float volume)
 {
-   int i;
-   float* temp_buffer = NULL;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
-
-   if (voice->types.ogg.position == voice->types.ogg.samples)
-   {
-again:
-      if (temp_buffer == NULL)
-         temp_buffer = (float*)malloc(AUDIO_MIXER_TEMP_BUFFER * sizeof(float));
-
-      temp_samples = stb_vorbis_get_samples_float_interleaved(
-            voice->types.ogg.stream, 2, temp_buffer,
-            AUDIO_MIXER_TEMP_BUFFER) * 2;
-
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            stb_vorbis_seek_start(voice->types.ogg.stream);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         goto cleanup;
-      }
-
-      if (voice->types.ogg.resampler)
-      {
-         struct resampler_data info;
-         info.data_in = temp_buffer;
-         info.data_out = voice->types.ogg.buffer;
-         info.input_frames = temp_samples / 2;
-         info.output_frames = 0;
-         info.ratio = voice->types.ogg.ratio;
-
-         voice->types.ogg.resampler->process(
-               voice->types.ogg.resampler_data, &info);
-      }
-      else
-         memcpy(voice->types.ogg.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-
-      voice->types.ogg.position = 0;
-      voice->types.ogg.samples  = voice->types.ogg.buf_samples;
-   }
-
-   pcm = voice->types.ogg.buffer + voice->types.ogg.position;
+   unsigned pos, first, samples, available, repeats;
+   bool eos          = false;
+   unsigned buf_free = (unsigned)(num_frames * 2);
 
-   if (voice->types.ogg.samples < buf_free)
+   /* Without a decoder thread, decode as needed */
+#ifdef HAVE_THREADS
+   if (!s_decoder_thread)
+#endif
    {
-      for (i = voice->types.ogg.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
-
-      buf_free -= voice->types.ogg.samples;
-      goto again;
+      while (  !voice->eos
+            && voice->ring_write - voice->ring_read < buf_free
+            && voice->ring_size - (voice->ring_write - voice->ring_read)
+               >= voice->chunk_samples)
+         audio_mixer_decode_chunk(voice);
    }
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.ogg.position += buf_free;
-   voice->types.ogg.samples  -= buf_free;
-
-cleanup:
-   if (temp_buffer != NULL)
-      free(temp_buffer);
-}
+   AUDIO_MIXER_LOCK(s_ring_lock);
+   available      = voice->ring_write - voice->ring_read;
+   repeats        = voice->repeats;
+   eos            = voice->eos;
+   voice->repeats = 0;
+   AUDIO_MIXER_UNLOCK(s_ring_lock);
+
+   samples        = (available < buf_free) ? available : buf_free;
+   pos            = voice->ring_read & (voice->ring_size - 1);
+   first          = voice->ring_size - pos;
+   if (first > samples)
+      first       = samples;
+
+   audio_mixer_accumulate(buffer, voice->ring + pos, first, volume);
+   audio_mixer_accumulate(buffer + first, voice->ring,
+         samples - first, volume);
+
+   AUDIO_MIXER_LOCK(s_ring_lock);
+   voice->ring_read += samples;
+#ifdef HAVE_THREADS
+   if (s_decoder_thread)
+      scond_signal(s_decoder_cond);
 #endif
+   AUDIO_MIXER_UNLOCK(s_ring_lock);
 
-#ifdef HAVE_IBXM
-static void audio_mixer_mix_mod(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
-{
-   int i;
-   float samplef                    = 0.0f;
-   unsigned temp_samples            = 0;
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   int* pcm                         = NULL;
+   if (voice->stop_cb)
+      for (; repeats != 0; repeats--)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
 
-   if (voice->types.mod.samples == 0)
+   /* Everything decoded has been played */
+   if (eos && available <= buf_free)
    {
-again:
-      temp_samples = replay_get_audio(
-            voice->types.mod.stream, voice->types.mod.buffer, 0 ) * 2;
+      AUDIO_MIXER_LOCK(s_ring_lock);
+      voice->streaming = false;
+      AUDIO_MIXER_UNLOCK(s_ring_lock);
 
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            replay_seek( voice->types.mod.stream, 0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
-
-      voice->types.mod.position = 0;
-      voice->types.mod.samples  = temp_samples;
-   }
-   pcm = voice->types.mod.buffer + voice->types.mod.position;
-
-   if (voice->types.mod.samples < buf_free)
-   {
-      for (i = voice->types.mod.samples; i != 0; i--)
-      {
-         samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-         samplef     = samplef * 2.0f - 1.0f;
-         *buffer++  += samplef * volume;
-      }
-
-      buf_free -= voice->types.mod.samples;
-      goto again;
-   }
+      if (voice->stop_cb)
+         voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
 
-   for (i = buf_free; i != 0; --i )
-   {
-      samplef     = ((float)(*pcm++) + 32768.0f) / 65535.0f;
-      samplef     = samplef * 2.0f - 1.0f;
-      *buffer++  += samplef * volume;
+      voice->type = AUDIO_MIXER_TYPE_NONE;
    }
-
-   voice->types.mod.position += buf_free;
-   voice->types.mod.samples  -= buf_free;
 }
-#endif
 
-#ifdef HAVE_DR_FLAC
-static void audio_mixer_mix_flac(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+#ifdef HAVE_THREADS
+/* Returns a streamed voice with room for another chunk
+ * in its ring. Requires s_ring_lock. */
+static audio_mixer_voice_t *audio_mixer_decoder_next_voice(void)
 {
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float *pcm                       = NULL;
-
-   if (voice->types.flac.position == voice->types.flac.samples)
-   {
-again:
-      temp_samples = (unsigned)drflac_read_f32( voice->types.flac.stream, AUDIO_MIXER_TEMP_BUFFER, temp_buffer);
-      if (temp_samples == 0)
-      {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drflac_seek_to_sample(voice->types.flac.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
-      }
-
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.flac.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.flac.ratio;
-
-      if (voice->types.flac.resampler)
-         voice->types.flac.resampler->process(
-               voice->types.flac.resampler_data, &info);
-      else
-         memcpy(voice->types.flac.buffer, temp_buffer, temp_samples * sizeof(float));
-      voice->types.flac.position = 0;
-      voice->types.flac.samples  = voice->types.flac.buf_samples;
-   }
-
-   pcm = voice->types.flac.buffer + voice->types.flac.position;
+   unsigned i;
 
-   if (voice->types.flac.samples < buf_free)
+   for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++)
    {
-      for (i = voice->types.flac.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      audio_mixer_voice_t *voice = &s_voices[i];
 
-      buf_free -= voice->types.flac.samples;
-      goto again;
+      if (     voice->streaming
+            && !voice->eos
+            && voice->ring_size - (voice->ring_write - voice->ring_read)
+               >= voice->chunk_samples)
+         return voice;
    }
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.flac.position += buf_free;
-   voice->types.flac.samples  -= buf_free;
+   return NULL;
 }
-#endif
 
-#ifdef HAVE_DR_MP3
-static void audio_mixer_mix_mp3(float* buffer, size_t num_frames,
-      audio_mixer_voice_t* voice,
-      float volume)
+static void audio_mixer_decoder_thread(void *data)
 {
-   int i;
-   struct resampler_data info;
-   float temp_buffer[AUDIO_MIXER_TEMP_BUFFER] = { 0 };
-   unsigned buf_free                = (unsigned)(num_frames * 2);
-   unsigned temp_samples            = 0;
-   float* pcm                       = NULL;
+   slock_lock(s_ring_lock);
 
-   if (voice->types.mp3.position == voice->types.mp3.samples)
+   while (!s_decoder_quit)
    {
-again:
-      temp_samples = (unsigned)drmp3_read_f32(
-            &voice->types.mp3.stream,
-            AUDIO_MIXER_TEMP_BUFFER / 2, temp_buffer) * 2;
+      audio_mixer_voice_t *voice = audio_mixer_decoder_next_voice();
 
-      if (temp_samples == 0)
+      if (!voice)
       {
-         if (voice->repeat)
-         {
-            if (voice->stop_cb)
-               voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_REPEATED);
-
-            drmp3_seek_to_frame(&voice->types.mp3.stream,0);
-            goto again;
-         }
-
-         if (voice->stop_cb)
-            voice->stop_cb(voice->sound, AUDIO_MIXER_SOUND_FINISHED);
-
-         voice->type = AUDIO_MIXER_TYPE_NONE;
-         return;
+         scond_wait(s_decoder_cond, s_ring_lock);
+         continue;
       }
 
-      info.data_in              = temp_buffer;
-      info.data_out             = voice->types.mp3.buffer;
-      info.input_frames         = temp_samples / 2;
-      info.output_frames        = 0;
-      info.ratio                = voice->types.mp3.ratio;
-
-      if (voice->types.mp3.resampler)
-         voice->types.mp3.resampler->process(
-               voice->types.mp3.resampler_data, &info);
-      else
-         memcpy(voice->types.mp3.buffer, temp_buffer,
-               temp_samples * sizeof(float));
-      voice->types.mp3.position = 0;
-      voice->types.mp3.samples  = voice->types.mp3.buf_samples;
-   }
-
-   pcm = voice->types.mp3.buffer + voice->types.mp3.position;
+      slock_unlock(s_ring_lock);
 
-   if (voice->types.mp3.samples < buf_free)
-   {
-      for (i = voice->types.mp3.samples; i != 0; i--)
-         *buffer++ += *pcm++ * volume;
+      slock_lock(s_decode_lock);
+      /* The voice may have been stopped in the meantime */
+      if (voice->streaming)
+         audio_mixer_decode_chunk(voice);
+      slock_unlock(s_decode_lock);
 
-      buf_free -= voice->types.mp3.samples;
-      goto again;
+      slock_lock(s_ring_lock);
    }
 
-   for (i = buf_free; i != 0; --i )
-      *buffer++ += *pcm++ * volume;
-
-   voice->types.mp3.position += buf_free;
-   voice->types.mp3.samples  -= buf_free;
+   slock_unlock(s_ring_lock);
 }
 #endif
 
@@ -1233,6 +1475,10 @@ void audio_mixer_mix(float* buffer, size_t num_frames,
    size_t j                   = 0;
    float* sample              = NULL;
    audio_mixer_voice_t* voice = s_voices;
+#if defined(__SSE__)
+   __m128 min                 = _mm_set1_ps(-1.0f);
+   __m128 max                 = _mm_set1_ps( 1.0f);
+#endif
 
    for (i = 0; i < AUDIO_MIXER_MAX_VOICES; i++, voice++)
    {
@@ -1244,31 +1490,25 @@ void audio_mixer_mix(float* buffer, size_t num_frames,
             audio_mixer_mix_wav(buffer, num_frames, voice, volume);
             break;
          case AUDIO_MIXER_TYPE_OGG:
-#ifdef HAVE_STB_VORBIS
-            audio_mixer_mix_ogg(buffer, num_frames, voice, volume);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_MOD:
-#ifdef HAVE_IBXM
-            audio_mixer_mix_mod(buffer, num_frames, voice, volume);
-#endif
-            break;
          case AUDIO_MIXER_TYPE_FLAC:
-#ifdef HAVE_DR_FLAC
-            audio_mixer_mix_flac(buffer, num_frames, voice, volume);
-#endif
-            break;
-            case AUDIO_MIXER_TYPE_MP3:
-#ifdef HAVE_DR_MP3
-            audio_mixer_mix_mp3(buffer, num_frames, voice, volume);
-#endif
+         case AUDIO_MIXER_TYPE_MP3:
+            if (voice->streaming)
+               audio_mixer_mix_stream(buffer, num_frames, voice, volume);
             break;
          case AUDIO_MIXER_TYPE_NONE:
             break;
       }
    }
 
-   for (j = 0, sample = buffer; j < num_frames * 2; j++, sample++)
+   sample = buffer;
+#if defined(__SSE__)
+   for (; j + 4 <= num_frames * 2; j += 4, sample += 4)
+      _mm_storeu_ps(sample, _mm_min_ps(_mm_max_ps(
+                  _mm_loadu_ps(sample), min), max));
+#endif
+
+   for (; j < num_frames * 2; j++, sample++)
    {
       if (*sample < -1.0f)
          *sample = -1.0f;
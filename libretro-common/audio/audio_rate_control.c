@@ -0,0 +1,95 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_rate_control.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#include <audio/audio_rate_control.h>
+
+void audio_rate_control_init(audio_rate_control_t *rc,
+      double max_adjust, double buffer_duration)
+{
+   rc->max_adjust    = max_adjust;
+   /* Smooth out the sawtooth left by writing whole
+    * video frames of audio at a time */
+   rc->filter_time   = buffer_duration;
+   /* The buffer integrates the rate error, so with a
+    * proportional gain of max_adjust the loop gain is
+    * 2 * max_adjust / buffer_duration; critical damping
+    * asks for an integral time of four times its inverse. */
+   rc->integral_time = max_adjust > 0.0
+      ? 2.0 * buffer_duration / max_adjust : 0.0;
+
+   audio_rate_control_reset(rc);
+}
+
+void audio_rate_control_reset(audio_rate_control_t *rc)
+{
+   rc->error    = 0.0;
+   rc->integral = 0.0;
+   rc->primed   = false;
+}
+
+double audio_rate_control_update(audio_rate_control_t *rc,
+      size_t queued, size_t pending, size_t buffer_size, double dt)
+{
+   double level;
+   double error;
+   double adjust;
+
+   if (!buffer_size)
+      return 1.0;
+
+   level = (double)queued + (double)pending / 2.0;
+   if (level > (double)buffer_size)
+      level = (double)buffer_size;
+
+   /* Positive when the buffer is emptier than half full. */
+   error = 1.0 - 2.0 * level / (double)buffer_size;
+
+   if (!rc->primed || dt <= 0.0)
+   {
+      rc->error  = error;
+      rc->primed = true;
+   }
+   else
+      rc->error += (error - rc->error) * dt / (rc->filter_time + dt);
+
+   adjust = rc->max_adjust * rc->error;
+
+   if (rc->integral_time > 0.0 && dt > 0.0)
+   {
+      rc->integral += adjust * dt / rc->integral_time;
+
+      /* Anti-windup */
+      if (rc->integral > rc->max_adjust)
+         rc->integral = rc->max_adjust;
+      else if (rc->integral < -rc->max_adjust)
+         rc->integral = -rc->max_adjust;
+   }
+
+   adjust += rc->integral;
+
+   if (adjust > rc->max_adjust)
+      adjust = rc->max_adjust;
+   else if (adjust < -rc->max_adjust)
+      adjust = -rc->max_adjust;
+
+   return 1.0 + adjust;
+}
@@ -29,6 +29,12 @@
 #include <filters.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
 #include "fft/fft.c"
 
 struct eq_data
@@ -64,6 +70,46 @@ static void eq_free(void *data)
    free(eq);
 }
 
+/* Multiplies a spectrum by the filter response, in place. */
+static void eq_apply_filter(fft_complex_t *block,
+      const fft_complex_t *filter, unsigned samples)
+{
+   unsigned i = 0;
+#if defined(__SSE__)
+   const __m128 sign = _mm_setr_ps(-1.0f, 1.0f, -1.0f, 1.0f);
+
+   /* Two complex values per vector. */
+   for (; i + 2 <= samples; i += 2)
+   {
+      __m128 a    = _mm_loadu_ps((const float*)(block + i));
+      __m128 b    = _mm_loadu_ps((const float*)(filter + i));
+      __m128 b_re = _mm_shuffle_ps(b, b, _MM_SHUFFLE(2, 2, 0, 0));
+      __m128 b_im = _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 3, 1, 1));
+      __m128 a_sw = _mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1));
+
+      _mm_storeu_ps((float*)(block + i), _mm_add_ps(_mm_mul_ps(a, b_re),
+               _mm_mul_ps(_mm_mul_ps(a_sw, b_im), sign)));
+   }
+#elif defined(__ARM_NEON__) || defined(HAVE_NEON)
+   /* Four complex values per iteration, split into
+    * real and imaginary vectors. */
+   for (; i + 4 <= samples; i += 4)
+   {
+      float32x4x2_t a = vld2q_f32((const float*)(block + i));
+      float32x4x2_t b = vld2q_f32((const float*)(filter + i));
+      float32x4x2_t res;
+
+      res.val[0]      = vmlsq_f32(vmulq_f32(a.val[0], b.val[0]),
+            a.val[1], b.val[1]);
+      res.val[1]      = vmlaq_f32(vmulq_f32(a.val[1], b.val[0]),
+            a.val[0], b.val[1]);
+      vst2q_f32((float*)(block + i), res);
+   }
+#endif
+   for (; i < samples; i++)
+      block[i] = fft_complex_mul(block[i], filter[i]);
+}
+
 static void eq_process(void *data, struct dspfilter_output *output,
       const struct dspfilter_input *input)
 {
@@ -95,15 +141,17 @@ static void eq_process(void *data, struct dspfilter_output *output,
       // Convolve a new block.
       if (eq->block_ptr == eq->block_size)
       {
-         unsigned i, c;
-
-         for (c = 0; c < 2; c++)
-         {
-            fft_process_forward(eq->fft, eq->fftblock, eq->block + c, 2);
-            for (i = 0; i < 2 * eq->block_size; i++)
-               eq->fftblock[i] = fft_complex_mul(eq->fftblock[i], eq->filter[i]);
-            fft_process_inverse(eq->fft, out + c, eq->fftblock, 2);
-         }
+         unsigned i;
+
+         /* The filter is real, so both channels are convolved
+          * with a single complex FFT: left in the real part,
+          * right in the imaginary part. Interleaved stereo
+          * already has that layout. */
+         fft_process_forward_complex(eq->fft, eq->fftblock,
+               (const fft_complex_t*)eq->block, 1);
+         eq_apply_filter(eq->fftblock, eq->filter, 2 * eq->block_size);
+         fft_process_inverse_complex(eq->fft, (fft_complex_t*)out,
+               eq->fftblock, 1);
 
          // Overlap add method, so add in saved block now.
          for (i = 0; i < 2 * eq->block_size; i++)
@@ -49,8 +49,9 @@ enum IIRFilter
 
 struct iir_data
 {
+   /* Coefficients are normalized by a0. */
    float b0, b1, b2;
-   float a0, a1, a2;
+   float a1, a2;
 
    struct
    {
@@ -74,7 +75,6 @@ static void iir_process(void *data, struct dspfilter_output *output,
    float b0             = iir->b0;
    float b1             = iir->b1;
    float b2             = iir->b2;
-   float a0             = iir->a0;
    float a1             = iir->a1;
    float a2             = iir->a2;
 
@@ -96,8 +96,8 @@ static void iir_process(void *data, struct dspfilter_output *output,
       float in_l = out[0];
       float in_r = out[1];
 
-      float l    = (b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l) / a0;
-      float r    = (b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r) / a0;
+      float l    = b0 * in_l + b1 * xn1_l + b2 * xn2_l - a1 * yn1_l - a2 * yn2_l;
+      float r    = b0 * in_r + b1 * xn1_r + b2 * xn2_r - a1 * yn1_r - a2 * yn2_r;
 
       xn2_l      = xn1_l;
       xn1_l      = in_l;
@@ -317,12 +317,15 @@ static void iir_filter_init(struct iir_data *iir,
          break;
    }
 
-   iir->b0 = b0;
-   iir->b1 = b1;
-   iir->b2 = b2;
-   iir->a0 = a0;
-   iir->a1 = a1;
-   iir->a2 = a2;
+   if (a0 == 0.0f)
+      a0 = 1.0f;
+
+   /* Normalize once here instead of dividing every sample. */
+   iir->b0 = b0 / a0;
+   iir->b1 = b1 / a0;
+   iir->b2 = b2 / a0;
+   iir->a1 = a1 / a0;
+   iir->a2 = a2 / a0;
 }
 
 static void *iir_init(const struct dspfilter_info *info,
@@ -24,18 +24,25 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include <boolean.h>
 #include <retro_inline.h>
 #include <libretro_dspfilter.h>
 
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+/* Both channels share the same delay lengths and settings,
+ * so every comb and allpass holds the left and right
+ * channel interleaved, and processes them together. */
+
 struct comb
 {
    float *buffer;
    unsigned bufsize;
    unsigned bufidx;
 
-   float feedback;
-   float filterstore;
-   float damp1, damp2;
+   float filterstore[2];
 };
 
 struct allpass
@@ -46,31 +53,20 @@ struct allpass
    unsigned bufidx;
 };
 
-static INLINE float comb_process(struct comb *c, float input)
+static INLINE void allpass_process(struct allpass *a, float *samples)
 {
-   float output         = c->buffer[c->bufidx];
-   c->filterstore       = (output * c->damp2) + (c->filterstore * c->damp1);
+   float *buf           = a->buffer + a->bufidx * 2;
+   float bufout_l       = buf[0];
+   float bufout_r       = buf[1];
 
-   c->buffer[c->bufidx] = input + (c->filterstore * c->feedback);
-
-   c->bufidx++;
-   if (c->bufidx >= c->bufsize)
-      c->bufidx = 0;
-
-   return output;
-}
-
-static INLINE float allpass_process(struct allpass *a, float input)
-{
-   float bufout         = a->buffer[a->bufidx];
-   float output         = -input + bufout;
-   a->buffer[a->bufidx] = input + bufout * a->feedback;
+   buf[0]               = samples[0] + bufout_l * a->feedback;
+   buf[1]               = samples[1] + bufout_r * a->feedback;
+   samples[0]           = -samples[0] + bufout_l;
+   samples[1]           = -samples[1] + bufout_r;
 
    a->bufidx++;
    if (a->bufidx >= a->bufsize)
       a->bufidx = 0;
-
-   return output;
 }
 
 #define numcombs 8
@@ -92,11 +88,8 @@ static const float freezemode = 0.5f;
 
 struct revmodel
 {
-   struct comb combL[numcombs];
-   struct allpass allpassL[numallpasses];
-
-   float *bufcomb[numcombs];
-   float *bufallpass[numallpasses];
+   struct comb comb[numcombs];
+   struct allpass allpass[numallpasses];
 
    float gain;
    float roomsize, roomsize1;
@@ -105,27 +98,101 @@ struct revmodel
    float dry;
    float width;
    float mode;
+
+   /* Shared by all combs. */
+   float feedback;
+   float comb_damp1, comb_damp2;
 };
 
-static float revmodel_process(struct revmodel *rev, float in)
+static INLINE void comb_advance(struct comb *c)
+{
+   c->bufidx++;
+   if (c->bufidx >= c->bufsize)
+      c->bufidx = 0;
+}
+
+static void revmodel_process(struct revmodel *rev, float *samples)
 {
    int i;
-   float mono_out = 0.0f;
-   float mono_in  = in;
-   float input    = mono_in * rev->gain;
+   float out[2];
+   float input_l  = samples[0] * rev->gain;
+   float input_r  = samples[1] * rev->gain;
+
+#if defined(__SSE__)
+   {
+      /* Two combs per vector: [a.l, a.r, b.l, b.r] */
+      __m128 acc      = _mm_setzero_ps();
+      __m128 input    = _mm_setr_ps(input_l, input_r, input_l, input_r);
+      __m128 feedback = _mm_set1_ps(rev->feedback);
+      __m128 damp1    = _mm_set1_ps(rev->comb_damp1);
+      __m128 damp2    = _mm_set1_ps(rev->comb_damp2);
+
+      for (i = 0; i < numcombs; i += 2)
+      {
+         struct comb *a = &rev->comb[i];
+         struct comb *b = &rev->comb[i + 1];
+         float *buf_a   = a->buffer + a->bufidx * 2;
+         float *buf_b   = b->buffer + b->bufidx * 2;
+         __m128 output  = _mm_loadh_pi(
+               _mm_loadl_pi(_mm_setzero_ps(), (const __m64*)buf_a),
+               (const __m64*)buf_b);
+         __m128 store   = _mm_setr_ps(
+               a->filterstore[0], a->filterstore[1],
+               b->filterstore[0], b->filterstore[1]);
+
+         store          = _mm_add_ps(_mm_mul_ps(output, damp2),
+               _mm_mul_ps(store, damp1));
+         acc            = _mm_add_ps(acc, output);
+
+         _mm_storel_pi((__m64*)a->filterstore, store);
+         _mm_storeh_pi((__m64*)b->filterstore, store);
+
+         store          = _mm_add_ps(input, _mm_mul_ps(store, feedback));
+         _mm_storel_pi((__m64*)buf_a, store);
+         _mm_storeh_pi((__m64*)buf_b, store);
+
+         comb_advance(a);
+         comb_advance(b);
+      }
+
+      acc = _mm_add_ps(acc, _mm_movehl_ps(acc, acc));
+      _mm_storel_pi((__m64*)out, acc);
+   }
+#else
+   out[0] = 0.0f;
+   out[1] = 0.0f;
 
    for (i = 0; i < numcombs; i++)
-      mono_out += comb_process(&rev->combL[i], input);
+   {
+      struct comb *c    = &rev->comb[i];
+      float *buf        = c->buffer + c->bufidx * 2;
+      float output_l    = buf[0];
+      float output_r    = buf[1];
+
+      c->filterstore[0] = output_l * rev->comb_damp2
+         + c->filterstore[0] * rev->comb_damp1;
+      c->filterstore[1] = output_r * rev->comb_damp2
+         + c->filterstore[1] * rev->comb_damp1;
+
+      buf[0]            = input_l + c->filterstore[0] * rev->feedback;
+      buf[1]            = input_r + c->filterstore[1] * rev->feedback;
+
+      out[0]           += output_l;
+      out[1]           += output_r;
+
+      comb_advance(c);
+   }
+#endif
 
    for (i = 0; i < numallpasses; i++)
-      mono_out = allpass_process(&rev->allpassL[i], mono_out);
+      allpass_process(&rev->allpass[i], out);
 
-   return mono_in * rev->dry + mono_out * rev->wet1;
+   samples[0] = samples[0] * rev->dry + out[0] * rev->wet1;
+   samples[1] = samples[1] * rev->dry + out[1] * rev->wet1;
 }
 
 static void revmodel_update(struct revmodel *rev)
 {
-   int i;
    rev->wet1 = rev->wet * (rev->width / 2.0f + 0.5f);
 
    if (rev->mode >= freezemode)
@@ -141,12 +208,9 @@ static void revmodel_update(struct revmodel *rev)
       rev->gain = fixedgain;
    }
 
-   for (i = 0; i < numcombs; i++)
-   {
-      rev->combL[i].feedback = rev->roomsize1;
-      rev->combL[i].damp1 = rev->damp1;
-      rev->combL[i].damp2 = 1.0f - rev->damp1;
-   }
+   rev->feedback   = rev->roomsize1;
+   rev->comb_damp1 = rev->damp1;
+   rev->comb_damp2 = 1.0f - rev->damp1;
 }
 
 static void revmodel_setroomsize(struct revmodel *rev, float value)
@@ -185,30 +249,31 @@ static void revmodel_setmode(struct revmodel *rev, float value)
    revmodel_update(rev);
 }
 
-static void revmodel_init(struct revmodel *rev,int srate)
+static bool revmodel_init(struct revmodel *rev, int srate)
 {
-
-  static const int comb_lengths[8] = { 1116,1188,1277,1356,1422,1491,1557,1617 };
-  static const int allpass_lengths[4] = { 225,341,441,556 };
-  double r = srate * (1 / 44100.0);
-  unsigned c;
+   static const int comb_lengths[8] = { 1116,1188,1277,1356,1422,1491,1557,1617 };
+   static const int allpass_lengths[4] = { 225,341,441,556 };
+   double r = srate * (1 / 44100.0);
+   unsigned c;
 
    for (c = 0; c < numcombs; ++c)
    {
-	   rev->bufcomb[c] = malloc(r*comb_lengths[c]*sizeof(float));
-	   rev->combL[c].buffer  =  rev->bufcomb[c];
-         memset(rev->combL[c].buffer,0,r*comb_lengths[c]*sizeof(float));
-         rev->combL[c].bufsize=r*comb_lengths[c];
-  }
+      rev->comb[c].bufsize = r * comb_lengths[c];
+      rev->comb[c].buffer  = (float*)calloc(rev->comb[c].bufsize,
+            2 * sizeof(float));
+      if (!rev->comb[c].buffer)
+         return false;
+   }
 
    for (c = 0; c < numallpasses; ++c)
    {
-	   rev->bufallpass[c] = malloc(r*allpass_lengths[c]*sizeof(float));
-	   rev->allpassL[c].buffer  =  rev->bufallpass[c];
-         memset(rev->allpassL[c].buffer,0,r*allpass_lengths[c]*sizeof(float));
-         rev->allpassL[c].bufsize=r*allpass_lengths[c];
-         rev->allpassL[c].feedback = 0.5f;
-  }
+      rev->allpass[c].bufsize  = r * allpass_lengths[c];
+      rev->allpass[c].buffer   = (float*)calloc(rev->allpass[c].bufsize,
+            2 * sizeof(float));
+      rev->allpass[c].feedback = 0.5f;
+      if (!rev->allpass[c].buffer)
+         return false;
+   }
 
    revmodel_setwet(rev, initialwet);
    revmodel_setroomsize(rev, initialroom);
@@ -216,11 +281,12 @@ static void revmodel_init(struct revmodel *rev,int srate)
    revmodel_setdamp(rev, initialdamp);
    revmodel_setwidth(rev, initialwidth);
    revmodel_setmode(rev, initialmode);
+   return true;
 }
 
 struct reverb_data
 {
-   struct revmodel left, right;
+   struct revmodel rev;
 };
 
 static void reverb_free(void *data)
@@ -228,15 +294,11 @@ static void reverb_free(void *data)
    struct reverb_data *rev = (struct reverb_data*)data;
    unsigned i;
 
-   for (i = 0; i < numcombs; i++) {
-   free(rev->left.bufcomb[i]);
-   free(rev->right.bufcomb[i]);
-   }
+   for (i = 0; i < numcombs; i++)
+      free(rev->rev.comb[i].buffer);
 
-   for (i = 0; i < numallpasses; i++) {
-   free(rev->left.bufallpass[i]);
-   free(rev->right.bufallpass[i]);
-   }
+   for (i = 0; i < numallpasses; i++)
+      free(rev->rev.allpass[i].buffer);
    free(data);
 }
 
@@ -252,12 +314,7 @@ static void reverb_process(void *data, struct dspfilter_output *output,
    out                     = output->samples;
 
    for (i = 0; i < input->frames; i++, out += 2)
-   {
-      float in[2] = { out[0], out[1] };
-
-      out[0] = revmodel_process(&rev->left, in[0]);
-      out[1] = revmodel_process(&rev->right, in[1]);
-   }
+      revmodel_process(&rev->rev, out);
 }
 
 static void *reverb_init(const struct dspfilter_info *info,
@@ -275,20 +332,17 @@ static void *reverb_init(const struct dspfilter_info *info,
    config->get_float(userdata, "roomwidth", &roomwidth, 0.56f);
    config->get_float(userdata, "roomsize", &roomsize, 0.56f);
 
-   revmodel_init(&rev->left,info->input_rate);
-   revmodel_init(&rev->right,info->input_rate);
-
-   revmodel_setdamp(&rev->left, damping);
-   revmodel_setdry(&rev->left, drytime);
-   revmodel_setwet(&rev->left, wettime);
-   revmodel_setwidth(&rev->left, roomwidth);
-   revmodel_setroomsize(&rev->left, roomsize);
+   if (!revmodel_init(&rev->rev, info->input_rate))
+   {
+      reverb_free(rev);
+      return NULL;
+   }
 
-   revmodel_setdamp(&rev->right, damping);
-   revmodel_setdry(&rev->right, drytime);
-   revmodel_setwet(&rev->right, wettime);
-   revmodel_setwidth(&rev->right, roomwidth);
-   revmodel_setroomsize(&rev->right, roomsize);
+   revmodel_setdamp(&rev->rev, damping);
+   revmodel_setdry(&rev->rev, drytime);
+   revmodel_setwet(&rev->rev, wettime);
+   revmodel_setwidth(&rev->rev, roomwidth);
+   revmodel_setroomsize(&rev->rev, roomsize);
 
    return rev;
 }
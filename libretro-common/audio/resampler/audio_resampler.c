@@ -44,6 +44,7 @@ retro_resampler_t null_resampler = {
 
 static const retro_resampler_t *resampler_drivers[] = {
    &sinc_resampler,
+   &polyphase_resampler,
 #ifdef HAVE_CC_RESAMPLER
    &CC_resampler,
 #endif
@@ -0,0 +1,457 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (polyphase_resampler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Polyphase FIR resampler for fixed conversion ratios.
+ *
+ * The ratio passed at init time (e.g. 48000 / 44100 = 160 / 147)
+ * is matched against a rational L / M. The phase table is then built
+ * with a multiple of L phases, so that at the nominal ratio every
+ * output frame lands exactly on a precomputed phase and each output
+ * costs a single dot product per channel - no coefficient
+ * interpolation as in the sinc resampler.
+ *
+ * Small deviations from the nominal ratio (dynamic rate control,
+ * refresh rate skew) are handled by the fractional part of the
+ * 32.32 fixed-point time step: it accumulates between outputs, and
+ * the phase used is the one the time falls into. The table is dense
+ * enough (4096+ phases at the higher quality levels) that the
+ * resulting timing error stays below the filter's own noise floor.
+ *
+ * The exact L / M path only applies when the init ratio itself is
+ * rational. RetroArch passes the output rate over the core's rate
+ * after refresh rate skew adjustment, which is rarely a small L / M;
+ * such ratios use the rounded fixed-point step from the start, and
+ * the filter behaves like a plain dense phase table.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+#include <string.h>
+
+#include <retro_inline.h>
+#include <filters.h>
+#include <memalign.h>
+
+#include <audio/audio_resampler.h>
+
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
+
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON))
+#include <arm_neon.h>
+#endif
+
+/* Largest numerator considered when matching the
+ * init ratio against a rational L / M. */
+#define POLYPHASE_MAX_NUMERATOR 1024
+
+typedef void (*polyphase_dot_t)(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, unsigned taps);
+
+typedef struct rarch_polyphase_resampler
+{
+   polyphase_dot_t dot;
+   /* A buffer for phase_table, buffer_l and buffer_r
+    * are created in a single allocation, as in the sinc
+    * resampler. */
+   float *main_buffer;
+   float *phase_table;
+   float *buffer_l;
+   float *buffer_r;
+   /* Time in 32.32 fixed point, in units of phases. */
+   uint64_t time;
+   uint64_t step;
+   uint64_t nominal_step;
+   double nominal_ratio;
+   double last_ratio;
+   unsigned phases;
+   unsigned taps;
+   unsigned ptr;
+} rarch_polyphase_resampler_t;
+
+static void polyphase_dot_c(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, unsigned taps)
+{
+   unsigned i;
+   float sum_l = 0.0f;
+   float sum_r = 0.0f;
+
+   for (i = 0; i < taps; i++)
+   {
+      sum_l += buffer_l[i] * phase_table[i];
+      sum_r += buffer_r[i] * phase_table[i];
+   }
+
+   out[0] = sum_l;
+   out[1] = sum_r;
+}
+
+#if defined(__SSE__)
+/* Assumes that taps is a multiple of 8. */
+static void polyphase_dot_sse(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, unsigned taps)
+{
+   unsigned i;
+   __m128 sum;
+   __m128 sum_l0 = _mm_setzero_ps();
+   __m128 sum_r0 = _mm_setzero_ps();
+   __m128 sum_l1 = _mm_setzero_ps();
+   __m128 sum_r1 = _mm_setzero_ps();
+
+   /* Two accumulators per channel to hide the add latency. */
+   for (i = 0; i < taps; i += 8)
+   {
+      __m128 coeff0 = _mm_load_ps(phase_table + i);
+      __m128 coeff1 = _mm_load_ps(phase_table + i + 4);
+      sum_l0        = _mm_add_ps(sum_l0,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i), coeff0));
+      sum_r0        = _mm_add_ps(sum_r0,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i), coeff0));
+      sum_l1        = _mm_add_ps(sum_l1,
+            _mm_mul_ps(_mm_loadu_ps(buffer_l + i + 4), coeff1));
+      sum_r1        = _mm_add_ps(sum_r1,
+            _mm_mul_ps(_mm_loadu_ps(buffer_r + i + 4), coeff1));
+   }
+
+   sum_l0 = _mm_add_ps(sum_l0, sum_l1);
+   sum_r0 = _mm_add_ps(sum_r0, sum_r1);
+
+   /* sum = { r1, r0, l1, l0 } + { r3, r2, l3, l2 } */
+   sum    = _mm_add_ps(
+         _mm_shuffle_ps(sum_l0, sum_r0, _MM_SHUFFLE(1, 0, 1, 0)),
+         _mm_shuffle_ps(sum_l0, sum_r0, _MM_SHUFFLE(3, 2, 3, 2)));
+   /* sum = { X, R, X, L } */
+   sum    = _mm_add_ps(_mm_shuffle_ps(sum, sum, _MM_SHUFFLE(3, 3, 1, 1)), sum);
+
+   _mm_store_ss(out + 0, sum);
+   _mm_store_ss(out + 1, _mm_movehl_ps(sum, sum));
+}
+#endif
+
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON))
+/* Assumes that taps is a multiple of 8. */
+static void polyphase_dot_neon(float *out,
+      const float *buffer_l, const float *buffer_r,
+      const float *phase_table, unsigned taps)
+{
+   unsigned i;
+   float32x2_t p3, p4;
+   float32x4_t p1 = vdupq_n_f32(0.0f);
+   float32x4_t p2 = vdupq_n_f32(0.0f);
+
+   for (i = 0; i < taps; i += 8)
+   {
+      float32x4x2_t coeff8 = vld2q_f32(phase_table + i);
+      float32x4x2_t left8  = vld2q_f32(buffer_l + i);
+      float32x4x2_t right8 = vld2q_f32(buffer_r + i);
+
+      p1 = vmlaq_f32(p1,  left8.val[0], coeff8.val[0]);
+      p2 = vmlaq_f32(p2, right8.val[0], coeff8.val[0]);
+      p1 = vmlaq_f32(p1,  left8.val[1], coeff8.val[1]);
+      p2 = vmlaq_f32(p2, right8.val[1], coeff8.val[1]);
+   }
+
+   p3 = vadd_f32(vget_low_f32(p1), vget_high_f32(p1));
+   p4 = vadd_f32(vget_low_f32(p2), vget_high_f32(p2));
+   vst1_f32(out, vpadd_f32(p3, p4));
+}
+#endif
+
+/**
+ * polyphase_update_step:
+ * @resamp                 : polyphase resampler handle
+ * @ratio                  : current output/input ratio
+ *
+ * Recomputes the fixed-point time step for @ratio. Ratios
+ * that match the nominal one use the exact integer step, so
+ * that output frames keep landing on precomputed phases.
+ **/
+static void polyphase_update_step(
+      rarch_polyphase_resampler_t *resamp, double ratio)
+{
+   resamp->last_ratio = ratio;
+
+   if (fabs(ratio - resamp->nominal_ratio) <= 1e-9 * resamp->nominal_ratio)
+      resamp->step    = resamp->nominal_step;
+   else
+      resamp->step    = (uint64_t)(
+            (double)resamp->phases * 4294967296.0 / ratio + 0.5);
+}
+
+static void resampler_polyphase_process(void *re_,
+      struct resampler_data *data)
+{
+   rarch_polyphase_resampler_t *resamp = (rarch_polyphase_resampler_t*)re_;
+   uint64_t phases                     = (uint64_t)resamp->phases << 32;
+   const float *input                  = data->data_in;
+   float *output                       = data->data_out;
+   size_t frames                       = data->input_frames;
+   size_t out_frames                   = 0;
+   unsigned taps                       = resamp->taps;
+   uint64_t step;
+
+   if (data->ratio != resamp->last_ratio)
+      polyphase_update_step(resamp, data->ratio);
+   step = resamp->step;
+
+   while (frames)
+   {
+      while (frames && resamp->time >= phases)
+      {
+         /* Push in reverse to make filter more obvious. */
+         if (!resamp->ptr)
+            resamp->ptr = taps;
+         resamp->ptr--;
+
+         resamp->buffer_l[resamp->ptr + taps] =
+            resamp->buffer_l[resamp->ptr]     = *input++;
+
+         resamp->buffer_r[resamp->ptr + taps] =
+            resamp->buffer_r[resamp->ptr]     = *input++;
+
+         resamp->time                        -= phases;
+         frames--;
+      }
+
+      {
+         const float *buffer_l = resamp->buffer_l + resamp->ptr;
+         const float *buffer_r = resamp->buffer_r + resamp->ptr;
+
+         while (resamp->time < phases)
+         {
+            unsigned phase = (unsigned)(resamp->time >> 32);
+
+            resamp->dot(output, buffer_l, buffer_r,
+                  resamp->phase_table + phase * taps, taps);
+
+            output        += 2;
+            out_frames++;
+            resamp->time  += step;
+         }
+      }
+   }
+
+   data->output_frames = out_frames;
+}
+
+static void resampler_polyphase_free(void *data)
+{
+   rarch_polyphase_resampler_t *resamp = (rarch_polyphase_resampler_t*)data;
+   if (resamp)
+      memalign_free(resamp->main_buffer);
+   free(resamp);
+}
+
+/**
+ * polyphase_init_table:
+ *
+ * Fills @phase_table with @phases Kaiser-windowed sinc kernels
+ * of @taps taps each, laid out as in the sinc resampler.
+ * Every phase is normalized to unity DC gain, so that the
+ * choice of phase does not modulate the signal level.
+ **/
+static void polyphase_init_table(float *phase_table,
+      double cutoff, double beta, unsigned phases, unsigned taps)
+{
+   unsigned i, j;
+   double window_mod = kaiser_window_function(0.0, beta);
+   double sidelobes  = taps / 2.0;
+
+   for (i = 0; i < phases; i++)
+   {
+      float *row = phase_table + i * taps;
+      double sum = 0.0;
+
+      for (j = 0; j < taps; j++)
+      {
+         double n            = (double)j * phases + i;
+         double window_phase = 2.0 * n / ((double)phases * taps) - 1.0;
+         double sinc_phase   = sidelobes * window_phase;
+         double val          = cutoff * sinc(M_PI * sinc_phase * cutoff) *
+            kaiser_window_function(window_phase, beta) / window_mod;
+         row[j]              = (float)val;
+         sum                += val;
+      }
+
+      if (sum > 0.0)
+         for (j = 0; j < taps; j++)
+            row[j] = (float)(row[j] / sum);
+   }
+}
+
+/**
+ * polyphase_find_ratio:
+ * @ratio                  : output/input ratio
+ * @num                    : returns numerator L
+ * @den                    : returns denominator M
+ *
+ * Finds the smallest L <= POLYPHASE_MAX_NUMERATOR for which
+ * L / M matches @ratio.
+ *
+ * Returns: true if a match was found, otherwise false.
+ **/
+static bool polyphase_find_ratio(double ratio,
+      unsigned *num, unsigned *den)
+{
+   unsigned l;
+
+   for (l = 1; l <= POLYPHASE_MAX_NUMERATOR; l++)
+   {
+      double m = floor(l / ratio + 0.5);
+
+      if (m < 1.0)
+         continue;
+
+      if (fabs(l / m - ratio) <= 1e-9 * ratio)
+      {
+         *num = l;
+         *den = (unsigned)m;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+static void *resampler_polyphase_new(const struct resampler_config *config,
+      double bandwidth_mod, enum resampler_quality quality,
+      resampler_simd_mask_t mask)
+{
+   unsigned num                        = 1;
+   unsigned den                        = 1;
+   unsigned min_phases                 = 0;
+   unsigned sidelobes                  = 0;
+   double cutoff                       = 0.0;
+   double beta                         = 0.0;
+   size_t phase_elems                  = 0;
+   size_t elems                        = 0;
+   rarch_polyphase_resampler_t *re     = NULL;
+
+   if (bandwidth_mod <= 0.0)
+      return NULL;
+
+   if (!(re = (rarch_polyphase_resampler_t*)calloc(1, sizeof(*re))))
+      return NULL;
+
+   switch (quality)
+   {
+      case RESAMPLER_QUALITY_LOWEST:
+      case RESAMPLER_QUALITY_LOWER:
+         cutoff     = 0.825;
+         sidelobes  = 8;
+         beta       = 5.5;
+         min_phases = 1024;
+         break;
+      case RESAMPLER_QUALITY_HIGHER:
+      case RESAMPLER_QUALITY_HIGHEST:
+         cutoff     = 0.90;
+         sidelobes  = 32;
+         beta       = 10.5;
+         min_phases = 4096;
+         break;
+      case RESAMPLER_QUALITY_NORMAL:
+      case RESAMPLER_QUALITY_DONTCARE:
+         cutoff     = 0.87;
+         sidelobes  = 16;
+         beta       = 8.0;
+         min_phases = 2048;
+         break;
+   }
+
+   re->taps = sidelobes * 2;
+
+   /* Downsampling, must lower cutoff, and extend number of
+    * taps accordingly to keep same stopband attenuation. */
+   if (bandwidth_mod < 1.0)
+   {
+      cutoff  *= bandwidth_mod;
+      re->taps = (unsigned)ceil(re->taps / bandwidth_mod);
+   }
+
+   /* Be SIMD-friendly. */
+   re->taps = (re->taps + 7) & ~7;
+
+   /* Use a multiple of L phases, so that the nominal
+    * step of M input frames per L output frames is an
+    * exact number of phases. Ratios without a small L/M
+    * form (including skew adjusted ones) fall back to the
+    * rounded fixed-point step. */
+   re->nominal_ratio = bandwidth_mod;
+   if (polyphase_find_ratio(bandwidth_mod, &num, &den))
+   {
+      re->phases       = num * ((min_phases + num - 1) / num);
+      re->nominal_step = ((uint64_t)(re->phases / num) * den) << 32;
+   }
+   else
+   {
+      re->phases       = min_phases;
+      re->nominal_step = (uint64_t)(
+            (double)re->phases * 4294967296.0 / bandwidth_mod + 0.5);
+   }
+
+   polyphase_update_step(re, bandwidth_mod);
+
+   phase_elems       = (size_t)re->phases * re->taps;
+   elems             = phase_elems + 4 * re->taps;
+
+   if (!(re->main_buffer = (float*)memalign_alloc(128, sizeof(float) * elems)))
+      goto error;
+
+   memset(re->main_buffer, 0, sizeof(float) * elems);
+
+   re->phase_table   = re->main_buffer;
+   re->buffer_l      = re->main_buffer + phase_elems;
+   re->buffer_r      = re->buffer_l + 2 * re->taps;
+
+   polyphase_init_table(re->phase_table, cutoff, beta,
+         re->phases, re->taps);
+
+   re->dot           = polyphase_dot_c;
+#if defined(__SSE__)
+   if (mask & RESAMPLER_SIMD_SSE)
+      re->dot        = polyphase_dot_sse;
+#endif
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON))
+   if (mask & RESAMPLER_SIMD_NEON)
+      re->dot        = polyphase_dot_neon;
+#endif
+
+   return re;
+
+error:
+   resampler_polyphase_free(re);
+   return NULL;
+}
+
+retro_resampler_t polyphase_resampler = {
+   resampler_polyphase_new,
+   resampler_polyphase_process,
+   resampler_polyphase_free,
+   RESAMPLER_API_VERSION,
+   "polyphase",
+   "polyphase"
+};
@@ -40,6 +40,7 @@
 
 #ifdef _WIN32
 #include <direct.h>
+#include <encodings/utf.h>
 #else
 #include <unistd.h> /* stat() is defined here */
 #endif
@@ -100,6 +101,58 @@ int32_t path_get_size(const char *path)
    return -1;
 }
 
+/**
+ * path_get_mtime:
+ * @path               : path
+ *
+ * Gets the modification time of a file. The frontend
+ * VFS interface has no modification time, so this uses
+ * the platform's stat() directly.
+ *
+ * Returns: modification time in seconds since the epoch,
+ * or 0 if it is unknown or unavailable on this platform.
+ **/
+int64_t path_get_mtime(const char *path)
+{
+#if defined(VITA) || defined(PSP) || defined(ORBIS) || defined(__PSL1GHT__) || defined(__PS3__)
+   return 0;
+#elif defined(_WIN32)
+   struct _stat buf;
+#if defined(LEGACY_WIN32)
+   char *path_local    = NULL;
+#else
+   wchar_t *path_wide  = NULL;
+#endif
+   int ret             = -1;
+
+   if (!path || !*path)
+      return 0;
+
+#if defined(LEGACY_WIN32)
+   if ((path_local = utf8_to_local_string_alloc(path)))
+   {
+      ret = _stat(path_local, &buf);
+      free(path_local);
+   }
+#else
+   if ((path_wide = utf8_to_utf16_string_alloc(path)))
+   {
+      ret = _wstat(path_wide, &buf);
+      free(path_wide);
+   }
+#endif
+
+   return (ret == 0) ? (int64_t)buf.st_mtime : 0;
+#else
+   struct stat buf;
+
+   if (!path || !*path || stat(path, &buf) != 0)
+      return 0;
+
+   return (int64_t)buf.st_mtime;
+#endif
+}
+
 /**
  * path_mkdir:
  * @dir                : directory
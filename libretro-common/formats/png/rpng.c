@@ -39,6 +39,16 @@
 
 #include "rpng_internal.h"
 
+#if !defined(RPNG_NO_SIMD)
+#if defined(__SSE2__)
+#define RPNG_SSE2
+#include <emmintrin.h>
+#elif defined(__ARM_NEON__) || defined(__ARM_NEON) || defined(HAVE_NEON)
+#define RPNG_NEON
+#include <arm_neon.h>
+#endif
+#endif
+
 enum png_ihdr_color_type
 {
    PNG_IHDR_COLOR_GRAY       = 0,
@@ -220,6 +230,237 @@ static bool png_process_ihdr(struct png_ihdr *ihdr)
 }
 #endif
 
+/* SIMD reverse filters
+ *
+ * Sub, average and paeth depend on the pixel to the left,
+ * so these work on one pixel (3 or 4 bytes) at a time,
+ * with all of its channels in one vector. Up has no such
+ * dependency and is done 16 bytes at a time. */
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+static INLINE uint32_t png_simd_read_px(const uint8_t *p, unsigned bpp)
+{
+   uint32_t v;
+   if (bpp == 4)
+      memcpy(&v, p, sizeof(v));
+   else
+      v = p[0] | (p[1] << 8) | (p[2] << 16);
+   return v;
+}
+
+static INLINE void png_simd_write_px(uint8_t *p, uint32_t v, unsigned bpp)
+{
+   if (bpp == 4)
+      memcpy(p, &v, sizeof(v));
+   else
+   {
+      p[0] = (uint8_t)v;
+      p[1] = (uint8_t)(v >> 8);
+      p[2] = (uint8_t)(v >> 16);
+   }
+}
+#endif
+
+#if defined(RPNG_SSE2)
+static INLINE __m128i png_simd_load_px(const uint8_t *p, unsigned bpp)
+{
+   return _mm_cvtsi32_si128((int)png_simd_read_px(p, bpp));
+}
+
+static INLINE void png_simd_store_px(uint8_t *p, __m128i v, unsigned bpp)
+{
+   png_simd_write_px(p, (uint32_t)_mm_cvtsi128_si32(v), bpp);
+}
+
+static INLINE void png_reverse_filter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a = _mm_setzero_si128();
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = _mm_add_epi8(a, png_simd_load_px(in + i, bpp));
+      png_simd_store_px(out + i, a, bpp);
+   }
+}
+
+static void png_reverse_filter_up_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch)
+{
+   unsigned i;
+
+   for (i = 0; i + 16 <= pitch; i += 16)
+      _mm_storeu_si128((__m128i*)(out + i), _mm_add_epi8(
+               _mm_loadu_si128((const __m128i*)(in   + i)),
+               _mm_loadu_si128((const __m128i*)(prev + i))));
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static INLINE void png_reverse_filter_avg_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   __m128i a         = _mm_setzero_si128();
+   const __m128i one = _mm_set1_epi8(1);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i b   = png_simd_load_px(prev + i, bpp);
+      /* _mm_avg_epu8 rounds up, PNG rounds down */
+      __m128i avg = _mm_sub_epi8(_mm_avg_epu8(a, b),
+            _mm_and_si128(_mm_xor_si128(a, b), one));
+      a           = _mm_add_epi8(avg, png_simd_load_px(in + i, bpp));
+      png_simd_store_px(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_reverse_filter_paeth_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   const __m128i zero = _mm_setzero_si128();
+   const __m128i mask = _mm_set1_epi16(0xff);
+   __m128i a          = zero;
+   __m128i c          = zero;
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      __m128i pa, pb, pc, gt_a, gt_b, pred;
+      __m128i b = _mm_unpacklo_epi8(png_simd_load_px(prev + i, bpp), zero);
+      __m128i x = _mm_unpacklo_epi8(png_simd_load_px(in   + i, bpp), zero);
+
+      /* With p = a + b - c:
+       * p - a = b - c, p - b = a - c, p - c = (b - c) + (a - c) */
+      pa   = _mm_sub_epi16(b, c);
+      pb   = _mm_sub_epi16(a, c);
+      pc   = _mm_add_epi16(pa, pb);
+      pa   = _mm_max_epi16(pa, _mm_sub_epi16(zero, pa));
+      pb   = _mm_max_epi16(pb, _mm_sub_epi16(zero, pb));
+      pc   = _mm_max_epi16(pc, _mm_sub_epi16(zero, pc));
+
+      gt_a = _mm_or_si128(_mm_cmpgt_epi16(pa, pb), _mm_cmpgt_epi16(pa, pc));
+      gt_b = _mm_cmpgt_epi16(pb, pc);
+      pred = _mm_or_si128(_mm_and_si128(gt_b, c), _mm_andnot_si128(gt_b, b));
+      pred = _mm_or_si128(_mm_and_si128(gt_a, pred), _mm_andnot_si128(gt_a, a));
+
+      c    = b;
+      a    = _mm_and_si128(_mm_add_epi16(x, pred), mask);
+      png_simd_store_px(out + i, _mm_packus_epi16(a, a), bpp);
+   }
+}
+#elif defined(RPNG_NEON)
+static INLINE uint8x8_t png_simd_load_px(const uint8_t *p, unsigned bpp)
+{
+   return vreinterpret_u8_u32(vdup_n_u32(png_simd_read_px(p, bpp)));
+}
+
+static INLINE void png_simd_store_px(uint8_t *p, uint8x8_t v, unsigned bpp)
+{
+   png_simd_write_px(p, vget_lane_u32(vreinterpret_u32_u8(v), 0), bpp);
+}
+
+static INLINE void png_reverse_filter_sub_simd(uint8_t *out,
+      const uint8_t *in, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      a = vadd_u8(a, png_simd_load_px(in + i, bpp));
+      png_simd_store_px(out + i, a, bpp);
+   }
+}
+
+static void png_reverse_filter_up_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch)
+{
+   unsigned i;
+
+   for (i = 0; i + 16 <= pitch; i += 16)
+      vst1q_u8(out + i, vaddq_u8(vld1q_u8(in + i), vld1q_u8(prev + i)));
+
+   for (; i < pitch; i++)
+      out[i] = prev[i] + in[i];
+}
+
+static INLINE void png_reverse_filter_avg_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      /* vhadd_u8 rounds down, as PNG does */
+      a = vadd_u8(vhadd_u8(a, png_simd_load_px(prev + i, bpp)),
+            png_simd_load_px(in + i, bpp));
+      png_simd_store_px(out + i, a, bpp);
+   }
+}
+
+static INLINE void png_reverse_filter_paeth_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev, unsigned pitch, unsigned bpp)
+{
+   unsigned i;
+   uint8x8_t a = vdup_n_u8(0);
+   uint8x8_t c = vdup_n_u8(0);
+
+   for (i = 0; i < pitch; i += bpp)
+   {
+      uint8x8_t b     = png_simd_load_px(prev + i, bpp);
+      uint16x8_t pa   = vabdl_u8(b, c);
+      uint16x8_t pb   = vabdl_u8(a, c);
+      uint16x8_t pc   = vabdq_u16(vaddl_u8(a, b), vshll_n_u8(c, 1));
+      uint8x8_t gt_a  = vmovn_u16(vorrq_u16(vcgtq_u16(pa, pb),
+               vcgtq_u16(pa, pc)));
+      uint8x8_t gt_b  = vmovn_u16(vcgtq_u16(pb, pc));
+      uint8x8_t pred  = vbsl_u8(gt_a, vbsl_u8(gt_b, c, b), a);
+
+      c               = b;
+      a               = vadd_u8(pred, png_simd_load_px(in + i, bpp));
+      png_simd_store_px(out + i, a, bpp);
+   }
+}
+#endif
+
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+static INLINE void png_reverse_filter_px_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev,
+      unsigned pitch, unsigned bpp, unsigned filter)
+{
+   switch (filter)
+   {
+      case PNG_FILTER_SUB:
+         png_reverse_filter_sub_simd(out, in, pitch, bpp);
+         break;
+      case PNG_FILTER_AVERAGE:
+         png_reverse_filter_avg_simd(out, in, prev, pitch, bpp);
+         break;
+      case PNG_FILTER_PAETH:
+         png_reverse_filter_paeth_simd(out, in, prev, pitch, bpp);
+         break;
+   }
+}
+
+/* Only 3 and 4 byte pixels (8-bit RGB and RGBA) are
+ * handled, with the pixel size known at compile time */
+static bool png_reverse_filter_simd(uint8_t *out,
+      const uint8_t *in, const uint8_t *prev,
+      unsigned pitch, unsigned bpp, unsigned filter)
+{
+   if (bpp == 4)
+      png_reverse_filter_px_simd(out, in, prev, pitch, 4, filter);
+   else if (bpp == 3)
+      png_reverse_filter_px_simd(out, in, prev, pitch, 3, filter);
+   else
+      return false;
+   return true;
+}
+#endif
+
 static void png_reverse_filter_copy_line_rgb(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
@@ -244,11 +485,30 @@ static void png_reverse_filter_copy_line_rgb(uint32_t *data,
 static void png_reverse_filter_copy_line_rgba(uint32_t *data,
       const uint8_t *decoded, unsigned width, unsigned bpp)
 {
-   unsigned i;
+   unsigned i = 0;
+
+#if defined(RPNG_SSE2)
+   /* 8-bit RGBA only needs R and B swapped */
+   if (bpp == 8)
+   {
+      const __m128i mask_ag = _mm_set1_epi32((int)0xff00ff00);
+      const __m128i mask_b  = _mm_set1_epi32(0xff);
+
+      for (; i + 4 <= width; i += 4, decoded += 16)
+      {
+         __m128i px = _mm_loadu_si128((const __m128i*)decoded);
+         __m128i rb = _mm_or_si128(
+               _mm_slli_epi32(_mm_and_si128(px, mask_b), 16),
+               _mm_and_si128(_mm_srli_epi32(px, 16), mask_b));
+         _mm_storeu_si128((__m128i*)(data + i),
+               _mm_or_si128(_mm_and_si128(px, mask_ag), rb));
+      }
+   }
+#endif
 
    bpp /= 8;
 
-   for (i = 0; i < width; i++)
+   for (; i < width; i++)
    {
       uint32_t r, g, b, a;
       r        = *decoded;
@@ -559,6 +819,7 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
       struct rpng_process *pngp, unsigned filter)
 {
    unsigned i;
+   uint8_t *decoded;
 
    switch (filter)
    {
@@ -566,16 +827,33 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          memcpy(pngp->decoded_scanline, pngp->inflate_buf, pngp->pitch);
          break;
       case PNG_FILTER_SUB:
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+         if (png_reverse_filter_simd(pngp->decoded_scanline,
+                  pngp->inflate_buf, pngp->prev_scanline,
+                  pngp->pitch, pngp->bpp, filter))
+            break;
+#endif
          for (i = 0; i < pngp->bpp; i++)
             pngp->decoded_scanline[i] = pngp->inflate_buf[i];
          for (i = pngp->bpp; i < pngp->pitch; i++)
             pngp->decoded_scanline[i] = pngp->decoded_scanline[i - pngp->bpp] + pngp->inflate_buf[i];
          break;
       case PNG_FILTER_UP:
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+         png_reverse_filter_up_simd(pngp->decoded_scanline,
+               pngp->inflate_buf, pngp->prev_scanline, pngp->pitch);
+#else
          for (i = 0; i < pngp->pitch; i++)
             pngp->decoded_scanline[i] = pngp->prev_scanline[i] + pngp->inflate_buf[i];
+#endif
          break;
       case PNG_FILTER_AVERAGE:
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+         if (png_reverse_filter_simd(pngp->decoded_scanline,
+                  pngp->inflate_buf, pngp->prev_scanline,
+                  pngp->pitch, pngp->bpp, filter))
+            break;
+#endif
          for (i = 0; i < pngp->bpp; i++)
          {
             uint8_t avg = pngp->prev_scanline[i] >> 1;
@@ -588,6 +866,12 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          }
          break;
       case PNG_FILTER_PAETH:
+#if defined(RPNG_SSE2) || defined(RPNG_NEON)
+         if (png_reverse_filter_simd(pngp->decoded_scanline,
+                  pngp->inflate_buf, pngp->prev_scanline,
+                  pngp->pitch, pngp->bpp, filter))
+            break;
+#endif
          for (i = 0; i < pngp->bpp; i++)
             pngp->decoded_scanline[i] = paeth(0, pngp->prev_scanline[i], 0) + pngp->inflate_buf[i];
          for (i = pngp->bpp; i < pngp->pitch; i++)
@@ -620,7 +904,10 @@ static int png_reverse_filter_copy_line(uint32_t *data, const struct png_ihdr *i
          break;
    }
 
-   memcpy(pngp->prev_scanline, pngp->decoded_scanline, pngp->pitch);
+   /* The decoded line is the previous line of the next one */
+   decoded                = pngp->decoded_scanline;
+   pngp->decoded_scanline = pngp->prev_scanline;
+   pngp->prev_scanline    = decoded;
 
    return IMAGE_PROCESS_NEXT;
 }
@@ -29,6 +29,13 @@
 #include <streams/interface_stream.h>
 #include <streams/trans_stream.h>
 
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "rpng_internal.h"
 
 #undef GOTO_END_ERROR
@@ -41,6 +48,36 @@
 double DEFLATE_PADDING = 1.1;
 int PNG_ROUGH_HEADER = 100;
 
+/* Levels below this one use the same filter on every
+ * line, instead of trying all of them */
+#define PNG_ENCODE_ADAPTIVE_LEVEL RPNG_COMPRESSION_DEFAULT
+
+/* Minimum number of lines per stripe */
+#define PNG_ENCODE_STRIPE_LINES 64
+
+/* Large images are split into stripes of lines,
+ * filtered and deflated on their own threads */
+#if defined(HAVE_ZLIB) && defined(HAVE_THREADS)
+#define PNG_ENCODE_STRIPES
+#endif
+
+struct png_encode_stripe
+{
+   const uint8_t *data;    /* First line of the stripe */
+   uint8_t *encoded;       /* Filtered lines */
+   uint8_t *deflated;
+   size_t deflated_size;
+   uint32_t adler;         /* Adler-32 of the filtered lines */
+   signed pitch;
+   unsigned width;
+   unsigned height;        /* Number of lines */
+   unsigned bpp;
+   int level;
+   bool first;             /* First stripe of the image? */
+   bool last;              /* Last stripe of the image? */
+   bool ok;
+};
+
 static void dword_write_be(uint8_t *buf, uint32_t val)
 {
    *buf++ = (uint8_t)(val >> 24);
@@ -152,18 +189,16 @@ static unsigned count_sad(const uint8_t *data, size_t size)
    return cnt;
 }
 
-static unsigned filter_up(uint8_t *target, const uint8_t *line,
+static void filter_up(uint8_t *target, const uint8_t *line,
       const uint8_t *prev, unsigned width, unsigned bpp)
 {
    unsigned i;
    width *= bpp;
    for (i = 0; i < width; i++)
       target[i] = line[i] - prev[i];
-
-   return count_sad(target, width);
 }
 
-static unsigned filter_sub(uint8_t *target, const uint8_t *line,
+static void filter_sub(uint8_t *target, const uint8_t *line,
       unsigned width, unsigned bpp)
 {
    unsigned i;
@@ -172,11 +207,9 @@ static unsigned filter_sub(uint8_t *target, const uint8_t *line,
       target[i] = line[i];
    for (i = bpp; i < width; i++)
       target[i] = line[i] - line[i - bpp];
-
-   return count_sad(target, width);
 }
 
-static unsigned filter_avg(uint8_t *target, const uint8_t *line,
+static void filter_avg(uint8_t *target, const uint8_t *line,
       const uint8_t *prev, unsigned width, unsigned bpp)
 {
    unsigned i;
@@ -185,11 +218,9 @@ static unsigned filter_avg(uint8_t *target, const uint8_t *line,
       target[i] = line[i] - (prev[i] >> 1);
    for (i = bpp; i < width; i++)
       target[i] = line[i] - ((line[i - bpp] + prev[i]) >> 1);
-
-   return count_sad(target, width);
 }
 
-static unsigned filter_paeth(uint8_t *target,
+static void filter_paeth(uint8_t *target,
       const uint8_t *line, const uint8_t *prev,
       unsigned width, unsigned bpp)
 {
@@ -199,89 +230,109 @@ static unsigned filter_paeth(uint8_t *target,
       target[i] = line[i] - paeth(0, prev[i], 0);
    for (i = bpp; i < width; i++)
       target[i] = line[i] - paeth(line[i - bpp], prev[i], prev[i - bpp]);
+}
 
-   return count_sad(target, width);
+static void png_copy_line(uint8_t *dst, const uint8_t *src,
+      unsigned width, unsigned bpp)
+{
+   if (bpp == sizeof(uint32_t))
+      copy_argb_line(dst, (const uint32_t*)src, width);
+   else
+      copy_bgr24_line(dst, src, width);
 }
 
-bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
-      unsigned width, unsigned height, signed pitch, unsigned bpp)
+/* Filters the lines of a stripe, each one into its
+ * filter type byte followed by the filtered pixels. */
+static bool png_encode_lines(struct png_encode_stripe *stripe)
 {
    unsigned h;
-   struct png_ihdr ihdr = {0};
-   bool ret = true;
-   const struct trans_stream_backend *stream_backend = NULL;
-   size_t encode_buf_size  = 0;
-   uint8_t *encode_buf     = NULL;
-   uint8_t *deflate_buf    = NULL;
-   uint8_t *rgba_line      = NULL;
+   bool ret                = false;
+   unsigned width          = stripe->width;
+   unsigned bpp            = stripe->bpp;
+   size_t line_size        = width * bpp;
+   bool adaptive           = stripe->level >= PNG_ENCODE_ADAPTIVE_LEVEL;
+   const uint8_t *data     = stripe->data;
+   uint8_t *encode_target  = stripe->encoded;
+   uint8_t *rgba_line      = (uint8_t*)malloc(line_size);
+   uint8_t *prev_encoded   = (uint8_t*)calloc(1, line_size);
    uint8_t *up_filtered    = NULL;
    uint8_t *sub_filtered   = NULL;
    uint8_t *avg_filtered   = NULL;
    uint8_t *paeth_filtered = NULL;
-   uint8_t *prev_encoded   = NULL;
-   uint8_t *encode_target  = NULL;
-   void *stream            = NULL;
-   uint32_t total_in       = 0;
-   uint32_t total_out      = 0;
-   
-   if (!intf_s)
-      GOTO_END_ERROR();
 
-   stream_backend = trans_stream_get_zlib_deflate_backend();
+   if (!rgba_line || !prev_encoded)
+      goto end;
 
-   if (intfstream_write(intf_s, png_magic, sizeof(png_magic)) != sizeof(png_magic))
-      GOTO_END_ERROR();
+   if (adaptive)
+   {
+      up_filtered    = (uint8_t*)malloc(line_size);
+      sub_filtered   = (uint8_t*)malloc(line_size);
+      avg_filtered   = (uint8_t*)malloc(line_size);
+      paeth_filtered = (uint8_t*)malloc(line_size);
+      if (!up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
+         goto end;
+   }
 
-   ihdr.width = width;
-   ihdr.height = height;
-   ihdr.depth = 8;
-   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
-   if (!png_write_ihdr_string(intf_s, &ihdr))
-      GOTO_END_ERROR();
+   /* The first line is filtered against the
+    * last line of the previous stripe */
+   if (!stripe->first)
+      png_copy_line(prev_encoded, data - stripe->pitch, width, bpp);
 
-   encode_buf_size = (width * bpp + 1) * height;
-   encode_buf      = (uint8_t*)malloc(encode_buf_size);
-   if (!encode_buf)
-      GOTO_END_ERROR();
+   for (h = 0; h < stripe->height;
+         h++, encode_target += line_size, data += stripe->pitch)
+   {
+      uint8_t *tmp;
 
-   prev_encoded = (uint8_t*)calloc(1, width * bpp);
-   if (!prev_encoded)
-      GOTO_END_ERROR();
+      if (stripe->level == 0)
+      {
+         *encode_target++ = 0;
+         png_copy_line(encode_target, data, width, bpp);
+         continue;
+      }
 
-   rgba_line      = (uint8_t*)malloc(width * bpp);
-   up_filtered    = (uint8_t*)malloc(width * bpp);
-   sub_filtered   = (uint8_t*)malloc(width * bpp);
-   avg_filtered   = (uint8_t*)malloc(width * bpp);
-   paeth_filtered = (uint8_t*)malloc(width * bpp);
-   if (!rgba_line || !up_filtered || !sub_filtered || !avg_filtered || !paeth_filtered)
-      GOTO_END_ERROR();
+      png_copy_line(rgba_line, data, width, bpp);
 
-   encode_target = encode_buf;
-   for (h = 0; h < height;
-         h++, encode_target += width * bpp, data += pitch)
-   {
-      if (bpp == sizeof(uint32_t))
-         copy_argb_line(rgba_line, (const uint32_t*)data, width);
+      if (!adaptive)
+      {
+         /* Same filter for every line. 'Sub' on the
+          * first line of the image, since 'up' would
+          * leave it unfiltered. */
+         if (h == 0 && stripe->first)
+         {
+            *encode_target++ = 1;
+            filter_sub(encode_target, rgba_line, width, bpp);
+         }
+         else
+         {
+            *encode_target++ = 2;
+            filter_up(encode_target, rgba_line, prev_encoded, width, bpp);
+         }
+      }
       else
-         copy_bgr24_line(rgba_line, data, width);
-
-      /* Try every filtering method, and choose the method
-       * which has most entries as zero.
-       *
-       * This is probably not very optimal, but it's very
-       * simple to implement.
-       */
       {
-         unsigned none_score  = count_sad(rgba_line, width * bpp);
-         unsigned up_score    = filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned sub_score   = filter_sub(sub_filtered, rgba_line, width, bpp);
-         unsigned avg_score   = filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
-         unsigned paeth_score = filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
-
+         /* Try every filtering method, and choose the method
+          * which has most entries as zero.
+          *
+          * This is probably not very optimal, but it's very
+          * simple to implement.
+          */
+         unsigned none_score, up_score, sub_score, avg_score, paeth_score;
          uint8_t filter       = 0;
-         unsigned min_sad     = none_score;
+         unsigned min_sad     = 0;
          const uint8_t *chosen_filtered = rgba_line;
 
+         filter_up(up_filtered, rgba_line, prev_encoded, width, bpp);
+         filter_sub(sub_filtered, rgba_line, width, bpp);
+         filter_avg(avg_filtered, rgba_line, prev_encoded, width, bpp);
+         filter_paeth(paeth_filtered, rgba_line, prev_encoded, width, bpp);
+
+         none_score  = count_sad(rgba_line, line_size);
+         up_score    = count_sad(up_filtered, line_size);
+         sub_score   = count_sad(sub_filtered, line_size);
+         avg_score   = count_sad(avg_filtered, line_size);
+         paeth_score = count_sad(paeth_filtered, line_size);
+         min_sad     = none_score;
+
          if (sub_score < min_sad)
          {
             filter = 1;
@@ -310,13 +361,41 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
          }
 
          *encode_target++ = filter;
-         memcpy(encode_target, chosen_filtered, width * bpp);
-
-         memcpy(prev_encoded, rgba_line, width * bpp);
+         memcpy(encode_target, chosen_filtered, line_size);
       }
+
+      tmp          = prev_encoded;
+      prev_encoded = rgba_line;
+      rgba_line    = tmp;
    }
 
-   deflate_buf = (uint8_t*)malloc(encode_buf_size * 2); /* Just to be sure. */
+   ret = true;
+
+end:
+   free(rgba_line);
+   free(prev_encoded);
+   free(up_filtered);
+   free(sub_filtered);
+   free(avg_filtered);
+   free(paeth_filtered);
+   return ret;
+}
+
+/* Deflates the whole image as a single zlib stream */
+static bool png_write_idat_stream(intfstream_t *intf_s,
+      const uint8_t *encode_buf, size_t encode_buf_size, int level)
+{
+   bool ret                 = true;
+   uint8_t *deflate_buf     = NULL;
+   void *stream             = NULL;
+   /* Above the worst case of deflate, for incompressible data */
+   size_t deflate_size      = encode_buf_size + encode_buf_size / 8 + 64;
+   uint32_t total_in        = 0;
+   uint32_t total_out       = 0;
+   const struct trans_stream_backend *stream_backend =
+      trans_stream_get_zlib_deflate_backend();
+
+   deflate_buf = (uint8_t*)malloc(deflate_size + 8);
    if (!deflate_buf)
       GOTO_END_ERROR();
 
@@ -325,6 +404,7 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
    if (!stream)
       GOTO_END_ERROR();
 
+   stream_backend->define(stream, "level", (uint32_t)level);
    stream_backend->set_in(
          stream,
          encode_buf,
@@ -332,7 +412,7 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
    stream_backend->set_out(
          stream,
          deflate_buf + 8,
-         (unsigned)(encode_buf_size * 2));
+         (unsigned)deflate_size);
 
    if (!stream_backend->trans(stream, true, &total_in, &total_out, NULL))
       GOTO_END_ERROR();
@@ -342,31 +422,249 @@ bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
    if (!png_write_idat_string(intf_s, deflate_buf, ((size_t)total_out + 8)))
       GOTO_END_ERROR();
 
-   if (!png_write_iend_string(intf_s))
-      GOTO_END_ERROR();
 end:
-   free(encode_buf);
    free(deflate_buf);
-   free(rgba_line);
-   free(prev_encoded);
-   free(up_filtered);
-   free(sub_filtered);
-   free(avg_filtered);
-   free(paeth_filtered);
+   if (stream && stream_backend->stream_free)
+      stream_backend->stream_free(stream);
+   return ret;
+}
 
-   if (stream_backend)
+#ifdef PNG_ENCODE_STRIPES
+/* Same as adler32_combine(), which builtin zlib lacks */
+static uint32_t png_adler32_combine(uint32_t adler1, uint32_t adler2,
+      size_t len2)
+{
+   const uint32_t base = 65521;
+   uint32_t rem        = (uint32_t)(len2 % base);
+   uint32_t sum1       = adler1 & 0xffff;
+   uint32_t sum2       = (rem * sum1) % base;
+
+   sum1 += (adler2 & 0xffff) + base - 1;
+   sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + base - rem;
+   if (sum1 >= base)
+      sum1 -= base;
+   if (sum1 >= base)
+      sum1 -= base;
+   if (sum2 >= (base << 1))
+      sum2 -= (base << 1);
+   if (sum2 >= base)
+      sum2 -= base;
+   return sum1 | (sum2 << 16);
+}
+
+static void png_encode_stripe_work(void *data)
+{
+   z_stream z;
+   struct png_encode_stripe *stripe = (struct png_encode_stripe*)data;
+   size_t encoded_size              = (size_t)(stripe->width
+         * stripe->bpp + 1) * stripe->height;
+
+   if (!png_encode_lines(stripe))
+      return;
+
+   memset(&z, 0, sizeof(z));
+
+   /* Raw deflate, the stripes get joined into one zlib stream */
+   if (deflateInit2(&z, stripe->level, Z_DEFLATED, -MAX_WBITS, 8,
+            Z_DEFAULT_STRATEGY) != Z_OK)
+      return;
+
+   /* Room for the sync flush marker */
+   stripe->deflated_size = deflateBound(&z, (uLong)encoded_size) + 16;
+
+   if ((stripe->deflated = (uint8_t*)malloc(stripe->deflated_size)))
    {
-      if (stream)
+      int zret;
+
+      z.next_in  = stripe->encoded;
+      z.avail_in = (uInt)encoded_size;
+      z.next_out = stripe->deflated;
+      z.avail_out= (uInt)stripe->deflated_size;
+
+      /* All stripes but the last end with a non-final
+       * block, flushed to a byte boundary */
+      zret       = deflate(&z, stripe->last ? Z_FINISH : Z_SYNC_FLUSH);
+
+      if (     (zret == (stripe->last ? Z_STREAM_END : Z_OK))
+            && (z.avail_in  == 0)
+            && (z.avail_out != 0))
       {
-         if (stream_backend->stream_free)
-            stream_backend->stream_free(stream);
+         stripe->deflated_size = z.total_out;
+         stripe->adler         = (uint32_t)adler32(1L,
+               stripe->encoded, (uInt)encoded_size);
+         stripe->ok            = true;
       }
    }
+
+   deflateEnd(&z);
+}
+
+/* Filters and deflates the stripes in parallel, then
+ * joins them into a single zlib stream */
+static bool png_write_idat_stripes(intfstream_t *intf_s,
+      struct png_encode_stripe *stripes, unsigned num_stripes, int level)
+{
+   unsigned i;
+   uint8_t *deflate_buf = NULL;
+   uint8_t *out         = NULL;
+   bool ret             = true;
+   uint32_t adler       = 1;
+   /* Chunk header, zlib header and checksum */
+   size_t size          = 8 + 2 + 4;
+   tpool_t *pool        = tpool_create(num_stripes - 1);
+
+   if (!pool)
+      GOTO_END_ERROR();
+
+   for (i = 1; i < num_stripes; i++)
+      tpool_add_work(pool, png_encode_stripe_work, &stripes[i]);
+   png_encode_stripe_work(&stripes[0]);
+   tpool_wait(pool);
+   tpool_destroy(pool);
+
+   for (i = 0; i < num_stripes; i++)
+   {
+      if (!stripes[i].ok)
+         GOTO_END_ERROR();
+      size += stripes[i].deflated_size;
+   }
+
+   if (!(deflate_buf = (uint8_t*)malloc(size)))
+      GOTO_END_ERROR();
+
+   out    = deflate_buf + 8;
+   *out++ = 0x78;
+   if (level <= 1)
+      *out++ = 0x01;
+   else if (level < 6)
+      *out++ = 0x5e;
+   else if (level == 6)
+      *out++ = 0x9c;
+   else
+      *out++ = 0xda;
+
+   for (i = 0; i < num_stripes; i++)
+   {
+      memcpy(out, stripes[i].deflated, stripes[i].deflated_size);
+      out   += stripes[i].deflated_size;
+      adler  = png_adler32_combine(adler, stripes[i].adler,
+            (size_t)(stripes[i].width * stripes[i].bpp + 1)
+            * stripes[i].height);
+   }
+   dword_write_be(out, adler);
+
+   memcpy(deflate_buf + 4, "IDAT", 4);
+   dword_write_be(deflate_buf + 0, (uint32_t)(size - 8));
+   if (!png_write_idat_string(intf_s, deflate_buf, size))
+      GOTO_END_ERROR();
+
+end:
+   free(deflate_buf);
    return ret;
 }
+#endif
 
-bool rpng_save_image_argb(const char *path, const uint32_t *data,
-      unsigned width, unsigned height, unsigned pitch)
+static bool png_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
+      unsigned width, unsigned height, signed pitch, unsigned bpp,
+      int level, unsigned threads)
+{
+   unsigned i;
+   struct png_ihdr ihdr = {0};
+   bool ret                 = true;
+   size_t encode_buf_size   = 0;
+   size_t line_size         = 0;
+   uint8_t *encode_buf      = NULL;
+   unsigned num_stripes     = 1;
+   struct png_encode_stripe *stripes = NULL;
+
+   if (!intf_s)
+      GOTO_END_ERROR();
+
+   if (level < RPNG_COMPRESSION_NONE)
+      level = RPNG_COMPRESSION_NONE;
+   else if (level > RPNG_COMPRESSION_BEST)
+      level = RPNG_COMPRESSION_BEST;
+
+   if (intfstream_write(intf_s, png_magic, sizeof(png_magic)) != sizeof(png_magic))
+      GOTO_END_ERROR();
+
+   ihdr.width = width;
+   ihdr.height = height;
+   ihdr.depth = 8;
+   ihdr.color_type = bpp == sizeof(uint32_t) ? 6 : 2; /* RGBA or RGB */
+   if (!png_write_ihdr_string(intf_s, &ihdr))
+      GOTO_END_ERROR();
+
+   line_size       = width * bpp + 1;
+   encode_buf_size = line_size * height;
+   encode_buf      = (uint8_t*)malloc(encode_buf_size);
+   if (!encode_buf)
+      GOTO_END_ERROR();
+
+#ifdef PNG_ENCODE_STRIPES
+   num_stripes = height / PNG_ENCODE_STRIPE_LINES;
+   if (num_stripes > threads)
+      num_stripes = threads;
+   if (num_stripes < 1)
+      num_stripes = 1;
+#endif
+
+   stripes = (struct png_encode_stripe*)calloc(num_stripes, sizeof(*stripes));
+   if (!stripes)
+      GOTO_END_ERROR();
+
+   for (i = 0; i < num_stripes; i++)
+   {
+      unsigned first_line    = (unsigned)((uint64_t)height * i / num_stripes);
+      unsigned end_line      = (unsigned)((uint64_t)height * (i + 1) / num_stripes);
+
+      stripes[i].data        = data + (ptrdiff_t)first_line * pitch;
+      stripes[i].encoded     = encode_buf + first_line * line_size;
+      stripes[i].pitch       = pitch;
+      stripes[i].width       = width;
+      stripes[i].height      = end_line - first_line;
+      stripes[i].bpp         = bpp;
+      stripes[i].level       = level;
+      stripes[i].first       = i == 0;
+      stripes[i].last        = i == num_stripes - 1;
+   }
+
+   if (num_stripes == 1)
+   {
+      if (!png_encode_lines(&stripes[0]))
+         GOTO_END_ERROR();
+
+      if (!png_write_idat_stream(intf_s, encode_buf, encode_buf_size, level))
+         GOTO_END_ERROR();
+   }
+#ifdef PNG_ENCODE_STRIPES
+   else if (!png_write_idat_stripes(intf_s, stripes, num_stripes, level))
+      GOTO_END_ERROR();
+#endif
+
+   if (!png_write_iend_string(intf_s))
+      GOTO_END_ERROR();
+end:
+   if (stripes)
+   {
+      for (i = 0; i < num_stripes; i++)
+         free(stripes[i].deflated);
+      free(stripes);
+   }
+   free(encode_buf);
+   return ret;
+}
+
+bool rpng_save_image_stream(const uint8_t *data, intfstream_t* intf_s,
+      unsigned width, unsigned height, signed pitch, unsigned bpp)
+{
+   return png_save_image_stream(data, intf_s, width, height, pitch, bpp,
+         RPNG_COMPRESSION_BEST, 1);
+}
+
+static bool png_save_image_file(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, unsigned bpp,
+      int level, unsigned threads)
 {
    bool ret                      = false;
    intfstream_t* intf_s          = NULL;
@@ -375,33 +673,47 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
 
-   ret = rpng_save_image_stream((const uint8_t*) data, intf_s,
-                                width, height,
-                                (signed) pitch, sizeof(uint32_t));
+   ret = png_save_image_stream(data, intf_s, width, height,
+         pitch, bpp, level, threads);
    intfstream_close(intf_s);
    free(intf_s);
    return ret;
 }
 
+bool rpng_save_image_argb(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch)
+{
+   return png_save_image_file(path, (const uint8_t*)data,
+         width, height, (signed)pitch, sizeof(uint32_t),
+         RPNG_COMPRESSION_BEST, 1);
+}
+
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch)
 {
-   bool ret                      = false;
-   intfstream_t* intf_s          = NULL;
-   
-   intf_s = intfstream_open_file(path, 
-         RETRO_VFS_FILE_ACCESS_WRITE,
-         RETRO_VFS_FILE_ACCESS_HINT_NONE);
-   ret = rpng_save_image_stream(data, intf_s, width, height, 
-                                (signed) pitch, 3);
-   intfstream_close(intf_s);
-   free(intf_s);
-   return ret;
+   return png_save_image_file(path, data, width, height,
+         (signed)pitch, 3, RPNG_COMPRESSION_BEST, 1);
 }
 
+bool rpng_save_image_argb_ext(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      int level, unsigned threads)
+{
+   return png_save_image_file(path, (const uint8_t*)data,
+         width, height, (signed)pitch, sizeof(uint32_t), level, threads);
+}
 
-uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
-      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+bool rpng_save_image_bgr24_ext(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      int level, unsigned threads)
+{
+   return png_save_image_file(path, data, width, height,
+         (signed)pitch, 3, level, threads);
+}
+
+static uint8_t* rpng_save_image_string(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, unsigned bpp,
+      uint64_t* bytes, int level, unsigned threads)
 {
    bool ret                    = false;
    uint8_t* buf                = NULL;
@@ -409,7 +721,7 @@ uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
    int buf_length              = 0;
    intfstream_t* intf_s        = NULL;
 
-   buf_length = (int)(width*height*3*DEFLATE_PADDING)+PNG_ROUGH_HEADER;
+   buf_length = (int)((width*bpp+1)*height*DEFLATE_PADDING)+PNG_ROUGH_HEADER;
    buf        = (uint8_t*)malloc(buf_length*sizeof(uint8_t));
    if (!buf)
       GOTO_END_ERROR(); 
@@ -419,8 +731,8 @@ uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
          RETRO_VFS_FILE_ACCESS_HINT_NONE,
          buf_length);
 
-   ret = rpng_save_image_stream((const uint8_t*)data, 
-            intf_s, width, height, pitch, 3);
+   ret = png_save_image_stream((const uint8_t*)data, 
+            intf_s, width, height, pitch, bpp, level, threads);
 
    *bytes = intfstream_get_ptr(intf_s);
    intfstream_rewind(intf_s);
@@ -446,3 +758,33 @@ end:
    return output;
 }
 
+uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+{
+   return rpng_save_image_string(data, width, height, pitch, 3, bytes,
+         RPNG_COMPRESSION_BEST, 1);
+}
+
+uint8_t* rpng_save_image_argb_string(const uint32_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes)
+{
+   return rpng_save_image_string((const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), bytes,
+         RPNG_COMPRESSION_BEST, 1);
+}
+
+uint8_t* rpng_save_image_bgr24_string_ext(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes,
+      int level, unsigned threads)
+{
+   return rpng_save_image_string(data, width, height, pitch, 3, bytes,
+         level, threads);
+}
+
+uint8_t* rpng_save_image_argb_string_ext(const uint32_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t* bytes,
+      int level, unsigned threads)
+{
+   return rpng_save_image_string((const uint8_t*)data,
+         width, height, pitch, sizeof(uint32_t), bytes, level, threads);
+}
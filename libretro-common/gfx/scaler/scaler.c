@@ -29,6 +29,240 @@
 #include <gfx/scaler/scaler_int.h>
 #include <gfx/scaler/filter.h>
 #include <gfx/scaler/pixconv.h>
+#include <features/features_cpu.h>
+
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#endif
+
+/* Frames with fewer output pixels than this are scaled
+ * on the calling thread only; waking up the workers
+ * would cost more than it saves. */
+#define SCALER_THREAD_MIN_PIXELS (160 * 120)
+
+/* A frame is scaled in two phases, each split into
+ * bands of rows. The vertical pass reads rows of the
+ * horizontal pass from every band, so all bands of
+ * the first phase have to be done before the second
+ * one starts. */
+enum scaler_phase
+{
+   /* Input pixel conversion and horizontal pass,
+    * over input rows. */
+   SCALER_PHASE_INPUT = 0,
+   /* Vertical pass (or special path) and output
+    * pixel conversion, over output rows. */
+   SCALER_PHASE_OUTPUT
+};
+
+struct scaler_job
+{
+   const void *input;
+   const void *input_frame;
+   void *output;
+   void *output_frame;
+   int input_stride;
+   int output_stride;
+};
+
+static void scaler_ctx_scale_band(const struct scaler_ctx *ctx,
+      const struct scaler_job *job, enum scaler_phase phase,
+      unsigned index, unsigned count)
+{
+   int first, last;
+
+   if (phase == SCALER_PHASE_INPUT)
+   {
+      first = (int)(((int64_t)ctx->in_height * index) / count);
+      last  = (int)(((int64_t)ctx->in_height * (index + 1)) / count);
+
+      if (first >= last)
+         return;
+
+      if (ctx->in_fmt != SCALER_FMT_ARGB8888)
+         ctx->in_pixconv(
+               (uint8_t*)ctx->input.frame + first * ctx->input.stride,
+               (const uint8_t*)job->input + first * ctx->in_stride,
+               ctx->in_width, last - first,
+               ctx->input.stride, ctx->in_stride);
+
+      /* The special path reads the converted input directly. */
+      if (!ctx->scaler_special && ctx->scaler_horiz)
+         ctx->scaler_horiz(ctx, job->input_frame, job->input_stride,
+               first, last);
+   }
+   else
+   {
+      first = (int)(((int64_t)ctx->out_height * index) / count);
+      last  = (int)(((int64_t)ctx->out_height * (index + 1)) / count);
+
+      if (first >= last)
+         return;
+
+      /* Take some special, and (hopefully) more optimized path. */
+      if (ctx->scaler_special)
+         ctx->scaler_special(ctx, job->output_frame, job->input_frame,
+               ctx->out_width, ctx->out_height,
+               ctx->in_width, ctx->in_height,
+               job->output_stride, job->input_stride,
+               first, last);
+      else if (ctx->scaler_vert)
+         ctx->scaler_vert(ctx, job->output_frame, job->output_stride,
+               first, last);
+
+      if (ctx->out_fmt != SCALER_FMT_ARGB8888)
+         ctx->out_pixconv(
+               (uint8_t*)job->output + first * ctx->out_stride,
+               (const uint8_t*)ctx->output.frame + first * ctx->output.stride,
+               ctx->out_width, last - first,
+               ctx->out_stride, ctx->output.stride);
+   }
+}
+
+#ifdef HAVE_THREADS
+struct scaler_thread_data
+{
+   sthread_t *thread;
+   slock_t *lock;
+   scond_t *cond;
+   struct scaler_thread_pool *pool;
+   unsigned index;
+   bool done;
+   bool die;
+};
+
+struct scaler_thread_pool
+{
+   struct scaler_thread_data *workers;
+   const struct scaler_ctx *ctx;
+   struct scaler_job job;
+   enum scaler_phase phase;
+   unsigned count;
+};
+
+static void scaler_thread_loop(void *data)
+{
+   struct scaler_thread_data *thr = (struct scaler_thread_data*)data;
+
+   for (;;)
+   {
+      bool die;
+      struct scaler_thread_pool *pool = thr->pool;
+
+      slock_lock(thr->lock);
+      while (thr->done && !thr->die)
+         scond_wait(thr->cond, thr->lock);
+      die = thr->die;
+      slock_unlock(thr->lock);
+
+      if (die)
+         break;
+
+      /* Band 0 belongs to the calling thread. */
+      scaler_ctx_scale_band(pool->ctx, &pool->job, pool->phase,
+            thr->index + 1, pool->count + 1);
+
+      slock_lock(thr->lock);
+      thr->done = true;
+      scond_signal(thr->cond);
+      slock_unlock(thr->lock);
+   }
+}
+
+static void scaler_thread_pool_free(struct scaler_thread_pool *pool)
+{
+   unsigned i;
+
+   if (!pool)
+      return;
+
+   for (i = 0; i < pool->count; i++)
+   {
+      struct scaler_thread_data *thr = &pool->workers[i];
+
+      if (thr->thread)
+      {
+         slock_lock(thr->lock);
+         thr->die = true;
+         scond_signal(thr->cond);
+         slock_unlock(thr->lock);
+         sthread_join(thr->thread);
+      }
+      if (thr->lock)
+         slock_free(thr->lock);
+      if (thr->cond)
+         scond_free(thr->cond);
+   }
+
+   free(pool->workers);
+   free(pool);
+}
+
+static struct scaler_thread_pool *scaler_thread_pool_new(unsigned count)
+{
+   unsigned i;
+   struct scaler_thread_pool *pool = (struct scaler_thread_pool*)
+      calloc(1, sizeof(*pool));
+
+   if (!pool)
+      return NULL;
+
+   if (!(pool->workers = (struct scaler_thread_data*)
+            calloc(count, sizeof(*pool->workers))))
+   {
+      free(pool);
+      return NULL;
+   }
+
+   pool->count = count;
+
+   for (i = 0; i < count; i++)
+   {
+      struct scaler_thread_data *thr = &pool->workers[i];
+
+      thr->pool  = pool;
+      thr->index = i;
+      thr->done  = true;
+
+      if (     !(thr->lock   = slock_new())
+            || !(thr->cond   = scond_new())
+            || !(thr->thread = sthread_create(scaler_thread_loop, thr)))
+      {
+         scaler_thread_pool_free(pool);
+         return NULL;
+      }
+   }
+
+   return pool;
+}
+
+static void scaler_thread_pool_run(struct scaler_thread_pool *pool,
+      const struct scaler_ctx *ctx, enum scaler_phase phase)
+{
+   unsigned i;
+
+   pool->ctx   = ctx;
+   pool->phase = phase;
+
+   for (i = 0; i < pool->count; i++)
+   {
+      slock_lock(pool->workers[i].lock);
+      pool->workers[i].done = false;
+      scond_signal(pool->workers[i].cond);
+      slock_unlock(pool->workers[i].lock);
+   }
+
+   scaler_ctx_scale_band(ctx, &pool->job, phase, 0, pool->count + 1);
+
+   for (i = 0; i < pool->count; i++)
+   {
+      slock_lock(pool->workers[i].lock);
+      while (!pool->workers[i].done)
+         scond_wait(pool->workers[i].cond, pool->workers[i].lock);
+      slock_unlock(pool->workers[i].lock);
+   }
+}
+#endif
 
 static bool allocate_frames(struct scaler_ctx *ctx)
 {
@@ -204,9 +438,27 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
    }
    else
    {
+      uint64_t cpu      = cpu_features_get();
+
       ctx->scaler_horiz = scaler_argb8888_horiz;
       ctx->scaler_vert  = scaler_argb8888_vert;
 
+#if defined(__AVX2__) && !defined(SCALER_NO_SIMD)
+      if (cpu & RETRO_SIMD_AVX2)
+      {
+         ctx->scaler_horiz = scaler_argb8888_horiz_avx2;
+         ctx->scaler_vert  = scaler_argb8888_vert_avx2;
+      }
+#elif (defined(__ARM_NEON__) || defined(HAVE_NEON)) && !defined(SCALER_NO_SIMD)
+      if (cpu & RETRO_SIMD_NEON)
+      {
+         ctx->scaler_horiz = scaler_argb8888_horiz_neon;
+         ctx->scaler_vert  = scaler_argb8888_vert_neon;
+      }
+#else
+      (void)cpu;
+#endif
+
       switch (ctx->in_fmt)
       {
          case SCALER_FMT_ARGB8888:
@@ -261,6 +513,13 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
       if (!scaler_gen_filter(ctx))
          return false;
+
+#ifdef HAVE_THREADS
+      /* Not fatal; scale on the calling thread only
+       * if the workers can't be created. */
+      if (ctx->threads > 1)
+         ctx->pool = scaler_thread_pool_new(ctx->threads - 1);
+#endif
    }
 
    return true;
@@ -268,6 +527,11 @@ bool scaler_ctx_gen_filter(struct scaler_ctx *ctx)
 
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 {
+#ifdef HAVE_THREADS
+   scaler_thread_pool_free(ctx->pool);
+#endif
+   ctx->pool                = NULL;
+
    if (ctx->horiz.filter)
       free(ctx->horiz.filter);
    if (ctx->horiz.filter_pos)
@@ -316,44 +580,38 @@ void scaler_ctx_gen_reset(struct scaler_ctx *ctx)
 void scaler_ctx_scale(struct scaler_ctx *ctx,
       void *output, const void *input)
 {
-   const void *input_frame = input;
-   void *output_frame      = output;
-   int input_stride        = ctx->in_stride;
-   int output_stride       = ctx->out_stride;
+   struct scaler_job job;
+
+   job.input         = input;
+   job.input_frame   = input;
+   job.input_stride  = ctx->in_stride;
+   job.output        = output;
+   job.output_frame  = output;
+   job.output_stride = ctx->out_stride;
 
    if (ctx->in_fmt != SCALER_FMT_ARGB8888)
    {
-      ctx->in_pixconv(ctx->input.frame, input,
-            ctx->in_width, ctx->in_height,
-            ctx->input.stride, ctx->in_stride);
-
-      input_frame       = ctx->input.frame;
-      input_stride      = ctx->input.stride;
+      job.input_frame   = ctx->input.frame;
+      job.input_stride  = ctx->input.stride;
    }
 
    if (ctx->out_fmt != SCALER_FMT_ARGB8888)
    {
-      output_frame  = ctx->output.frame;
-      output_stride = ctx->output.stride;
+      job.output_frame  = ctx->output.frame;
+      job.output_stride = ctx->output.stride;
    }
 
-   /* Take some special, and (hopefully) more optimized path. */
-   if (ctx->scaler_special)
-      ctx->scaler_special(ctx, output_frame, input_frame,
-            ctx->out_width, ctx->out_height,
-            ctx->in_width, ctx->in_height,
-            output_stride, input_stride);
-   else
+#ifdef HAVE_THREADS
+   if (     ctx->pool
+         && ctx->out_width * ctx->out_height >= SCALER_THREAD_MIN_PIXELS)
    {
-      /* Take generic filter path. */
-      if (ctx->scaler_horiz)
-         ctx->scaler_horiz(ctx, input_frame, input_stride);
-      if (ctx->scaler_vert)
-         ctx->scaler_vert (ctx, output, output_stride);
+      ctx->pool->job = job;
+      scaler_thread_pool_run(ctx->pool, ctx, SCALER_PHASE_INPUT);
+      scaler_thread_pool_run(ctx->pool, ctx, SCALER_PHASE_OUTPUT);
+      return;
    }
+#endif
 
-   if (ctx->out_fmt != SCALER_FMT_ARGB8888)
-      ctx->out_pixconv(output, ctx->output.frame,
-            ctx->out_width, ctx->out_height,
-            ctx->out_stride, ctx->output.stride);
+   scaler_ctx_scale_band(ctx, &job, SCALER_PHASE_INPUT,  0, 1);
+   scaler_ctx_scale_band(ctx, &job, SCALER_PHASE_OUTPUT, 0, 1);
 }
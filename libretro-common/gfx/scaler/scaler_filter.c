@@ -177,7 +177,10 @@ bool scaler_gen_filter(struct scaler_ctx *ctx)
          ctx->vert.filter_stride  = 2;
          break;
       case SCALER_TYPE_SINC:
-         sinc_size                = 8 * ((ctx->in_width > ctx->out_width)
+      case SCALER_TYPE_LANCZOS:
+         /* Two taps per lobe */
+         sinc_size                = ((ctx->scaler_type == SCALER_TYPE_SINC) ? 8 : 6)
+            * ((ctx->in_width > ctx->out_width)
                ? next_pow2(ctx->in_width / ctx->out_width) : 1);
          ctx->horiz.filter_len    = sinc_size;
          ctx->horiz.filter_stride = sinc_size;
@@ -222,6 +225,7 @@ bool scaler_gen_filter(struct scaler_ctx *ctx)
          break;
 
       case SCALER_TYPE_SINC:
+      case SCALER_TYPE_LANCZOS:
          /* Need to expand the filter when downsampling
           * to get a proper low-pass effect. */
 
@@ -26,6 +26,9 @@
 
 #ifdef SCALER_NO_SIMD
 #undef __SSE2__
+#undef __AVX2__
+#undef __ARM_NEON__
+#undef HAVE_NEON
 #endif
 
 #if defined(__SSE2__)
@@ -35,6 +38,14 @@
 #endif
 #endif
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+#include <arm_neon.h>
+#endif
+
 /* ARGB8888 scaler is split in two:
  *
  * First, horizontal scaler is applied.
@@ -59,99 +70,164 @@
  * into 8-bit values.
  *
  * The C version of scalers perform the exact same operations as the
- * SIMD code for testing purposes.
+ * SIMD code for testing purposes. The SIMD versions work on
+ * several pixels of a row at once in the vertical pass, and on
+ * several taps at once in the horizontal pass; both give the
+ * same results as the C version unless a sum saturates.
  */
 
-void scaler_argb8888_vert(const struct scaler_ctx *ctx, void *output_, int stride)
+static INLINE uint32_t scaler_argb8888_vert_pixel_c(
+      const struct scaler_ctx *ctx,
+      const uint64_t *input_base_y, const int16_t *filter_vert)
 {
-   int h, w, y;
-   const uint64_t      *input = ctx->scaled.frame;
-   uint32_t           *output = (uint32_t*)output_;
+   int y;
+   int16_t res_a = 0;
+   int16_t res_r = 0;
+   int16_t res_g = 0;
+   int16_t res_b = 0;
+
+   for (y = 0; y < ctx->vert.filter_len; y++,
+         input_base_y += (ctx->scaled.stride >> 3))
+   {
+      uint64_t col   = *input_base_y;
+
+      int16_t a      = (col >> 48) & 0xffff;
+      int16_t r      = (col >> 32) & 0xffff;
+      int16_t g      = (col >> 16) & 0xffff;
+      int16_t b      = (col >>  0) & 0xffff;
+
+      int16_t coeff  = filter_vert[y];
+
+      res_a         += (a * coeff) >> 16;
+      res_r         += (r * coeff) >> 16;
+      res_g         += (g * coeff) >> 16;
+      res_b         += (b * coeff) >> 16;
+   }
+
+   res_a           >>= (7 - 2 - 2);
+   res_r           >>= (7 - 2 - 2);
+   res_g           >>= (7 - 2 - 2);
+   res_b           >>= (7 - 2 - 2);
 
-   const int16_t *filter_vert = ctx->vert.filter;
+   return
+      (clamp_8bit(res_a) << 24) |
+      (clamp_8bit(res_r) << 16) |
+      (clamp_8bit(res_g) << 8)  |
+      (clamp_8bit(res_b) << 0);
+}
+
+static INLINE uint64_t scaler_argb8888_horiz_pixel_c(
+      const struct scaler_ctx *ctx,
+      const uint32_t *input_base_x, const int16_t *filter_horiz)
+{
+   int x;
+   int16_t res_a = 0;
+   int16_t res_r = 0;
+   int16_t res_g = 0;
+   int16_t res_b = 0;
+
+   for (x = 0; x < ctx->horiz.filter_len; x++)
+   {
+      uint32_t col   = input_base_x[x];
+
+      int16_t a      = (col >> (24 - 7)) & (0xff << 7);
+      int16_t r      = (col >> (16 - 7)) & (0xff << 7);
+      int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
+      int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
+
+      int16_t coeff  = filter_horiz[x];
+
+      res_a         += (a * coeff) >> 16;
+      res_r         += (r * coeff) >> 16;
+      res_g         += (g * coeff) >> 16;
+      res_b         += (b * coeff) >> 16;
+   }
+
+   return
+      ((uint64_t)(uint16_t)res_a << 48) |
+      ((uint64_t)(uint16_t)res_r << 32) |
+      ((uint64_t)(uint16_t)res_g << 16) |
+      ((uint64_t)(uint16_t)res_b << 0);
+}
 
-   for (h = 0; h < ctx->out_height; h++,
+void scaler_argb8888_vert(const struct scaler_ctx *ctx,
+      void *output_, int stride, int first, int last)
+{
+   int h, w;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_ + first * (stride >> 2);
+   const int16_t *filter_vert = ctx->vert.filter
+      + first * ctx->vert.filter_stride;
+
+   for (h = first; h < last; h++,
          filter_vert += ctx->vert.filter_stride, output += stride >> 2)
    {
       const uint64_t *input_base = input + ctx->vert.filter_pos[h]
          * (ctx->scaled.stride >> 3);
 
-      for (w = 0; w < ctx->out_width; w++)
+      w = 0;
+#if defined(__SSE2__)
+      /* Four pixels at a time, two per register. */
+      for (; w + 4 <= ctx->out_width; w += 4)
       {
+         int y;
          const uint64_t *input_base_y = input_base + w;
-#if defined(__SSE2__)
-         __m128i final;
-         __m128i res = _mm_setzero_si128();
-
-         for (y = 0; (y + 1) < ctx->vert.filter_len; y += 2,
-               input_base_y += (ctx->scaled.stride >> 2))
-         {
-            __m128i coeff = _mm_set_epi64x(filter_vert[y + 1] * 0x0001000100010001ll, filter_vert[y + 0] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(input_base_y[ctx->scaled.stride >> 3], input_base_y[0]);
+         __m128i res0                 = _mm_setzero_si128();
+         __m128i res1                 = _mm_setzero_si128();
 
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
-         }
-
-         for (; y < ctx->vert.filter_len; y++, input_base_y += (ctx->scaled.stride >> 3))
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
          {
-            __m128i coeff = _mm_set_epi64x(0, filter_vert[y] * 0x0001000100010001ll);
-            __m128i col   = _mm_set_epi64x(0, input_base_y[0]);
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col0  = _mm_loadu_si128((const __m128i*)input_base_y);
+            __m128i col1  = _mm_loadu_si128((const __m128i*)(input_base_y + 2));
 
-            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+            res0          = _mm_adds_epi16(_mm_mulhi_epi16(col0, coeff), res0);
+            res1          = _mm_adds_epi16(_mm_mulhi_epi16(col1, coeff), res1);
          }
 
-         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
-         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         res0 = _mm_srai_epi16(res0, (7 - 2 - 2));
+         res1 = _mm_srai_epi16(res1, (7 - 2 - 2));
 
-         final     = _mm_packus_epi16(res, res);
+         _mm_storeu_si128((__m128i*)(output + w),
+               _mm_packus_epi16(res0, res1));
+      }
 
-         output[w] = _mm_cvtsi128_si32(final);
-#else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
+      for (; w < ctx->out_width; w++)
+      {
+         int y;
+         const uint64_t *input_base_y = input_base + w;
+         __m128i res                  = _mm_setzero_si128();
 
          for (y = 0; y < ctx->vert.filter_len; y++,
                input_base_y += (ctx->scaled.stride >> 3))
          {
-            uint64_t col   = *input_base_y;
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col   = _mm_loadl_epi64((const __m128i*)input_base_y);
 
-            int16_t a      = (col >> 48) & 0xffff;
-            int16_t r      = (col >> 32) & 0xffff;
-            int16_t g      = (col >> 16) & 0xffff;
-            int16_t b      = (col >>  0) & 0xffff;
-
-            int16_t coeff  = filter_vert[y];
-
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
          }
 
-         res_a           >>= (7 - 2 - 2);
-         res_r           >>= (7 - 2 - 2);
-         res_g           >>= (7 - 2 - 2);
-         res_b           >>= (7 - 2 - 2);
-
-         output[w]         =
-            (clamp_8bit(res_a) << 24) |
-            (clamp_8bit(res_r) << 16) |
-            (clamp_8bit(res_g) << 8)  |
-            (clamp_8bit(res_b) << 0);
-#endif
+         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         output[w] = _mm_cvtsi128_si32(_mm_packus_epi16(res, res));
       }
+#else
+      for (; w < ctx->out_width; w++)
+         output[w] = scaler_argb8888_vert_pixel_c(ctx,
+               input_base + w, filter_vert);
+#endif
    }
 }
 
-void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int stride)
+void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int first, int last)
 {
    int h, w, x;
-   const uint32_t *input = (uint32_t*)input_;
-   uint64_t *output      = ctx->scaled.frame;
+   const uint32_t *input = (const uint32_t*)input_ + first * (stride >> 2);
+   uint64_t *output      = ctx->scaled.frame
+      + first * (ctx->scaled.stride >> 3);
 
-   for (h = 0; h < ctx->scaled.height; h++, input += stride >> 2,
+   for (h = first; h < last; h++, input += stride >> 2,
          output += ctx->scaled.stride >> 3)
    {
       const int16_t *filter_horiz = ctx->horiz.filter;
@@ -173,8 +249,8 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
          {
             __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
 
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi64x(0,
-                     ((uint64_t)input_base_x[x + 1] << 32) | input_base_x[x + 0]), _mm_setzero_si128());
+            __m128i col   = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                     (const __m128i*)(input_base_x + x)), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -183,7 +259,7 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
          for (; x < ctx->horiz.filter_len; x++)
          {
             __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
-            __m128i col   = _mm_unpacklo_epi8(_mm_set_epi32(0, 0, 0, input_base_x[x]), _mm_setzero_si128());
+            __m128i col   = _mm_unpacklo_epi8(_mm_cvtsi32_si128(input_base_x[x]), _mm_setzero_si128());
 
             col           = _mm_slli_epi16(col, 7);
             res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
@@ -199,43 +275,258 @@ void scaler_argb8888_horiz(const struct scaler_ctx *ctx, const void *input_, int
          u.u32[1] = _mm_cvtsi128_si32(_mm_srli_si128(res, 4));
 #endif
 #else
-         int16_t res_a = 0;
-         int16_t res_r = 0;
-         int16_t res_g = 0;
-         int16_t res_b = 0;
+         output[w] = scaler_argb8888_horiz_pixel_c(ctx,
+               input_base_x, filter_horiz);
+#endif
+      }
+   }
+}
+
+#if defined(__AVX2__)
+void scaler_argb8888_vert_avx2(const struct scaler_ctx *ctx,
+      void *output_, int stride, int first, int last)
+{
+   int h, w;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_ + first * (stride >> 2);
+   const int16_t *filter_vert = ctx->vert.filter
+      + first * ctx->vert.filter_stride;
+
+   for (h = first; h < last; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * (ctx->scaled.stride >> 3);
+
+      /* Eight pixels at a time, four per register. */
+      for (w = 0; w + 8 <= ctx->out_width; w += 8)
+      {
+         int y;
+         __m256i packed;
+         const uint64_t *input_base_y = input_base + w;
+         __m256i res0                 = _mm256_setzero_si256();
+         __m256i res1                 = _mm256_setzero_si256();
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
+         {
+            __m256i coeff = _mm256_set1_epi16(filter_vert[y]);
+            __m256i col0  = _mm256_loadu_si256((const __m256i*)input_base_y);
+            __m256i col1  = _mm256_loadu_si256((const __m256i*)(input_base_y + 4));
+
+            res0          = _mm256_adds_epi16(_mm256_mulhi_epi16(col0, coeff), res0);
+            res1          = _mm256_adds_epi16(_mm256_mulhi_epi16(col1, coeff), res1);
+         }
+
+         res0   = _mm256_srai_epi16(res0, (7 - 2 - 2));
+         res1   = _mm256_srai_epi16(res1, (7 - 2 - 2));
+
+         /* Packing works within 128-bit lanes:
+          * { 0 1 4 5 | 2 3 6 7 } -> { 0 1 2 3 | 4 5 6 7 } */
+         packed = _mm256_permute4x64_epi64(
+               _mm256_packus_epi16(res0, res1), _MM_SHUFFLE(3, 1, 2, 0));
+
+         _mm256_storeu_si256((__m256i*)(output + w), packed);
+      }
+
+      for (; w < ctx->out_width; w++)
+      {
+         int y;
+         const uint64_t *input_base_y = input_base + w;
+         __m128i res                  = _mm_setzero_si128();
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
+         {
+            __m128i coeff = _mm_set1_epi16(filter_vert[y]);
+            __m128i col   = _mm_loadl_epi64((const __m128i*)input_base_y);
+
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         res       = _mm_srai_epi16(res, (7 - 2 - 2));
+         output[w] = _mm_cvtsi128_si32(_mm_packus_epi16(res, res));
+      }
+   }
+}
+
+void scaler_argb8888_horiz_avx2(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int first, int last)
+{
+   int h, w;
+   const uint32_t *input = (const uint32_t*)input_ + first * (stride >> 2);
+   uint64_t *output      = ctx->scaled.frame
+      + first * (ctx->scaled.stride >> 3);
+
+   for (h = first; h < last; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
 
-         for (x = 0; x < ctx->horiz.filter_len; x++)
+      for (w = 0; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+      {
+         int x;
+         __m128i res;
+         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         __m256i res4                 = _mm256_setzero_si256();
+
+         /* Four taps at a time: one pixel per 64-bit lane,
+          * each lane with its own coefficient. */
+         for (x = 0; (x + 3) < ctx->horiz.filter_len; x += 4)
          {
-            uint32_t col   = input_base_x[x];
+            __m128i c     = _mm_loadl_epi64((const __m128i*)(filter_horiz + x));
+            __m128i c2    = _mm_unpacklo_epi16(c, c);
+            __m256i coeff = _mm256_inserti128_si256(_mm256_castsi128_si256(
+                     _mm_unpacklo_epi32(c2, c2)), _mm_unpackhi_epi32(c2, c2), 1);
+            __m256i col   = _mm256_slli_epi16(_mm256_cvtepu8_epi16(
+                     _mm_loadu_si128((const __m128i*)(input_base_x + x))), 7);
+
+            res4          = _mm256_adds_epi16(_mm256_mulhi_epi16(col, coeff), res4);
+         }
 
-            int16_t a      = (col >> (24 - 7)) & (0xff << 7);
-            int16_t r      = (col >> (16 - 7)) & (0xff << 7);
-            int16_t g      = (col >> ( 8 - 7)) & (0xff << 7);
-            int16_t b      = (col << ( 0 + 7)) & (0xff << 7);
+         res = _mm_adds_epi16(_mm256_castsi256_si128(res4),
+               _mm256_extracti128_si256(res4, 1));
 
-            int16_t coeff  = filter_horiz[x];
+         for (; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            __m128i coeff = _mm_set_epi64x(filter_horiz[x + 1] * 0x0001000100010001ll, filter_horiz[x + 0] * 0x0001000100010001ll);
+            __m128i col   = _mm_unpacklo_epi8(_mm_loadl_epi64(
+                     (const __m128i*)(input_base_x + x)), _mm_setzero_si128());
 
-            res_a         += (a * coeff) >> 16;
-            res_r         += (r * coeff) >> 16;
-            res_g         += (g * coeff) >> 16;
-            res_b         += (b * coeff) >> 16;
+            col           = _mm_slli_epi16(col, 7);
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
          }
 
-         output[w]         = (
-               (uint64_t)res_a  << 48)  |
-               ((uint64_t)res_r << 32)  |
-               ((uint64_t)res_g << 16)  |
-               ((uint64_t)res_b << 0);
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            __m128i coeff = _mm_set_epi64x(0, filter_horiz[x] * 0x0001000100010001ll);
+            __m128i col   = _mm_unpacklo_epi8(_mm_cvtsi32_si128(input_base_x[x]), _mm_setzero_si128());
+
+            col           = _mm_slli_epi16(col, 7);
+            res           = _mm_adds_epi16(_mm_mulhi_epi16(col, coeff), res);
+         }
+
+         res       = _mm_adds_epi16(_mm_srli_si128(res, 8), res);
+         output[w] = _mm_cvtsi128_si64(res);
+      }
+   }
+}
 #endif
+
+#if defined(__ARM_NEON__) || defined(HAVE_NEON)
+/* (a * b) >> 16 on each channel, as _mm_mulhi_epi16 does. */
+static INLINE int16x8_t scaler_neon_mulhi(int16x8_t a, int16x4_t b)
+{
+   return vcombine_s16(
+         vshrn_n_s32(vmull_s16(vget_low_s16(a),  b), 16),
+         vshrn_n_s32(vmull_s16(vget_high_s16(a), b), 16));
+}
+
+void scaler_argb8888_vert_neon(const struct scaler_ctx *ctx,
+      void *output_, int stride, int first, int last)
+{
+   int h, w;
+   const uint64_t      *input = ctx->scaled.frame;
+   uint32_t           *output = (uint32_t*)output_ + first * (stride >> 2);
+   const int16_t *filter_vert = ctx->vert.filter
+      + first * ctx->vert.filter_stride;
+
+   for (h = first; h < last; h++,
+         filter_vert += ctx->vert.filter_stride, output += stride >> 2)
+   {
+      const uint64_t *input_base = input + ctx->vert.filter_pos[h]
+         * (ctx->scaled.stride >> 3);
+
+      /* Four pixels at a time, two per register. */
+      for (w = 0; w + 4 <= ctx->out_width; w += 4)
+      {
+         int y;
+         const uint64_t *input_base_y = input_base + w;
+         int16x8_t res0               = vdupq_n_s16(0);
+         int16x8_t res1               = vdupq_n_s16(0);
+
+         for (y = 0; y < ctx->vert.filter_len; y++,
+               input_base_y += (ctx->scaled.stride >> 3))
+         {
+            int16x4_t coeff = vdup_n_s16(filter_vert[y]);
+            int16x8_t col0  = vld1q_s16((const int16_t*)input_base_y);
+            int16x8_t col1  = vld1q_s16((const int16_t*)(input_base_y + 2));
+
+            res0            = vqaddq_s16(res0, scaler_neon_mulhi(col0, coeff));
+            res1            = vqaddq_s16(res1, scaler_neon_mulhi(col1, coeff));
+         }
+
+         vst1_u8((uint8_t*)(output + w),
+               vqmovun_s16(vshrq_n_s16(res0, (7 - 2 - 2))));
+         vst1_u8((uint8_t*)(output + w + 2),
+               vqmovun_s16(vshrq_n_s16(res1, (7 - 2 - 2))));
       }
+
+      for (; w < ctx->out_width; w++)
+         output[w] = scaler_argb8888_vert_pixel_c(ctx,
+               input_base + w, filter_vert);
    }
 }
 
+void scaler_argb8888_horiz_neon(const struct scaler_ctx *ctx,
+      const void *input_, int stride, int first, int last)
+{
+   int h, w;
+   const uint32_t *input = (const uint32_t*)input_ + first * (stride >> 2);
+   uint64_t *output      = ctx->scaled.frame
+      + first * (ctx->scaled.stride >> 3);
+
+   for (h = first; h < last; h++, input += stride >> 2,
+         output += ctx->scaled.stride >> 3)
+   {
+      const int16_t *filter_horiz = ctx->horiz.filter;
+
+      for (w = 0; w < ctx->scaled.width; w++,
+            filter_horiz += ctx->horiz.filter_stride)
+      {
+         int x;
+         int16x4_t res;
+         const uint32_t *input_base_x = input + ctx->horiz.filter_pos[w];
+         int16x8_t res2               = vdupq_n_s16(0);
+
+         /* Two taps at a time, one pixel per half. */
+         for (x = 0; (x + 1) < ctx->horiz.filter_len; x += 2)
+         {
+            int16x8_t col = vreinterpretq_s16_u16(vshlq_n_u16(vmovl_u8(
+                        vld1_u8((const uint8_t*)(input_base_x + x))), 7));
+            int32x4_t lo  = vmull_s16(vget_low_s16(col),
+                  vdup_n_s16(filter_horiz[x + 0]));
+            int32x4_t hi  = vmull_s16(vget_high_s16(col),
+                  vdup_n_s16(filter_horiz[x + 1]));
+
+            res2          = vqaddq_s16(res2, vcombine_s16(
+                     vshrn_n_s32(lo, 16), vshrn_n_s32(hi, 16)));
+         }
+
+         res = vqadd_s16(vget_low_s16(res2), vget_high_s16(res2));
+
+         for (; x < ctx->horiz.filter_len; x++)
+         {
+            int16x4_t col = vreinterpret_s16_u16(vshl_n_u16(vget_low_u16(
+                        vmovl_u8(vreinterpret_u8_u32(vdup_n_u32(input_base_x[x])))), 7));
+
+            res           = vqadd_s16(res, vshrn_n_s32(
+                     vmull_s16(col, vdup_n_s16(filter_horiz[x])), 16));
+         }
+
+         vst1_s16((int16_t*)(output + w), res);
+      }
+   }
+}
+#endif
+
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output_, const void *input_,
       int out_width, int out_height,
       int in_width, int in_height,
-      int out_stride, int in_stride)
+      int out_stride, int in_stride,
+      int first, int last)
 {
    int h, w;
    int x_pos             = (1 << 15) * in_width / out_width - (1 << 15);
@@ -243,14 +534,16 @@ void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
    int y_pos             = (1 << 15) * in_height / out_height - (1 << 15);
    int y_step            = (1 << 16) * in_height / out_height;
    const uint32_t *input = (const uint32_t*)input_;
-   uint32_t *output      = (uint32_t*)output_;
+   uint32_t *output      = (uint32_t*)output_ + first * (out_stride >> 2);
 
    if (x_pos < 0)
       x_pos = 0;
    if (y_pos < 0)
       y_pos = 0;
 
-   for (h = 0; h < out_height; h++, y_pos += y_step, output += out_stride >> 2)
+   y_pos += first * y_step;
+
+   for (h = first; h < last; h++, y_pos += y_step, output += out_stride >> 2)
    {
       int               x = x_pos;
       const uint32_t *inp = input + (y_pos >> 16) * (in_stride >> 2);
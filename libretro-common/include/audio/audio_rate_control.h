@@ -0,0 +1,91 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (audio_rate_control.h).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+#ifndef __LIBRETRO_SDK_AUDIO_RATE_CONTROL_H
+#define __LIBRETRO_SDK_AUDIO_RATE_CONTROL_H
+
+#include <stddef.h>
+
+#include <boolean.h>
+#include <retro_common_api.h>
+
+RETRO_BEGIN_DECLS
+
+/* Proportional-integral controller for dynamic rate control.
+ *
+ * The controlled value is the fill level of the audio output
+ * buffer, which is kept at half the buffer on average. The returned
+ * adjustment scales the resampling ratio: above 1.0 more
+ * audio is produced, below 1.0 less. */
+typedef struct audio_rate_control
+{
+   double max_adjust;    /* Largest relative change of the rate. */
+   double filter_time;   /* Time constant of the fill estimate, in seconds. */
+   double integral_time; /* Integral time of the controller, in seconds. */
+   double error;         /* Filtered distance to the target fill, [-1, 1]. */
+   double integral;      /* Accumulated adjustment, [-max_adjust, max_adjust]. */
+   bool primed;
+} audio_rate_control_t;
+
+/**
+ * audio_rate_control_init:
+ * @rc                 : controller state
+ * @max_adjust         : largest relative change of the rate
+ * @buffer_duration    : length of the output buffer, in seconds
+ *
+ * Sets up @rc for a buffer of @buffer_duration. The time constants
+ * follow from the buffer length, so that the loop stays critically
+ * damped whatever latency is configured.
+ **/
+void audio_rate_control_init(audio_rate_control_t *rc,
+      double max_adjust, double buffer_duration);
+
+/**
+ * audio_rate_control_reset:
+ * @rc                 : controller state
+ *
+ * Forgets the fill estimate and accumulated adjustment,
+ * e.g. after the output was paused.
+ **/
+void audio_rate_control_reset(audio_rate_control_t *rc);
+
+/**
+ * audio_rate_control_update:
+ * @rc                 : controller state
+ * @queued             : amount of audio queued for output
+ * @pending            : amount of audio about to be written
+ * @buffer_size        : size of the output buffer, same unit as @queued
+ * @dt                 : time since the last update, in seconds
+ *
+ * Audio is written in chunks, so the fill level saws between
+ * @queued and @queued + @pending. The controller centres the
+ * middle of that range, which keeps chunks that are large
+ * compared to the buffer clear of both ends.
+ *
+ * Returns: the factor to apply to the resampling ratio.
+ **/
+double audio_rate_control_update(audio_rate_control_t *rc,
+      size_t queued, size_t pending, size_t buffer_size, double dt);
+
+RETRO_END_DECLS
+
+#endif
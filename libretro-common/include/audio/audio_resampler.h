@@ -151,6 +151,7 @@ typedef struct audio_frame_float
 } audio_frame_float_t;
 
 extern retro_resampler_t sinc_resampler;
+extern retro_resampler_t polyphase_resampler;
 #ifdef HAVE_CC_RESAMPLER
 extern retro_resampler_t CC_resampler;
 #endif
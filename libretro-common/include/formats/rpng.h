@@ -56,8 +56,36 @@ bool rpng_save_image_argb(const char *path, const uint32_t *data,
 bool rpng_save_image_bgr24(const char *path, const uint8_t *data,
       unsigned width, unsigned height, unsigned pitch);
 
+/* Compression levels, as in zlib. Levels below
+ * RPNG_COMPRESSION_DEFAULT use the same line filter for
+ * the whole image, and RPNG_COMPRESSION_NONE stores it
+ * unfiltered and uncompressed. The functions without
+ * a level use RPNG_COMPRESSION_BEST. */
+#define RPNG_COMPRESSION_NONE    0
+#define RPNG_COMPRESSION_FAST    1
+#define RPNG_COMPRESSION_DEFAULT 6
+#define RPNG_COMPRESSION_BEST    9
+
+/* The _ext variants take a compression level, and split
+ * large images between up to @threads threads (needs
+ * HAVE_THREADS). */
+bool rpng_save_image_argb_ext(const char *path, const uint32_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      int level, unsigned threads);
+bool rpng_save_image_bgr24_ext(const char *path, const uint8_t *data,
+      unsigned width, unsigned height, unsigned pitch,
+      int level, unsigned threads);
+
 uint8_t* rpng_save_image_bgr24_string(const uint8_t *data,
       unsigned width, unsigned height, signed pitch, uint64_t *bytes);
+uint8_t* rpng_save_image_argb_string(const uint32_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t *bytes);
+uint8_t* rpng_save_image_bgr24_string_ext(const uint8_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t *bytes,
+      int level, unsigned threads);
+uint8_t* rpng_save_image_argb_string_ext(const uint32_t *data,
+      unsigned width, unsigned height, signed pitch, uint64_t *bytes,
+      int level, unsigned threads);
 
 RETRO_END_DECLS
 
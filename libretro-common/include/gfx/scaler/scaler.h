@@ -48,7 +48,11 @@ enum scaler_type
    SCALER_TYPE_UNKNOWN = 0,
    SCALER_TYPE_POINT,
    SCALER_TYPE_BILINEAR,
-   SCALER_TYPE_SINC
+   /* Lanczos, 4 lobes */
+   SCALER_TYPE_SINC,
+   /* Lanczos, 3 lobes. Sharper than SCALER_TYPE_SINC,
+    * with less ringing, and cheaper. */
+   SCALER_TYPE_LANCZOS
 };
 
 struct scaler_filter
@@ -59,20 +63,29 @@ struct scaler_filter
    int      filter_stride;
 };
 
+struct scaler_thread_pool;
+
+/* The scaling callbacks process the rows [first, last)
+ * of their output, so that a frame can be split
+ * between threads. */
 struct scaler_ctx
 {
    void (*scaler_horiz)(const struct scaler_ctx*,
-         const void*, int);
+         const void*, int, int, int);
    void (*scaler_vert)(const struct scaler_ctx*,
-         void*, int);
+         void*, int, int, int);
    void (*scaler_special)(const struct scaler_ctx*,
-         void*, const void*, int, int, int, int, int, int);
+         void*, const void*, int, int, int, int, int, int, int, int);
 
    void (*in_pixconv)(void*, const void*, int, int, int, int);
    void (*out_pixconv)(void*, const void*, int, int, int, int);
    void (*direct_pixconv)(void*, const void*, int, int, int, int);
    struct scaler_filter horiz, vert;   /* ptr alignment */
 
+   /* Worker threads, created by scaler_ctx_gen_filter()
+    * when threads is larger than 1. */
+   struct scaler_thread_pool *pool;
+
    struct
    {
       uint32_t *frame;
@@ -105,11 +118,23 @@ struct scaler_ctx
    enum scaler_pix_fmt out_fmt;
    enum scaler_type scaler_type;
 
+   /* Number of threads scaling a frame, including the
+    * calling thread. Set before scaler_ctx_gen_filter().
+    * 0 or 1 scales on the calling thread only. */
+   unsigned threads;
+
    bool unscaled;
 };
 
 bool scaler_ctx_gen_filter(struct scaler_ctx *ctx);
 
+/**
+ * scaler_ctx_gen_reset:
+ * @ctx          : pointer to scaler context object.
+ *
+ * Frees the filters, buffers and worker threads
+ * allocated by scaler_ctx_gen_filter().
+ **/
 void scaler_ctx_gen_reset(struct scaler_ctx *ctx);
 
 /**
@@ -29,17 +29,39 @@
 
 RETRO_BEGIN_DECLS
 
+/* Vertical pass: writes output rows [first, last). */
 void scaler_argb8888_vert(const struct scaler_ctx *ctx,
-      void *output, int stride);
+      void *output, int stride, int first, int last);
 
+/* Horizontal pass: scales input rows [first, last)
+ * into ctx->scaled. */
 void scaler_argb8888_horiz(const struct scaler_ctx *ctx,
-      const void *input, int stride);
+      const void *input, int stride, int first, int last);
 
+#if defined(__AVX2__) && !defined(SCALER_NO_SIMD)
+void scaler_argb8888_vert_avx2(const struct scaler_ctx *ctx,
+      void *output, int stride, int first, int last);
+
+void scaler_argb8888_horiz_avx2(const struct scaler_ctx *ctx,
+      const void *input, int stride, int first, int last);
+#endif
+
+#if (defined(__ARM_NEON__) || defined(HAVE_NEON)) && !defined(SCALER_NO_SIMD)
+void scaler_argb8888_vert_neon(const struct scaler_ctx *ctx,
+      void *output, int stride, int first, int last);
+
+void scaler_argb8888_horiz_neon(const struct scaler_ctx *ctx,
+      const void *input, int stride, int first, int last);
+#endif
+
+/* Point sampling, in a single pass: writes
+ * output rows [first, last). */
 void scaler_argb8888_point_special(const struct scaler_ctx *ctx,
       void *output, const void *input,
       int out_width, int out_height,
       int in_width, int in_height,
-      int out_stride, int in_stride);
+      int out_stride, int in_stride,
+      int first, int last);
 
 RETRO_END_DECLS
 
@@ -23,6 +23,8 @@
 #ifndef __LIBRETRO_SDK_DIR_LIST_H
 #define __LIBRETRO_SDK_DIR_LIST_H
 
+#include <stddef.h>
+
 #include <retro_common_api.h>
 #include <boolean.h>
 
@@ -83,6 +85,19 @@ bool dir_list_initialize(struct string_list *list,
  **/
 void dir_list_sort(struct string_list *list, bool dir_first);
 
+/**
+ * dir_list_sort_merge:
+ * @list        : pointer to the directory listing.
+ * @sorted_size : number of leading entries of @list already sorted.
+ * @dir_first   : move the directories in the listing to the top?
+ *
+ * Sorts the entries appended after @sorted_size and merges
+ * them into the already sorted head of the listing.
+ *
+ **/
+void dir_list_sort_merge(struct string_list *list,
+      size_t sorted_size, bool dir_first);
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
@@ -94,6 +109,43 @@ void dir_list_free(struct string_list *list);
 
 bool dir_list_deinitialize(struct string_list *list);
 
+typedef struct dir_list_stream dir_list_stream_t;
+
+/**
+ * dir_list_stream_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : Only include files which match ext. Do not try to match compressed files, etc.
+ *
+ * Opens a (non-recursive) directory listing that can be read
+ * in batches with dir_list_stream_read().
+ *
+ * Returns: directory stream on success, NULL in case of error.
+ * Has to be freed with dir_list_stream_free().
+ **/
+dir_list_stream_t *dir_list_stream_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed);
+
+/**
+ * dir_list_stream_read:
+ * @stream      : directory stream.
+ * @list        : the string list to add files to.
+ * @max_entries : maximum number of directory entries to examine.
+ *
+ * Appends up to @max_entries directory entries that pass the
+ * filters of @stream to @list.
+ *
+ * Returns: 1 if the directory has more entries, 0 once it has
+ * been read completely, -1 on error.
+ **/
+int dir_list_stream_read(dir_list_stream_t *stream,
+      struct string_list *list, size_t max_entries);
+
+void dir_list_stream_free(dir_list_stream_t *stream);
+
 RETRO_END_DECLS
 
 #endif
@@ -21,6 +21,7 @@
  */
 
 #include <stdlib.h>
+#include <string.h>
 
 #if defined(_WIN32) && defined(_XBOX)
 #include <xtl.h>
@@ -74,6 +75,63 @@ void dir_list_sort(struct string_list *list, bool dir_first)
             dir_first ? qstrcmp_dir : qstrcmp_plain);
 }
 
+/**
+ * dir_list_sort_merge:
+ * @list        : pointer to the directory listing.
+ * @sorted_size : number of leading entries of @list already sorted.
+ * @dir_first   : move the directories in the listing to the top?
+ *
+ * Sorts the entries appended to a directory listing after
+ * @sorted_size and merges them into the already sorted head,
+ * so that a listing read in batches can be kept sorted without
+ * re-sorting it as a whole after every batch.
+ *
+ **/
+void dir_list_sort_merge(struct string_list *list,
+      size_t sorted_size, bool dir_first)
+{
+   size_t i, j, k;
+   struct string_list_elem *head = NULL;
+   int (*cmp)(const void*, const void*) = dir_first
+      ? qstrcmp_dir : qstrcmp_plain;
+
+   if (!list || sorted_size >= list->size)
+      return;
+
+   qsort(list->elems + sorted_size, list->size - sorted_size,
+         sizeof(struct string_list_elem), cmp);
+
+   /* Nothing to merge, or both runs are already in order */
+   if (     sorted_size == 0
+         || cmp(&list->elems[sorted_size - 1],
+                &list->elems[sorted_size]) <= 0)
+      return;
+
+   if (!(head = (struct string_list_elem*)
+            malloc(sorted_size * sizeof(*head))))
+   {
+      dir_list_sort(list, dir_first);
+      return;
+   }
+
+   memcpy(head, list->elems, sorted_size * sizeof(*head));
+
+   /* The write position never overtakes the read
+    * position of the tail run, so merge in place */
+   for (i = 0, j = sorted_size, k = 0; i < sorted_size && j < list->size;)
+   {
+      if (cmp(&head[i], &list->elems[j]) <= 0)
+         list->elems[k++] = head[i++];
+      else
+         list->elems[k++] = list->elems[j++];
+   }
+
+   while (i < sorted_size)
+      list->elems[k++] = head[i++];
+
+   free(head);
+}
+
 /**
  * dir_list_free:
  * @list : pointer to the directory listing
@@ -93,6 +151,99 @@ bool dir_list_deinitialize(struct string_list *list)
    return string_list_deinitialize(list);
 }
 
+static int dir_list_read(const char *dir,
+      struct string_list *list, struct string_list *ext_list,
+      bool include_dirs, bool include_hidden,
+      bool include_compressed, bool recursive);
+
+/**
+ * dir_list_read_entry:
+ * @entry              : directory stream, positioned on the entry to read.
+ * @dir                : directory path.
+ * @list               : the string list to add the entry to
+ * @ext_list           : the string list of extensions to include
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : Only include files which match ext. Do not try to match compressed files, etc.
+ * @recursive          : list directory contents recursively
+ *
+ * Add the current entry of a directory stream to an existing string list,
+ * if it passes the filters.
+ *
+ * Returns: -1 on error, 0 on success.
+ **/
+static int dir_list_read_entry(struct RDIR *entry, const char *dir,
+      struct string_list *list, struct string_list *ext_list,
+      bool include_dirs, bool include_hidden,
+      bool include_compressed, bool recursive)
+{
+   union string_list_elem_attr attr;
+   char file_path[PATH_MAX_LENGTH];
+   const char *name                = retro_dirent_get_name(entry);
+
+   if (name[0] == '.')
+   {
+      /* Do not include hidden files and directories */
+      if (!include_hidden)
+         return 0;
+
+      /* char-wise comparisons to avoid string comparison */
+
+      /* Do not include current dir */
+      if (name[1] == '\0')
+         return 0;
+      /* Do not include parent dir */
+      if (name[1] == '.' && name[2] == '\0')
+         return 0;
+   }
+
+   file_path[0] = '\0';
+   fill_pathname_join(file_path, dir, name, sizeof(file_path));
+
+   if (retro_dirent_is_dir(entry, NULL))
+   {
+      if (recursive)
+         dir_list_read(file_path, list, ext_list, include_dirs,
+               include_hidden, include_compressed, recursive);
+
+      if (!include_dirs)
+         return 0;
+      attr.i = RARCH_DIRECTORY;
+   }
+   else
+   {
+      const char *file_ext    = path_get_extension(name);
+
+      attr.i                  = RARCH_FILETYPE_UNSET;
+
+      /*
+       * If the file format is explicitly supported by the libretro-core, we
+       * need to immediately load it and not designate it as a compressed file.
+       *
+       * Example: .zip could be supported as a image by the core and as a
+       * compressed_file. In that case, we have to interpret it as a image.
+       *
+       * */
+      if (string_list_find_elem_prefix(ext_list, ".", file_ext))
+         attr.i            = RARCH_PLAIN_FILE;
+      else
+      {
+         bool is_compressed_file;
+         if ((is_compressed_file = path_is_compressed_file(file_path)))
+            attr.i               = RARCH_COMPRESSED_ARCHIVE;
+
+         if (ext_list &&
+               (!is_compressed_file || !include_compressed))
+            return 0;
+      }
+   }
+
+   if (!string_list_append(list, file_path, attr))
+      return -1;
+
+   return 0;
+}
+
 /**
  * dir_list_read:
  * @dir                : directory path.
@@ -119,68 +270,9 @@ static int dir_list_read(const char *dir,
 
    while (retro_readdir(entry))
    {
-      union string_list_elem_attr attr;
-      char file_path[PATH_MAX_LENGTH];
-      const char *name                = retro_dirent_get_name(entry);
-
-      if (name[0] == '.')
-      {
-         /* Do not include hidden files and directories */
-         if (!include_hidden)
-            continue;
-
-         /* char-wise comparisons to avoid string comparison */
-
-         /* Do not include current dir */
-         if (name[1] == '\0')
-            continue;
-         /* Do not include parent dir */
-         if (name[1] == '.' && name[2] == '\0')
-            continue;
-      }
-
-      file_path[0] = '\0';
-      fill_pathname_join(file_path, dir, name, sizeof(file_path));
-
-      if (retro_dirent_is_dir(entry, NULL))
-      {
-         if (recursive)
-            dir_list_read(file_path, list, ext_list, include_dirs,
-                  include_hidden, include_compressed, recursive);
-
-         if (!include_dirs)
-            continue;
-         attr.i = RARCH_DIRECTORY;
-      }
-      else
-      {
-         const char *file_ext    = path_get_extension(name);
-
-         attr.i                  = RARCH_FILETYPE_UNSET;
-
-         /*
-          * If the file format is explicitly supported by the libretro-core, we
-          * need to immediately load it and not designate it as a compressed file.
-          *
-          * Example: .zip could be supported as a image by the core and as a
-          * compressed_file. In that case, we have to interpret it as a image.
-          *
-          * */
-         if (string_list_find_elem_prefix(ext_list, ".", file_ext))
-            attr.i            = RARCH_PLAIN_FILE;
-         else
-         {
-            bool is_compressed_file;
-            if ((is_compressed_file = path_is_compressed_file(file_path)))
-               attr.i               = RARCH_COMPRESSED_ARCHIVE;
-
-            if (ext_list &&
-                  (!is_compressed_file || !include_compressed))
-               continue;
-         }
-      }
-
-      if (!string_list_append(list, file_path, attr))
+      if (dir_list_read_entry(entry, dir, list, ext_list,
+               include_dirs, include_hidden,
+               include_compressed, recursive) == -1)
          goto error;
    }
 
@@ -278,3 +370,113 @@ bool dir_list_initialize(struct string_list *list,
    return dir_list_append(list, dir, ext, include_dirs,
             include_hidden, include_compressed, recursive);
 }
+
+struct dir_list_stream
+{
+   struct RDIR *entry;
+   struct string_list ext_list;
+   char *dir;
+   bool has_ext_list;
+   bool include_dirs;
+   bool include_hidden;
+   bool include_compressed;
+};
+
+/**
+ * dir_list_stream_new:
+ * @dir                : directory path.
+ * @ext                : allowed extensions of file directory entries to include.
+ * @include_dirs       : include directories as part of the finished directory listing?
+ * @include_hidden     : include hidden files and directories as part of the finished directory listing?
+ * @include_compressed : Only include files which match ext. Do not try to match compressed files, etc.
+ *
+ * Opens a (non-recursive) directory listing that can be read
+ * in batches with dir_list_stream_read().
+ *
+ * Returns: directory stream on success, NULL in case of error.
+ * Has to be freed with dir_list_stream_free().
+ **/
+dir_list_stream_t *dir_list_stream_new(const char *dir,
+      const char *ext, bool include_dirs,
+      bool include_hidden, bool include_compressed)
+{
+   dir_list_stream_t *stream = NULL;
+
+   if (string_is_empty(dir))
+      return NULL;
+
+   if (!(stream = (dir_list_stream_t*)calloc(1, sizeof(*stream))))
+      return NULL;
+
+   stream->include_dirs       = include_dirs;
+   stream->include_hidden     = include_hidden;
+   stream->include_compressed = include_compressed;
+
+   if (ext)
+   {
+      string_list_initialize(&stream->ext_list);
+      string_split_noalloc(&stream->ext_list, ext, "|");
+      stream->has_ext_list    = true;
+   }
+
+   if (     !(stream->dir = strdup(dir))
+         || !(stream->entry = retro_opendir_include_hidden(
+               dir, include_hidden))
+         || retro_dirent_error(stream->entry))
+   {
+      dir_list_stream_free(stream);
+      return NULL;
+   }
+
+   return stream;
+}
+
+/**
+ * dir_list_stream_read:
+ * @stream      : directory stream.
+ * @list        : the string list to add files to.
+ * @max_entries : maximum number of directory entries to examine.
+ *
+ * Appends up to @max_entries directory entries that pass the
+ * filters of @stream to @list.
+ *
+ * Returns: 1 if the directory has more entries, 0 once it has
+ * been read completely, -1 on error.
+ **/
+int dir_list_stream_read(dir_list_stream_t *stream,
+      struct string_list *list, size_t max_entries)
+{
+   size_t count = 0;
+
+   if (!stream || !list)
+      return -1;
+
+   while (count++ < max_entries)
+   {
+      if (!retro_readdir(stream->entry))
+         return 0;
+
+      if (dir_list_read_entry(stream->entry, stream->dir, list,
+               stream->has_ext_list ? &stream->ext_list : NULL,
+               stream->include_dirs, stream->include_hidden,
+               stream->include_compressed, false) == -1)
+         return -1;
+   }
+
+   return 1;
+}
+
+void dir_list_stream_free(dir_list_stream_t *stream)
+{
+   if (!stream)
+      return;
+
+   if (stream->entry)
+      retro_closedir(stream->entry);
+   if (stream->has_ext_list)
+      string_list_deinitialize(&stream->ext_list);
+   if (stream->dir)
+      free(stream->dir);
+
+   free(stream);
+}
@@ -0,0 +1,176 @@
+/* Copyright  (C) 2010-2020 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (rate_control_test.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Offline check of the dynamic rate control loop.
+ *
+ * A core emits one video frame worth of audio at a time,
+ * resampled with the controller's adjustment, into a blocking
+ * output buffer. The audio device drains the buffer at a rate
+ * that drifts from the nominal one, and frames arrive with
+ * timing jitter. After the loop settled, the buffer has to stay
+ * clear of underruns and hover around half full. */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdint.h>
+
+#include <audio/audio_rate_control.h>
+
+#define OUT_RATE     48000.0
+#define FRAME_RATE   60.0
+#define MAX_ADJUST   0.005
+#define SIM_SECONDS  240.0
+
+typedef struct
+{
+   unsigned underruns;
+   double fill_min;
+   double fill_max;
+   double fill_avg;
+} sim_result_t;
+
+static uint32_t sim_seed = 1;
+
+/* Uniform in [-1, 1]. */
+static double sim_random(void)
+{
+   sim_seed = sim_seed * 1664525u + 1013904223u;
+   return (double)(sim_seed >> 8) / (double)(1 << 23) - 1.0;
+}
+
+static void simulate(bool integral, double drift, double jitter_ms,
+      unsigned latency_ms, sim_result_t *res)
+{
+   audio_rate_control_t rc;
+   double t           = 0.0;
+   double clock       = 0.0;
+   double last_t      = 0.0;
+   double buffer_size = OUT_RATE * latency_ms / 1000.0;
+   double queued      = buffer_size / 2.0;
+   double fill_sum    = 0.0;
+   unsigned samples   = 0;
+
+   audio_rate_control_init(&rc, MAX_ADJUST, latency_ms / 1000.0);
+   if (!integral)
+   {
+      /* What audio_driver_flush() did before: direct
+       * proportional control of the raw fill level. */
+      rc.integral_time = 0.0;
+      rc.filter_time   = 0.0;
+   }
+
+   res->underruns = 0;
+   res->fill_min  = 1.0;
+   res->fill_max  = 0.0;
+
+   while (clock < SIM_SECONDS)
+   {
+      double adjust;
+      double frames;
+      double period;
+      bool settled  = clock > SIM_SECONDS / 2.0;
+
+      /* Frames are paced by the video clock; the jitter
+       * delays single frames without accumulating. */
+      clock  += 1.0 / FRAME_RATE;
+      period  = clock + sim_random() * jitter_ms / 1000.0 - t;
+      t      += period;
+
+      /* The device plays while the core runs a frame. */
+      queued -= OUT_RATE * (1.0 + drift) * period;
+      if (queued < 0.0)
+      {
+         if (settled)
+            res->underruns++;
+         queued = 0.0;
+      }
+
+      /* The old controller only looked at the fill level
+       * ahead of the write. */
+      frames  = OUT_RATE / FRAME_RATE;
+      adjust  = audio_rate_control_update(&rc, (size_t)queued,
+            integral ? (size_t)frames : 0, (size_t)buffer_size, t - last_t);
+      last_t  = t;
+      frames *= adjust;
+
+      /* Blocking write: wait for the device to make room. */
+      if (queued + frames > buffer_size)
+      {
+         double wait = (queued + frames - buffer_size)
+            / (OUT_RATE * (1.0 + drift));
+         t     += wait;
+         clock += wait;
+         queued = buffer_size;
+      }
+      else
+         queued += frames;
+
+      if (settled)
+      {
+         /* Middle of the sawtooth left by the write */
+         double fill = (queued - frames / 2.0) / buffer_size;
+         if (fill < res->fill_min)
+            res->fill_min = fill;
+         if (fill > res->fill_max)
+            res->fill_max = fill;
+         fill_sum += fill;
+         samples++;
+      }
+   }
+
+   res->fill_avg = fill_sum / samples;
+}
+
+int main(void)
+{
+   unsigned i;
+   static const double drifts[]     = { -0.003, -0.001, 0.0, 0.001, 0.003 };
+   static const unsigned latencies[] = { 32, 64 };
+
+   printf("latency  drift   controller  underruns  fill min/avg/max\n");
+
+   for (i = 0; i < sizeof(latencies) / sizeof(latencies[0]); i++)
+   {
+      unsigned j;
+      for (j = 0; j < sizeof(drifts) / sizeof(drifts[0]); j++)
+      {
+         sim_result_t p, pi;
+
+         simulate(false, drifts[j], 2.0, latencies[i], &p);
+         simulate(true,  drifts[j], 2.0, latencies[i], &pi);
+
+         printf("%4ums  %+.3f  P           %9u  %.2f/%.2f/%.2f\n",
+               latencies[i], drifts[j], p.underruns,
+               p.fill_min, p.fill_avg, p.fill_max);
+         printf("%4ums  %+.3f  PI          %9u  %.2f/%.2f/%.2f\n",
+               latencies[i], drifts[j], pi.underruns,
+               pi.fill_min, pi.fill_avg, pi.fill_max);
+
+         /* Converged: no underruns and centred on half full,
+          * whatever the drift. */
+         assert(pi.underruns == 0);
+         assert(pi.fill_avg > 0.45 && pi.fill_avg < 0.55);
+      }
+   }
+
+   return 0;
+}
@@ -0,0 +1,483 @@
+/* Copyright  (C) 2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_resampler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Throughput and accuracy benchmark for the audio resamplers.
+ *
+ * Every registered resampler (and every quality level of
+ * resamplers that have them) is run on:
+ * - white noise, to measure throughput in input frames per second;
+ * - a sweep of passband tones, to measure SNR against the ideal
+ *   resampled sine, both at the ratio the resampler was created
+ *   for and at a slightly drifted one, as dynamic rate control
+ *   does;
+ * - the same tones at ratios without a small rational form, such
+ *   as a core running at a skewed 32040.5 Hz, to check both SNR
+ *   and that the output has the requested number of frames;
+ * - a sweep of tones that must not survive resampling (above the
+ *   output Nyquist frequency when downsampling, and the images
+ *   above the input Nyquist frequency when upsampling), to
+ *   measure aliasing rejection.
+ *
+ * Returns failure if a result drops below the minimum listed
+ * for its resampler, so that it can be run after changes to
+ * the resamplers. */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <audio/audio_resampler.h>
+
+#define BENCH_CHUNK_FRAMES    1024
+#define BENCH_SPEED_SECONDS   8
+#define BENCH_TONE_SECONDS    1
+/* Resampler start-up and tail are left out of the measurement */
+#define BENCH_SETTLE_FRACTION 0.1
+/* Largest deviation from the requested output length, in ppm */
+#define BENCH_MAX_RATE_ERROR  1000.0
+
+typedef struct
+{
+   const char *ident;
+   enum resampler_quality quality;
+   /* Minimums, in dB */
+   double min_snr;
+   double min_rejection;
+} bench_limit_t;
+
+typedef struct
+{
+   double speed;
+   double snr_1k;
+   double snr;
+   double rejection;
+   double rate_error;
+} bench_result_t;
+
+/* Limits leave a few dB of margin below what the
+ * current implementations reach. */
+static const bench_limit_t bench_limits[] = {
+   { "sinc",      RESAMPLER_QUALITY_LOWEST,    5.0,  2.0 },
+   { "sinc",      RESAMPLER_QUALITY_LOWER,    15.0,  6.0 },
+   { "sinc",      RESAMPLER_QUALITY_NORMAL,   55.0, 45.0 },
+   { "sinc",      RESAMPLER_QUALITY_HIGHER,   57.0, 85.0 },
+   { "sinc",      RESAMPLER_QUALITY_HIGHEST,  57.0, 77.0 },
+   { "polyphase", RESAMPLER_QUALITY_LOWEST,   54.0, 45.0 },
+   { "polyphase", RESAMPLER_QUALITY_LOWER,    54.0, 45.0 },
+   { "polyphase", RESAMPLER_QUALITY_NORMAL,   65.0, 75.0 },
+   { "polyphase", RESAMPLER_QUALITY_HIGHER,   72.0, 87.0 },
+   { "polyphase", RESAMPLER_QUALITY_HIGHEST,  72.0, 87.0 },
+   { "cc",        RESAMPLER_QUALITY_DONTCARE,  5.0,  2.0 },
+   { "nearest",   RESAMPLER_QUALITY_DONTCARE,  0.0, -1.0 },
+};
+
+static const char *bench_quality_name(enum resampler_quality quality)
+{
+   switch (quality)
+   {
+      case RESAMPLER_QUALITY_LOWEST:
+         return "lowest";
+      case RESAMPLER_QUALITY_LOWER:
+         return "lower";
+      case RESAMPLER_QUALITY_NORMAL:
+         return "normal";
+      case RESAMPLER_QUALITY_HIGHER:
+         return "higher";
+      case RESAMPLER_QUALITY_HIGHEST:
+         return "highest";
+      default:
+         break;
+   }
+   return "-";
+}
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* Runs @in through a fresh resampler in chunks,
+ * the way the audio driver feeds it. The resampler is
+ * created for @ratio, and run at @ratio * @drift. */
+static size_t bench_resample(const char *ident,
+      enum resampler_quality quality, double ratio, double drift,
+      const float *in, size_t in_frames, float *out)
+{
+   size_t done                      = 0;
+   size_t out_frames                = 0;
+   void *re                         = NULL;
+   const retro_resampler_t *backend = NULL;
+
+   if (!retro_resampler_realloc(&re, &backend, ident, quality, ratio))
+      return 0;
+
+   while (done < in_frames)
+   {
+      struct resampler_data data;
+      size_t frames     = in_frames - done;
+
+      if (frames > BENCH_CHUNK_FRAMES)
+         frames         = BENCH_CHUNK_FRAMES;
+
+      data.data_in      = in + done * 2;
+      data.data_out     = out + out_frames * 2;
+      data.input_frames = frames;
+      data.output_frames= 0;
+      data.ratio        = ratio * drift;
+
+      backend->process(re, &data);
+
+      done             += frames;
+      out_frames       += data.output_frames;
+   }
+
+   backend->free(re);
+   return out_frames;
+}
+
+static void bench_tone(float *out, size_t frames, double freq, double rate)
+{
+   size_t i;
+   for (i = 0; i < frames; i++)
+   {
+      float s        = (float)(0.5 * sin(2.0 * M_PI * freq * i / rate));
+      out[i * 2 + 0] = s;
+      out[i * 2 + 1] = s;
+   }
+}
+
+/* Least-squares fit of a sine at @freq to the left channel,
+ * leaving out the start and end. Returns the power of the fit,
+ * and the power of what is left in @residual. */
+static double bench_fit(const float *in, size_t frames,
+      double freq, double rate, double *residual)
+{
+   size_t i;
+   double ss = 0.0, sc = 0.0, cc = 0.0, ys = 0.0, yc = 0.0, yy = 0.0;
+   double det, a, b, fit = 0.0;
+   size_t start = (size_t)(frames * BENCH_SETTLE_FRACTION);
+   size_t end   = frames - start;
+
+   for (i = start; i < end; i++)
+   {
+      double w = 2.0 * M_PI * freq * i / rate;
+      double s = sin(w);
+      double c = cos(w);
+      double y = in[i * 2];
+
+      ss += s * s;
+      sc += s * c;
+      cc += c * c;
+      ys += y * s;
+      yc += y * c;
+      yy += y * y;
+   }
+
+   det = ss * cc - sc * sc;
+   if (det == 0.0)
+   {
+      *residual = yy;
+      return 0.0;
+   }
+
+   a = (ys * cc - yc * sc) / det;
+   b = (yc * ss - ys * sc) / det;
+
+   *residual = 0.0;
+   for (i = start; i < end; i++)
+   {
+      double w = 2.0 * M_PI * freq * i / rate;
+      double y = a * sin(w) + b * cos(w);
+      double e = in[i * 2] - y;
+
+      fit       += y * y;
+      *residual += e * e;
+   }
+
+   return fit;
+}
+
+static double bench_db(double ratio)
+{
+   if (ratio <= 0.0)
+      return 999.0;
+   return 10.0 * log10(ratio);
+}
+
+static double bench_speed(const char *ident,
+      enum resampler_quality quality, float *in, float *out)
+{
+   size_t i;
+   double start;
+   size_t frames = 44100 * BENCH_SPEED_SECONDS;
+
+   srand(1);
+   for (i = 0; i < frames * 2; i++)
+      in[i] = (float)rand() / RAND_MAX - 0.5f;
+
+   start = bench_time();
+   bench_resample(ident, quality, 48000.0 / 44100.0, 1.0, in, frames, out);
+   return frames / (bench_time() - start);
+}
+
+/* Worst SNR over a sweep of passband tones, upsampling
+ * and downsampling, with and without drift. @snr_1k receives
+ * the SNR of the 1 kHz tone, upsampled without drift. */
+static double bench_snr(const char *ident,
+      enum resampler_quality quality, float *in, float *out,
+      double *snr_1k)
+{
+   unsigned i, j, k;
+   static const double tones[]    = { 100, 1000, 5000, 10000, 15000, 18000 };
+   static const double rates[][2] = { { 44100, 48000 }, { 48000, 44100 } };
+   static const double drifts[]   = { 1.0, 1.002 };
+   double worst                   = 999.0;
+
+   *snr_1k                        = 0.0;
+
+   for (k = 0; k < ARRAY_SIZE(drifts); k++)
+   {
+      for (i = 0; i < ARRAY_SIZE(rates); i++)
+      {
+         for (j = 0; j < ARRAY_SIZE(tones); j++)
+         {
+            double residual, fit, snr;
+            size_t frames     = (size_t)rates[i][0] * BENCH_TONE_SECONDS;
+            size_t out_frames;
+
+            bench_tone(in, frames, tones[j], rates[i][0]);
+            out_frames = bench_resample(ident, quality,
+                  rates[i][1] / rates[i][0], drifts[k],
+                  in, frames, out);
+            fit        = bench_fit(out, out_frames, tones[j],
+                  rates[i][1] * drifts[k], &residual);
+            snr        = bench_db(fit / residual);
+
+            if (k == 0 && i == 0 && tones[j] == 1000)
+               *snr_1k = snr;
+            if (snr < worst)
+               worst = snr;
+         }
+      }
+   }
+
+   return worst;
+}
+
+/* Worst SNR over passband tones at output/input ratios that
+ * have no small L/M form. @rate_error receives the largest
+ * deviation of the output length from the requested one, in ppm. */
+static double bench_skew(const char *ident,
+      enum resampler_quality quality, float *in, float *out,
+      double *rate_error)
+{
+   unsigned i, j;
+   static const double tones[]    = { 100, 1000, 5000 };
+   static const double rates[][2] = {
+      { 32040.5, 48000 }, { 32000, 32000 * 1.500505 } };
+   double worst                   = 999.0;
+
+   *rate_error                    = 0.0;
+
+   for (i = 0; i < ARRAY_SIZE(rates); i++)
+   {
+      for (j = 0; j < ARRAY_SIZE(tones); j++)
+      {
+         double residual, fit, snr, error;
+         double ratio      = rates[i][1] / rates[i][0];
+         size_t frames     = (size_t)rates[i][0] * BENCH_TONE_SECONDS;
+         size_t out_frames;
+
+         bench_tone(in, frames, tones[j], rates[i][0]);
+         out_frames = bench_resample(ident, quality, ratio, 1.0,
+               in, frames, out);
+         fit        = bench_fit(out, out_frames, tones[j],
+               rates[i][1], &residual);
+         snr        = bench_db(fit / residual);
+         error      = fabs(out_frames - frames * ratio)
+            / (frames * ratio) * 1000000.0;
+
+         if (snr < worst)
+            worst = snr;
+         if (error > *rate_error)
+            *rate_error = error;
+      }
+   }
+
+   return worst;
+}
+
+/* Worst rejection, relative to the input tone, of what
+ * resampling must remove: tones above the output Nyquist
+ * frequency when downsampling, and images of the input
+ * spectrum when upsampling. */
+static double bench_rejection(const char *ident,
+      enum resampler_quality quality, float *in, float *out)
+{
+   unsigned i;
+   static const double down_tones[] = { 22600, 23000, 23500 };
+   static const double up_tones[]   = { 16000, 18000, 20000 };
+   double worst                     = 999.0;
+
+   for (i = 0; i < ARRAY_SIZE(down_tones); i++)
+   {
+      size_t j, start, end;
+      double power      = 0.0;
+      size_t frames     = 48000 * BENCH_TONE_SECONDS;
+      size_t out_frames;
+      double rejection;
+
+      bench_tone(in, frames, down_tones[i], 48000);
+      out_frames = bench_resample(ident, quality,
+            44100.0 / 48000.0, 1.0, in, frames, out);
+      start      = (size_t)(out_frames * BENCH_SETTLE_FRACTION);
+      end        = out_frames - start;
+
+      for (j = start; j < end; j++)
+         power  += out[j * 2] * out[j * 2];
+      power     /= end - start;
+
+      /* A sine of amplitude 0.5 has a power of 0.125 */
+      rejection  = bench_db(0.125 / power);
+      if (rejection < worst)
+         worst = rejection;
+   }
+
+   for (i = 0; i < ARRAY_SIZE(up_tones); i++)
+   {
+      double residual, signal, image, rejection;
+      size_t frames     = 44100 * BENCH_TONE_SECONDS;
+      size_t out_frames;
+
+      bench_tone(in, frames, up_tones[i], 44100);
+      out_frames = bench_resample(ident, quality,
+            48000.0 / 44100.0, 1.0, in, frames, out);
+
+      /* The image at 44100 - f folds back to 48000 - (44100 - f) */
+      signal     = bench_fit(out, out_frames, up_tones[i], 48000, &residual);
+      image      = bench_fit(out, out_frames,
+            48000 - (44100 - up_tones[i]), 48000, &residual);
+      rejection  = bench_db(signal / image);
+      if (rejection < worst)
+         worst = rejection;
+   }
+
+   return worst;
+}
+
+static const bench_limit_t *bench_find_limit(const char *ident,
+      enum resampler_quality quality)
+{
+   unsigned i;
+   for (i = 0; i < ARRAY_SIZE(bench_limits); i++)
+   {
+      if (     !strcmp(bench_limits[i].ident, ident)
+            && bench_limits[i].quality == quality)
+         return &bench_limits[i];
+   }
+   return NULL;
+}
+
+int main(void)
+{
+   int idx;
+   const retro_resampler_t *backend;
+   bool failed = false;
+   /* Large enough for the longest input, and its output */
+   float *in   = (float*)malloc(44100 * BENCH_SPEED_SECONDS * 2 * sizeof(float));
+   float *out  = (float*)malloc(48000 * (BENCH_SPEED_SECONDS + 1) * 2 * sizeof(float));
+
+   if (!in || !out)
+      return EXIT_FAILURE;
+
+   printf("%-10s %-8s %12s %10s %10s %10s %10s %10s\n", "resampler",
+         "quality", "frames/s", "SNR 1k", "SNR min", "SNR skew", "alias",
+         "rate ppm");
+
+   for (idx = 0; (backend = (const retro_resampler_t*)
+            audio_resampler_driver_find_handle(idx)); idx++)
+   {
+      const char *ident              = backend->short_ident;
+      enum resampler_quality quality = RESAMPLER_QUALITY_DONTCARE;
+      enum resampler_quality last    = RESAMPLER_QUALITY_DONTCARE;
+
+      if (!strcmp(ident, "null"))
+         continue;
+
+      /* Only sinc and polyphase have quality levels */
+      if (!strcmp(ident, "sinc") || !strcmp(ident, "polyphase"))
+      {
+         quality = RESAMPLER_QUALITY_LOWEST;
+         last    = RESAMPLER_QUALITY_HIGHEST;
+      }
+
+      for (; quality <= last; quality++)
+      {
+         const bench_limit_t *limit = bench_find_limit(ident, quality);
+         double snr_skew;
+         bench_result_t res;
+
+         res.speed     = bench_speed(backend->ident, quality, in, out);
+         res.snr       = bench_snr(backend->ident, quality, in, out,
+               &res.snr_1k);
+         snr_skew      = bench_skew(backend->ident, quality, in, out,
+               &res.rate_error);
+         res.rejection = bench_rejection(backend->ident, quality, in, out);
+
+         printf("%-10s %-8s %12.0f %10.1f %10.1f %10.1f %10.1f %10.1f",
+               ident, bench_quality_name(quality),
+               res.speed, res.snr_1k, res.snr, snr_skew, res.rejection,
+               res.rate_error);
+
+         if (snr_skew < res.snr)
+            res.snr = snr_skew;
+
+         if (limit && (res.snr < limit->min_snr
+                  || res.rejection < limit->min_rejection))
+         {
+            printf("  FAILED (minimum %.1f / %.1f)",
+                  limit->min_snr, limit->min_rejection);
+            failed = true;
+         }
+         if (res.rate_error > BENCH_MAX_RATE_ERROR)
+         {
+            printf("  FAILED (rate off by more than %.0f ppm)",
+                  BENCH_MAX_RATE_ERROR);
+            failed = true;
+         }
+         printf("\n");
+      }
+   }
+
+   printf("SNR in dB over passband tones up to 18 kHz (5 kHz at skewed"
+         " ratios),\nalias rejection in dB, output length error in ppm.\n");
+
+   free(in);
+   free(out);
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
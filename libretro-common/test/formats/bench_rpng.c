@@ -0,0 +1,451 @@
+/* Copyright  (C) 2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_rpng.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Decoding speed benchmark for rpng.
+ *
+ * Decodes a corpus of PNG files given on the command line
+ * (typically all the files of a thumbnail directory), or a
+ * generated set of RGB and RGBA images when there is none,
+ * to measure throughput in images and megapixels per second:
+ * one image at a time, then all of them at once on a thread
+ * pool, the way the image load task runs them.
+ *
+ * Prints a CRC of all decoded pixels. Builds with and without
+ * RPNG_NO_SIMD have to print the same CRC.
+ *
+ * Then encodes the decoded images back at several
+ * compression levels, on one thread and split between
+ * threads, reporting speed and size.
+ *
+ * Returns failure if an image fails to decode, if the
+ * threaded pass decodes different pixels, or if an
+ * encoded image does not decode back to the same pixels. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <formats/image.h>
+#include <formats/rpng.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#ifdef HAVE_THREADS
+#include <rthreads/tpool.h>
+#endif
+
+#define BENCH_SECONDS 2.0
+
+typedef struct
+{
+   const char *name;
+   uint8_t *data;
+   uint32_t *pixels;
+   size_t size;
+   unsigned width;
+   unsigned height;
+   uint32_t crc;
+   bool check;
+   bool keep;
+   bool ok;
+} bench_image_t;
+
+/* Thumbnail-like sizes */
+static const struct
+{
+   unsigned width;
+   unsigned height;
+   unsigned bpp;
+} bench_synthetic[] = {
+   { 512, 384, 3 },
+   { 320, 240, 3 },
+   { 256, 224, 3 },
+   { 512, 512, 4 },
+   { 256, 256, 4 },
+   {  64,  64, 4 },
+};
+
+static const int bench_levels[] = {
+   RPNG_COMPRESSION_NONE,
+   RPNG_COMPRESSION_FAST,
+   RPNG_COMPRESSION_DEFAULT,
+   RPNG_COMPRESSION_BEST,
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+static bool bench_decode(bench_image_t *img)
+{
+   int ret;
+   uint32_t *pixels = NULL;
+   unsigned width   = 0;
+   unsigned height  = 0;
+   rpng_t *rpng     = rpng_alloc();
+
+   img->ok          = false;
+
+   if (!rpng)
+      return false;
+
+   if (     !rpng_set_buf_ptr(rpng, img->data, img->size)
+         || !rpng_start(rpng))
+      goto end;
+
+   while (rpng_iterate_image(rpng));
+
+   if (!rpng_is_valid(rpng))
+      goto end;
+
+   do
+   {
+      ret = rpng_process_image(rpng, (void**)&pixels,
+            img->size, &width, &height);
+   } while (ret == IMAGE_PROCESS_NEXT);
+
+   if (ret == IMAGE_PROCESS_END && pixels)
+   {
+      img->width  = width;
+      img->height = height;
+      img->ok     = true;
+      /* Left out of timed runs */
+      if (img->check)
+         img->crc = encoding_crc32(0, (const uint8_t*)pixels,
+               (size_t)width * height * sizeof(uint32_t));
+      if (img->keep)
+      {
+         img->pixels = pixels;
+         pixels      = NULL;
+      }
+   }
+
+end:
+   free(pixels);
+   rpng_free(rpng);
+   return img->ok;
+}
+
+#ifdef HAVE_THREADS
+static void bench_decode_work(void *arg)
+{
+   bench_decode((bench_image_t*)arg);
+}
+#endif
+
+/* Encodes the decoded pixels of an image and returns
+ * the size of the PNG, or 0 on failure. Checked runs
+ * decode it again and compare the pixels. */
+static uint64_t bench_encode(bench_image_t *img, int level,
+      unsigned threads, bool check)
+{
+   bench_image_t decoded;
+   uint64_t size = 0;
+   uint8_t *png  = rpng_save_image_argb_string_ext(img->pixels,
+         img->width, img->height, img->width * sizeof(uint32_t),
+         &size, level, threads);
+
+   if (!png)
+      return 0;
+
+   if (check)
+   {
+      memset(&decoded, 0, sizeof(decoded));
+      decoded.data  = png;
+      decoded.size  = (size_t)size;
+      decoded.check = true;
+
+      if (     !bench_decode(&decoded)
+            || decoded.width  != img->width
+            || decoded.height != img->height
+            || decoded.crc    != img->crc)
+         size = 0;
+   }
+
+   free(png);
+   return size;
+}
+
+static bool bench_load_file(bench_image_t *img, const char *path)
+{
+   long size;
+   FILE *file = fopen(path, "rb");
+
+   if (!file)
+      return false;
+
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   fseek(file, 0, SEEK_SET);
+
+   if (     (size <= 0)
+         || !(img->data = (uint8_t*)malloc((size_t)size))
+         || (fread(img->data, 1, (size_t)size, file) != (size_t)size))
+   {
+      fclose(file);
+      return false;
+   }
+
+   fclose(file);
+   img->name = path;
+   img->size = (size_t)size;
+   return true;
+}
+
+/* Gradients with some noise, so that the encoder
+ * picks a mix of line filters. */
+static bool bench_make_image(bench_image_t *img,
+      unsigned width, unsigned height, unsigned bpp)
+{
+   unsigned x, y;
+   uint64_t size   = 0;
+   uint32_t seed   = 1;
+   uint8_t *pixels = (uint8_t*)malloc((size_t)width * height * bpp);
+
+   if (!pixels)
+      return false;
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint8_t *px = pixels + ((size_t)y * width + x) * bpp;
+
+         seed        = seed * 1103515245u + 12345u;
+         px[0]       = (uint8_t)((x * 255) / width);
+         px[1]       = (uint8_t)((y * 255) / height);
+         px[2]       = (uint8_t)(((x >> 4) ^ (y >> 4)) & 1
+               ? (seed >> 16) : (x + y));
+         if (bpp == 4)
+            px[3]    = (uint8_t)(((x + y) & 0x40) ? 0xff : (x * 2));
+      }
+   }
+
+   if (bpp == 4)
+      img->data = rpng_save_image_argb_string((const uint32_t*)pixels,
+            width, height, width * bpp, &size);
+   else
+      img->data = rpng_save_image_bgr24_string(pixels,
+            width, height, width * bpp, &size);
+
+   free(pixels);
+
+   img->name = bpp == 4 ? "generated RGBA" : "generated RGB";
+   img->size = (size_t)size;
+   return img->data != NULL;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   unsigned j, passes;
+   double start, elapsed, speed_single;
+   uint32_t crc             = 0;
+   uint64_t pixels          = 0;
+   unsigned num_images      = 0;
+   bool failed              = false;
+   bench_image_t *images    = NULL;
+   uint32_t *crcs           = NULL;
+   unsigned threads         = cpu_features_get_core_amount();
+   unsigned max_images      = argc > 1 ? (unsigned)(argc - 1)
+      : (unsigned)(sizeof(bench_synthetic) / sizeof(bench_synthetic[0]));
+
+   if (!(images = (bench_image_t*)calloc(max_images, sizeof(*images))))
+      return EXIT_FAILURE;
+
+   for (j = 0; j < max_images; j++)
+   {
+      bench_image_t *img = &images[num_images];
+
+      if (argc > 1)
+      {
+         if (!bench_load_file(img, argv[j + 1]))
+         {
+            printf("%s: FAILED (read)\n", argv[j + 1]);
+            failed = true;
+            continue;
+         }
+      }
+      else if (!bench_make_image(img, bench_synthetic[j].width,
+               bench_synthetic[j].height, bench_synthetic[j].bpp))
+      {
+         printf("FAILED (encode)\n");
+         return EXIT_FAILURE;
+      }
+
+      img->check = true;
+      img->keep  = true;
+      if (!bench_decode(img))
+      {
+         printf("%s: FAILED (decode)\n", img->name);
+         free(img->data);
+         img->data = NULL;
+         failed    = true;
+         continue;
+      }
+
+      crc     = encoding_crc32(crc, (const uint8_t*)&img->crc,
+            sizeof(img->crc));
+      pixels += (uint64_t)img->width * img->height;
+      num_images++;
+   }
+
+   if (num_images == 0)
+      return EXIT_FAILURE;
+
+   if (!(crcs = (uint32_t*)malloc(num_images * sizeof(uint32_t))))
+      return EXIT_FAILURE;
+   for (j = 0; j < num_images; j++)
+   {
+      crcs[j]          = images[j].crc;
+      images[j].check  = false;
+      images[j].keep   = false;
+   }
+
+   printf("%u images, %.1f megapixels, crc %08x (%s)\n",
+         num_images, pixels / 1000000.0, (unsigned)crc,
+#if defined(RPNG_NO_SIMD)
+         "scalar"
+#else
+         "simd"
+#endif
+         );
+
+   /* One image at a time */
+   passes = 0;
+   start  = bench_time();
+   do
+   {
+      for (j = 0; j < num_images; j++)
+         bench_decode(&images[j]);
+      passes++;
+   } while ((elapsed = bench_time() - start) < BENCH_SECONDS);
+
+   speed_single = passes * num_images / elapsed;
+   printf("%-10s %9.1f images/s %9.1f MP/s\n", "1 thread",
+         speed_single, passes * (pixels / 1000000.0) / elapsed);
+
+#ifdef HAVE_THREADS
+   {
+      tpool_t *pool;
+
+      /* Always exercise the threaded path */
+      if (threads < 2)
+         threads = 2;
+
+      if (!(pool = tpool_create(threads)))
+         return EXIT_FAILURE;
+
+      passes = 0;
+      start  = bench_time();
+      do
+      {
+         for (j = 0; j < num_images; j++)
+            tpool_add_work(pool, bench_decode_work, &images[j]);
+         tpool_wait(pool);
+         passes++;
+      } while ((elapsed = bench_time() - start) < BENCH_SECONDS);
+
+      /* Checked pass */
+      for (j = 0; j < num_images; j++)
+      {
+         images[j].check = true;
+         images[j].crc   = 0;
+         tpool_add_work(pool, bench_decode_work, &images[j]);
+      }
+      tpool_wait(pool);
+      tpool_destroy(pool);
+
+      printf("%2u threads %9.1f images/s %9.1f MP/s  (%.2fx)\n", threads,
+            passes * num_images / elapsed,
+            passes * (pixels / 1000000.0) / elapsed,
+            (passes * num_images / elapsed) / speed_single);
+
+      for (j = 0; j < num_images; j++)
+      {
+         if (!images[j].ok || images[j].crc != crcs[j])
+         {
+            printf("%s: FAILED (threaded decode differs)\n", images[j].name);
+            failed = true;
+         }
+      }
+   }
+#endif
+
+   /* Encoding, on one thread and split between threads */
+   for (i = 0; i < (int)(sizeof(bench_levels) / sizeof(bench_levels[0])); i++)
+   {
+      unsigned k;
+      uint64_t size;
+      unsigned thread_counts[2];
+
+      thread_counts[0] = 1;
+      thread_counts[1] = threads;
+
+      for (k = 0; k < (threads > 1 ? 2u : 1u); k++)
+      {
+         unsigned t = thread_counts[k];
+
+         size = 0;
+         for (j = 0; j < num_images; j++)
+         {
+            uint64_t image_size = bench_encode(&images[j],
+                  bench_levels[i], t, true);
+            if (!image_size)
+            {
+               printf("%s: FAILED (level %d encode)\n",
+                     images[j].name, bench_levels[i]);
+               failed = true;
+            }
+            size += image_size;
+         }
+
+         passes = 0;
+         start  = bench_time();
+         do
+         {
+            for (j = 0; j < num_images; j++)
+               bench_encode(&images[j], bench_levels[i], t, false);
+            passes++;
+         } while ((elapsed = bench_time() - start) < BENCH_SECONDS);
+
+         printf("level %d %2u thread%s %9.1f MP/s %6.1f%% of raw size\n",
+               bench_levels[i], t, t == 1 ? " " : "s",
+               passes * (pixels / 1000000.0) / elapsed,
+               100.0 * size / (pixels * sizeof(uint32_t)));
+      }
+   }
+
+   for (i = 0; i < (int)num_images; i++)
+   {
+      free(images[i].data);
+      free(images[i].pixels);
+   }
+   free(images);
+   free(crcs);
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
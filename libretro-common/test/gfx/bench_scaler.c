@@ -0,0 +1,344 @@
+/* Copyright  (C) 2021 The RetroArch team
+ *
+ * ---------------------------------------------------------------------------------------
+ * The following license statement only applies to this file (bench_scaler.c).
+ * ---------------------------------------------------------------------------------------
+ *
+ * Permission is hereby granted, free of charge,
+ * to any person obtaining a copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation the rights to
+ * use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR IMPLIED,
+ * INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+ * IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+ */
+
+/* Throughput and accuracy benchmark for the software scaler.
+ *
+ * Every scaler type is run on upscales and a downscale,
+ * on the calling thread only and split between threads,
+ * to measure throughput in output megapixels per second.
+ *
+ * Each result is checked against a plain C version of the
+ * scaler's fixed-point filter: the threaded result has to
+ * match the single-threaded one exactly, and both have to be
+ * within BENCH_MAX_DIFF of the reference (SIMD sums may
+ * saturate in a different order than the reference does).
+ *
+ * Returns failure if a check fails, so that it can be run
+ * after changes to the scaler. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <gfx/scaler/scaler.h>
+#include <features/features_cpu.h>
+
+#define BENCH_SECONDS  1.0
+#define BENCH_MAX_DIFF 2
+
+typedef struct
+{
+   const char *name;
+   int in_width;
+   int in_height;
+   int out_width;
+   int out_height;
+} bench_case_t;
+
+static const bench_case_t bench_cases[] = {
+   { "up",     320,  240, 1280,  960 },
+   { "down",  1920, 1080,  640,  360 },
+   { "odd",    301,  203, 1366,  767 },
+};
+
+static const struct
+{
+   const char *name;
+   enum scaler_type type;
+} bench_types[] = {
+   { "point",    SCALER_TYPE_POINT    },
+   { "bilinear", SCALER_TYPE_BILINEAR },
+   { "sinc",     SCALER_TYPE_SINC     },
+   { "lanczos",  SCALER_TYPE_LANCZOS  },
+};
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* Gradients, with sharp edges and some noise, so that
+ * filters overshoot the way they do on real content. */
+static void bench_fill(uint32_t *frame, int width, int height)
+{
+   int x, y;
+   uint32_t seed = 1;
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint32_t r = (x * 255) / width;
+         uint32_t g = (y * 255) / height;
+         uint32_t b = (((x >> 3) ^ (y >> 3)) & 1) ? 0xff : 0x00;
+
+         seed       = seed * 1103515245u + 12345u;
+         if (((x >> 5) + (y >> 5)) & 1)
+            r       = (seed >> 16) & 0xff;
+
+         frame[y * width + x] = 0xff000000u | (r << 16) | (g << 8) | b;
+      }
+   }
+}
+
+static int16_t bench_adds(int16_t a, int b)
+{
+   int sum = a + b;
+   if (sum > 0x7fff)
+      return 0x7fff;
+   if (sum < -0x8000)
+      return -0x8000;
+   return (int16_t)sum;
+}
+
+/* Plain C version of the two passes, with the saturating
+ * sums of the SIMD code. */
+static void bench_reference(const struct scaler_ctx *ctx,
+      uint32_t *output, const uint32_t *input)
+{
+   int x, y, i, c;
+   int16_t *scaled = (int16_t*)malloc(
+         ctx->out_width * ctx->in_height * 4 * sizeof(int16_t));
+
+   if (!scaled)
+      return;
+
+   for (y = 0; y < ctx->in_height; y++)
+   {
+      for (x = 0; x < ctx->out_width; x++)
+      {
+         const int16_t *filter = ctx->horiz.filter
+            + x * ctx->horiz.filter_stride;
+         const uint32_t *in    = input + y * ctx->in_width
+            + ctx->horiz.filter_pos[x];
+
+         for (c = 0; c < 4; c++)
+         {
+            int16_t res = 0;
+            for (i = 0; i < ctx->horiz.filter_len; i++)
+            {
+               int16_t col = ((in[i] >> (c * 8)) & 0xff) << 7;
+               res         = bench_adds(res, (col * filter[i]) >> 16);
+            }
+            scaled[(y * ctx->out_width + x) * 4 + c] = res;
+         }
+      }
+   }
+
+   for (y = 0; y < ctx->out_height; y++)
+   {
+      const int16_t *filter = ctx->vert.filter
+         + y * ctx->vert.filter_stride;
+
+      for (x = 0; x < ctx->out_width; x++)
+      {
+         uint32_t col = 0;
+
+         for (c = 0; c < 4; c++)
+         {
+            int16_t res = 0;
+            for (i = 0; i < ctx->vert.filter_len; i++)
+            {
+               int row     = ctx->vert.filter_pos[y] + i;
+               res         = bench_adds(res, (scaled[(row
+                           * ctx->out_width + x) * 4 + c]
+                        * filter[i]) >> 16);
+            }
+            res  >>= (7 - 2 - 2);
+            col   |= (uint32_t)(res < 0 ? 0 : res > 0xff ? 0xff : res)
+               << (c * 8);
+         }
+
+         output[y * ctx->out_width + x] = col;
+      }
+   }
+
+   free(scaled);
+}
+
+/* Point sampling takes its own path, which doesn't use
+ * the filters. */
+static void bench_reference_point(const struct scaler_ctx *ctx,
+      uint32_t *output, const uint32_t *input)
+{
+   int x, y;
+   int x_pos  = (1 << 15) * ctx->in_width  / ctx->out_width  - (1 << 15);
+   int x_step = (1 << 16) * ctx->in_width  / ctx->out_width;
+   int y_pos  = (1 << 15) * ctx->in_height / ctx->out_height - (1 << 15);
+   int y_step = (1 << 16) * ctx->in_height / ctx->out_height;
+
+   if (x_pos < 0)
+      x_pos = 0;
+   if (y_pos < 0)
+      y_pos = 0;
+
+   for (y = 0; y < ctx->out_height; y++)
+      for (x = 0; x < ctx->out_width; x++)
+         output[y * ctx->out_width + x] = input[
+            ((y_pos + y * y_step) >> 16) * ctx->in_width
+               + ((x_pos + x * x_step) >> 16)];
+}
+
+static int bench_diff(const uint32_t *a, const uint32_t *b, size_t pixels)
+{
+   size_t i;
+   int c, max_diff = 0;
+
+   for (i = 0; i < pixels; i++)
+   {
+      for (c = 0; c < 32; c += 8)
+      {
+         int diff = (int)((a[i] >> c) & 0xff) - (int)((b[i] >> c) & 0xff);
+         if (diff < 0)
+            diff = -diff;
+         if (diff > max_diff)
+            max_diff = diff;
+      }
+   }
+
+   return max_diff;
+}
+
+static bool bench_init(struct scaler_ctx *ctx, const bench_case_t *bc,
+      enum scaler_type type, unsigned threads)
+{
+   memset(ctx, 0, sizeof(*ctx));
+
+   ctx->in_width    = bc->in_width;
+   ctx->in_height   = bc->in_height;
+   ctx->in_stride   = bc->in_width * sizeof(uint32_t);
+   ctx->in_fmt      = SCALER_FMT_ARGB8888;
+   ctx->out_width   = bc->out_width;
+   ctx->out_height  = bc->out_height;
+   ctx->out_stride  = bc->out_width * sizeof(uint32_t);
+   ctx->out_fmt     = SCALER_FMT_ARGB8888;
+   ctx->scaler_type = type;
+   ctx->threads     = threads;
+
+   return scaler_ctx_gen_filter(ctx);
+}
+
+/* Returns output megapixels per second. */
+static double bench_speed(struct scaler_ctx *ctx,
+      uint32_t *output, const uint32_t *input)
+{
+   double start, elapsed;
+   unsigned frames = 0;
+
+   start = bench_time();
+   do
+   {
+      scaler_ctx_scale(ctx, output, input);
+      frames++;
+      elapsed = bench_time() - start;
+   } while (elapsed < BENCH_SECONDS);
+
+   return (double)frames * ctx->out_width * ctx->out_height
+      / elapsed / 1000000.0;
+}
+
+int main(void)
+{
+   unsigned i, j;
+   bool failed      = false;
+   unsigned threads = cpu_features_get_core_amount();
+
+   /* Always exercise the threaded path */
+   if (threads < 2)
+      threads = 2;
+
+   printf("%-9s %-5s %11s %11s %11s %9s %9s\n", "scaler", "case",
+         "size", "1 thread", "threads", "vs ref", "threaded");
+
+   for (i = 0; i < sizeof(bench_types) / sizeof(bench_types[0]); i++)
+   {
+      for (j = 0; j < sizeof(bench_cases) / sizeof(bench_cases[0]); j++)
+      {
+         char size[32];
+         struct scaler_ctx ctx;
+         double speed_single, speed_threaded;
+         int diff_ref, diff_threaded;
+         const bench_case_t *bc = &bench_cases[j];
+         size_t out_pixels      = (size_t)bc->out_width * bc->out_height;
+         uint32_t *input        = (uint32_t*)malloc(
+               (size_t)bc->in_width * bc->in_height * sizeof(uint32_t));
+         uint32_t *ref          = (uint32_t*)malloc(out_pixels * sizeof(uint32_t));
+         uint32_t *single       = (uint32_t*)malloc(out_pixels * sizeof(uint32_t));
+         uint32_t *threaded     = (uint32_t*)malloc(out_pixels * sizeof(uint32_t));
+
+         if (!input || !ref || !single || !threaded)
+            return EXIT_FAILURE;
+
+         bench_fill(input, bc->in_width, bc->in_height);
+
+         if (!bench_init(&ctx, bc, bench_types[i].type, 1))
+         {
+            printf("%-9s %-5s  FAILED (init)\n", bench_types[i].name, bc->name);
+            return EXIT_FAILURE;
+         }
+         if (bench_types[i].type == SCALER_TYPE_POINT)
+            bench_reference_point(&ctx, ref, input);
+         else
+            bench_reference(&ctx, ref, input);
+         speed_single = bench_speed(&ctx, single, input);
+         scaler_ctx_gen_reset(&ctx);
+
+         if (!bench_init(&ctx, bc, bench_types[i].type, threads))
+         {
+            printf("%-9s %-5s  FAILED (init)\n", bench_types[i].name, bc->name);
+            return EXIT_FAILURE;
+         }
+         speed_threaded = bench_speed(&ctx, threaded, input);
+         scaler_ctx_gen_reset(&ctx);
+
+         diff_ref      = bench_diff(ref, single, out_pixels);
+         diff_threaded = bench_diff(single, threaded, out_pixels);
+
+         snprintf(size, sizeof(size), "%dx%d", bc->out_width, bc->out_height);
+         printf("%-9s %-5s %11s %11.1f %11.1f %9d %9d",
+               bench_types[i].name, bc->name, size,
+               speed_single, speed_threaded, diff_ref, diff_threaded);
+
+         if (diff_ref > BENCH_MAX_DIFF || diff_threaded != 0)
+         {
+            printf("  FAILED");
+            failed = true;
+         }
+         printf("\n");
+
+         free(input);
+         free(ref);
+         free(single);
+         free(threaded);
+      }
+   }
+
+   printf("Throughput in output megapixels per second, %u threads; "
+         "maximum channel difference to the reference and to 1 thread.\n",
+         threads);
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -298,6 +298,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_recording_toggle,      ME
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_streaming_toggle,      MENU_ENUM_SUBLABEL_INPUT_META_STREAMING_TOGGLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_runahead_toggle,       MENU_ENUM_SUBLABEL_INPUT_META_RUNAHEAD_TOGGLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_ai_service,            MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_replay_save,           MENU_ENUM_SUBLABEL_INPUT_META_REPLAY_SAVE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_meta_menu_toggle,           MENU_ENUM_SUBLABEL_INPUT_META_MENU_TOGGLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_hotkey_block_delay,         MENU_ENUM_SUBLABEL_INPUT_HOTKEY_BLOCK_DELAY)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_adc_type,                   MENU_ENUM_SUBLABEL_INPUT_ADC_TYPE)
@@ -334,7 +335,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_configurations_list_list,      MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_shared_context,          MENU_ENUM_SUBLABEL_VIDEO_SHARED_CONTEXT)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_driver_switch_enable,          MENU_ENUM_SUBLABEL_DRIVER_SWITCH_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_latency,                 MENU_ENUM_SUBLABEL_AUDIO_LATENCY)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_output_thread,           MENU_ENUM_SUBLABEL_AUDIO_OUTPUT_THREAD)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_rate_control_delta,      MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_DELTA)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_rate_control_pi,         MENU_ENUM_SUBLABEL_AUDIO_RATE_CONTROL_PI)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_mute,                    MENU_ENUM_SUBLABEL_AUDIO_MUTE)
 #ifdef HAVE_AUDIOMIXER
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_audio_mixer_mute,              MENU_ENUM_SUBLABEL_AUDIO_MIXER_MUTE)
@@ -531,6 +534,9 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_auto_load,           MENU_
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_thumbnail_enable,    MENU_ENUM_SUBLABEL_SAVESTATE_THUMBNAIL_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_save_file_compression,         MENU_ENUM_SUBLABEL_SAVE_FILE_COMPRESSION)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_file_compression,    MENU_ENUM_SUBLABEL_SAVESTATE_FILE_COMPRESSION)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_screenshot_compression_level,   MENU_ENUM_SUBLABEL_SCREENSHOT_COMPRESSION_LEVEL)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_record_replay_buffer,     MENU_ENUM_SUBLABEL_VIDEO_RECORD_REPLAY_BUFFER)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_video_record_segment_length,    MENU_ENUM_SUBLABEL_VIDEO_RECORD_SEGMENT_LENGTH)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_savestate_max_keep,            MENU_ENUM_SUBLABEL_SAVESTATE_MAX_KEEP)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_autosave_interval,             MENU_ENUM_SUBLABEL_AUTOSAVE_INTERVAL)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_input_remap_binds_enable,      MENU_ENUM_SUBLABEL_INPUT_REMAP_BINDS_ENABLE)
@@ -626,6 +632,7 @@ DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_ozone_sort_after_truncate_playlist_n
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_ozone_scroll_content_metadata,           MENU_ENUM_SUBLABEL_OZONE_SCROLL_CONTENT_METADATA)
 #endif
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_thumbnail_upscale_threshold,      MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD)
+DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_menu_thumbnail_cache_size,             MENU_ENUM_SUBLABEL_MENU_THUMBNAIL_CACHE_SIZE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_timedate_enable,                       MENU_ENUM_SUBLABEL_TIMEDATE_ENABLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_timedate_style,                        MENU_ENUM_SUBLABEL_TIMEDATE_STYLE)
 DEFAULT_SUBLABEL_MACRO(action_bind_sublabel_timedate_date_separator,               MENU_ENUM_SUBLABEL_TIMEDATE_DATE_SEPARATOR)
@@ -1894,6 +1901,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
             case RARCH_AI_SERVICE:
                BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_meta_ai_service);
                return 0;
+            case RARCH_REPLAY_SAVE:
+               BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_input_meta_replay_save);
+               return 0;
             default:
                break;
          }
@@ -2927,6 +2937,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_menu_thumbnail_upscale_threshold);
             break;
+         case MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_menu_thumbnail_cache_size);
+            break;
          case MENU_ENUM_LABEL_MOUSE_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_mouse_enable);
             break;
@@ -3149,6 +3162,15 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_SAVESTATE_FILE_COMPRESSION:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_file_compression);
             break;
+         case MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_screenshot_compression_level);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_RECORD_REPLAY_BUFFER:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_record_replay_buffer);
+            break;
+         case MENU_ENUM_LABEL_VIDEO_RECORD_SEGMENT_LENGTH:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_video_record_segment_length);
+            break;
          case MENU_ENUM_LABEL_SAVESTATE_AUTO_SAVE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_savestate_auto_save);
             break;
@@ -3649,6 +3671,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_rate_control_delta);
             break;
+         case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_rate_control_pi);
+            break;
          case MENU_ENUM_LABEL_AUDIO_MUTE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_mute);
             break;
@@ -3663,6 +3688,9 @@ int menu_cbs_init_bind_sublabel(menu_file_list_cbs_t *cbs,
          case MENU_ENUM_LABEL_AUDIO_LATENCY:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_latency);
             break;
+         case MENU_ENUM_LABEL_AUDIO_OUTPUT_THREAD:
+            BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_audio_output_thread);
+            break;
          case MENU_ENUM_LABEL_DRIVER_SWITCH_ENABLE:
             BIND_ACTION_SUBLABEL(cbs, action_bind_sublabel_driver_switch_enable);
             break;
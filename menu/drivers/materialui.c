@@ -3776,6 +3776,39 @@ static void materialui_render(void *data,
          break;
    }
 
+   /* Load thumbnails of the entries about to
+    * scroll into view */
+   if (entries_end > 0)
+   {
+      switch (mui->list_view_type)
+      {
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_SMALL:
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_MEDIUM:
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_LIST_LARGE:
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON:
+            gfx_thumbnail_prefetch(
+                  mui->thumbnail_path_data, mui->playlist,
+                  list->list[mui->first_onscreen_entry].entry_idx,
+                  list->list[mui->last_onscreen_entry].entry_idx,
+                  true,
+                  mui->secondary_thumbnail_enabled ||
+                        (mui->list_view_type == MUI_LIST_VIEW_PLAYLIST_THUMB_DUAL_ICON),
+                  thumbnail_upscale_threshold);
+            break;
+         case MUI_LIST_VIEW_PLAYLIST_THUMB_DESKTOP:
+            if (selection < entries_end)
+               gfx_thumbnail_prefetch(
+                     mui->thumbnail_path_data, mui->playlist,
+                     list->list[selection].entry_idx,
+                     list->list[selection].entry_idx,
+                     true, true,
+                     thumbnail_upscale_threshold);
+            break;
+         default:
+            break;
+      }
+   }
+
    menu_entries_ctl(MENU_ENTRIES_CTL_SET_START, &mui->first_onscreen_entry);
 }
 
@@ -10035,6 +10068,7 @@ static void materialui_list_insert(
       node->thumbnails.primary.alpha         = 0.0f;
       node->thumbnails.primary.delay_timer   = 0.0f;
       node->thumbnails.primary.fade_active   = false;
+      node->thumbnails.primary.cached        = false;
 
       node->thumbnails.secondary.status      = GFX_THUMBNAIL_STATUS_UNKNOWN;
       node->thumbnails.secondary.texture     = 0;
@@ -10043,6 +10077,7 @@ static void materialui_list_insert(
       node->thumbnails.secondary.alpha       = 0.0f;
       node->thumbnails.secondary.delay_timer = 0.0f;
       node->thumbnails.secondary.fade_active = false;
+      node->thumbnails.secondary.cached      = false;
    }
    else
    {
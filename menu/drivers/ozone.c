@@ -7094,6 +7094,15 @@ static void ozone_update_thumbnail_image(void *data)
          gfx_thumbnail_upscale_threshold,
          network_on_demand_thumbnails);
    }
+
+   /* Load thumbnails of the next entries in
+    * the direction of navigation */
+   if (ozone->is_playlist)
+      gfx_thumbnail_prefetch(
+            ozone->thumbnail_path_data,
+            playlist, selection, selection,
+            true, !ozone->selection_core_is_viewer,
+            gfx_thumbnail_upscale_threshold);
 }
 
 static void ozone_refresh_thumbnail_image(void *data, unsigned i)
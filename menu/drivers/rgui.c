@@ -2417,8 +2417,11 @@ static bool request_thumbnail(
       {
          /* Would like to cancel any existing image load tasks
           * here, but can't see how to do it... */
-         if (task_push_image_load(thumbnail->path,
+         /* Stored at the size RGUI draws it, which
+          * makes the downscale on upload a no-op */
+         if (task_push_image_load_cached(thumbnail->path,
                   video_driver_supports_rgba(), 0,
+                  thumbnail->max_width, thumbnail->max_height,
                   (thumbnail_id == GFX_THUMBNAIL_LEFT) ?
             menu_display_handle_left_thumbnail_upload 
             : menu_display_handle_thumbnail_upload, NULL))
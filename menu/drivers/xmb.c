@@ -1270,6 +1270,14 @@ static void xmb_update_thumbnail_image(void *data)
          &xmb->thumbnails.left,
          thumbnail_upscale_threshold,
          network_on_demand_thumbnails);
+
+      /* Load thumbnails of the next entries in
+       * the direction of navigation */
+      if (xmb->is_playlist)
+         gfx_thumbnail_prefetch(
+               xmb->thumbnail_path_data,
+               playlist, selection, selection,
+               true, true, thumbnail_upscale_threshold);
    }
 }
 
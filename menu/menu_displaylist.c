@@ -132,15 +132,39 @@
 #endif
 #endif
 
+/* Number of directory entries the file browser reads
+ * per batch. The first batch is read in place, the rest
+ * of a larger directory on the task queue */
+#define FILEBROWSER_DIR_BATCH_ENTRIES 1024
+
 /* TODO/FIXME - globals - need to find a way to
  * get rid of these */
 struct menu_displaylist_state
 {
+   /* Listing of a large directory, growing as batches
+    * are read on the task queue. Only its first
+    * filebrowser_dir_sorted entries are sorted until the
+    * last batch has arrived. The stream is set while a
+    * batch is being read */
+   struct string_list *filebrowser_dir_list;
+   dir_list_stream_t *filebrowser_dir_stream;
+   size_t filebrowser_dir_sorted;
+   /* Streams with a batch on the task queue, including
+    * superseded ones */
+   unsigned filebrowser_dir_pending;
+   char filebrowser_dir_path[PATH_MAX_LENGTH];
    enum filebrowser_enums filebrowser_types;
+   bool filebrowser_dir_failed;
 };
 
 static struct menu_displaylist_state menu_displist_st = {
-   FILEBROWSER_NONE /* filebrowser_types */
+   NULL,              /* filebrowser_dir_list */
+   NULL,              /* filebrowser_dir_stream */
+   0,                 /* filebrowser_dir_sorted */
+   0,                 /* filebrowser_dir_pending */
+   {0},               /* filebrowser_dir_path */
+   FILEBROWSER_NONE,  /* filebrowser_types */
+   false              /* filebrowser_dir_failed */
 };
 
 extern struct key_desc key_descriptors[RARCH_MAX_KEYS];
@@ -163,6 +187,214 @@ void filebrowser_set_type(enum filebrowser_enums type)
    p_displist->filebrowser_types = type;
 }
 
+static void filebrowser_dir_reset(
+      struct menu_displaylist_state *p_displist)
+{
+   dir_list_free(p_displist->filebrowser_dir_list);
+   /* A pending batch frees its stream once it
+    * finds it has been superseded */
+   p_displist->filebrowser_dir_list    = NULL;
+   p_displist->filebrowser_dir_stream  = NULL;
+   p_displist->filebrowser_dir_sorted  = 0;
+   p_displist->filebrowser_dir_path[0] = '\0';
+   p_displist->filebrowser_dir_failed  = false;
+}
+
+static bool filebrowser_dir_is_pending(void *data)
+{
+   struct menu_displaylist_state *p_displist =
+      (struct menu_displaylist_state*)data;
+   return p_displist->filebrowser_dir_pending > 0;
+}
+
+void filebrowser_free(void)
+{
+   struct menu_displaylist_state *p_displist = &menu_displist_st;
+
+   filebrowser_dir_reset(p_displist);
+
+   /* Batches being read still use their streams. Each
+    * is freed by its callback once found superseded */
+   if (p_displist->filebrowser_dir_pending)
+      task_queue_wait(filebrowser_dir_is_pending, p_displist);
+}
+
+static void filebrowser_dir_list_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   struct menu_displaylist_state *p_displist = &menu_displist_st;
+   dir_list_batch_t *batch                   = (dir_list_batch_t*)task_data;
+   dir_list_stream_t *stream                 = (dir_list_stream_t*)user_data;
+   struct string_list *list                  = p_displist->filebrowser_dir_list;
+   const char *menu_path                     = NULL;
+   bool done                                 = true;
+
+   /* Discard batches of a superseded directory */
+   if (stream != p_displist->filebrowser_dir_stream)
+   {
+      dir_list_batch_free(batch);
+      dir_list_stream_free(stream);
+      p_displist->filebrowser_dir_pending--;
+      return;
+   }
+
+   if (batch && batch->list)
+   {
+      size_t i;
+
+      /* Batches are only appended here. The listing is
+       * sorted once, when the last batch has arrived */
+      for (i = 0; i < batch->list->size; i++)
+         if (!string_list_append(list, batch->list->elems[i].data,
+                  batch->list->elems[i].attr))
+            break;
+
+      /* If an entry cannot be added or the next batch
+       * cannot be pushed, keep what has been read so far */
+      done = i < batch->list->size
+         || batch->end
+         || !task_push_dir_list(stream, FILEBROWSER_DIR_BATCH_ENTRIES,
+               filebrowser_dir_list_cb, stream);
+
+      if (done)
+         dir_list_sort_merge(list,
+               p_displist->filebrowser_dir_sorted, true);
+   }
+   else
+   {
+      /* Remember the failure, so that the refresh below
+       * shows an error instead of reading the directory
+       * again */
+      dir_list_free(list);
+      p_displist->filebrowser_dir_list   = NULL;
+      p_displist->filebrowser_dir_failed = true;
+   }
+
+   dir_list_batch_free(batch);
+
+   if (!done)
+      return;
+
+   dir_list_stream_free(stream);
+   p_displist->filebrowser_dir_stream = NULL;
+   p_displist->filebrowser_dir_pending--;
+
+   /* Refresh the file browser once, if it still
+    * shows this directory */
+   menu_entries_get_last_stack(&menu_path, NULL, NULL, NULL, NULL);
+   if (string_is_equal(menu_path, p_displist->filebrowser_dir_path))
+   {
+      bool refresh = false;
+      menu_entries_ctl(MENU_ENTRIES_CTL_SET_REFRESH, &refresh);
+      menu_driver_ctl(RARCH_MENU_CTL_SET_PREVENT_POPULATE, NULL);
+   }
+}
+
+/**
+ * filebrowser_read_dir:
+ *
+ * Reads directory @path into @list, sorted with
+ * directories first. Small directories are read
+ * in place. Larger ones are shown as soon as the
+ * first FILEBROWSER_DIR_BATCH_ENTRIES have been
+ * read: the rest is read on the task queue, @loading
+ * is set and the file browser is refreshed once the
+ * whole directory has been read.
+ *
+ * Returns: false if the directory could not be read.
+ **/
+static bool filebrowser_read_dir(
+      struct menu_displaylist_state *p_displist,
+      struct string_list *list,
+      const char *path, const char *exts,
+      bool show_hidden_files, bool include_compressed,
+      bool *loading)
+{
+   int ret;
+   struct string_list *dir_list = NULL;
+   dir_list_stream_t *stream    = NULL;
+
+   if (string_is_equal(p_displist->filebrowser_dir_path, path))
+   {
+      if (p_displist->filebrowser_dir_failed)
+         return false;
+
+      if ((dir_list = p_displist->filebrowser_dir_list))
+      {
+         /* Still reading - show a sorted copy of
+          * what has been read so far */
+         if (p_displist->filebrowser_dir_stream)
+         {
+            if (!(dir_list = string_list_clone(dir_list)))
+               return false;
+            dir_list_sort_merge(dir_list,
+                  p_displist->filebrowser_dir_sorted, true);
+            *list    = *dir_list;
+            *loading = true;
+            free(dir_list);
+            return true;
+         }
+
+         /* Complete - consume the listing, so that the
+          * next visit reads the directory again */
+         p_displist->filebrowser_dir_list = NULL;
+         *list                            = *dir_list;
+         free(dir_list);
+         filebrowser_dir_reset(p_displist);
+         return true;
+      }
+   }
+
+   filebrowser_dir_reset(p_displist);
+
+   if (!(stream = dir_list_stream_new(path, exts, true,
+               show_hidden_files, include_compressed)))
+      return false;
+
+   if (!string_list_initialize(list))
+   {
+      dir_list_stream_free(stream);
+      return false;
+   }
+
+   ret = dir_list_stream_read(stream, list, FILEBROWSER_DIR_BATCH_ENTRIES);
+
+   if (ret > 0)
+   {
+      /* Large directory - show the first batch now
+       * and read the rest in the background */
+      dir_list_sort(list, true);
+
+      if (     (dir_list = string_list_clone(list))
+            && task_push_dir_list(stream, FILEBROWSER_DIR_BATCH_ENTRIES,
+               filebrowser_dir_list_cb, stream))
+      {
+         p_displist->filebrowser_dir_list   = dir_list;
+         p_displist->filebrowser_dir_stream = stream;
+         p_displist->filebrowser_dir_sorted = dir_list->size;
+         p_displist->filebrowser_dir_pending++;
+         strlcpy(p_displist->filebrowser_dir_path, path,
+               sizeof(p_displist->filebrowser_dir_path));
+         *loading                           = true;
+         return true;
+      }
+
+      string_list_free(dir_list);
+
+      /* Unable to push task - read the rest in place */
+      while ((ret = dir_list_stream_read(stream, list,
+                  FILEBROWSER_DIR_BATCH_ENTRIES)) > 0);
+   }
+
+   dir_list_stream_free(stream);
+
+   if (ret < 0)
+      return false;
+
+   dir_list_sort(list, true);
+   return true;
+}
+
 static void filebrowser_parse(
       menu_displaylist_info_t *info,
       unsigned type_data,
@@ -174,7 +406,10 @@ static void filebrowser_parse(
 {
    size_t i, list_size;
    const struct retro_subsystem_info *subsystem = NULL;
+   struct menu_displaylist_state *p_displist    = &menu_displist_st;
    bool ret                                     = false;
+   bool list_sorted                             = false;
+   bool loading                                 = false;
    struct string_list str_list                  = {0};
    unsigned items_found                         = 0;
    enum menu_displaylist_ctl_state type         = (enum menu_displaylist_ctl_state)type_data;
@@ -232,13 +467,17 @@ static void filebrowser_parse(
                   filter_ext ? subsystem->roms[content_get_subsystem_rom_id()].valid_extensions : NULL,
                   true, show_hidden_files, true, false);
       }
-      else if ((info->type_default == FILE_TYPE_MANUAL_SCAN_DAT) || (info->type_default == FILE_TYPE_SIDELOAD_CORE))
-         ret = dir_list_initialize(&str_list, path,
-               info->exts, true, show_hidden_files, false, false);
       else
-         ret = dir_list_initialize(&str_list, path,
-               filter_ext ? info->exts : NULL,
-               true, show_hidden_files, true, false);
+      {
+         if ((info->type_default == FILE_TYPE_MANUAL_SCAN_DAT) || (info->type_default == FILE_TYPE_SIDELOAD_CORE))
+            ret = filebrowser_read_dir(p_displist, &str_list, path,
+                  info->exts, show_hidden_files, false, &loading);
+         else
+            ret = filebrowser_read_dir(p_displist, &str_list, path,
+                  filter_ext ? info->exts : NULL,
+                  show_hidden_files, true, &loading);
+         list_sorted = true;
+      }
    }
 
    switch (filebrowser_type)
@@ -274,6 +513,9 @@ static void filebrowser_parse(
    {
       const char *str = path_is_compressed
          ? msg_hash_to_str(MENU_ENUM_LABEL_VALUE_UNABLE_TO_READ_COMPRESSED_FILE)
+         : (    p_displist->filebrowser_dir_failed
+             && string_is_equal(p_displist->filebrowser_dir_path, path))
+         ? msg_hash_to_str(MSG_ERROR_READING_DIRECTORY)
          : msg_hash_to_str(MENU_ENUM_LABEL_VALUE_DIRECTORY_NOT_FOUND);
 
       menu_entries_append_enum(info->list, str, "",
@@ -281,7 +523,8 @@ static void filebrowser_parse(
       goto end;
    }
 
-   dir_list_sort(&str_list, true);
+   if (!list_sorted)
+      dir_list_sort(&str_list, true);
 
    list_size = str_list.size;
 
@@ -430,7 +673,14 @@ static void filebrowser_parse(
 
    dir_list_deinitialize(&str_list);
 
-   if (items_found == 0)
+   /* More entries are still being read */
+   if (loading)
+      menu_entries_append_enum(info->list,
+            msg_hash_to_str(MSG_READING_DIRECTORY),
+            msg_hash_to_str(MENU_ENUM_LABEL_NO_ITEMS),
+            MENU_ENUM_LABEL_NO_ITEMS,
+            MENU_SETTING_NO_ITEM, 0, 0);
+   else if (items_found == 0)
    {
       menu_entries_append_enum(info->list,
             msg_hash_to_str(MENU_ENUM_LABEL_VALUE_NO_ITEMS),
@@ -5981,6 +6231,10 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_LATENCY,
                   PARSE_ONLY_UINT, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_OUTPUT_THREAD,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
          if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
                   MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE,
                   PARSE_ONLY_BOOL, false) == 0)
@@ -6011,6 +6265,10 @@ unsigned menu_displaylist_build_list(
                   MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_DELTA,
                   PARSE_ONLY_FLOAT, false) == 0)
             count++;
+         if (MENU_DISPLAYLIST_PARSE_SETTINGS_ENUM(list,
+                  MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+                  PARSE_ONLY_BOOL, false) == 0)
+            count++;
          break;
       case DISPLAYLIST_AUDIO_SETTINGS_LIST:
       {
@@ -7592,6 +7850,8 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_VIDEO_RECORD_QUALITY,                                  PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_RECORD_CONFIG,                                         PARSE_ONLY_PATH,   true},
                {MENU_ENUM_LABEL_VIDEO_RECORD_THREADS,                                  PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_VIDEO_RECORD_REPLAY_BUFFER,                            PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_VIDEO_RECORD_SEGMENT_LENGTH,                           PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_VIDEO_POST_FILTER_RECORD,                              PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_VIDEO_GPU_RECORD,                                      PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_STREAMING_MODE,                                        PARSE_ONLY_UINT,   true},
@@ -8725,6 +8985,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_SAVESTATES_IN_CONTENT_DIR_ENABLE,   PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SYSTEMFILES_IN_CONTENT_DIR_ENABLE,  PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_SCREENSHOTS_IN_CONTENT_DIR_ENABLE,  PARSE_ONLY_BOOL, true},
+               {MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL,       PARSE_ONLY_UINT, true},
                {MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG,                PARSE_ONLY_BOOL, true},
                {MENU_ENUM_LABEL_CONTENT_RUNTIME_LOG_AGGREGATE,      PARSE_ONLY_BOOL, true},
             };
@@ -9408,6 +9669,7 @@ unsigned menu_displaylist_build_list(
                {MENU_ENUM_LABEL_XMB_VERTICAL_THUMBNAILS,                      PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_XMB_THUMBNAIL_SCALE_FACTOR,              PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_THUMBNAIL_UPSCALE_THRESHOLD,             PARSE_ONLY_UINT,   true},
+               {MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,                    PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_SWAP_THUMBNAILS,                    PARSE_ONLY_BOOL,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DOWNSCALER,               PARSE_ONLY_UINT,   true},
                {MENU_ENUM_LABEL_MENU_RGUI_THUMBNAIL_DELAY,                    PARSE_ONLY_UINT,   true},
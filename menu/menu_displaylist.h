@@ -347,6 +347,9 @@ void filebrowser_clear_type(void);
 
 void filebrowser_set_type(enum filebrowser_enums type);
 
+/* Frees the listing of a directory still being read */
+void filebrowser_free(void);
+
 int menu_displaylist_parse_settings_enum(
       file_list_t *info_list,
       enum menu_displaylist_parse_type parse_type,
@@ -2155,6 +2155,10 @@ void menu_input_get_touchscreen_hw_state(
 
 void menu_entries_settings_deinit(struct menu_state *menu_st)
 {
+   menu_setting_index_free(menu_st->entries.list_settings_map);
+   menu_setting_index_free(menu_st->entries.list_settings_enum_map);
+   menu_st->entries.list_settings_map      = NULL;
+   menu_st->entries.list_settings_enum_map = NULL;
    menu_setting_free(menu_st->entries.list_settings);
    if (menu_st->entries.list_settings)
       free(menu_st->entries.list_settings);
@@ -3309,6 +3313,10 @@ bool menu_entries_init(
       return false;
    if (!(menu_st->entries.list_settings = menu_setting_new()))
       return false;
+   menu_st->entries.list_settings_map      = menu_setting_index_name_new(
+         menu_st->entries.list_settings);
+   menu_st->entries.list_settings_enum_map = menu_setting_index_enum_new(
+         menu_st->entries.list_settings);
    return true;
 }
 
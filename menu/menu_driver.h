@@ -442,6 +442,10 @@ struct menu_state
    struct
    {
       rarch_setting_t *list_settings;
+      /* Lookup maps into list_settings,
+       * see menu_setting_find() */
+      rarch_setting_t **list_settings_map;
+      rarch_setting_t **list_settings_enum_map;
       menu_list_t *list;
       size_t begin;
    } entries;
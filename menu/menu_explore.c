@@ -21,15 +21,28 @@
 #include "../configuration.h"
 #include "../playlist.h"
 #include "../libretro-db/libretrodb.h"
-#include <compat/strcasestr.h>
+#include "../verbosity.h"
 #include <compat/strl.h>
 #include <array/rbuf.h>
 #include <array/rhmap.h>
+#include <encodings/crc32.h>
+#include <file/file_path.h>
+#include <queues/task_queue.h>
+#include <streams/file_stream.h>
+#include <retro_endianness.h>
 
 #define EX_ARENA_ALIGNMENT 8
 #define EX_ARENA_BLOCK_SIZE (64 * 1024)
 #define EX_ARENA_ALIGN_UP(n, a) (((n) + (a) - 1) & ~((a) - 1))
 
+#define EXPLORE_CACHE_FILE_NAME "explore.cache"
+#define EXPLORE_CACHE_MAGIC     0x50584552 /* 'REXP' */
+#define EXPLORE_CACHE_VERSION   2
+#define EXPLORE_CACHE_NONE      0xFFFFFFFF
+
+/* Labels indexed per search index task iteration */
+#define EXPLORE_SEARCH_INDEX_BATCH 1024
+
 /* Explore */
 enum
 {
@@ -79,6 +92,8 @@ typedef struct
 #ifdef EXPLORE_SHOW_ORIGINAL_TITLE
    char* original_title;
 #endif
+   /* Without database match, only listed by search */
+   bool search_only;
 } explore_entry_t;
 
 typedef struct 
@@ -88,15 +103,77 @@ typedef struct
    explore_entry_t *entries;
    playlist_t **playlists;
    uintptr_t *icons;
+   /* trigram -> RBUF of entry indices, NULL
+    * until built by the search index task */
+   uint32_t **search_index;
    const char *label_explore_item_str;
    unsigned top_depth;
    unsigned show_icons;
+   unsigned search_gen;
+   unsigned playlist_gen;
 
    char title[1024];
    char find_string[1024];
    bool has_unknown[EXPLORE_CAT_COUNT];
 } explore_state_t;
 
+typedef struct
+{
+   uint32_t **index;
+   char *labels;   /* RBUF of the labels of all entries,
+                    * each NUL terminated */
+   size_t pos;     /* offset of the next label to index */
+   uint32_t count;
+   uint32_t next;  /* index of the next label */
+   unsigned gen;
+} explore_search_task_t;
+
+typedef struct
+{
+   uint32_t idx;
+   uint32_t score;
+} explore_search_hit_t;
+
+/* Category strings plus original title */
+#define EXPLORE_CACHE_FIELDS (EXPLORE_CAT_COUNT + 1)
+/* Playlist index plus fields */
+#define EXPLORE_CACHE_STRIDE (1 + EXPLORE_CACHE_FIELDS)
+
+typedef struct
+{
+   uint32_t size;
+   /* Modification time, or CRC32 where
+    * the platform provides none */
+   uint32_t stamp;
+} explore_cache_key_t;
+
+typedef struct
+{
+   const char *path;
+   explore_cache_key_t key;
+} explore_cache_rdb_t;
+
+/* RDB matches of a single playlist */
+typedef struct
+{
+   const char *path;
+   explore_cache_rdb_t *rdbs;
+   const char **strings;
+   uint32_t *string_map;
+   /* EXPLORE_CACHE_STRIDE values per entry, strings
+    * given as index or EXPLORE_CACHE_NONE */
+   uint32_t *entries;
+   explore_cache_key_t key;
+   bool valid;
+} explore_cache_playlist_t;
+
+typedef struct
+{
+   const uint8_t *ptr;
+   const uint8_t *end;
+   bool error;
+} explore_cache_reader_t;
+
 static const struct
 {
    const char* rdbkey;
@@ -119,6 +196,8 @@ explore_by_info[EXPLORE_CAT_COUNT] =
 
 /* TODO/FIXME - static global */
 static explore_state_t* explore_state;
+static unsigned explore_search_gen;
+static unsigned explore_search_pending;
 
 static void ex_arena_grow(ex_arena *arena, size_t min_size)
 {
@@ -202,6 +281,15 @@ static int explore_qsort_func_menulist(const void *a_, const void *b_)
    return strcasecmp(a->path, b->path);
 }
 
+static int explore_qsort_func_search_hits(const void *a_, const void *b_)
+{
+   const explore_search_hit_t *a = (const explore_search_hit_t*)a_;
+   const explore_search_hit_t *b = (const explore_search_hit_t*)b_;
+   if (a->score != b->score)
+      return (a->score > b->score ? -1 : 1);
+   return (a->idx < b->idx ? -1 : (a->idx > b->idx ? 1 : 0));
+}
+
 static int explore_check_company_suffix(const char* p, bool search_reverse)
 {
    int p0, p0_lc, p1, p1_lc, p2, p2_lc;
@@ -329,6 +417,15 @@ static void explore_unload_icons(explore_state_t *state)
          video_driver_texture_unload(&state->icons[i]);
 }
 
+static void explore_search_index_free(uint32_t **index)
+{
+   size_t i;
+   for (i = 0; i != RHMAP_CAP(index); i++)
+      if (RHMAP_KEY(index, i))
+         RBUF_FREE(index[i]);
+   RHMAP_FREE(index);
+}
+
 static void explore_free(explore_state_t *state)
 {
    unsigned i;
@@ -339,6 +436,8 @@ static void explore_free(explore_state_t *state)
 
    RBUF_FREE(state->entries);
 
+   explore_search_index_free(state->search_index);
+
    for (i = 0; i != RBUF_LEN(state->playlists); i++)
       playlist_free(state->playlists[i]);
    RBUF_FREE(state->playlists);
@@ -349,6 +448,292 @@ static void explore_free(explore_state_t *state)
    ex_arena_free(&state->arena);
 }
 
+/* Lower cases ASCII letters and collapses any run of other
+ * characters except digits into a single space. Bytes of
+ * multibyte UTF-8 characters are kept as they are. */
+static size_t explore_search_normalize(const char *str,
+      char *s, size_t len)
+{
+   size_t _len = 0;
+   bool  space = true;
+   for (; *str && _len + 1 < len; str++)
+   {
+      unsigned char c = (unsigned char)*str;
+      if (c >= 'A' && c <= 'Z')
+         c |= 0x20;
+      if (     (c >= 'a' && c <= 'z')
+            || (c >= '0' && c <= '9')
+            || (c >= 0x80))
+      {
+         s[_len++] = (char)c;
+         space     = false;
+      }
+      else if (!space)
+      {
+         s[_len++] = ' ';
+         space     = true;
+      }
+   }
+   if (_len && s[_len - 1] == ' ')
+      _len--;
+   s[_len] = '\0';
+   return _len;
+}
+
+#define EXPLORE_SEARCH_TRIGRAM(p) \
+   (((uint32_t)(unsigned char)(p)[0] << 16) \
+  | ((uint32_t)(unsigned char)(p)[1] <<  8) \
+  |  (uint32_t)(unsigned char)(p)[2])
+
+static void explore_search_index_add(uint32_t ***index,
+      uint32_t idx, const char *str)
+{
+   char label[512];
+   size_t j, _len = explore_search_normalize(str, label, sizeof(label));
+
+   for (j = 0; j + 3 <= _len; j++)
+   {
+      uint32_t **bucket;
+      uint32_t key = EXPLORE_SEARCH_TRIGRAM(label + j);
+
+      if (!RHMAP_HAS(*index, key))
+         RHMAP_SET(*index, key, NULL);
+      bucket = RHMAP_PTR(*index, key);
+
+      /* Entries are indexed in order, so a trigram repeated
+       * within a label can only match the last bucket item */
+      if (     RBUF_LEN(*bucket)
+            && (*bucket)[RBUF_LEN(*bucket) - 1] == idx)
+         continue;
+      RBUF_PUSH(*bucket, idx);
+   }
+}
+
+static void explore_search_task_free(explore_search_task_t *st)
+{
+   explore_search_index_free(st->index);
+   RBUF_FREE(st->labels);
+   free(st);
+}
+
+static void explore_search_index_handler(retro_task_t *task)
+{
+   uint32_t end;
+   explore_search_task_t *st = (explore_search_task_t*)task->state;
+
+   if (task_get_cancelled(task))
+      goto task_finished;
+
+   end = st->next + EXPLORE_SEARCH_INDEX_BATCH;
+   if (end > st->count)
+      end = st->count;
+
+   for (; st->next != end; st->next++)
+   {
+      const char *label = st->labels + st->pos;
+      explore_search_index_add(&st->index, st->next, label);
+      st->pos          += strlen(label) + 1;
+   }
+
+   if (st->next != st->count)
+      return;
+
+task_finished:
+   /* Ownership of the index passes to the callback */
+   task_set_data(task, st);
+   task->state = NULL;
+   task_set_finished(task, true);
+}
+
+static void explore_search_index_cb(retro_task_t *task,
+      void *task_data, void *user_data, const char *error)
+{
+   explore_search_task_t *st = (explore_search_task_t*)task_data;
+
+   explore_search_pending--;
+
+   if (!st)
+      return;
+
+   /* Discard the index of a rebuilt or freed list */
+   if (     explore_state
+         && explore_state->search_gen == st->gen
+         && st->next == st->count
+         && !explore_state->search_index)
+   {
+      explore_state->search_index = st->index;
+      st->index                   = NULL;
+   }
+
+   explore_search_task_free(st);
+}
+
+static bool explore_search_is_pending(void *data)
+{
+   return explore_search_pending > 0;
+}
+
+/* Builds the search index of all entries on the task
+ * queue. Labels are copied, as the list can be freed
+ * while the task runs; until the index is installed,
+ * searches fall back to matching substrings only. */
+static void explore_search_index_push(explore_state_t *state)
+{
+   uint32_t i;
+   retro_task_t *task        = NULL;
+   explore_search_task_t *st = NULL;
+   uint32_t count            = (uint32_t)RBUF_LEN(state->entries);
+
+   state->search_gen         = ++explore_search_gen;
+
+   if (!count)
+      return;
+
+   if (!(st = (explore_search_task_t*)calloc(1, sizeof(*st))))
+      return;
+
+   for (i = 0; i != count; i++)
+   {
+      const char *label = state->entries[i].playlist_entry->label;
+      size_t len        = strlen(label) + 1;
+      size_t pos        = RBUF_LEN(st->labels);
+      RBUF_RESIZE(st->labels, pos + len);
+      memcpy(st->labels + pos, label, len);
+   }
+
+   st->count = count;
+   st->gen   = state->search_gen;
+
+   if (!(task = task_init()))
+   {
+      explore_search_task_free(st);
+      return;
+   }
+
+   task->handler  = explore_search_index_handler;
+   task->state    = st;
+   task->callback = explore_search_index_cb;
+   task->mute     = true;
+   task->progress = -1;
+
+   explore_search_pending++;
+   task_queue_push(task);
+}
+
+static uint32_t explore_search_score(const char *label,
+      const char *query, size_t query_len)
+{
+   const char *found;
+   if (!strncmp(label, query, query_len))
+      return 3;
+   for (found = strstr(label, query); found;
+         found = strstr(found + 1, query))
+      if (found[-1] == ' ')
+         return 2;
+   return (strstr(label, query) ? 1 : 0);
+}
+
+/**
+ * explore_search:
+ * @state : explore state.
+ * @find  : search string.
+ *
+ * Matches @find against the labels of all entries. Entries
+ * containing the search string rank highest (before all when
+ * it starts the label, then at the start of a word), followed
+ * by entries sharing most of its trigrams, which allows for
+ * small typos once the search index has been built. Equally
+ * ranked entries keep the alphabetical order of the entries.
+ *
+ * Returns: RBUF of matching entry indices, in rank order.
+ * Has to be freed with RBUF_FREE.
+ **/
+static uint32_t *explore_search(explore_state_t *state, const char *find)
+{
+   char label[512];
+   char query[512];
+   uint32_t i;
+   explore_search_hit_t *hits = NULL;
+   uint32_t *found            = NULL;
+   uint16_t *counts           = NULL;
+   uint32_t min_count         = 0;
+   uint32_t count             = (uint32_t)RBUF_LEN(state->entries);
+   size_t query_len           = explore_search_normalize(
+         find, query, sizeof(query));
+
+   if (!query_len || !count)
+      return NULL;
+
+   /* Shorter queries have no trigrams, so they (and all queries
+    * while the index is being built) can only match as
+    * substrings of all labels */
+   if (query_len >= 3 && state->search_index)
+   {
+      size_t j;
+      uint32_t query_trigrams = 0;
+
+      if (!(counts = (uint16_t*)calloc(count, sizeof(*counts))))
+         return NULL;
+
+      for (j = 0; j + 3 <= query_len; j++)
+      {
+         size_t k;
+         uint32_t *bucket;
+         uint32_t key = EXPLORE_SEARCH_TRIGRAM(query + j);
+
+         /* Count repeated query trigrams only once */
+         for (k = 0; k != j; k++)
+            if (EXPLORE_SEARCH_TRIGRAM(query + k) == key)
+               break;
+         if (k != j)
+            continue;
+
+         query_trigrams++;
+         if (!(bucket = RHMAP_GET(state->search_index, key)))
+            continue;
+         for (k = 0; k != RBUF_LEN(bucket); k++)
+            if (counts[bucket[k]] != 0xFFFF)
+               counts[bucket[k]]++;
+      }
+
+      /* Tolerate one missing trigram out of three */
+      min_count = query_trigrams - query_trigrams / 3;
+   }
+
+   for (i = 0; i != count; i++)
+   {
+      explore_search_hit_t hit;
+
+      if (counts && !counts[i])
+         continue;
+
+      explore_search_normalize(state->entries[i].playlist_entry->label,
+            label, sizeof(label));
+
+      hit.idx   = i;
+      hit.score = explore_search_score(label, query, query_len) << 16;
+      if (!hit.score)
+      {
+         if (!counts || counts[i] < min_count)
+            continue;
+         hit.score = counts[i];
+      }
+      RBUF_PUSH(hits, hit);
+   }
+
+   free(counts);
+
+   qsort(hits, RBUF_LEN(hits), sizeof(*hits),
+         explore_qsort_func_search_hits);
+
+   RBUF_RESIZE(found, RBUF_LEN(hits));
+   for (i = 0; i != RBUF_LEN(hits); i++)
+      found[i] = hits[i].idx;
+   RBUF_FREE(hits);
+
+   return found;
+}
+
 static void explore_load_icons(explore_state_t *state)
 {
    char path[PATH_MAX_LENGTH];
@@ -399,24 +784,454 @@ static void explore_load_icons(explore_state_t *state)
    }
 }
 
+/* Explore cache
+ *
+ * Matching playlist entries against the RDBs is by far the
+ * most expensive part of building the explore view, so the
+ * matches of each playlist are stored in a cache file along
+ * with the raw category strings, and only playlists which
+ * changed since (or whose RDBs changed) are matched again.
+ *
+ * Playlists and RDBs are identified by file size and
+ * modification time, so checking them costs no more than a
+ * stat(). Only on platforms without a modification time is
+ * the whole file read to compute a CRC32 instead. */
+static explore_cache_key_t explore_cache_file_key(const char *path)
+{
+   explore_cache_key_t key;
+   int32_t size = path_get_size(path);
+
+   key.size     = 0;
+   key.stamp    = 0;
+
+   if (size > 0)
+   {
+      key.size  = (uint32_t)size;
+      if (!(key.stamp = (uint32_t)path_get_mtime(path)))
+         key.stamp = file_crc32(0, path);
+   }
+
+   return key;
+}
+
+static bool explore_cache_key_equal(
+      const explore_cache_key_t *a, const explore_cache_key_t *b)
+{
+   return a->size == b->size && a->stamp == b->stamp;
+}
+
+/* RDBs are shared by many playlists, so their keys are
+ * computed only once per build */
+static explore_cache_key_t explore_cache_rdb_key(
+      explore_cache_key_t **rdb_keys, const char *path)
+{
+   if (!RHMAP_HAS_STR(*rdb_keys, path))
+   {
+      explore_cache_key_t key = explore_cache_file_key(path);
+      RHMAP_SET_STR(*rdb_keys, path, key);
+   }
+   return RHMAP_GET_STR(*rdb_keys, path);
+}
+
+static uint32_t explore_cache_read_u32(explore_cache_reader_t *r)
+{
+   uint32_t val;
+
+   if (r->error || r->end - r->ptr < 4)
+   {
+      r->error = true;
+      return 0;
+   }
+
+   memcpy(&val, r->ptr, 4);
+   r->ptr += 4;
+   return swap_if_big32(val);
+}
+
+static const char *explore_cache_read_str(explore_cache_reader_t *r)
+{
+   const char *str = NULL;
+   uint32_t len    = explore_cache_read_u32(r);
+
+   if (     r->error
+         || (size_t)(r->end - r->ptr) <= len
+         || r->ptr[len] != '\0')
+   {
+      r->error = true;
+      return NULL;
+   }
+
+   str     = (const char*)r->ptr;
+   r->ptr += len + 1;
+   return str;
+}
+
+static void explore_cache_write_u32(uint8_t **buf, uint32_t val)
+{
+   size_t pos = RBUF_LEN(*buf);
+
+   val        = swap_if_big32(val);
+   RBUF_RESIZE(*buf, pos + 4);
+   memcpy(*buf + pos, &val, 4);
+}
+
+static void explore_cache_write_str(uint8_t **buf, const char *str)
+{
+   size_t pos;
+   size_t len = strlen(str);
+
+   explore_cache_write_u32(buf, (uint32_t)len);
+   pos        = RBUF_LEN(*buf);
+   RBUF_RESIZE(*buf, pos + len + 1);
+   memcpy(*buf + pos, str, len + 1);
+}
+
+static void explore_cache_free(explore_cache_playlist_t *records)
+{
+   size_t i;
+
+   for (i = 0; i != RBUF_LEN(records); i++)
+   {
+      RBUF_FREE(records[i].rdbs);
+      RBUF_FREE(records[i].strings);
+      RBUF_FREE(records[i].entries);
+      RHMAP_FREE(records[i].string_map);
+   }
+
+   RBUF_FREE(records);
+}
+
+/* Reads the cache file into @buf and returns its playlist
+ * records. Strings of the records point into @buf. */
+static explore_cache_playlist_t *explore_cache_load(
+      const char *path, const char *directory_database, void **buf)
+{
+   uint32_t i, j, count;
+   explore_cache_reader_t r;
+   int64_t len                       = 0;
+   explore_cache_playlist_t *records = NULL;
+
+   if (!filestream_read_file(path, buf, &len) || len <= 0)
+      goto error;
+
+   r.ptr   = (const uint8_t*)*buf;
+   r.end   = r.ptr + len;
+   r.error = false;
+
+   if (     explore_cache_read_u32(&r) != EXPLORE_CACHE_MAGIC
+         || explore_cache_read_u32(&r) != EXPLORE_CACHE_VERSION
+         || !string_is_equal(explore_cache_read_str(&r),
+               directory_database))
+      goto error;
+
+   count = explore_cache_read_u32(&r);
+
+   for (i = 0; i < count && !r.error; i++)
+   {
+      explore_cache_playlist_t rec;
+      uint32_t n;
+
+      memset(&rec, 0, sizeof(rec));
+      rec.path      = explore_cache_read_str(&r);
+      rec.key.size  = explore_cache_read_u32(&r);
+      rec.key.stamp = explore_cache_read_u32(&r);
+
+      n             = explore_cache_read_u32(&r);
+      for (j = 0; j < n && !r.error; j++)
+      {
+         explore_cache_rdb_t rdb;
+         rdb.path      = explore_cache_read_str(&r);
+         rdb.key.size  = explore_cache_read_u32(&r);
+         rdb.key.stamp = explore_cache_read_u32(&r);
+         RBUF_PUSH(rec.rdbs, rdb);
+      }
+
+      n            = explore_cache_read_u32(&r);
+      for (j = 0; j < n && !r.error; j++)
+      {
+         const char *str = explore_cache_read_str(&r);
+         RBUF_PUSH(rec.strings, str);
+      }
+
+      n            = explore_cache_read_u32(&r);
+      if ((size_t)(r.end - r.ptr) / (EXPLORE_CACHE_STRIDE * 4) < n)
+         r.error   = true;
+      for (j = 0; j < n * EXPLORE_CACHE_STRIDE && !r.error; j++)
+      {
+         uint32_t val = explore_cache_read_u32(&r);
+         if (     (j % EXPLORE_CACHE_STRIDE)
+               && val != EXPLORE_CACHE_NONE
+               && val >= RBUF_LEN(rec.strings))
+            r.error   = true;
+         RBUF_PUSH(rec.entries, val);
+      }
+
+      RBUF_PUSH(records, rec);
+   }
+
+   if (r.error)
+      goto error;
+
+   return records;
+
+error:
+   explore_cache_free(records);
+   if (*buf)
+      free(*buf);
+   *buf = NULL;
+   return NULL;
+}
+
+static void explore_cache_save(const char *path,
+      const char *directory_database,
+      const explore_cache_playlist_t *records)
+{
+   size_t i, j;
+   uint32_t count = 0;
+   uint8_t *buf   = NULL;
+
+   for (i = 0; i != RBUF_LEN(records); i++)
+      if (records[i].valid)
+         count++;
+
+   explore_cache_write_u32(&buf, EXPLORE_CACHE_MAGIC);
+   explore_cache_write_u32(&buf, EXPLORE_CACHE_VERSION);
+   explore_cache_write_str(&buf, directory_database);
+   explore_cache_write_u32(&buf, count);
+
+   for (i = 0; i != RBUF_LEN(records); i++)
+   {
+      const explore_cache_playlist_t *rec = &records[i];
+
+      if (!rec->valid)
+         continue;
+
+      explore_cache_write_str(&buf, rec->path);
+      explore_cache_write_u32(&buf, rec->key.size);
+      explore_cache_write_u32(&buf, rec->key.stamp);
+
+      explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(rec->rdbs));
+      for (j = 0; j != RBUF_LEN(rec->rdbs); j++)
+      {
+         explore_cache_write_str(&buf, rec->rdbs[j].path);
+         explore_cache_write_u32(&buf, rec->rdbs[j].key.size);
+         explore_cache_write_u32(&buf, rec->rdbs[j].key.stamp);
+      }
+
+      explore_cache_write_u32(&buf, (uint32_t)RBUF_LEN(rec->strings));
+      for (j = 0; j != RBUF_LEN(rec->strings); j++)
+         explore_cache_write_str(&buf, rec->strings[j]);
+
+      explore_cache_write_u32(&buf,
+            (uint32_t)(RBUF_LEN(rec->entries) / EXPLORE_CACHE_STRIDE));
+      for (j = 0; j != RBUF_LEN(rec->entries); j++)
+         explore_cache_write_u32(&buf, rec->entries[j]);
+   }
+
+   if (!filestream_write_file(path, buf, (int64_t)RBUF_LEN(buf)))
+      RARCH_WARN("[Explore] Failed to write cache file: \"%s\".\n", path);
+
+   RBUF_FREE(buf);
+}
+
+static bool explore_cache_playlist_valid(
+      const explore_cache_playlist_t *rec,
+      const explore_cache_key_t *key,
+      explore_cache_key_t **rdb_keys)
+{
+   size_t i;
+
+   if (!explore_cache_key_equal(&rec->key, key))
+      return false;
+
+   for (i = 0; i != RBUF_LEN(rec->rdbs); i++)
+   {
+      explore_cache_key_t rdb_key = explore_cache_rdb_key(
+            rdb_keys, rec->rdbs[i].path);
+      if (!explore_cache_key_equal(&rec->rdbs[i].key, &rdb_key))
+         return false;
+   }
+
+   return true;
+}
+
+static const char *explore_cache_add_path(ex_arena *arena,
+      const char *path)
+{
+   size_t len = strlen(path) + 1;
+   char *copy = (char*)ex_arena_alloc(arena, len);
+   memcpy(copy, path, len);
+   return copy;
+}
+
+static void explore_cache_add_rdb(explore_cache_playlist_t *rec,
+      ex_arena *arena, const char *path, const explore_cache_key_t *key)
+{
+   size_t i;
+   explore_cache_rdb_t rdb;
+
+   for (i = 0; i != RBUF_LEN(rec->rdbs); i++)
+      if (string_is_equal(rec->rdbs[i].path, path))
+         return;
+
+   rdb.path = explore_cache_add_path(arena, path);
+   rdb.key  = *key;
+   RBUF_PUSH(rec->rdbs, rdb);
+}
+
+static uint32_t explore_cache_add_string(explore_cache_playlist_t *rec,
+      ex_arena *arena, const char *str)
+{
+   uint32_t idx;
+   const char *copy;
+
+   if (!str || !*str)
+      return EXPLORE_CACHE_NONE;
+
+   /* Map holds index + 1, so that 0 means 'not found' */
+   if ((idx = RHMAP_GET_STR(rec->string_map, str)))
+      return idx - 1;
+
+   copy = explore_cache_add_path(arena, str);
+   RBUF_PUSH(rec->strings, copy);
+
+   idx  = (uint32_t)RBUF_LEN(rec->strings);
+   RHMAP_SET_STR(rec->string_map, str, idx);
+   return idx - 1;
+}
+
+static void explore_cache_add_entry(explore_cache_playlist_t *rec,
+      ex_arena *arena, uint32_t playlist_idx,
+      const char *fields[EXPLORE_CACHE_FIELDS])
+{
+   unsigned i;
+
+   RBUF_PUSH(rec->entries, playlist_idx);
+   for (i = 0; i != EXPLORE_CACHE_FIELDS; i++)
+   {
+      uint32_t idx = explore_cache_add_string(rec, arena, fields[i]);
+      RBUF_PUSH(rec->entries, idx);
+   }
+}
+
+static void explore_add_entry(explore_state_t *explore,
+      explore_string_t **cat_maps[EXPLORE_CAT_COUNT],
+      explore_string_t ***split_buf,
+      const struct playlist_entry *entry,
+      const char *fields[EXPLORE_CACHE_FIELDS])
+{
+   unsigned cat;
+   explore_entry_t e;
+
+   e.playlist_entry  = entry;
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+      e.by[cat]      = NULL;
+   e.split           = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   e.original_title  = NULL;
+#endif
+   e.search_only     = false;
+
+   for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
+   {
+      explore_add_unique_string(explore,
+            cat_maps, &e, cat,
+            fields[cat], split_buf);
+   }
+
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   if (fields[EXPLORE_CAT_COUNT] && *fields[EXPLORE_CAT_COUNT])
+   {
+      size_t len       = strlen(fields[EXPLORE_CAT_COUNT]) + 1;
+      e.original_title = (char*)
+         ex_arena_alloc(&explore->arena, len);
+      memcpy(e.original_title, fields[EXPLORE_CAT_COUNT], len);
+   }
+#endif
+
+   if (RBUF_LEN(*split_buf))
+   {
+      size_t len;
+
+      RBUF_PUSH(*split_buf, NULL); /* terminator */
+      len        = RBUF_SIZEOF(*split_buf);
+      e.split    = (explore_string_t **)
+         ex_arena_alloc(&explore->arena, len);
+      memcpy(e.split, *split_buf, len);
+      RBUF_CLEAR(*split_buf);
+   }
+
+   RBUF_PUSH(explore->entries, e);
+}
+
+static void explore_add_search_entry(explore_state_t *explore,
+      const struct playlist_entry *entry)
+{
+   unsigned cat;
+   explore_entry_t e;
+
+   e.playlist_entry  = entry;
+   for (cat = 0; cat < EXPLORE_CAT_COUNT; cat++)
+      e.by[cat]      = NULL;
+   e.split           = NULL;
+#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
+   e.original_title  = NULL;
+#endif
+   e.search_only     = true;
+
+   RBUF_PUSH(explore->entries, e);
+}
+
+static bool explore_playlist_has_labels(playlist_t *playlist)
+{
+   size_t i;
+   for (i = 0; i < playlist_size(playlist); i++)
+   {
+      const struct playlist_entry *entry = NULL;
+      playlist_get_index(playlist, i, &entry);
+      if (entry->label && *entry->label)
+         return true;
+   }
+   return false;
+}
+
 static explore_state_t *explore_build_list(settings_t *settings)
 {
    unsigned i;
    char tmp[PATH_MAX_LENGTH];
+   char cache_path[PATH_MAX_LENGTH];
    struct explore_rdb
    {
       libretrodb_t *handle;
-      const struct playlist_entry **playlist_crcs;
-      const struct playlist_entry **playlist_names;
+      uint32_t *playlist_crcs;
+      uint32_t *playlist_names;
       size_t count;
+      explore_cache_key_t key;
+      char path[PATH_MAX_LENGTH];
       char systemname[256];
    }
    *rdbs                                          = NULL;
+   /* Playlist entries waiting to be matched against an RDB */
+   struct explore_pending
+   {
+      const struct playlist_entry *entry;
+      uint32_t record;
+      uint32_t playlist_idx;
+   }
+   *pending                                       = NULL;
    int *rdb_indices                               = NULL;
    explore_string_t **cat_maps[EXPLORE_CAT_COUNT] = {NULL};
    explore_string_t **split_buf                   = NULL;
+   explore_cache_playlist_t *cache                = NULL;
+   explore_cache_key_t *rdb_keys                  = NULL;
+   bool *content_paths                            = NULL;
+   void *cache_buf                                = NULL;
+   size_t cache_loaded                            = 0;
+   bool cache_dirty                               = false;
+   ex_arena cache_arena                           = {NULL, NULL, NULL};
    const char *directory_playlist                 = settings->paths.directory_playlist;
    const char *directory_database                 = settings->paths.path_content_database;
+   const char *directory_cache                    = settings->paths.directory_cache;
    libretro_vfs_implementation_dir *dir           = NULL;
 
    explore_state_t *explore                       = (explore_state_t*)calloc(
@@ -428,11 +1243,22 @@ static explore_state_t *explore_build_list(settings_t *settings)
    explore->label_explore_item_str    = 
       msg_hash_to_str(MENU_ENUM_LABEL_EXPLORE_ITEM);
 
+   cache_path[0] = '\0';
+   if (!string_is_empty(directory_cache))
+   {
+      fill_pathname_join(cache_path, directory_cache,
+            EXPLORE_CACHE_FILE_NAME, sizeof(cache_path));
+      cache        = explore_cache_load(cache_path,
+            directory_database, &cache_buf);
+      cache_loaded = RBUF_LEN(cache);
+   }
+
    /* Index all playlists */
    for (dir = retro_vfs_opendir_impl(directory_playlist, false); dir;)
    {
       playlist_config_t playlist_config;
       size_t j, used_entries                    = 0;
+      uint32_t record                           = EXPLORE_CACHE_NONE;
       playlist_t *playlist                      = NULL;
       const char *fext                          = NULL;
       const char *fname                         = NULL;
@@ -464,6 +1290,75 @@ static explore_state_t *explore_build_list(settings_t *settings)
       playlist_config.capacity          = COLLECTION_SIZE;
       playlist                          = playlist_init(&playlist_config);
 
+      if (*cache_path)
+      {
+         explore_cache_playlist_t new_rec;
+         explore_cache_key_t key = explore_cache_file_key(
+               playlist_config.path);
+
+         /* Use cached RDB matches if neither
+          * the playlist nor its RDBs changed */
+         for (j = 0; j != cache_loaded; j++)
+         {
+            explore_cache_playlist_t *rec = &cache[j];
+            if (     rec->valid
+                  || !string_is_equal(rec->path, playlist_config.path))
+               continue;
+            if (explore_cache_playlist_valid(rec, &key, &rdb_keys))
+               record = (uint32_t)j;
+            break;
+         }
+
+         if (record != EXPLORE_CACHE_NONE)
+         {
+            explore_cache_playlist_t *rec = &cache[record];
+            size_t k;
+
+            rec->valid = true;
+
+            for (k = 0; k < RBUF_LEN(rec->entries);
+                  k += EXPLORE_CACHE_STRIDE)
+            {
+               unsigned l;
+               const char *fields[EXPLORE_CACHE_FIELDS];
+               const struct playlist_entry *entry = NULL;
+               uint32_t playlist_idx              = rec->entries[k];
+
+               if (playlist_idx >= playlist_size(playlist))
+                  continue;
+
+               playlist_get_index(playlist, playlist_idx, &entry);
+
+               for (l = 0; l != EXPLORE_CACHE_FIELDS; l++)
+               {
+                  uint32_t str = rec->entries[k + 1 + l];
+                  fields[l]    = (str == EXPLORE_CACHE_NONE)
+                     ? NULL : rec->strings[str];
+               }
+
+               explore_add_entry(explore, cat_maps, &split_buf,
+                     entry, fields);
+               used_entries++;
+            }
+
+            if (used_entries || explore_playlist_has_labels(playlist))
+               RBUF_PUSH(explore->playlists, playlist);
+            else
+               playlist_free(playlist);
+            continue;
+         }
+
+         /* Start a new record, filled in while matching */
+         memset(&new_rec, 0, sizeof(new_rec));
+         new_rec.path  = explore_cache_add_path(&cache_arena,
+               playlist_config.path);
+         new_rec.key   = key;
+         new_rec.valid = true;
+         RBUF_PUSH(cache, new_rec);
+         record        = (uint32_t)(RBUF_LEN(cache) - 1);
+         cache_dirty   = true;
+      }
+
       fhash = ex_hash32_nocase_filtered(
             (unsigned char*)fname, fext - fname, '0', 255);
 
@@ -471,6 +1366,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
       {
          int rdb_num;
          uint32_t entry_crc32;
+         struct explore_pending p;
          struct explore_rdb* rdb             = NULL;
          const struct playlist_entry *entry  = NULL;
          const char *db_name                 = fname;
@@ -513,41 +1409,58 @@ static explore_state_t *explore_build_list(settings_t *settings)
             newrdb.systemname[systemname_len] = '\0';
 
             fill_pathname_join_noext(
-                  tmp, directory_database, db_name, sizeof(tmp));
-            strlcat(tmp, ".rdb", sizeof(tmp));
+                  newrdb.path, directory_database, db_name,
+                  sizeof(newrdb.path));
+            strlcat(newrdb.path, ".rdb", sizeof(newrdb.path));
 
-            if (libretrodb_open(tmp, newrdb.handle) != 0)
+            /* Invalid RDBs are kept (without handle), so that
+             * cached matches notice when they become valid */
+            if (libretrodb_open(newrdb.path, newrdb.handle) != 0)
             {
-               /* Invalid RDB file */
                libretrodb_free(newrdb.handle);
-               RHMAP_SET(rdb_indices, rdb_hash, -1);
-               continue;
+               newrdb.handle      = NULL;
             }
 
+            if (*cache_path)
+               newrdb.key         = explore_cache_rdb_key(
+                     &rdb_keys, newrdb.path);
+
             RBUF_PUSH(rdbs, newrdb);
-            rdb_num = (uintptr_t)RBUF_LEN(rdbs);
+            rdb_num = (int)RBUF_LEN(rdbs);
             RHMAP_SET(rdb_indices, rdb_hash, rdb_num);
          }
 
-         if (rdb_num == (uintptr_t)-1)
+         rdb = &rdbs[rdb_num - 1];
+
+         if (record != EXPLORE_CACHE_NONE)
+            explore_cache_add_rdb(&cache[record], &cache_arena,
+                  rdb->path, &rdb->key);
+
+         if (!rdb->handle)
             continue;
 
-         rdb = &rdbs[rdb_num - 1];
+         p.entry        = entry;
+         p.record       = record;
+         p.playlist_idx = (uint32_t)j;
+         RBUF_PUSH(pending, p);
+
          rdb->count++;
          entry_crc32 = (uint32_t)strtoul(
                (entry->crc32 ? entry->crc32 : ""), NULL, 16);
          if (entry_crc32)
          {
-            RHMAP_SET(rdb->playlist_crcs, entry_crc32, entry);
+            RHMAP_SET(rdb->playlist_crcs, entry_crc32,
+                  (uint32_t)RBUF_LEN(pending));
          }
          else
          {
-            RHMAP_SET_STR(rdb->playlist_names, entry->label, entry);
+            RHMAP_SET_STR(rdb->playlist_names, entry->label,
+                  (uint32_t)RBUF_LEN(pending));
          }
          used_entries++;
       }
 
-      if (used_entries)
+      if (used_entries || explore_playlist_has_labels(playlist))
          RBUF_PUSH(explore->playlists, playlist);
       else
          playlist_free(playlist);
@@ -559,8 +1472,14 @@ static explore_state_t *explore_build_list(settings_t *settings)
    {
       struct rmsgpack_dom_value item;
       struct explore_rdb* rdb  = &rdbs[i];
-      libretrodb_cursor_t *cur = libretrodb_cursor_new();
-      bool more                = 
+      libretrodb_cursor_t *cur = NULL;
+      bool more                = false;
+
+      if (!rdb->handle)
+         continue;
+
+      cur                      = libretrodb_cursor_new();
+      more                     = 
          (
           libretrodb_cursor_open(rdb->handle, cur, NULL) == 0
           && libretrodb_cursor_read_item(cur, &item) == 0);
@@ -568,21 +1487,18 @@ static explore_state_t *explore_build_list(settings_t *settings)
       for (; more; more = (rmsgpack_dom_value_free(&item),
                libretrodb_cursor_read_item(cur, &item) == 0))
       {
-         unsigned k, l, cat;
-         explore_entry_t e;
-         char *fields[EXPLORE_CAT_COUNT];
+         unsigned k, cat;
+         const char *fields[EXPLORE_CACHE_FIELDS];
          char numeric_buf[EXPLORE_CAT_COUNT][16];
-         const struct playlist_entry *entry = NULL;
+         struct explore_pending *p          = NULL;
+         uint32_t pending_num               = 0;
          uint32_t crc32                     = 0;
          char *name                         = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         char *original_title               = NULL;
-#endif
 
          if (item.type != RDT_MAP)
             continue;
 
-         for (k = 0; k < EXPLORE_CAT_COUNT; k++)
+         for (k = 0; k < EXPLORE_CACHE_FIELDS; k++)
             fields[k]                       = NULL;
 
          for (k = 0; k < item.val.map.len; k++)
@@ -622,7 +1538,7 @@ static explore_state_t *explore_build_list(settings_t *settings)
 #ifdef EXPLORE_SHOW_ORIGINAL_TITLE
             else if (string_is_equal(key_str, "original_title"))
             {
-               original_title = val->val.string.buff;
+               fields[EXPLORE_CAT_COUNT] = val->val.string.buff;
                continue;
             }
 #endif
@@ -651,55 +1567,24 @@ static explore_state_t *explore_build_list(settings_t *settings)
 
          if (crc32)
          {
-            entry = RHMAP_GET(rdb->playlist_crcs, crc32);
+            pending_num = RHMAP_GET(rdb->playlist_crcs, crc32);
          }
-         if (!entry && name)
+         if (!pending_num && name)
          {
-            entry = RHMAP_GET_STR(rdb->playlist_names, name);
+            pending_num = RHMAP_GET_STR(rdb->playlist_names, name);
          }
-         if (!entry)
+         if (!pending_num)
             continue;
 
-         e.playlist_entry  = entry;
-         for (l = 0; l < EXPLORE_CAT_COUNT; l++)
-            e.by[l]        = NULL;
-         e.split           = NULL;
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         e.original_title  = NULL;
-#endif
-
+         p                         = &pending[pending_num - 1];
          fields[EXPLORE_BY_SYSTEM] = rdb->systemname;
 
-         for (cat = 0; cat != EXPLORE_CAT_COUNT; cat++)
-         {
-            explore_add_unique_string(explore,
-                  cat_maps, &e, cat,
-                  fields[cat], &split_buf);
-         }
-
-#ifdef EXPLORE_SHOW_ORIGINAL_TITLE
-         if (original_title && *original_title)
-         {
-            size_t len       = strlen(original_title) + 1;
-            e.original_title = (char*)
-               ex_arena_alloc(&explore->arena, len);
-            memcpy(e.original_title, original_title, len);
-         }
-#endif
-
-         if (RBUF_LEN(split_buf))
-         {
-            size_t len;
-
-            RBUF_PUSH(split_buf, NULL); /* terminator */
-            len        = RBUF_SIZEOF(split_buf);
-            e.split    = (explore_string_t **)
-               ex_arena_alloc(&explore->arena, len);
-            memcpy(e.split, split_buf, len);
-            RBUF_CLEAR(split_buf);
-         }
+         explore_add_entry(explore, cat_maps, &split_buf,
+               p->entry, fields);
 
-         RBUF_PUSH(explore->entries, e);
+         if (p->record != EXPLORE_CACHE_NONE)
+            explore_cache_add_entry(&cache[p->record], &cache_arena,
+                  p->playlist_idx, fields);
 
          /* if all entries have found connections, we can leave early */
          if (--rdb->count == 0)
@@ -719,6 +1604,55 @@ static explore_state_t *explore_build_list(settings_t *settings)
    RBUF_FREE(split_buf);
    RHMAP_FREE(rdb_indices);
    RBUF_FREE(rdbs);
+   RBUF_FREE(pending);
+
+   /* Entries without database match can still be found by
+    * search. Content in several playlists (like the history)
+    * is added once, and not at all if it has a match */
+   for (i = 0; i != RBUF_LEN(explore->entries); i++)
+   {
+      const char *path = explore->entries[i].playlist_entry->path;
+      if (path && *path)
+         RHMAP_SET_STR(content_paths, path, true);
+   }
+
+   for (i = 0; i != RBUF_LEN(explore->playlists); i++)
+   {
+      size_t j;
+      playlist_t *playlist = explore->playlists[i];
+
+      for (j = 0; j < playlist_size(playlist); j++)
+      {
+         const struct playlist_entry *entry = NULL;
+         playlist_get_index(playlist, j, &entry);
+
+         if (     !entry->label || !*entry->label
+               || !entry->path  || !*entry->path
+               || RHMAP_HAS_STR(content_paths, entry->path))
+            continue;
+
+         RHMAP_SET_STR(content_paths, entry->path, true);
+         explore_add_search_entry(explore, entry);
+      }
+   }
+   RHMAP_FREE(content_paths);
+
+   if (*cache_path)
+   {
+      /* Drop records of playlists which no longer exist */
+      for (i = 0; i != cache_loaded; i++)
+         if (!cache[i].valid)
+            cache_dirty = true;
+
+      if (cache_dirty)
+         explore_cache_save(cache_path, directory_database, cache);
+   }
+
+   explore_cache_free(cache);
+   RHMAP_FREE(rdb_keys);
+   ex_arena_free(&cache_arena);
+   if (cache_buf)
+      free(cache_buf);
 
    for (i = 0; i != EXPLORE_CAT_COUNT; i++)
    {
@@ -737,6 +1671,9 @@ static explore_state_t *explore_build_list(settings_t *settings)
    qsort(explore->entries,
          RBUF_LEN(explore->entries),
          sizeof(*explore->entries), explore_qsort_func_entries);
+
+   explore->playlist_gen = playlist_get_generation();
+   explore_search_index_push(explore);
    return explore;
 }
 
@@ -842,6 +1779,25 @@ unsigned menu_displaylist_explore(file_list_t *list,
    struct item_file *stack_top  = NULL;
    file_list_t *menu_stack      = menu_entries_get_menu_stack_ptr(0);
 
+   /* Rebuild the list when entering its top after playlists
+    * have changed, as entries may have been added or deleted */
+   if (     explore_state
+         && explore_state->playlist_gen != playlist_get_generation()
+         && menu_stack->size - 1 == explore_state->top_depth
+         && menu_stack->list[explore_state->top_depth].type
+            == MENU_EXPLORE_TAB)
+   {
+      playlist_t *cached = playlist_get_cached();
+
+      for (i = 0; i != RBUF_LEN(explore_state->playlists); i++)
+         if (explore_state->playlists[i] == cached)
+            playlist_free_cached();
+
+      explore_free(explore_state);
+      free(explore_state);
+      explore_state             = NULL;
+   }
+
    if (!explore_state)
    {
       explore_state             = explore_build_list(settings);
@@ -1005,8 +1961,8 @@ SKIP_EXPLORE_BY_CATEGORY:;
       bool use_split[10];
       unsigned cats[10];
       explore_string_t* filter[10];
-      explore_entry_t *e                  = NULL;
-      explore_entry_t *e_end              = NULL;
+      uint32_t entry_idx, entry_count;
+      uint32_t *found                     = NULL;
       bool* map_filtered_category         = NULL;
       unsigned levels                     = 0;
       bool use_find                       = (
@@ -1069,12 +2025,27 @@ SKIP_EXPLORE_BY_CATEGORY:;
          levels++;
       }
 
-      e                             = explore_state->entries;
-      e_end                         = RBUF_END(explore_state->entries);
+      /* Search results are listed in rank order */
+      if (use_find)
+      {
+         found                      = explore_search(explore_state,
+               explore_state->find_string);
+         entry_count                = (uint32_t)RBUF_LEN(found);
+      }
+      else
+         entry_count                = (uint32_t)RBUF_LEN(explore_state->entries);
 
-      for (; e != e_end; e++)
+      for (entry_idx = 0; entry_idx != entry_count; entry_idx++)
       {
          unsigned lvl;
+         explore_entry_t *e         = &explore_state->entries[
+            found ? found[entry_idx] : entry_idx];
+
+         /* Entries without categories are only listed
+          * as results of a search without filters */
+         if (e->search_only && (!found || levels || is_filtered_category))
+            continue;
+
          for (lvl = 0; lvl != levels; lvl++)
          {
             if (filter[lvl] == e->by[cats[lvl]])
@@ -1093,11 +2064,6 @@ SKIP_EXPLORE_BY_CATEGORY:;
             goto SKIP_ENTRY;
          }
 
-         if (use_find && 
-               !strcasestr(e->playlist_entry->label,
-                  explore_state->find_string))
-            goto SKIP_ENTRY;
-
          if (is_filtered_category)
          {
             explore_string_t* str = e->by[current_cat];
@@ -1142,6 +2108,7 @@ SKIP_ENTRY:;
             " (%u)", (unsigned) (list->size - (is_filtered_category ? 0 : 1)));
 
       RHMAP_FREE(map_filtered_category);
+      RBUF_FREE(found);
    }
    else
    {
@@ -1196,7 +2163,8 @@ uintptr_t menu_explore_get_entry_icon(unsigned type)
    if (explore_state->show_icons == EXPLORE_ICONS_CONTENT)
    {
       explore_entry_t* e = &explore_state->entries[i];
-      if (e < RBUF_END(explore_state->entries))
+      if (     e < RBUF_END(explore_state->entries)
+            && e->by[EXPLORE_BY_SYSTEM])
          return explore_state->icons[e->by[EXPLORE_BY_SYSTEM]->idx];
    }
    else if (explore_state->show_icons == EXPLORE_ICONS_SYSTEM_CATEGORY)
@@ -1225,10 +2193,15 @@ void menu_explore_context_deinit(void)
 
 void menu_explore_free(void)
 {
-   if (!explore_state)
-      return;
+   if (explore_state)
+   {
+      explore_free(explore_state);
+      free(explore_state);
+      explore_state = NULL;
+   }
 
-   explore_free(explore_state);
-   free(explore_state);
-   explore_state = NULL;
+   /* Let pending index tasks hand their index
+    * over, so that it is discarded */
+   if (explore_search_pending)
+      task_queue_wait(explore_search_is_pending, NULL);
 }
@@ -23,6 +23,7 @@
 #endif
 
 #include <libretro.h>
+#include <array/rhmap.h>
 #include <lists/file_list.h>
 #include <file/file_path.h>
 #include <string/stdstring.h>
@@ -63,6 +64,7 @@
 #include "menu_cbs.h"
 #include "menu_driver.h"
 #include "../gfx/gfx_animation.h"
+#include "../gfx/gfx_thumbnail.h"
 #ifdef HAVE_GFX_WIDGETS
 #include "../gfx/gfx_widgets.h"
 #endif
@@ -6911,68 +6913,44 @@ int menu_action_handle_setting(rarch_setting_t *setting,
  **/
 rarch_setting_t *menu_setting_find(const char *label)
 {
-   rarch_setting_t *setting = NULL;
-   rarch_setting_t **list   = &setting;
+   rarch_setting_t *setting   = NULL;
+   struct menu_state *menu_st = menu_state_get_ptr();
+   rarch_setting_t **map      = menu_st->entries.list_settings_map;
 
-   if (!label)
+   if (!label || !map)
       return NULL;
 
-   menu_entries_ctl(MENU_ENTRIES_CTL_SETTINGS_GET, &setting);
-
-   if (!setting)
+   if (!(setting = RHMAP_GET_STR(map, label)))
       return NULL;
 
-   for (; setting->type != ST_NONE; (*list = *list + 1))
-   {
-      const char *name              = setting->name;
-      const char *short_description = setting->short_description;
-
-      if (
-            string_is_equal(label, name) &&
-            (setting->type <= ST_GROUP))
-      {
-         if (string_is_empty(short_description))
-            break;
-
-         if (setting->read_handler)
-            setting->read_handler(setting);
+   if (string_is_empty(setting->short_description))
+      return NULL;
 
-         return setting;
-      }
-   }
+   if (setting->read_handler)
+      setting->read_handler(setting);
 
-   return NULL;
+   return setting;
 }
 
 rarch_setting_t *menu_setting_find_enum(enum msg_hash_enums enum_idx)
 {
-   rarch_setting_t *setting = NULL;
-   rarch_setting_t **list   = &setting;
+   rarch_setting_t *setting   = NULL;
+   struct menu_state *menu_st = menu_state_get_ptr();
+   rarch_setting_t **map      = menu_st->entries.list_settings_enum_map;
 
-   if (enum_idx == 0)
+   if (enum_idx == 0 || !map)
       return NULL;
 
-   menu_entries_ctl(MENU_ENTRIES_CTL_SETTINGS_GET, &setting);
-
-   if (!setting)
+   if (!(setting = RHMAP_GET(map, (uint32_t)enum_idx)))
       return NULL;
-   for (; setting->type != ST_NONE; (*list = *list + 1))
-   {
-      if (  setting->enum_idx == enum_idx &&
-            setting->type <= ST_GROUP)
-      {
-         const char *short_description = setting->short_description;
-         if (string_is_empty(short_description))
-            return NULL;
 
-         if (setting->read_handler)
-            setting->read_handler(setting);
+   if (string_is_empty(setting->short_description))
+      return NULL;
 
-         return setting;
-      }
-   }
+   if (setting->read_handler)
+      setting->read_handler(setting);
 
-   return NULL;
+   return setting;
 }
 
 int menu_setting_set(unsigned type, unsigned action, bool wraparound)
@@ -7869,6 +7847,10 @@ static void general_write_handler(rarch_setting_t *setting)
 #endif
          }
          break;
+      case MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE:
+         gfx_thumbnail_set_cache_size(
+               (size_t)*setting->value.target.unsigned_integer * 1024 * 1024);
+         break;
       case MENU_ENUM_LABEL_AUDIO_VOLUME:
          audio_set_float(AUDIO_ACTION_VOLUME_GAIN, *setting->value.target.fraction);
          break;
@@ -7878,6 +7860,8 @@ static void general_write_handler(rarch_setting_t *setting)
 #endif
          break;
       case MENU_ENUM_LABEL_AUDIO_LATENCY:
+      case MENU_ENUM_LABEL_AUDIO_OUTPUT_THREAD:
+      case MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI:
       case MENU_ENUM_LABEL_AUDIO_OUTPUT_RATE:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_EXCLUSIVE_MODE:
       case MENU_ENUM_LABEL_AUDIO_WASAPI_FLOAT_FORMAT:
@@ -10308,6 +10292,22 @@ static bool setting_append_list(
             (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
             menu_settings_list_current_add_range(list, list_info, 0, 999, 1, true, true);
 
+#if defined(HAVE_RPNG)
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.screenshot_compression_level,
+                  MENU_ENUM_LABEL_SCREENSHOT_COMPRESSION_LEVEL,
+                  MENU_ENUM_LABEL_VALUE_SCREENSHOT_COMPRESSION_LEVEL,
+                  DEFAULT_SCREENSHOT_COMPRESSION_LEVEL,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok     = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 9, 1, true, true);
+#endif
+
             CONFIG_BOOL(
                   list, list_info,
                   &settings->bools.content_runtime_log,
@@ -12633,6 +12633,25 @@ static bool setting_append_list(
          menu_settings_list_current_add_range(list, list_info, 0, 512, 1.0, true, true);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
 
+#ifdef HAVE_THREADS
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_output_thread,
+               MENU_ENUM_LABEL_AUDIO_OUTPUT_THREAD,
+               MENU_ENUM_LABEL_VALUE_AUDIO_OUTPUT_THREAD,
+               DEFAULT_AUDIO_OUTPUT_THREAD,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+#endif
+
          CONFIG_UINT(
                list, list_info,
                &settings->uints.audio_resampler_quality,
@@ -12672,6 +12691,23 @@ static bool setting_append_list(
                false);
          SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
 
+         CONFIG_BOOL(
+               list, list_info,
+               &settings->bools.audio_rate_control_pi,
+               MENU_ENUM_LABEL_AUDIO_RATE_CONTROL_PI,
+               MENU_ENUM_LABEL_VALUE_AUDIO_RATE_CONTROL_PI,
+               DEFAULT_RATE_CONTROL_PI,
+               MENU_ENUM_LABEL_VALUE_OFF,
+               MENU_ENUM_LABEL_VALUE_ON,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler,
+               SD_FLAG_NONE
+               );
+         SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
+
          CONFIG_FLOAT(
                list, list_info,
                &settings->floats.audio_max_timing_skew,
@@ -13655,6 +13691,36 @@ static bool setting_append_list(
                SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
                (*list)[list_info->index - 1].ui_type   = ST_UI_TYPE_UINT_COMBOBOX;
 
+            CONFIG_UINT(
+               list, list_info,
+               &settings->uints.video_record_replay_buffer,
+               MENU_ENUM_LABEL_VIDEO_RECORD_REPLAY_BUFFER,
+               MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_REPLAY_BUFFER,
+               DEFAULT_VIDEO_RECORD_REPLAY_BUFFER,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+               (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+               menu_settings_list_current_add_range(list, list_info, 0, 600, 5, true, true);
+               SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+
+            CONFIG_UINT(
+               list, list_info,
+               &settings->uints.video_record_segment_length,
+               MENU_ENUM_LABEL_VIDEO_RECORD_SEGMENT_LENGTH,
+               MENU_ENUM_LABEL_VALUE_VIDEO_RECORD_SEGMENT_LENGTH,
+               DEFAULT_VIDEO_RECORD_SEGMENT_LENGTH,
+               &group_info,
+               &subgroup_info,
+               parent_group,
+               general_write_handler,
+               general_read_handler);
+               (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+               menu_settings_list_current_add_range(list, list_info, 0, 3600, 60, true, true);
+               SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_LAKKA_ADVANCED);
+
             CONFIG_DIR(
                list, list_info,
                global->record.output_dir,
@@ -16845,6 +16911,21 @@ static bool setting_append_list(
                   general_read_handler);
             (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint_special;
             menu_settings_list_current_add_range(list, list_info, 0, 1024, 256, true, true);
+
+            CONFIG_UINT(
+                  list, list_info,
+                  &settings->uints.gfx_thumbnail_cache_size,
+                  MENU_ENUM_LABEL_MENU_THUMBNAIL_CACHE_SIZE,
+                  MENU_ENUM_LABEL_VALUE_MENU_THUMBNAIL_CACHE_SIZE,
+                  DEFAULT_GFX_THUMBNAIL_CACHE_SIZE,
+                  &group_info,
+                  &subgroup_info,
+                  parent_group,
+                  general_write_handler,
+                  general_read_handler);
+            (*list)[list_info->index - 1].action_ok = &setting_action_ok_uint;
+            menu_settings_list_current_add_range(list, list_info, 0, 512, 16, true, true);
+            SETTINGS_DATA_LIST_CURRENT_ADD_FLAGS(list, list_info, SD_FLAG_ADVANCED);
          }
 
          if (string_is_equal(settings->arrays.menu_driver, "rgui"))
@@ -20512,6 +20593,76 @@ void menu_setting_free(rarch_setting_t *setting)
             }
 }
 
+/**
+ * menu_setting_index_name_new:
+ * @setting            : settings list
+ *
+ * Builds a hash map from setting name to the first
+ * group-or-value entry of @setting carrying that name,
+ * so that menu_setting_find() does not have to walk
+ * the whole settings list.
+ *
+ * Returns: hash map on success, otherwise NULL.
+ * Free with menu_setting_index_free().
+ **/
+rarch_setting_t **menu_setting_index_name_new(rarch_setting_t *setting)
+{
+   rarch_setting_t **map = NULL;
+
+   if (!setting)
+      return NULL;
+
+   for (; setting->type != ST_NONE; setting++)
+   {
+      uint32_t hash;
+
+      if (setting->type > ST_GROUP || !setting->name)
+         continue;
+
+      hash = rhmap_hash_string(setting->name);
+      if (!RHMAP_HAS_FULL(map, hash, setting->name))
+         RHMAP_SET_FULL(map, hash, setting->name, setting);
+   }
+
+   return map;
+}
+
+/**
+ * menu_setting_index_enum_new:
+ * @setting            : settings list
+ *
+ * Same as menu_setting_index_name_new(), but keyed
+ * by enum index, for menu_setting_find_enum().
+ *
+ * Returns: hash map on success, otherwise NULL.
+ * Free with menu_setting_index_free().
+ **/
+rarch_setting_t **menu_setting_index_enum_new(rarch_setting_t *setting)
+{
+   rarch_setting_t **map = NULL;
+
+   if (!setting)
+      return NULL;
+
+   for (; setting->type != ST_NONE; setting++)
+   {
+      uint32_t key = (uint32_t)setting->enum_idx;
+
+      if (setting->type > ST_GROUP || key == 0)
+         continue;
+
+      if (!RHMAP_HAS(map, key))
+         RHMAP_SET(map, key, setting);
+   }
+
+   return map;
+}
+
+void menu_setting_index_free(rarch_setting_t **map)
+{
+   RHMAP_FREE(map);
+}
+
 #define MENU_SETTING_INITIALIZE(list, _pos) \
 { \
    unsigned pos                                   = _pos; \
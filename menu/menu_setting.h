@@ -103,6 +103,30 @@ rarch_setting_t *menu_setting_new(void);
 
 void menu_setting_free(rarch_setting_t *setting);
 
+/**
+ * menu_setting_index_name_new:
+ * @setting            : settings list
+ *
+ * Builds a name lookup map for @setting, used by
+ * menu_setting_find().
+ *
+ * Returns: hash map on success, otherwise NULL.
+ **/
+rarch_setting_t **menu_setting_index_name_new(rarch_setting_t *setting);
+
+/**
+ * menu_setting_index_enum_new:
+ * @setting            : settings list
+ *
+ * Builds an enum index lookup map for @setting, used by
+ * menu_setting_find_enum().
+ *
+ * Returns: hash map on success, otherwise NULL.
+ **/
+rarch_setting_t **menu_setting_index_enum_new(rarch_setting_t *setting);
+
+void menu_setting_index_free(rarch_setting_t **map);
+
 RETRO_END_DECLS
 
 #endif
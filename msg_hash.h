@@ -292,6 +292,8 @@ enum msg_hash_enums
    MSG_ERROR,
    MSG_FOUND_DISK_LABEL,
    MSG_READING_FIRST_DATA_TRACK,
+   MSG_READING_DIRECTORY,
+   MSG_ERROR_READING_DIRECTORY,
    MSG_COULD_NOT_FIND_COMPATIBLE_SYSTEM,
    MSG_COMPARING_WITH_KNOWN_MAGIC_NUMBERS,
    MSG_COULD_NOT_FIND_VALID_DATA_TRACK,
@@ -327,6 +329,8 @@ enum msg_hash_enums
    MSG_CONTENT_CRC32S_DIFFER,
    MSG_RECORDING_TERMINATED_DUE_TO_RESIZE,
    MSG_FAILED_TO_START_RECORDING,
+   MSG_REPLAY_BUFFER_SAVING,
+   MSG_REPLAY_BUFFER_NOT_ACTIVE,
    MSG_REVERTING_SAVEFILE_DIRECTORY_TO,
    MSG_ERROR_PARSING_ARGUMENTS,
    MSG_REVERTING_SAVESTATE_DIRECTORY_TO,
@@ -883,6 +887,7 @@ enum msg_hash_enums
    MENU_ENUM_LABEL_VALUE_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_AI_SERVICE,
+   MENU_ENUM_LABEL_VALUE_INPUT_META_REPLAY_SAVE,
    MENU_ENUM_LABEL_VALUE_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_VALUE_INPUT_DEVICE_INDEX,
@@ -940,6 +945,7 @@ enum msg_hash_enums
    MENU_ENUM_SUBLABEL_INPUT_META_STREAMING_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_RUNAHEAD_TOGGLE,
    MENU_ENUM_SUBLABEL_INPUT_META_AI_SERVICE,
+   MENU_ENUM_SUBLABEL_INPUT_META_REPLAY_SAVE,
    MENU_ENUM_SUBLABEL_INPUT_META_MENU_TOGGLE,
 
    MENU_ENUM_LABEL_INPUT_DESCRIPTION,
@@ -1062,6 +1068,8 @@ enum msg_hash_enums
    MENU_LABEL(SCREEN_ORIENTATION),
    MENU_LABEL(VIDEO_SCALE),
    MENU_LABEL(VIDEO_RECORD_THREADS),
+   MENU_LABEL(VIDEO_RECORD_REPLAY_BUFFER),
+   MENU_LABEL(VIDEO_RECORD_SEGMENT_LENGTH),
    MENU_LABEL(VIDEO_SMOOTH),
    MENU_LABEL(VIDEO_CTX_SCALING),
 #ifdef HAVE_ODROIDGO2
@@ -1199,6 +1207,7 @@ enum msg_hash_enums
    MENU_LABEL(XMB_VERTICAL_THUMBNAILS),
    MENU_LABEL(MENU_XMB_THUMBNAIL_SCALE_FACTOR),
    MENU_LABEL(MENU_THUMBNAIL_UPSCALE_THRESHOLD),
+   MENU_LABEL(MENU_THUMBNAIL_CACHE_SIZE),
    MENU_LABEL(MENU_RGUI_INLINE_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_SWAP_THUMBNAILS),
    MENU_LABEL(MENU_RGUI_THUMBNAIL_DOWNSCALER),
@@ -1706,6 +1715,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_OUTPUT_RATE),
    MENU_LABEL(AUDIO_DEVICE),
    MENU_LABEL(AUDIO_BLOCK_FRAMES),
+   MENU_LABEL(AUDIO_OUTPUT_THREAD),
    MENU_LABEL(AUDIO_DSP_PLUGIN),
    MENU_LABEL(AUDIO_DSP_PLUGIN_REMOVE),
    MENU_LABEL(AUDIO_MUTE),
@@ -1715,6 +1725,7 @@ enum msg_hash_enums
    MENU_LABEL(AUDIO_VOLUME),
    MENU_LABEL(AUDIO_MIXER_VOLUME),
    MENU_LABEL(AUDIO_RATE_CONTROL_DELTA),
+   MENU_LABEL(AUDIO_RATE_CONTROL_PI),
    MENU_LABEL(AUDIO_LATENCY),
    MENU_LABEL(AUDIO_RESAMPLER_QUALITY),
    MENU_LABEL(AUDIO_WASAPI_EXCLUSIVE_MODE),
@@ -1903,6 +1914,7 @@ enum msg_hash_enums
    MENU_LABEL(SYSTEMFILES_IN_CONTENT_DIR_ENABLE),
    MENU_LABEL(SCREENSHOTS_IN_CONTENT_DIR_ENABLE),
    MENU_LABEL(SORT_SCREENSHOTS_BY_CONTENT_ENABLE),
+   MENU_LABEL(SCREENSHOT_COMPRESSION_LEVEL),
    MENU_LABEL(NETPLAY_IP_ADDRESS),
    MENU_LABEL(NETPLAY_PASSWORD),
    MENU_LABEL(NETPLAY_SPECTATE_PASSWORD),
@@ -1981,6 +1993,7 @@ enum msg_hash_enums
 
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_SINC,
    MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_CC,
+   MENU_ENUM_LABEL_AUDIO_RESAMPLER_DRIVER_POLYPHASE,
 
    MENU_LABEL(SAVEFILE_DIRECTORY),
    MENU_LABEL(SAVESTATE_DIRECTORY),
@@ -114,6 +114,7 @@ typedef struct
 
 /* TODO/FIXME - global state - perhaps move outside this file */
 static playlist_t *playlist_cached = NULL;
+static unsigned playlist_generation = 0;
 
 typedef int (playlist_sort_fun_t)(
       const struct playlist_entry *a,
@@ -672,6 +673,7 @@ void playlist_delete_index(playlist_t *playlist,
    RBUF_RESIZE(playlist->entries, len - 1);
 
    playlist->modified = true;
+   playlist_generation++;
 }
 
 /**
@@ -1074,6 +1076,7 @@ success:
    if (path_id)
       playlist_path_id_free(path_id);
    playlist->modified = true;
+   playlist_generation++;
    return true;
 
 error:
@@ -1475,6 +1478,7 @@ success:
    if (path_id)
       playlist_path_id_free(path_id);
    playlist->modified = true;
+   playlist_generation++;
    return true;
 
 error:
@@ -2076,6 +2080,7 @@ void playlist_clear(playlist_t *playlist)
          playlist_free_entry(entry);
    }
    RBUF_CLEAR(playlist->entries);
+   playlist_generation++;
 }
 
 /**
@@ -2768,6 +2773,11 @@ playlist_t *playlist_get_cached(void)
    return NULL;
 }
 
+unsigned playlist_get_generation(void)
+{
+   return playlist_generation;
+}
+
 bool playlist_init_cached(const playlist_config_t *config)
 {
    playlist_t *playlist = playlist_init(config);
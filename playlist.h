@@ -308,6 +308,12 @@ void playlist_free_cached(void);
 
 playlist_t *playlist_get_cached(void);
 
+/* Returns a counter which changes whenever entries
+ * are pushed to, deleted from or cleared out of any
+ * playlist, so that views built from playlist files
+ * can tell when they are outdated */
+unsigned playlist_get_generation(void);
+
 /* If current on-disk playlist file referenced
  * by 'config->path' does not match requested
  * 'old format' or 'compression' state, file will
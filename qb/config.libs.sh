@@ -453,8 +453,10 @@ check_lib '' DRMINGW -lexchndl
 check_enabled THREADS FFMPEG FFmpeg 'Threads are' false
 
 if [ "$HAVE_FFMPEG" != 'no' ]; then
-   check_val '' AVCODEC -lavcodec '' libavcodec 57 '' false
-   check_val '' AVFORMAT -lavformat '' libavformat 57 '' false
+   # The encoders use avcodec_send_frame(), added in 57.37.100,
+   # and the muxer fills AVStream.codecpar, added in 57.33.100
+   check_val '' AVCODEC -lavcodec '' libavcodec 57.37.100 '' false
+   check_val '' AVFORMAT -lavformat '' libavformat 57.33.100 '' false
    check_val '' AVDEVICE -lavdevice '' libavdevice 57 '' false
    check_val '' SWRESAMPLE -lswresample '' libswresample 2 '' false
    check_val '' AVUTIL -lavutil '' libavutil 55 '' false
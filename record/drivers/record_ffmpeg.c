@@ -18,12 +18,15 @@
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include <retro_assert.h>
 #include <compat/msvc.h>
 #include <compat/strl.h>
 
 #include <boolean.h>
+#include <retro_miscellaneous.h>
+#include <file/file_path.h>
 #include <queues/fifo_queue.h>
 #include <rthreads/rthreads.h>
 #include <gfx/scaler/scaler.h>
@@ -125,6 +128,27 @@ extern "C" {
 #define av_frame_free avcodec_free_frame
 #endif
 
+#if defined(__clang__) || (defined(__GNUC__) && ((__GNUC__ > 4) || (__GNUC__ == 4 && __GNUC_MINOR__ >= 7)))
+#define FFMPEG_HAVE_ATOMICS
+#endif
+
+/* Number of frame slots shared between the run loop
+ * and the encoder thread. When all of them are queued,
+ * new frames are dropped instead of stalling the run loop. */
+#define FFMPEG_VIDEO_SLOTS 8
+
+/* Packets held by the replay buffer are capped at this
+ * many bytes, whatever the buffer length. */
+#define FFMPEG_REPLAY_MAX_SIZE (512 * 1024 * 1024)
+
+struct ff_video_slot
+{
+   /* Tightly packed frame; data points to buf. */
+   struct record_video_data attr;
+   uint8_t *buf;
+   int64_t pts;
+};
+
 struct ff_video_info
 {
    AVCodecContext *codec;
@@ -132,6 +156,8 @@ struct ff_video_info
 
    AVFrame *conv_frame;
    uint8_t *conv_frame_buf;
+   /* Timestamp of the next frame pushed by the run loop.
+    * Dropped frames still advance it, keeping A/V sync. */
    int64_t frame_cnt;
 
    uint8_t *outbuf;
@@ -145,6 +171,17 @@ struct ff_video_info
    unsigned frame_drop_ratio;
    unsigned frame_drop_count;
 
+   /* Frames between forced keyframes, and the timestamp
+    * of the next one. Used to cut segments and replays. */
+   int64_t keyframe_interval;
+   int64_t next_keyframe;
+
+   /* Frames queued for and dropped in front of the
+    * encoder, and the deepest the queue has been. */
+   unsigned frames_queued;
+   unsigned frames_dropped;
+   unsigned queue_peak;
+
    /* Input pixel size. */
    size_t pix_size;
 
@@ -164,6 +201,9 @@ struct ff_audio_info
    size_t frames_in_buffer;
 
    int64_t frame_cnt;
+   /* Input frames the run loop dropped while a replay was
+    * being saved, not yet counted in frame_cnt. Guarded by lock. */
+   size_t frames_dropped;
 
    uint8_t *outbuf;
    size_t outbuf_size;
@@ -199,6 +239,40 @@ struct ff_muxer_info
    AVFormatContext *ctx;
    AVStream *astream;
    AVStream *vstream;
+
+   /* Video timestamp at which this file starts,
+    * and at which the next segment begins. */
+   int64_t start_pts;
+   int64_t segment_end;
+   unsigned segment;
+
+   /* Whether ctx and its streams are freed on close.
+    * The first file shares its codec contexts. */
+   bool own_ctx;
+};
+
+struct ff_replay_packet
+{
+   /* Timestamps are in codec time base. */
+   AVPacket *pkt;
+   bool is_video;
+};
+
+struct ff_replay_info
+{
+   /* Oldest first, always starting with a video keyframe. */
+   struct ff_replay_packet *packets;
+   size_t count;
+   size_t capacity;
+   /* Bytes of packet data held. */
+   size_t size;
+   unsigned saved;
+
+   /* Guarded by cond_lock. While saving, the encoder thread
+    * does not drain the audio FIFO, so the run loop drops
+    * audio instead of waiting for room. */
+   bool save_requested;
+   bool saving;
 };
 
 struct ff_config_param
@@ -232,15 +306,21 @@ typedef struct ffmpeg
    struct ff_audio_info audio;
    struct ff_muxer_info muxer;
    struct ff_config_param config;
+   struct ff_replay_info replay;
 
    struct record_params params;
+   char filename[PATH_MAX_LENGTH];
+
+   struct ff_video_slot video_slots[FFMPEG_VIDEO_SLOTS];
+   /* Free-running slot positions; written by the run loop
+    * and the encoder thread respectively. */
+   size_t video_write;
+   size_t video_read;
 
    scond_t *cond;
    slock_t *cond_lock;
    slock_t *lock;
    fifo_buffer_t *audio_fifo;
-   fifo_buffer_t *video_fifo;
-   fifo_buffer_t *attr_fifo;
    sthread_t *thread;
 
    volatile bool alive;
@@ -424,6 +504,14 @@ static bool ffmpeg_init_audio(ffmpeg_t *handle, const char *audio_resampler)
    return true;
 }
 
+/* Converts seconds to video timestamps, in codec time base */
+static int64_t ffmpeg_seconds_to_pts(ffmpeg_t *handle, double seconds)
+{
+   int64_t pts = (int64_t)(seconds * handle->params.fps
+         / handle->video.frame_drop_ratio + 0.5);
+   return pts > 0 ? pts : 1;
+}
+
 static bool ffmpeg_init_video(ffmpeg_t *handle)
 {
    size_t size;
@@ -525,6 +613,8 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
    video->codec->pix_fmt             = video->pix_fmt;
 
    video->codec->thread_count = params->threads;
+   /* The in-house scaler splits frames between as many threads */
+   video->scaler.threads      = params->threads;
 
    if (params->video_qscale)
    {
@@ -548,6 +638,13 @@ static bool ffmpeg_init_video(ffmpeg_t *handle)
 
    video->frame_drop_ratio = params->frame_drop_ratio;
 
+   /* Replays are trimmed, and segments cut, at keyframes */
+   if (param->replay_buffer_seconds)
+      video->keyframe_interval = ffmpeg_seconds_to_pts(handle, 1.0);
+   else if (param->segment_seconds)
+      video->keyframe_interval = ffmpeg_seconds_to_pts(handle,
+            param->segment_seconds);
+
    size = avpicture_get_size(video->pix_fmt, param->out_width,
          param->out_height);
    video->conv_frame_buf   = (uint8_t*)av_malloc(size);
@@ -876,7 +973,7 @@ static bool ffmpeg_init_config(struct ff_config_param *params,
 static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
 {
    ctx = avformat_alloc_context();
-   av_strlcpy(ctx->filename, handle->params.filename, sizeof(ctx->filename));
+   av_strlcpy(ctx->filename, handle->filename, sizeof(ctx->filename));
 
    if (*handle->config.format)
       ctx->oformat = av_guess_format(handle->config.format, NULL, NULL);
@@ -886,7 +983,10 @@ static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
    if (!ctx->oformat)
       return false;
 
-   if (avio_open(&ctx->pb, ctx->filename, AVIO_FLAG_WRITE) < 0)
+   /* With a replay buffer, this context only serves as
+    * a template for the files written out later. */
+   if (     !handle->params.replay_buffer_seconds
+         && avio_open(&ctx->pb, ctx->filename, AVIO_FLAG_WRITE) < 0)
    {
       av_free(ctx);
       return false;
@@ -896,54 +996,219 @@ static bool ffmpeg_init_muxer_pre(ffmpeg_t *handle)
    return true;
 }
 
-static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+static AVStream *ffmpeg_muxer_new_stream(AVFormatContext *ctx,
+      AVCodec *encoder, AVCodecContext *codec)
 {
-   AVStream *stream = avformat_new_stream(handle->muxer.ctx,
-         handle->video.encoder);
+   AVStream *stream = avformat_new_stream(ctx, encoder);
+
+   if (!stream)
+      return NULL;
+
+   if (avcodec_parameters_from_context(stream->codecpar, codec) < 0)
+      return NULL;
+
+   stream->time_base           = codec->time_base;
+   stream->sample_aspect_ratio = codec->sample_aspect_ratio;
+   return stream;
+}
 
-   stream->codec = handle->video.codec;
-   stream->time_base = stream->codec->time_base;
-   handle->muxer.vstream = stream;
-   handle->muxer.vstream->sample_aspect_ratio =
-      handle->video.codec->sample_aspect_ratio;
+static bool ffmpeg_init_muxer_post(ffmpeg_t *handle)
+{
+   if (!(handle->muxer.vstream = ffmpeg_muxer_new_stream(
+               handle->muxer.ctx, handle->video.encoder,
+               handle->video.codec)))
+      return false;
 
    if (handle->config.audio_enable)
-   {
-      stream = avformat_new_stream(handle->muxer.ctx,
-            handle->audio.encoder);
-      stream->codec = handle->audio.codec;
-      stream->time_base = stream->codec->time_base;
-      handle->muxer.astream = stream;
-   }
+      if (!(handle->muxer.astream = ffmpeg_muxer_new_stream(
+                  handle->muxer.ctx, handle->audio.encoder,
+                  handle->audio.codec)))
+         return false;
 
    av_dict_set(&handle->muxer.ctx->metadata, "title",
          "RetroArch Video Dump", 0);
 
+   handle->muxer.segment     = 1;
+   if (handle->params.segment_seconds)
+      handle->muxer.segment_end = handle->video.keyframe_interval;
+
+   if (handle->params.replay_buffer_seconds)
+      return true;
+
    return avformat_write_header(handle->muxer.ctx, NULL) >= 0;
 }
 
+/* Fills @s with the output filename, suffixed with @tag and @index */
+static void ffmpeg_fill_indexed_path(ffmpeg_t *handle,
+      char *s, size_t len, const char *tag, unsigned index)
+{
+   char base[PATH_MAX_LENGTH];
+   const char *ext = path_get_extension(handle->filename);
+
+   strlcpy(base, handle->filename, sizeof(base));
+   path_remove_extension(base);
+
+   if (string_is_empty(ext))
+      snprintf(s, len, "%s-%s%03u", base, tag, index);
+   else
+      snprintf(s, len, "%s-%s%03u.%s", base, tag, index, ext);
+}
+
+static void ffmpeg_muxer_close(struct ff_muxer_info *muxer)
+{
+   if (!muxer->ctx)
+      return;
+
+   av_write_trailer(muxer->ctx);
+   avio_closep(&muxer->ctx->pb);
+
+   if (muxer->own_ctx)
+      avformat_free_context(muxer->ctx);
+   muxer->ctx = NULL;
+}
+
+/**
+ * ffmpeg_muxer_open:
+ * @handle                    : FFmpeg handle.
+ * @muxer                     : muxer to open.
+ * @path                      : file to write.
+ * @start_pts                 : video timestamp the file starts at.
+ *
+ * Opens another output file in the format of the first one,
+ * for the streams of the running encoders.
+ *
+ * Returns: true if the header of @path could be written.
+ **/
+static bool ffmpeg_muxer_open(ffmpeg_t *handle,
+      struct ff_muxer_info *muxer, const char *path, int64_t start_pts)
+{
+   AVFormatContext *out = avformat_alloc_context();
+
+   if (!out)
+      return false;
+
+   out->oformat = handle->muxer.ctx->oformat;
+   av_strlcpy(out->filename, path, sizeof(out->filename));
+
+   if (avio_open(&out->pb, path, AVIO_FLAG_WRITE) < 0)
+   {
+      avformat_free_context(out);
+      return false;
+   }
+
+   muxer->ctx       = out;
+   muxer->own_ctx   = true;
+   muxer->start_pts = start_pts;
+   muxer->astream   = NULL;
+
+   if (!(muxer->vstream = ffmpeg_muxer_new_stream(out,
+               handle->video.encoder, handle->video.codec)))
+      goto error;
+
+   if (handle->config.audio_enable)
+      if (!(muxer->astream = ffmpeg_muxer_new_stream(out,
+                  handle->audio.encoder, handle->audio.codec)))
+         goto error;
+
+   av_dict_set(&out->metadata, "title", "RetroArch Video Dump", 0);
+
+   if (avformat_write_header(out, NULL) < 0)
+      goto error;
+
+   return true;
+
+error:
+   avio_closep(&out->pb);
+   avformat_free_context(out);
+   muxer->ctx = NULL;
+   return false;
+}
+
+/* Continues recording in the next segment file,
+ * starting with the keyframe at @pts. */
+static void ffmpeg_next_segment(ffmpeg_t *handle, int64_t pts)
+{
+   char path[PATH_MAX_LENGTH];
+   struct ff_muxer_info muxer = {0};
+   unsigned segment           = handle->muxer.segment + 1;
+
+   /* On failure, keep writing to the current file
+    * and try again at the next boundary. */
+   handle->muxer.segment_end  = pts + handle->video.keyframe_interval;
+
+   ffmpeg_fill_indexed_path(handle, path, sizeof(path), "", segment);
+
+   if (!ffmpeg_muxer_open(handle, &muxer, path, pts))
+   {
+      RARCH_ERR("[FFmpeg]: Cannot open segment %s.\n", path);
+      return;
+   }
+
+   ffmpeg_muxer_close(&handle->muxer);
+
+   muxer.segment     = segment;
+   muxer.segment_end = handle->muxer.segment_end;
+   handle->muxer     = muxer;
+
+   RARCH_LOG("[FFmpeg]: Recording segment to %s.\n", path);
+}
+
 #define MAX_FRAMES 32
 
 static void ffmpeg_thread(void *data);
+static void ffmpeg_replay_free(ffmpeg_t *handle);
+
+static size_t ffmpeg_slot_load(ffmpeg_t *handle, size_t *pos)
+{
+#ifdef FFMPEG_HAVE_ATOMICS
+   return __atomic_load_n(pos, __ATOMIC_ACQUIRE);
+#else
+   size_t ret;
+   slock_lock(handle->lock);
+   ret = *pos;
+   slock_unlock(handle->lock);
+   return ret;
+#endif
+}
+
+static void ffmpeg_slot_store(ffmpeg_t *handle, size_t *pos, size_t val)
+{
+#ifdef FFMPEG_HAVE_ATOMICS
+   __atomic_store_n(pos, val, __ATOMIC_RELEASE);
+#else
+   slock_lock(handle->lock);
+   *pos = val;
+   slock_unlock(handle->lock);
+#endif
+}
 
 static bool init_thread(ffmpeg_t *handle)
 {
+   unsigned i;
+   /* One spare line, as swscale may read past the last one. */
+   size_t slot_size = handle->params.fb_width *
+      (handle->params.fb_height + 1) * handle->video.pix_size;
+
+   for (i = 0; i < FFMPEG_VIDEO_SLOTS; i++)
+   {
+      handle->video_slots[i].buf = (uint8_t*)av_malloc(slot_size);
+      retro_assert(handle->video_slots[i].buf);
+   }
+   handle->video_write = 0;
+   handle->video_read  = 0;
+
    handle->lock = slock_new();
    handle->cond_lock = slock_new();
    handle->cond = scond_new();
    handle->audio_fifo = fifo_new(32000 * sizeof(int16_t) *
          handle->params.channels * MAX_FRAMES / 60); /* Some arbitrary max size. */
-   handle->attr_fifo = fifo_new(sizeof(struct record_video_data) * MAX_FRAMES);
-   handle->video_fifo = fifo_new(handle->params.fb_width * handle->params.fb_height *
-            handle->video.pix_size * MAX_FRAMES);
 
    handle->alive = true;
    handle->can_sleep = true;
    handle->thread = sthread_create(ffmpeg_thread, handle);
 
    retro_assert(handle->lock && handle->cond_lock &&
-      handle->cond && handle->audio_fifo &&
-      handle->attr_fifo && handle->video_fifo && handle->thread);
+      handle->cond && handle->audio_fifo && handle->thread);
 
    return true;
 }
@@ -970,22 +1235,18 @@ static void deinit_thread(ffmpeg_t *handle)
 
 static void deinit_thread_buf(ffmpeg_t *handle)
 {
+   unsigned i;
+
    if (handle->audio_fifo)
    {
       fifo_free(handle->audio_fifo);
       handle->audio_fifo = NULL;
    }
 
-   if (handle->attr_fifo)
+   for (i = 0; i < FFMPEG_VIDEO_SLOTS; i++)
    {
-      fifo_free(handle->attr_fifo);
-      handle->attr_fifo = NULL;
-   }
-
-   if (handle->video_fifo)
-   {
-      fifo_free(handle->video_fifo);
-      handle->video_fifo = NULL;
+      av_free(handle->video_slots[i].buf);
+      handle->video_slots[i].buf = NULL;
    }
 }
 
@@ -997,6 +1258,7 @@ static void ffmpeg_free(void *data)
 
    deinit_thread(handle);
    deinit_thread_buf(handle);
+   ffmpeg_replay_free(handle);
 
    if (handle->audio.codec)
    {
@@ -1051,6 +1313,10 @@ static void *ffmpeg_new(const struct record_params *params)
 
    handle->params       = *params;
 
+   /* params->filename does not outlive this call */
+   strlcpy(handle->filename, params->filename, sizeof(handle->filename));
+   handle->params.filename = handle->filename;
+
    switch (params->preset)
    {
       case RECORD_CONFIG_TYPE_RECORDING_CUSTOM:
@@ -1101,10 +1367,12 @@ static bool ffmpeg_push_video(void *data,
       const struct record_video_data *vid)
 {
    unsigned y;
-   struct record_video_data attr_data;
-   bool drop_frame  = false;
-   ffmpeg_t *handle = (ffmpeg_t*)data;
-   int       offset = 0;
+   size_t write, queued;
+   struct ff_video_slot *slot = NULL;
+   bool drop_frame            = false;
+   ffmpeg_t *handle           = (ffmpeg_t*)data;
+   const uint8_t *src         = NULL;
+   uint8_t *dst               = NULL;
 
    if (!handle || !vid)
       return false;
@@ -1117,53 +1385,69 @@ static bool ffmpeg_push_video(void *data,
    if (drop_frame)
       return true;
 
-   for (;;)
-   {
-      unsigned avail;
-
-      slock_lock(handle->lock);
-      avail = FIFO_WRITE_AVAIL(handle->attr_fifo);
-      slock_unlock(handle->lock);
-
-      if (!handle->alive)
-         return false;
+   if (!handle->alive)
+      return false;
 
-      if (avail >= sizeof(*vid))
-         break;
+   /* Slots are sized for the frame size given at init.
+    * The viewport read back for GPU recording can grow
+    * past it when the window is resized. */
+   if (     !vid->is_dupe
+         && (  vid->width  > handle->params.fb_width
+            || vid->height > handle->params.fb_height))
+   {
+      handle->video.frames_dropped++;
+      handle->video.frame_cnt++;
+      return true;
+   }
 
-      slock_lock(handle->cond_lock);
-      if (handle->can_sleep)
-      {
-         handle->can_sleep = false;
-         scond_wait(handle->cond, handle->cond_lock);
-         handle->can_sleep = true;
-      }
-      else
-         scond_signal(handle->cond);
+   /* Only the run loop writes video_write */
+   write  = handle->video_write;
+   queued = write - ffmpeg_slot_load(handle, &handle->video_read);
 
-      slock_unlock(handle->cond_lock);
+   if (queued >= FFMPEG_VIDEO_SLOTS)
+   {
+      /* The encoder is behind. Drop the frame rather than
+       * wait for it, but keep its timestamp so that the
+       * output stays in sync. */
+      handle->video.frames_dropped++;
+      handle->video.frame_cnt++;
+      return true;
    }
 
-   slock_lock(handle->lock);
+   if (queued + 1 > handle->video.queue_peak)
+      handle->video.queue_peak = queued + 1;
 
    /* Tightly pack our frame to conserve memory.
     * libretro tends to use a very large pitch.
+    * The encoder thread converts it straight from the slot.
     */
-   attr_data = *vid;
+   slot            = &handle->video_slots[write % FFMPEG_VIDEO_SLOTS];
+   slot->attr      = *vid;
+   slot->attr.data = slot->buf;
+   slot->pts       = handle->video.frame_cnt++;
 
-   if (attr_data.is_dupe)
-      attr_data.width = attr_data.height = attr_data.pitch = 0;
+   if (slot->attr.is_dupe)
+      slot->attr.width = slot->attr.height = slot->attr.pitch = 0;
    else
-      attr_data.pitch = attr_data.width * handle->video.pix_size;
+      slot->attr.pitch = slot->attr.width * handle->video.pix_size;
 
-   fifo_write(handle->attr_fifo, &attr_data, sizeof(attr_data));
+   src = (const uint8_t*)vid->data;
+   dst = slot->buf;
+   for (y = 0; y < slot->attr.height; y++)
+   {
+      memcpy(dst, src, slot->attr.pitch);
+      src += vid->pitch;
+      dst += slot->attr.pitch;
+   }
 
-   for (y = 0; y < attr_data.height; y++, offset += vid->pitch)
-      fifo_write(handle->video_fifo,
-            (const uint8_t*)vid->data + offset, attr_data.pitch);
+   handle->video.frames_queued++;
+   ffmpeg_slot_store(handle, &handle->video_write, write + 1);
 
-   slock_unlock(handle->lock);
+   /* The encoder thread rechecks the slots under cond_lock
+    * before sleeping, so this wakeup cannot be lost. */
+   slock_lock(handle->cond_lock);
    scond_signal(handle->cond);
+   slock_unlock(handle->cond_lock);
 
    return true;
 }
@@ -1195,6 +1479,16 @@ static bool ffmpeg_push_audio(void *data,
          break;
 
       slock_lock(handle->cond_lock);
+      if (handle->replay.saving)
+      {
+         slock_unlock(handle->cond_lock);
+
+         slock_lock(handle->lock);
+         handle->audio.frames_dropped += audio_data->frames;
+         slock_unlock(handle->lock);
+         return true;
+      }
+
       if (handle->can_sleep)
       {
          handle->can_sleep = false;
@@ -1216,6 +1510,221 @@ static bool ffmpeg_push_audio(void *data,
    return true;
 }
 
+/* Writes a packet with timestamps in codec time base to @muxer */
+static bool ffmpeg_mux_packet(ffmpeg_t *handle,
+      struct ff_muxer_info *muxer, AVPacket *pkt, bool is_video)
+{
+   int ret;
+   AVCodecContext *codec = is_video
+      ? handle->video.codec : handle->audio.codec;
+   AVStream *stream      = is_video ? muxer->vstream : muxer->astream;
+   int64_t start         = is_video ? muxer->start_pts
+      : av_rescale_q(muxer->start_pts,
+            handle->video.codec->time_base, codec->time_base);
+
+   /* Audio encoded before the file's first video keyframe
+    * would get a negative timestamp, leave it out. */
+   if (     !is_video
+         && pkt->pts != AV_NOPTS_VALUE
+         && pkt->pts < start)
+   {
+      av_packet_unref(pkt);
+      return true;
+   }
+
+   if (pkt->pts != AV_NOPTS_VALUE)
+      pkt->pts = av_rescale_q(pkt->pts - start,
+            codec->time_base, stream->time_base);
+   if (pkt->dts != AV_NOPTS_VALUE)
+      pkt->dts = av_rescale_q(pkt->dts - start,
+            codec->time_base, stream->time_base);
+
+   pkt->stream_index = stream->index;
+
+   ret = av_interleaved_write_frame(muxer->ctx, pkt);
+   if (ret < 0)
+   {
+#ifdef __cplusplus
+      RARCH_ERR("[FFmpeg]: Cannot write %s packet to output file. Error code: %d.\n",
+            is_video ? "video" : "audio", ret);
+#else
+      RARCH_ERR("[FFmpeg]: Cannot write %s packet to output file. Error code: %s.\n",
+            is_video ? "video" : "audio", av_err2str(ret));
+#endif
+      return false;
+   }
+   return true;
+}
+
+static void ffmpeg_replay_drop(ffmpeg_t *handle, size_t count)
+{
+   size_t i;
+   struct ff_replay_info *replay = &handle->replay;
+
+   if (!count)
+      return;
+
+   for (i = 0; i < count; i++)
+   {
+      replay->size -= replay->packets[i].pkt->size;
+      av_packet_free(&replay->packets[i].pkt);
+   }
+
+   replay->count -= count;
+   memmove(replay->packets, replay->packets + count,
+         replay->count * sizeof(*replay->packets));
+}
+
+/* Drops the oldest keyframe intervals as long as the
+ * rest still covers the buffer length, or while the
+ * buffer is over its size cap. */
+static void ffmpeg_replay_trim(ffmpeg_t *handle, int64_t newest_pts)
+{
+   struct ff_replay_info *replay = &handle->replay;
+   int64_t length                = ffmpeg_seconds_to_pts(handle,
+         handle->params.replay_buffer_seconds);
+
+   for (;;)
+   {
+      size_t i;
+
+      for (i = 1; i < replay->count; i++)
+         if (     replay->packets[i].is_video
+               && (replay->packets[i].pkt->flags & AV_PKT_FLAG_KEY))
+            break;
+
+      if (i >= replay->count)
+         return;
+
+      if (     newest_pts - replay->packets[i].pkt->pts < length
+            && replay->size <= FFMPEG_REPLAY_MAX_SIZE)
+         return;
+
+      ffmpeg_replay_drop(handle, i);
+   }
+}
+
+static bool ffmpeg_replay_push(ffmpeg_t *handle,
+      const AVPacket *pkt, bool is_video)
+{
+   struct ff_replay_info *replay = &handle->replay;
+   bool is_key                   = is_video
+      && (pkt->flags & AV_PKT_FLAG_KEY);
+   AVPacket *copy                = NULL;
+
+   /* A replay has to start with a video keyframe */
+   if (!replay->count && !is_key)
+      return true;
+
+   if (replay->count == replay->capacity)
+   {
+      size_t capacity                  = replay->capacity
+         ? replay->capacity * 2 : 256;
+      struct ff_replay_packet *packets = (struct ff_replay_packet*)
+         realloc(replay->packets, capacity * sizeof(*packets));
+
+      if (!packets)
+         return false;
+
+      replay->packets  = packets;
+      replay->capacity = capacity;
+   }
+
+   if (!(copy = av_packet_clone(pkt)))
+      return false;
+
+   replay->packets[replay->count].pkt      = copy;
+   replay->packets[replay->count].is_video = is_video;
+   replay->count++;
+   replay->size += copy->size;
+
+   if (is_key)
+      ffmpeg_replay_trim(handle, copy->pts);
+
+   return true;
+}
+
+/* Writes the replay buffer to the next replay file.
+ * Called on the encoder thread, the buffer keeps going. */
+static void ffmpeg_replay_write(ffmpeg_t *handle)
+{
+   size_t i;
+   char path[PATH_MAX_LENGTH];
+   int64_t end_pts               = 0;
+   struct ff_muxer_info muxer    = {0};
+   struct ff_replay_info *replay = &handle->replay;
+
+   if (!replay->count)
+   {
+      RARCH_WARN("[FFmpeg]: Replay buffer is still empty.\n");
+      return;
+   }
+
+   ffmpeg_fill_indexed_path(handle, path, sizeof(path),
+         "replay-", replay->saved + 1);
+
+   if (!ffmpeg_muxer_open(handle, &muxer, path,
+            replay->packets[0].pkt->pts))
+   {
+      RARCH_ERR("[FFmpeg]: Cannot open replay %s.\n", path);
+      return;
+   }
+
+   for (i = 0; i < replay->count; i++)
+   {
+      /* Muxing takes over the packet, the buffer keeps its own */
+      AVPacket *pkt = av_packet_clone(replay->packets[i].pkt);
+
+      if (!pkt)
+         break;
+
+      if (replay->packets[i].is_video)
+         end_pts = pkt->pts;
+
+      if (!ffmpeg_mux_packet(handle, &muxer, pkt,
+               replay->packets[i].is_video))
+      {
+         av_packet_free(&pkt);
+         break;
+      }
+
+      av_packet_free(&pkt);
+   }
+
+   ffmpeg_muxer_close(&muxer);
+   replay->saved++;
+
+   RARCH_LOG("[FFmpeg]: Saved %.1f seconds of replay to %s.\n",
+         (double)(end_pts - replay->packets[0].pkt->pts)
+         * handle->video.frame_drop_ratio / handle->params.fps,
+         path);
+}
+
+static void ffmpeg_replay_free(ffmpeg_t *handle)
+{
+   ffmpeg_replay_drop(handle, handle->replay.count);
+   free(handle->replay.packets);
+   handle->replay.packets  = NULL;
+   handle->replay.capacity = 0;
+}
+
+/* Hands a packet with timestamps in codec time base
+ * to the replay buffer or the current output file. */
+static bool ffmpeg_write_packet(ffmpeg_t *handle,
+      AVPacket *pkt, bool is_video)
+{
+   if (handle->params.replay_buffer_seconds)
+      return ffmpeg_replay_push(handle, pkt, is_video);
+
+   if (     is_video
+         && handle->params.segment_seconds
+         && (pkt->flags & AV_PKT_FLAG_KEY)
+         && pkt->pts >= handle->muxer.segment_end)
+      ffmpeg_next_segment(handle, pkt->pts);
+
+   return ffmpeg_mux_packet(handle, &handle->muxer, pkt, is_video);
+}
+
 static bool encode_video(ffmpeg_t *handle, AVFrame *frame)
 {
    AVPacket pkt;
@@ -1251,25 +1760,8 @@ static bool encode_video(ffmpeg_t *handle, AVFrame *frame)
          return false;
       }
 
-      pkt.pts = av_rescale_q(pkt.pts, handle->video.codec->time_base,
-         handle->muxer.vstream->time_base);
-
-      pkt.dts = av_rescale_q(pkt.dts,
-         handle->video.codec->time_base,
-         handle->muxer.vstream->time_base);
-      
-      pkt.stream_index = handle->muxer.vstream->index;
-
-      ret = av_interleaved_write_frame(handle->muxer.ctx, &pkt);
-      if (ret < 0)
-      {
-#ifdef __cplusplus
-         RARCH_ERR("[FFmpeg]: Cannot write video packet to output file. Error code: %d.\n", ret);
-#else
-         RARCH_ERR("[FFmpeg]: Cannot write video packet to output file. Error code: %s.\n", av_err2str(ret));
-#endif
+      if (!ffmpeg_write_packet(handle, &pkt, true))
          return false;
-      }
    }
    return true;
 }
@@ -1310,18 +1802,37 @@ static void ffmpeg_scale_input(ffmpeg_t *handle,
 }
 
 static bool ffmpeg_push_video_thread(ffmpeg_t *handle,
-      const struct record_video_data *vid)
+      const struct record_video_data *vid, int64_t pts)
 {
    if (!vid->is_dupe)
       ffmpeg_scale_input(handle, vid);
 
-   handle->video.conv_frame->pts = handle->video.frame_cnt;
+   handle->video.conv_frame->pts = pts;
 
-   if (!encode_video(handle, handle->video.conv_frame))
-      return false;
+   if (handle->video.keyframe_interval)
+   {
+      if (pts >= handle->video.next_keyframe)
+      {
+         handle->video.conv_frame->pict_type = AV_PICTURE_TYPE_I;
+         handle->video.next_keyframe         = pts
+            + handle->video.keyframe_interval;
+      }
+      else
+         handle->video.conv_frame->pict_type = AV_PICTURE_TYPE_NONE;
+   }
 
-   handle->video.frame_cnt++;
-   return true;
+   return encode_video(handle, handle->video.conv_frame);
+}
+
+/* Encodes the frame in slot @pos and hands the
+ * slot back to the run loop. */
+static void ffmpeg_push_video_slot(ffmpeg_t *handle, size_t pos)
+{
+   struct ff_video_slot *slot = &handle->video_slots[
+      pos % FFMPEG_VIDEO_SLOTS];
+
+   ffmpeg_push_video_thread(handle, &slot->attr, slot->pts);
+   ffmpeg_slot_store(handle, &handle->video_read, pos + 1);
 }
 
 static void planarize_float(float *out, const float *in, size_t frames)
@@ -1438,25 +1949,9 @@ static bool encode_audio(ffmpeg_t *handle, bool dry)
          return false;
       }
 
-      pkt.pts = av_rescale_q(pkt.pts,
-         handle->audio.codec->time_base,
-         handle->muxer.astream->time_base);
-
-      pkt.dts = av_rescale_q(pkt.dts,
-         handle->audio.codec->time_base,
-         handle->muxer.astream->time_base);
-
-      pkt.stream_index = handle->muxer.astream->index;
-
-      ret = av_interleaved_write_frame(handle->muxer.ctx, &pkt);
-      if (ret < 0)
+      if (!ffmpeg_write_packet(handle, &pkt, false))
       {
          av_frame_free(&frame);
-#ifdef __cplusplus
-         RARCH_ERR("[FFmpeg]: Cannot write video packet to output file. Error code: %d.\n", ret);
-#else
-         RARCH_ERR("[FFmpeg]: Cannot write video packet to output file. Error code: %s.\n", av_err2str(ret));
-#endif
          return false;
       }
    }
@@ -1606,8 +2101,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 {
    void *audio_buf       = NULL;
    bool did_work         = false;
-   void *video_buf       = av_malloc(2 * handle->params.fb_width *
-         handle->params.fb_height * handle->video.pix_size);
    size_t audio_buf_size = handle->config.audio_enable ?
       (handle->audio.codec->frame_size *
        handle->params.channels * sizeof(int16_t)) : 0;
@@ -1619,8 +2112,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
 
    do
    {
-      struct record_video_data attr_buf;
-
       did_work = false;
 
       if (handle->config.audio_enable)
@@ -1638,14 +2129,10 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
          }
       }
 
-      if (FIFO_READ_AVAIL(handle->attr_fifo) >= sizeof(attr_buf))
+      /* The encoder thread has already been joined */
+      if (handle->video_read != handle->video_write)
       {
-         fifo_read(handle->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(handle->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(handle, &attr_buf);
-
+         ffmpeg_push_video_slot(handle, handle->video_read);
          did_work = true;
       }
    }while (did_work);
@@ -1657,7 +2144,6 @@ static void ffmpeg_flush_buffers(ffmpeg_t *handle)
    /* Flush out last video. */
    ffmpeg_flush_video(handle);
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
@@ -1674,10 +2160,23 @@ static bool ffmpeg_finalize(void *data)
 
    deinit_thread_buf(handle);
 
-   /* Write final data. */
-   av_write_trailer(handle->muxer.ctx);
+   RARCH_LOG("[FFmpeg]: Queued %u video frames, dropped %u, "
+         "queue peak %u/%u.\n",
+         handle->video.frames_queued, handle->video.frames_dropped,
+         handle->video.queue_peak, FFMPEG_VIDEO_SLOTS);
 
-   avio_close(ctx->pb);
+   if (handle->params.replay_buffer_seconds)
+   {
+      /* Nothing was written to the output file itself.
+       * The encoder thread has already been joined. */
+      if (handle->replay.save_requested)
+         ffmpeg_replay_write(handle);
+      handle->replay.save_requested = false;
+      return true;
+   }
+
+   /* Write final data. */
+   ffmpeg_muxer_close(&handle->muxer);
 
    return true;
 }
@@ -1687,12 +2186,6 @@ static void ffmpeg_thread(void *data)
    size_t audio_buf_size;
    void *audio_buf = NULL;
    ffmpeg_t *ff    = (ffmpeg_t*)data;
-   /* For some reason, FFmpeg has a tendency to crash
-    * if we don't overallocate a bit. */
-   void *video_buf = av_malloc(2 * ff->params.fb_width *
-         ff->params.fb_height * ff->video.pix_size);
-
-   retro_assert(video_buf);
 
    audio_buf_size = ff->config.audio_enable ?
       (ff->audio.codec->frame_size * ff->params.channels * sizeof(int16_t)) : 0;
@@ -1700,57 +2193,82 @@ static void ffmpeg_thread(void *data)
 
    while (ff->alive)
    {
-      struct record_video_data attr_buf;
-
-      bool avail_video = false;
-      bool avail_audio = false;
-
-      slock_lock(ff->lock);
-      if (FIFO_READ_AVAIL(ff->attr_fifo) >= sizeof(attr_buf))
-         avail_video = true;
+      /* Only this thread writes video_read */
+      size_t video_read = ff->video_read;
+      bool avail_video  = ffmpeg_slot_load(ff, &ff->video_write)
+         != video_read;
+      bool avail_audio  = false;
+      bool save         = false;
 
       if (ff->config.audio_enable)
+      {
+         slock_lock(ff->lock);
          if (FIFO_READ_AVAIL(ff->audio_fifo) >= audio_buf_size)
             avail_audio = true;
-      slock_unlock(ff->lock);
+         slock_unlock(ff->lock);
+      }
 
-      if (!avail_video && !avail_audio)
+      if (ff->params.replay_buffer_seconds)
       {
          slock_lock(ff->cond_lock);
-         if (ff->can_sleep)
-         {
-            ff->can_sleep = false;
-            scond_wait(ff->cond, ff->cond_lock);
-            ff->can_sleep = true;
-         }
-         else
+         save                      = ff->replay.save_requested;
+         ff->replay.save_requested = false;
+         ff->replay.saving         = save;
+         /* Wake the run loop if it waits for room for audio */
+         if (save)
             scond_signal(ff->cond);
+         slock_unlock(ff->cond_lock);
+      }
+
+      if (save)
+      {
+         ffmpeg_replay_write(ff);
 
+         slock_lock(ff->cond_lock);
+         ff->replay.saving = false;
          slock_unlock(ff->cond_lock);
       }
 
-      if (avail_video && video_buf)
+      if (!avail_video && !avail_audio)
       {
-         slock_lock(ff->lock);
-         fifo_read(ff->attr_fifo, &attr_buf, sizeof(attr_buf));
-         fifo_read(ff->video_fifo, video_buf,
-               attr_buf.height * attr_buf.pitch);
-         slock_unlock(ff->lock);
-         scond_signal(ff->cond);
+         slock_lock(ff->cond_lock);
+         if (ffmpeg_slot_load(ff, &ff->video_write) == video_read
+               && !ff->replay.save_requested
+               && ff->alive)
+         {
+            if (ff->can_sleep)
+            {
+               ff->can_sleep = false;
+               scond_wait(ff->cond, ff->cond_lock);
+               ff->can_sleep = true;
+            }
+            else
+               scond_signal(ff->cond);
+         }
 
-         attr_buf.data = video_buf;
-         ffmpeg_push_video_thread(ff, &attr_buf);
+         slock_unlock(ff->cond_lock);
       }
 
+      if (avail_video)
+         ffmpeg_push_video_slot(ff, video_read);
+
       if (avail_audio && audio_buf)
       {
+         size_t dropped;
          struct record_audio_data aud = {0};
 
          slock_lock(ff->lock);
          fifo_read(ff->audio_fifo, audio_buf, audio_buf_size);
+         dropped                  = ff->audio.frames_dropped;
+         ff->audio.frames_dropped = 0;
          slock_unlock(ff->lock);
          scond_signal(ff->cond);
 
+         /* Leave a gap for dropped audio so it stays in sync */
+         if (dropped)
+            ff->audio.frame_cnt += ff->audio.resampler
+               ? (int64_t)(dropped * ff->audio.ratio) : (int64_t)dropped;
+
          aud.frames = ff->audio.codec->frame_size;
          aud.data   = audio_buf;
 
@@ -1758,15 +2276,31 @@ static void ffmpeg_thread(void *data)
       }
    }
 
-   av_free(video_buf);
    av_free(audio_buf);
 }
 
+static bool ffmpeg_save_replay(void *data)
+{
+   ffmpeg_t *handle = (ffmpeg_t*)data;
+
+   if (!handle || !handle->params.replay_buffer_seconds || !handle->alive)
+      return false;
+
+   /* The encoder thread owns the buffer and writes it out */
+   slock_lock(handle->cond_lock);
+   handle->replay.save_requested = true;
+   scond_signal(handle->cond);
+   slock_unlock(handle->cond_lock);
+
+   return true;
+}
+
 const record_driver_t record_ffmpeg = {
    ffmpeg_new,
    ffmpeg_free,
    ffmpeg_push_video,
    ffmpeg_push_audio,
    ffmpeg_finalize,
+   ffmpeg_save_replay,
    "ffmpeg",
 };
@@ -97,12 +97,15 @@
 #include <compat/posix_string.h>
 #include <streams/file_stream.h>
 #include <streams/interface_stream.h>
+#include <streams/trans_stream.h>
 #include <file/file_path.h>
 #include <retro_assert.h>
 #include <retro_miscellaneous.h>
 #include <queues/message_queue.h>
 #include <queues/task_queue.h>
 #include <lists/dir_list.h>
+#include <formats/rjson.h>
+#include <encodings/crc32.h>
 #ifdef HAVE_NETWORKING
 #include <net/net_http.h>
 #endif
@@ -149,6 +152,7 @@
 #endif
 
 #include <audio/audio_resampler.h>
+#include <audio/audio_rate_control.h>
 
 #include "gfx/gfx_animation.h"
 #include "gfx/gfx_display.h"
@@ -1591,6 +1595,9 @@ static bool menu_driver_init_internal(
 
    gfx_display_init();
 
+   gfx_thumbnail_set_cache_size(
+         (size_t)settings->uints.gfx_thumbnail_cache_size * 1024 * 1024);
+
    /* TODO/FIXME - can we get rid of this? Is this needed? */
    configuration_set_string(settings,
          settings->arrays.menu_driver, menu_st->driver_ctx->ident);
@@ -1669,10 +1676,15 @@ bool menu_driver_ctl(enum rarch_menu_ctl_state state, void *data)
                && menu_st->driver_ctx->context_destroy)
             menu_st->driver_ctx->context_destroy(menu_st->userdata);
 
+         /* Cached thumbnail textures do not survive
+          * the graphics context */
+         gfx_thumbnail_cache_flush();
+
          if (menu_st->data_own)
             return true;
 
          playlist_free_cached();
+         filebrowser_free();
 #if defined(HAVE_CG) || defined(HAVE_GLSL) || defined(HAVE_SLANG) || defined(HAVE_HLSL)
          menu_shader_manager_free(p_rarch);
 #endif
@@ -3409,6 +3421,307 @@ static void retro_perf_log(void)
    log_counters(p_rarch->perf_counters_libretro, p_rarch->perf_ptr_libretro);
 }
 
+static void benchmark_add_key(rjsonwriter_t *writer,
+      int indent, const char *key)
+{
+   rjsonwriter_add_spaces(writer, indent);
+   rjsonwriter_add_string(writer, key);
+   rjsonwriter_add_colon(writer);
+   rjsonwriter_add_space(writer);
+}
+
+static void benchmark_add_counters(rjsonwriter_t *writer,
+      struct retro_perf_counter **counters, unsigned num,
+      retro_perf_tick_t total_ticks, double usec_per_tick)
+{
+   unsigned i;
+   bool first = true;
+
+   rjsonwriter_add_start_array(writer);
+
+   for (i = 0; i < num; i++)
+   {
+      struct retro_perf_counter *counter = counters[i];
+
+      if (!counter->call_cnt)
+         continue;
+
+      if (!first)
+         rjsonwriter_add_comma(writer);
+      first = false;
+
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_spaces(writer, 4);
+      rjsonwriter_add_start_object(writer);
+      rjsonwriter_add_newline(writer);
+      benchmark_add_key(writer, 6, "name");
+      rjsonwriter_add_string(writer, counter->ident);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      benchmark_add_key(writer, 6, "calls");
+      rjsonwriter_rawf(writer, STRING_REP_UINT64,
+            (uint64_t)counter->call_cnt);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      benchmark_add_key(writer, 6, "ticks");
+      rjsonwriter_rawf(writer, STRING_REP_UINT64,
+            (uint64_t)counter->total);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      benchmark_add_key(writer, 6, "usec");
+      rjsonwriter_add_double(writer, counter->total * usec_per_tick);
+      rjsonwriter_add_comma(writer);
+      rjsonwriter_add_newline(writer);
+      benchmark_add_key(writer, 6, "share");
+      rjsonwriter_add_double(writer, total_ticks
+            ? (double)counter->total / (double)total_ticks
+            : 0.0);
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_spaces(writer, 4);
+      rjsonwriter_add_end_object(writer);
+   }
+
+   if (!first)
+   {
+      rjsonwriter_add_newline(writer);
+      rjsonwriter_add_spaces(writer, 2);
+   }
+   rjsonwriter_add_end_array(writer);
+}
+
+/**
+ * benchmark_write_report:
+ *
+ * Writes the result of a --benchmark run as JSON, either to
+ * the file given with --benchmark-report or to stdout.
+ *
+ * Performance counters only count ticks, so their time is
+ * derived from the ticks and the wall clock time elapsed
+ * over the whole run. Counters nest: 'core_run' includes
+ * whatever the core triggers from inside retro_run(), such
+ * as input polling, audio flushes and video frames,
+ * 'video_frame' includes 'video_filter' and 'runahead'
+ * includes the core runs it performs.
+ **/
+static void benchmark_write_report(struct rarch_state *p_rarch)
+{
+   char *json;
+   int json_len;
+   rjsonwriter_t *writer           = NULL;
+   rarch_system_info_t *sys_info   = &runloop_state.system;
+   retro_time_t elapsed_usec       = cpu_features_get_time_usec()
+      - runloop_state.benchmark_start_time;
+   retro_perf_tick_t elapsed_ticks = cpu_features_get_perf_counter()
+      - runloop_state.benchmark_start_ticks;
+   uint64_t frames                 = runloop_state.benchmark_frames;
+   double usec_per_tick            = elapsed_ticks
+      ? (double)elapsed_usec / (double)elapsed_ticks
+      : 0.0;
+
+   if (!(writer = rjsonwriter_open_memory()))
+      return;
+
+   rjsonwriter_add_start_object(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "version");
+   rjsonwriter_add_string(writer, PACKAGE_VERSION);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "core");
+   rjsonwriter_add_string(writer, sys_info->info.library_name);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "core_version");
+   rjsonwriter_add_string(writer, sys_info->info.library_version);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "content");
+   rjsonwriter_add_string(writer, path_basename(path_get(RARCH_PATH_CONTENT)));
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "frames");
+   rjsonwriter_rawf(writer, STRING_REP_UINT64, frames);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "elapsed_usec");
+   rjsonwriter_rawf(writer, STRING_REP_UINT64, (uint64_t)elapsed_usec);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "fps");
+   rjsonwriter_add_double(writer, elapsed_usec > 0
+         ? (double)frames * 1000000.0 / (double)elapsed_usec
+         : 0.0);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "counters");
+   benchmark_add_counters(writer,
+         p_rarch->perf_counters_rarch, p_rarch->perf_ptr_rarch,
+         elapsed_ticks, usec_per_tick);
+   rjsonwriter_add_comma(writer);
+   rjsonwriter_add_newline(writer);
+   benchmark_add_key(writer, 2, "core_counters");
+   benchmark_add_counters(writer,
+         p_rarch->perf_counters_libretro, p_rarch->perf_ptr_libretro,
+         elapsed_ticks, usec_per_tick);
+   rjsonwriter_add_newline(writer);
+   rjsonwriter_add_end_object(writer);
+   rjsonwriter_add_newline(writer);
+
+   if ((json = rjsonwriter_get_memory_buffer(writer, &json_len)))
+   {
+      if (string_is_empty(runloop_state.benchmark_report_path))
+      {
+         fputs(json, stdout);
+         fflush(stdout);
+      }
+      else if (!filestream_write_file(runloop_state.benchmark_report_path,
+               json, json_len))
+         RARCH_ERR("[Benchmark]: Failed to write report to \"%s\".\n",
+               runloop_state.benchmark_report_path);
+   }
+
+   rjsonwriter_free(writer);
+}
+
+/* Hashes the visible part of each line, so pitch
+ * padding is ignored. Hardware rendered frames cannot
+ * be read back and hash to zero. */
+static uint32_t frame_hash_video_crc(const void *data,
+      unsigned width, unsigned height, size_t pitch, unsigned bpp)
+{
+   unsigned y;
+   uint32_t crc       = 0;
+   const uint8_t *src = (const uint8_t*)data;
+
+   if (data == RETRO_HW_FRAME_BUFFER_VALID)
+      return 0;
+
+   for (y = 0; y < height; y++, src += pitch)
+      crc = encoding_crc32(crc, src, width * bpp);
+
+   return crc;
+}
+
+/**
+ * frame_hash_add_video:
+ *
+ * Hashes a frame handed to video_driver_frame() for the
+ * --frame-hash-log regression log, as the core output it.
+ * Duplicate frames keep the hash of the frame they repeat.
+ **/
+static void frame_hash_add_video(const void *data,
+      unsigned width, unsigned height, size_t pitch,
+      enum retro_pixel_format pix_fmt)
+{
+   runloop_state.frame_hash_width  = width;
+   runloop_state.frame_hash_height = height;
+
+   if (data)
+      runloop_state.frame_hash_video = frame_hash_video_crc(data,
+            width, height, pitch,
+            (pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888) ? 4 : 2);
+}
+
+/**
+ * frame_hash_add_filtered_video:
+ *
+ * Hashes the frame video_driver_frame() hands to the video
+ * driver, after pixel format conversion and the software
+ * filter. @bpp is the size of its pixels.
+ **/
+static void frame_hash_add_filtered_video(const void *data,
+      unsigned width, unsigned height, size_t pitch, unsigned bpp)
+{
+   if (data)
+      runloop_state.frame_hash_filtered = frame_hash_video_crc(data,
+            width, height, pitch, bpp);
+}
+
+static void frame_hash_add_audio(const int16_t *data, size_t frames)
+{
+   runloop_state.frame_hash_audio         = encoding_crc32(
+         runloop_state.frame_hash_audio,
+         (const uint8_t*)data, frames * 2 * sizeof(int16_t));
+   runloop_state.frame_hash_audio_frames += (unsigned)frames;
+}
+
+/* Hashes audio as written to the audio driver, after
+ * the DSP filter, resampler and mixer. */
+static void frame_hash_add_output_audio(const void *data,
+      size_t size, size_t frames)
+{
+   runloop_state.frame_hash_output         = encoding_crc32(
+         runloop_state.frame_hash_output, (const uint8_t*)data, size);
+   runloop_state.frame_hash_output_frames += (unsigned)frames;
+}
+
+/**
+ * frame_hash_write_line:
+ *
+ * Logs the hashes of the frame the core just ran. Each line
+ * holds the frame number, the video size, the hashes of the
+ * last video frame as output by the core and as handed to the
+ * video driver, and the number and hash of the audio frames
+ * output by the core and written to the audio driver since
+ * the previous line.
+ **/
+static void frame_hash_write_line(void)
+{
+   filestream_printf(runloop_state.frame_hash_file,
+         STRING_REP_UINT64 " %ux%u %08x %08x %u %08x %u %08x\n",
+         runloop_state.frame_hash_frames++,
+         runloop_state.frame_hash_width,
+         runloop_state.frame_hash_height,
+         (unsigned)runloop_state.frame_hash_video,
+         (unsigned)runloop_state.frame_hash_filtered,
+         runloop_state.frame_hash_audio_frames,
+         (unsigned)runloop_state.frame_hash_audio,
+         runloop_state.frame_hash_output_frames,
+         (unsigned)runloop_state.frame_hash_output);
+
+   runloop_state.frame_hash_audio         = 0;
+   runloop_state.frame_hash_audio_frames  = 0;
+   runloop_state.frame_hash_output        = 0;
+   runloop_state.frame_hash_output_frames = 0;
+}
+
+static void frame_hash_log_open(void)
+{
+   if (     string_is_empty(runloop_state.frame_hash_path)
+         || runloop_state.frame_hash_file)
+      return;
+
+   if (!(runloop_state.frame_hash_file = filestream_open(
+               runloop_state.frame_hash_path,
+               RETRO_VFS_FILE_ACCESS_WRITE,
+               RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+   {
+      RARCH_ERR("[Frame Hash]: Failed to open \"%s\".\n",
+            runloop_state.frame_hash_path);
+      return;
+   }
+
+   filestream_printf(runloop_state.frame_hash_file,
+         "# frame size video filtered audio_frames audio"
+         " output_frames output\n");
+   runloop_state.frame_hash_frames        = 0;
+   runloop_state.frame_hash_video         = 0;
+   runloop_state.frame_hash_filtered      = 0;
+   runloop_state.frame_hash_audio         = 0;
+   runloop_state.frame_hash_audio_frames  = 0;
+   runloop_state.frame_hash_output        = 0;
+   runloop_state.frame_hash_output_frames = 0;
+}
+
+static void frame_hash_log_close(void)
+{
+   if (!runloop_state.frame_hash_file)
+      return;
+
+   filestream_close(runloop_state.frame_hash_file);
+   runloop_state.frame_hash_file = NULL;
+}
+
 struct retro_perf_counter **retro_get_perf_counter_rarch(void)
 {
    struct rarch_state *p_rarch = &rarch_st;
@@ -7727,6 +8040,24 @@ bool command_event(enum event_command cmd, void *data)
          else
             command_event(CMD_EVENT_RECORD_INIT, NULL);
          break;
+      case CMD_EVENT_RECORDING_REPLAY_SAVE:
+         {
+            bool saved = p_rarch->recording_data
+               && p_rarch->recording_driver->save_replay
+               && p_rarch->recording_driver->save_replay(
+                     p_rarch->recording_data);
+
+            runloop_msg_queue_push(
+                  msg_hash_to_str(saved
+                     ? MSG_REPLAY_BUFFER_SAVING
+                     : MSG_REPLAY_BUFFER_NOT_ACTIVE),
+                  1, 180, true,
+                  NULL, MESSAGE_QUEUE_ICON_DEFAULT,
+                  MESSAGE_QUEUE_CATEGORY_INFO);
+            if (!saved)
+               return false;
+         }
+         break;
       case CMD_EVENT_OSK_TOGGLE:
          if (p_rarch->input_driver_keyboard_linefeed_enable)
             p_rarch->input_driver_keyboard_linefeed_enable = false;
@@ -9402,6 +9733,18 @@ void retroarch_override_setting_set(
       case RARCH_OVERRIDE_SETTING_LOG_TO_FILE:
          p_rarch->has_set_log_to_file = true;
          break;
+      case RARCH_OVERRIDE_SETTING_VIDEO_DRIVER:
+         p_rarch->has_set_video_driver = true;
+         break;
+      case RARCH_OVERRIDE_SETTING_AUDIO_DRIVER:
+         p_rarch->has_set_audio_driver = true;
+         break;
+      case RARCH_OVERRIDE_SETTING_INPUT_DRIVER:
+         p_rarch->has_set_input_driver = true;
+         break;
+      case RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER:
+         p_rarch->has_set_input_joypad_driver = true;
+         break;
       case RARCH_OVERRIDE_SETTING_NONE:
       default:
          break;
@@ -9475,6 +9818,18 @@ void retroarch_override_setting_unset(
       case RARCH_OVERRIDE_SETTING_LOG_TO_FILE:
          p_rarch->has_set_log_to_file = false;
          break;
+      case RARCH_OVERRIDE_SETTING_VIDEO_DRIVER:
+         p_rarch->has_set_video_driver = false;
+         break;
+      case RARCH_OVERRIDE_SETTING_AUDIO_DRIVER:
+         p_rarch->has_set_audio_driver = false;
+         break;
+      case RARCH_OVERRIDE_SETTING_INPUT_DRIVER:
+         p_rarch->has_set_input_driver = false;
+         break;
+      case RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER:
+         p_rarch->has_set_input_joypad_driver = false;
+         break;
       case RARCH_OVERRIDE_SETTING_NONE:
       default:
          break;
@@ -9597,6 +9952,8 @@ void main_exit(void *args)
       log_counters(p_rarch->perf_counters_rarch, p_rarch->perf_ptr_rarch);
    }
 
+   frame_hash_log_close();
+
 #if defined(HAVE_LOGGER) && !defined(ANDROID)
    logger_shutdown();
 #endif
@@ -9622,6 +9979,7 @@ void main_exit(void *args)
    rarch_ctl(RARCH_CTL_STATE_FREE,  NULL);
    global_free(p_rarch);
    task_queue_deinit();
+   task_image_load_deinit();
 
    if (p_rarch->configuration_settings)
       free(p_rarch->configuration_settings);
@@ -14008,6 +14366,12 @@ static bool recording_init(
    params.video_record_threads      = settings->uints.video_record_threads;
    params.streaming_mode            = settings->uints.streaming_mode;
 
+   if (!p_rarch->streaming_enable)
+   {
+      params.replay_buffer_seconds  = settings->uints.video_record_replay_buffer;
+      params.segment_seconds        = settings->uints.video_record_segment_length;
+   }
+
    params.out_width                 = av_info->geometry.base_width;
    params.out_height                = av_info->geometry.base_height;
    params.fb_width                  = av_info->geometry.max_width;
@@ -14199,12 +14563,70 @@ void recording_driver_update_streaming_url(void)
 
 #ifdef HAVE_BSV_MOVIE
 /* BSV MOVIE */
+
+/* BSV2 movies extend the BSV1 header with the keyframe
+ * interval and the offset of a frame index. Every
+ * keyframe_interval frames, a savestate block is stored
+ * in front of the input of that frame:
+ *
+ *   uint32_t stored_size, state_size
+ *   uint8_t  data[stored_size]
+ *
+ * data is zlib compressed unless stored_size equals
+ * state_size. The frame index is written when recording
+ * stops: a uint32_t count followed by count pairs of
+ * uint32_t frame and file offset of the keyframe block.
+ * All values are little-endian, as in the BSV1 header. */
+
+static bool bsv_movie_load_index(bsv_movie_t *handle,
+      uint32_t index_offset)
+{
+   size_t i;
+   uint32_t count = 0;
+
+   intfstream_seek(handle->file, (int64_t)index_offset, SEEK_SET);
+
+   if (intfstream_read(handle->file, &count, sizeof(count))
+         != sizeof(count))
+      return false;
+
+   count = swap_if_big32(count);
+
+   if (count)
+   {
+      if (!(handle->keyframes = (struct bsv_keyframe*)
+               malloc(count * sizeof(*handle->keyframes))))
+         return false;
+
+      if (intfstream_read(handle->file, handle->keyframes,
+               count * sizeof(*handle->keyframes))
+            != (int64_t)(count * sizeof(*handle->keyframes)))
+         return false;
+
+      for (i = 0; i < count; i++)
+      {
+         handle->keyframes[i].frame  =
+            swap_if_big32(handle->keyframes[i].frame);
+         handle->keyframes[i].offset =
+            swap_if_big32(handle->keyframes[i].offset);
+      }
+   }
+
+   handle->keyframes_count = count;
+   handle->keyframes_size  = count;
+   handle->data_end        = index_offset;
+
+   return true;
+}
+
 static bool bsv_movie_init_playback(
       bsv_movie_t *handle, const char *path)
 {
    uint32_t state_size       = 0;
    uint32_t content_crc      = 0;
-   uint32_t header[4]        = {0};
+   uint32_t index_offset     = 0;
+   size_t header_size        = 4 * sizeof(uint32_t);
+   uint32_t header[6]        = {0};
    intfstream_t *file        = intfstream_open_file(path,
          RETRO_VFS_FILE_ACCESS_READ,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -14219,9 +14641,20 @@ static bool bsv_movie_init_playback(
    handle->playback          = true;
 
    intfstream_read(handle->file, header, sizeof(uint32_t) * 4);
+
+   if (swap_if_little32(header[MAGIC_INDEX]) == BSV2_MAGIC)
+   {
+      header_size = sizeof(header);
+      intfstream_read(handle->file, &header[KEYFRAME_INTERVAL_INDEX],
+            sizeof(uint32_t) * 2);
+      handle->keyframe_interval = swap_if_big32(
+            header[KEYFRAME_INTERVAL_INDEX]);
+      index_offset              = swap_if_big32(
+            header[FRAME_INDEX_INDEX]);
+   }
    /* Compatibility with old implementation that
     * used incorrect documentation. */
-   if (swap_if_little32(header[MAGIC_INDEX]) != BSV_MAGIC
+   else if (swap_if_little32(header[MAGIC_INDEX]) != BSV_MAGIC
          && swap_if_big32(header[MAGIC_INDEX]) != BSV_MAGIC)
    {
       RARCH_ERR("%s\n", msg_hash_to_str(MSG_MOVIE_FILE_IS_NOT_A_VALID_BSV1_FILE));
@@ -14274,18 +14707,43 @@ static bool bsv_movie_init_playback(
                msg_hash_to_str(MSG_MOVIE_FORMAT_DIFFERENT_SERIALIZER_VERSION));
    }
 
-   handle->min_file_pos = sizeof(header) + state_size;
+   handle->min_file_pos = header_size + state_size;
+
+   /* Without an index (e.g. recording was interrupted),
+    * the movie still plays back linearly. */
+   if (index_offset)
+   {
+      if (!bsv_movie_load_index(handle, index_offset))
+      {
+         RARCH_WARN("[BSV]: Could not read frame index, "
+               "seeking will replay the movie from the start.\n");
+         free(handle->keyframes);
+         handle->keyframes       = NULL;
+         handle->keyframes_count = 0;
+         handle->keyframes_size  = 0;
+         handle->data_end        = 0;
+      }
+
+      intfstream_seek(handle->file,
+            (int64_t)handle->min_file_pos, SEEK_SET);
+   }
+
+   if (handle->keyframe_interval && handle->state_size)
+      if (!(handle->keyframe_buf = (uint8_t*)malloc(handle->state_size)))
+         return false;
 
    return true;
 }
 
 static bool bsv_movie_init_record(
-      bsv_movie_t *handle, const char *path)
+      bsv_movie_t *handle, const char *path,
+      unsigned keyframe_interval)
 {
    retro_ctx_size_info_t info;
    uint32_t state_size       = 0;
    uint32_t content_crc      = 0;
-   uint32_t header[4]        = {0};
+   size_t header_size        = 4 * sizeof(uint32_t);
+   uint32_t header[6]        = {0};
    intfstream_t *file        = intfstream_open_file(path,
          RETRO_VFS_FILE_ACCESS_WRITE,
          RETRO_VFS_FILE_ACCESS_HINT_NONE);
@@ -14311,9 +14769,22 @@ static bool bsv_movie_init_record(
 
    header[STATE_SIZE_INDEX] = swap_if_big32(state_size);
 
-   intfstream_write(handle->file, header, 4 * sizeof(uint32_t));
+   /* Keyframes need savestates, so cores without
+    * serialization support record a BSV1 movie. */
+   if (keyframe_interval && state_size)
+   {
+      if (!(handle->keyframe_buf = (uint8_t*)malloc(state_size)))
+         return false;
+
+      header_size                       = sizeof(header);
+      header[MAGIC_INDEX]               = swap_if_little32(BSV2_MAGIC);
+      header[KEYFRAME_INTERVAL_INDEX]   = swap_if_big32(keyframe_interval);
+      handle->keyframe_interval         = keyframe_interval;
+   }
+
+   intfstream_write(handle->file, header, header_size);
 
-   handle->min_file_pos     = sizeof(header) + state_size;
+   handle->min_file_pos     = header_size + state_size;
    handle->state_size       = state_size;
 
    if (state_size)
@@ -14338,21 +14809,67 @@ static bool bsv_movie_init_record(
    return true;
 }
 
+/* Appends the frame index to a BSV2 recording and
+ * stores its offset in the header. */
+static void bsv_movie_write_index(bsv_movie_t *handle)
+{
+   size_t i;
+   uint32_t value;
+   int64_t index_offset = intfstream_tell(handle->file);
+
+   /* The header stores the index offset in 32 bits, so
+    * larger movies are left without an index. */
+   if (index_offset < 0 || index_offset > 0xFFFFFFFF)
+   {
+      RARCH_WARN("[BSV]: Movie exceeds 4 GiB, "
+            "not writing frame index.\n");
+      return;
+   }
+
+   /* Keyframes beyond the last recorded frame
+    * were left behind by rewinding. */
+   while (     handle->keyframes_count
+         && handle->keyframes[handle->keyframes_count - 1].frame
+         >= handle->frame_count)
+      handle->keyframes_count--;
+
+   value = swap_if_big32((uint32_t)handle->keyframes_count);
+   intfstream_write(handle->file, &value, sizeof(value));
+
+   for (i = 0; i < handle->keyframes_count; i++)
+   {
+      struct bsv_keyframe keyframe;
+      keyframe.frame  = swap_if_big32(handle->keyframes[i].frame);
+      keyframe.offset = swap_if_big32(handle->keyframes[i].offset);
+      intfstream_write(handle->file, &keyframe, sizeof(keyframe));
+   }
+
+   value = swap_if_big32((uint32_t)index_offset);
+   intfstream_seek(handle->file,
+         FRAME_INDEX_INDEX * sizeof(uint32_t), SEEK_SET);
+   intfstream_write(handle->file, &value, sizeof(value));
+}
+
 static void bsv_movie_free(bsv_movie_t *handle)
 {
    if (!handle)
       return;
 
+   if (handle->file && !handle->playback && handle->keyframe_interval)
+      bsv_movie_write_index(handle);
+
    intfstream_close(handle->file);
    free(handle->file);
 
    free(handle->state);
+   free(handle->keyframe_buf);
+   free(handle->keyframes);
    free(handle->frame_pos);
    free(handle);
 }
 
 static bsv_movie_t *bsv_movie_init_internal(const char *path,
-      enum rarch_movie_type type)
+      enum rarch_movie_type type, unsigned keyframe_interval)
 {
    size_t *frame_pos   = NULL;
    bsv_movie_t *handle = (bsv_movie_t*)calloc(1, sizeof(*handle));
@@ -14365,7 +14882,7 @@ static bsv_movie_t *bsv_movie_init_internal(const char *path,
       if (!bsv_movie_init_playback(handle, path))
          goto error;
    }
-   else if (!bsv_movie_init_record(handle, path))
+   else if (!bsv_movie_init_record(handle, path, keyframe_interval))
       goto error;
 
    /* Just pick something really large
@@ -14399,7 +14916,8 @@ void bsv_movie_frame_rewind(void)
          && (handle->frame_pos[0] == handle->min_file_pos))
    {
       /* If we're at the beginning... */
-      handle->frame_ptr = 0;
+      handle->frame_ptr   = 0;
+      handle->frame_count = 0;
       intfstream_seek(handle->file, (int)handle->min_file_pos, SEEK_SET);
    }
    else
@@ -14410,8 +14928,11 @@ void bsv_movie_frame_rewind(void)
        *
        * Sucessively rewinding frames, we need to rewind past the read data,
        * plus another. */
-      handle->frame_ptr = (handle->frame_ptr -
-            (handle->first_rewind ? 1 : 2)) & handle->frame_mask;
+      size_t frames       = handle->first_rewind ? 1 : 2;
+      handle->frame_ptr   = (handle->frame_ptr - frames)
+         & handle->frame_mask;
+      handle->frame_count = (handle->frame_count > frames)
+         ? handle->frame_count - frames : 0;
       intfstream_seek(handle->file,
             (int)handle->frame_pos[handle->frame_ptr], SEEK_SET);
    }
@@ -14419,6 +14940,7 @@ void bsv_movie_frame_rewind(void)
    if (intfstream_tell(handle->file) <= (long)handle->min_file_pos)
    {
       /* We rewound past the beginning. */
+      handle->frame_count = 0;
 
       if (!handle->playback)
       {
@@ -14427,7 +14949,9 @@ void bsv_movie_frame_rewind(void)
          /* If recording, we simply reset
           * the starting point. Nice and easy. */
 
-         intfstream_seek(handle->file, 4 * sizeof(uint32_t), SEEK_SET);
+         intfstream_seek(handle->file,
+               (int64_t)(handle->min_file_pos - handle->state_size),
+               SEEK_SET);
 
          serial_info.data = handle->state;
          serial_info.size = handle->state_size;
@@ -14441,6 +14965,297 @@ void bsv_movie_frame_rewind(void)
    }
 }
 
+/* Compresses the keyframe state in handle->state into
+ * handle->keyframe_buf. Returns the compressed size, or 0
+ * if compression is unavailable or would not save space. */
+static uint32_t bsv_movie_compress_keyframe(bsv_movie_t *handle)
+{
+   uint32_t rd                                = 0;
+   uint32_t wn                                = 0;
+   enum trans_stream_error error              = TRANS_STREAM_ERROR_NONE;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_deflate_backend();
+   void *stream                               = NULL;
+
+   if (!backend || !(stream = backend->stream_new()))
+      return 0;
+
+   /* Keyframes are written while the game runs,
+    * so favour speed over ratio. */
+   backend->define(stream, "level", BSV_KEYFRAME_COMPRESSION_LEVEL);
+   backend->set_in(stream, handle->state, (uint32_t)handle->state_size);
+   backend->set_out(stream, handle->keyframe_buf,
+         (uint32_t)handle->state_size);
+
+   if (     !backend->trans(stream, true, &rd, &wn, &error)
+         || (error != TRANS_STREAM_ERROR_NONE))
+      wn = 0;
+
+   backend->stream_free(stream);
+   return wn;
+}
+
+static bool bsv_movie_decompress_keyframe(bsv_movie_t *handle,
+      uint32_t stored_size)
+{
+   uint32_t rd                                = 0;
+   uint32_t wn                                = 0;
+   enum trans_stream_error error              = TRANS_STREAM_ERROR_NONE;
+   const struct trans_stream_backend *backend =
+      trans_stream_get_zlib_inflate_backend();
+   void *stream                               = NULL;
+   bool ret                                   = false;
+
+   if (!backend || !(stream = backend->stream_new()))
+      return false;
+
+   backend->set_in(stream, handle->keyframe_buf, stored_size);
+   backend->set_out(stream, handle->state, (uint32_t)handle->state_size);
+
+   if (     backend->trans(stream, true, &rd, &wn, &error)
+         && (error == TRANS_STREAM_ERROR_NONE))
+      ret = (wn == handle->state_size);
+
+   backend->stream_free(stream);
+   return ret;
+}
+
+/* Stores the current state as a keyframe block and adds
+ * it to the frame index. A block is written even if the
+ * core fails to serialize, so playback stays in step.
+ * Index entries hold 32-bit offsets, so past 4 GiB only
+ * empty blocks are written. */
+static void bsv_movie_write_keyframe(bsv_movie_t *handle)
+{
+   retro_ctx_serialize_info_t serial_info;
+   uint32_t block[2];
+   const uint8_t *data  = handle->state;
+   uint32_t stored_size = (uint32_t)handle->state_size;
+   int64_t offset       = intfstream_tell(handle->file);
+
+   /* Drop keyframes left behind by rewinding. */
+   while (     handle->keyframes_count
+         && handle->keyframes[handle->keyframes_count - 1].frame
+         >= handle->frame_count)
+      handle->keyframes_count--;
+
+   serial_info.data     = handle->state;
+   serial_info.size     = handle->state_size;
+
+   if (offset < 0 || offset > 0xFFFFFFFF)
+   {
+      if (!handle->keyframes_full)
+         RARCH_WARN("[BSV]: Movie exceeds 4 GiB, "
+               "no longer writing keyframes.\n");
+      handle->keyframes_full = true;
+      stored_size            = 0;
+   }
+   else if (core_serialize(&serial_info))
+   {
+      uint32_t compressed_size = bsv_movie_compress_keyframe(handle);
+
+      /* A stored size equal to the state size marks raw data
+       * on load, so only keep output that actually shrank. */
+      if (compressed_size && compressed_size < handle->state_size)
+      {
+         data        = handle->keyframe_buf;
+         stored_size = compressed_size;
+      }
+
+      if (handle->keyframes_count == handle->keyframes_size)
+      {
+         size_t new_size                = handle->keyframes_size
+            ? handle->keyframes_size * 2 : 64;
+         struct bsv_keyframe *keyframes = (struct bsv_keyframe*)
+            realloc(handle->keyframes, new_size * sizeof(*keyframes));
+
+         if (keyframes)
+         {
+            handle->keyframes      = keyframes;
+            handle->keyframes_size = new_size;
+         }
+      }
+
+      if (handle->keyframes_count < handle->keyframes_size)
+      {
+         struct bsv_keyframe *keyframe =
+            &handle->keyframes[handle->keyframes_count++];
+         keyframe->frame               = (uint32_t)handle->frame_count;
+         keyframe->offset              = (uint32_t)offset;
+      }
+   }
+   else
+      stored_size = 0;
+
+   block[0] = swap_if_big32(stored_size);
+   block[1] = swap_if_big32((uint32_t)handle->state_size);
+   intfstream_write(handle->file, block, sizeof(block));
+   intfstream_write(handle->file, data, stored_size);
+}
+
+static bool bsv_movie_load_keyframe(bsv_movie_t *handle,
+      const struct bsv_keyframe *keyframe)
+{
+   retro_ctx_serialize_info_t serial_info;
+   uint32_t block[2];
+   uint32_t stored_size;
+
+   if (!handle->state_size)
+      return false;
+
+   intfstream_seek(handle->file, (int64_t)keyframe->offset, SEEK_SET);
+
+   if (intfstream_read(handle->file, block, sizeof(block)) != sizeof(block))
+      return false;
+
+   stored_size = swap_if_big32(block[0]);
+
+   if (     (swap_if_big32(block[1]) != handle->state_size)
+         || (stored_size == 0)
+         || (stored_size > handle->state_size))
+      return false;
+
+   if (stored_size == handle->state_size)
+   {
+      if (intfstream_read(handle->file, handle->state, stored_size)
+            != stored_size)
+         return false;
+   }
+   else if (     (intfstream_read(handle->file,
+                  handle->keyframe_buf, stored_size) != stored_size)
+            || !bsv_movie_decompress_keyframe(handle, stored_size))
+      return false;
+
+   serial_info.data_const = handle->state;
+   serial_info.size       = handle->state_size;
+
+   if (!core_unserialize(&serial_info))
+      return false;
+
+   /* Leave the block to be skipped by bsv_movie_frame_start(). */
+   intfstream_seek(handle->file, (int64_t)keyframe->offset, SEEK_SET);
+
+   return true;
+}
+
+/* Called at the start of every frame while a movie is
+ * active, before the core runs. */
+static void bsv_movie_frame_start(struct rarch_state *p_rarch,
+      bsv_movie_t *handle)
+{
+   uint32_t block[2];
+   int64_t offset = intfstream_tell(handle->file);
+
+   /* Used for rewinding while playback/record. */
+   handle->frame_pos[handle->frame_ptr] = offset;
+
+   if (     !handle->keyframe_interval
+         || !handle->frame_count
+         || (handle->frame_count % handle->keyframe_interval))
+      return;
+
+   if (!handle->playback)
+   {
+      bsv_movie_write_keyframe(handle);
+      return;
+   }
+
+   /* Skip the keyframe block during playback. */
+   if (     (handle->data_end && offset >= (int64_t)handle->data_end)
+         || (intfstream_read(handle->file, block, sizeof(block))
+            != sizeof(block)))
+   {
+      p_rarch->bsv_movie_state.movie_end = true;
+      return;
+   }
+
+   intfstream_seek(handle->file,
+         offset + sizeof(block) + swap_if_big32(block[0]), SEEK_SET);
+}
+
+static void bsv_movie_frame_end(bsv_movie_t *handle)
+{
+   handle->frame_ptr    = (handle->frame_ptr + 1) & handle->frame_mask;
+   handle->frame_count++;
+
+   handle->first_rewind = !handle->did_rewind;
+   handle->did_rewind   = false;
+}
+
+/**
+ * bsv_movie_seek:
+ *
+ * Handles --bsv-seek. Restores the last keyframe at or
+ * before the target frame, then replays the remaining
+ * frames with video and audio suspended. Without a frame
+ * index, the whole movie up to the target is replayed.
+ **/
+static void bsv_movie_seek(struct rarch_state *p_rarch,
+      bsv_movie_t *handle)
+{
+   size_t lo                = 0;
+   size_t hi                = handle->keyframes_count;
+   size_t start_frame       = handle->frame_count;
+   bool video_driver_active = p_rarch->video_driver_active;
+   bool audio_suspended     = p_rarch->audio_suspended;
+
+   handle->seek_pending     = false;
+
+   /* Find the last keyframe at or before the target. */
+   while (lo < hi)
+   {
+      size_t mid = lo + (hi - lo) / 2;
+      if (handle->keyframes[mid].frame <= handle->seek_frame)
+         lo      = mid + 1;
+      else
+         hi      = mid;
+   }
+
+   if (lo && handle->keyframes[lo - 1].frame > handle->frame_count)
+   {
+      int64_t offset = intfstream_tell(handle->file);
+
+      if (bsv_movie_load_keyframe(handle, &handle->keyframes[lo - 1]))
+      {
+         handle->frame_count  = handle->keyframes[lo - 1].frame;
+         handle->frame_ptr    = 0;
+         handle->first_rewind = true;
+         start_frame          = handle->frame_count;
+      }
+      else
+      {
+         RARCH_WARN("[BSV]: Could not load keyframe at frame %u.\n",
+               handle->keyframes[lo - 1].frame);
+         intfstream_seek(handle->file, offset, SEEK_SET);
+      }
+   }
+
+   p_rarch->video_driver_active = false;
+   p_rarch->audio_suspended     = true;
+
+   while (     handle->frame_count < handle->seek_frame
+         && !p_rarch->bsv_movie_state.movie_end)
+   {
+      bsv_movie_frame_start(p_rarch, handle);
+      core_run();
+      bsv_movie_frame_end(handle);
+   }
+
+   p_rarch->video_driver_active = video_driver_active;
+   p_rarch->audio_suspended     = audio_suspended;
+
+   /* Keep frame hash log lines in step with the movie,
+    * so a seeked run can be compared to a full one. */
+   if (runloop_state.frame_hash_file)
+      runloop_state.frame_hash_frames = handle->frame_count;
+
+   RARCH_LOG("[BSV]: Seeked to frame %u, replayed %u frames "
+         "from frame %u.\n",
+         (unsigned)handle->frame_count,
+         (unsigned)(handle->frame_count - start_frame),
+         (unsigned)start_frame);
+}
+
 static bool bsv_movie_init(struct rarch_state *p_rarch)
 {
    bsv_movie_t *state = NULL;
@@ -14448,7 +15263,7 @@ static bool bsv_movie_init(struct rarch_state *p_rarch)
    {
       if (!(state = bsv_movie_init_internal(
                p_rarch->bsv_movie_state.movie_start_path,
-               RARCH_MOVIE_PLAYBACK)))
+               RARCH_MOVIE_PLAYBACK, 0)))
       {
          RARCH_ERR("%s: \"%s\".\n",
                msg_hash_to_str(MSG_FAILED_TO_LOAD_MOVIE_FILE),
@@ -14456,6 +15271,10 @@ static bool bsv_movie_init(struct rarch_state *p_rarch)
          return false;
       }
 
+      state->seek_frame                       =
+         p_rarch->bsv_movie_state.seek_frame;
+      state->seek_pending                     = state->seek_frame > 0;
+
       p_rarch->bsv_movie_state_handle         = state;
       p_rarch->bsv_movie_state.movie_playback = true;
       runloop_msg_queue_push(msg_hash_to_str(MSG_STARTING_MOVIE_PLAYBACK),
@@ -14471,7 +15290,8 @@ static bool bsv_movie_init(struct rarch_state *p_rarch)
 
       if (!(state = bsv_movie_init_internal(
                p_rarch->bsv_movie_state.movie_start_path,
-               RARCH_MOVIE_RECORD)))
+               RARCH_MOVIE_RECORD,
+               p_rarch->bsv_movie_state.keyframe_interval)))
       {
          runloop_msg_queue_push(
                msg_hash_to_str(MSG_FAILED_TO_START_MOVIE_RECORD),
@@ -14529,7 +15349,8 @@ static bool runloop_check_movie_init(struct rarch_state *p_rarch,
          msg_hash_to_str(MSG_STARTING_MOVIE_RECORD_TO),
          path);
 
-   state = bsv_movie_init_internal(path, RARCH_MOVIE_RECORD);
+   state = bsv_movie_init_internal(path, RARCH_MOVIE_RECORD,
+         p_rarch->bsv_movie_state.keyframe_interval);
 
    if (!state)
    {
@@ -15229,6 +16050,11 @@ static void input_driver_poll(void)
 #endif
    bool input_remap_binds_enable  = settings->bools.input_remap_binds_enable;
    uint8_t max_users              = (uint8_t)settings->uints.input_max_users;
+   bool is_perfcnt_enable         = runloop_state.perfcnt_enable;
+   static struct retro_perf_counter input_poll_perf = {0};
+
+   performance_counter_init(input_poll_perf, "input_poll");
+   performance_counter_start_plus(is_perfcnt_enable, input_poll_perf);
 
    if (     joypad && joypad->poll)
       joypad->poll();
@@ -15244,7 +16070,7 @@ static void input_driver_poll(void)
    {
       for (i = 0; i < max_users; i++)
          p_rarch->input_driver_turbo_btns.frame_enable[i] = 0;
-      return;
+      goto end;
    }
 
    /* This rarch_joypad_info_t struct contains the device index + autoconfig binds for the 
@@ -15632,7 +16458,7 @@ static void input_driver_poll(void)
             struct remote_message msg;
 
             if (p_rarch->input_driver_remote->net_fd[user] < 0)
-               return;
+               goto end;
 
             FD_ZERO(&fds);
             FD_SET(p_rarch->input_driver_remote->net_fd[user], &fds);
@@ -15657,6 +16483,9 @@ static void input_driver_poll(void)
       }
    }
 #endif
+
+end:
+   performance_counter_stop_plus(is_perfcnt_enable, input_poll_perf);
 }
 
 static int16_t input_state_device(
@@ -16190,16 +17019,6 @@ int16_t input_state_internal(unsigned port, unsigned device,
          result |= port_result;
    }
 
-#ifdef HAVE_BSV_MOVIE
-   /* Save input to BSV record, if enabled */
-   if (BSV_MOVIE_IS_PLAYBACK_OFF())
-   {
-      result = swap_if_big16(result);
-      intfstream_write(
-            p_rarch->bsv_movie_state_handle->file, &result, 2);
-   }
-#endif
-
    return result;
 }
 
@@ -16225,10 +17044,13 @@ static int16_t input_state(unsigned port, unsigned device,
    /* Load input from BSV record, if enabled */
    if (BSV_MOVIE_IS_PLAYBACK_ON())
    {
-      int16_t bsv_result = 0;
-      if (intfstream_read(
-               p_rarch->bsv_movie_state_handle->file,
-               &bsv_result, 2) == 2)
+      int16_t bsv_result     = 0;
+      bsv_movie_t *handle    = p_rarch->bsv_movie_state_handle;
+
+      /* BSV2 movies end where the frame index starts. */
+      if (     (  !handle->data_end
+               || intfstream_tell(handle->file) < (int64_t)handle->data_end)
+            && intfstream_read(handle->file, &bsv_result, 2) == 2)
       {
 #ifdef HAVE_CHEEVOS
          rcheevos_pause_hardcore();
@@ -16254,8 +17076,8 @@ static int16_t input_state(unsigned port, unsigned device,
    /* Save input to BSV record, if enabled */
    if (BSV_MOVIE_IS_PLAYBACK_OFF())
    {
-      result = swap_if_big16(result);
-      intfstream_write(p_rarch->bsv_movie_state_handle->file, &result, 2);
+      int16_t bsv_result = swap_if_big16(result);
+      intfstream_write(p_rarch->bsv_movie_state_handle->file, &bsv_result, 2);
    }
 #endif
 
@@ -18767,7 +19589,11 @@ static bool audio_driver_init_internal(
          "audio driver", verbosity_enabled)))
       retroarch_fail(p_rarch, 1, "audio_driver_find()");
 
-   if (!p_rarch->current_audio || !p_rarch->current_audio->init)
+   /* Only benchmarks take samples with the null driver */
+   if (     !p_rarch->current_audio
+         || !p_rarch->current_audio->init
+         || (  p_rarch->current_audio == &audio_null
+            && !runloop_state.benchmark))
    {
       RARCH_ERR("Failed to initialize audio driver. Will continue without audio.\n");
       p_rarch->audio_driver_active = false;
@@ -18795,11 +19621,17 @@ static bool audio_driver_init_internal(
    else
 #endif
    {
+      unsigned driver_latency = audio_latency;
+#ifdef HAVE_THREADS
+      /* The output thread queues the rest of the latency */
+      if (!audio_cb_inited && settings->bools.audio_output_thread)
+         driver_latency       = audio_latency / 2;
+#endif
       p_rarch->audio_driver_context_audio_data =
          p_rarch->current_audio->init(*settings->arrays.audio_device ?
                settings->arrays.audio_device : NULL,
                settings->uints.audio_output_sample_rate,
-               audio_latency,
+               driver_latency,
                settings->uints.audio_block_frames,
                &new_rate);
    }
@@ -18812,6 +19644,21 @@ static bool audio_driver_init_internal(
       RARCH_ERR("Failed to initialize audio driver. Will continue without audio.\n");
       p_rarch->audio_driver_active    = false;
    }
+#ifdef HAVE_THREADS
+   else if (!audio_cb_inited && settings->bools.audio_output_thread)
+   {
+      RARCH_LOG("[Audio]: Starting audio output thread ...\n");
+      if (!audio_init_output_thread(
+               &p_rarch->current_audio,
+               &p_rarch->audio_driver_context_audio_data,
+               p_rarch->current_audio,
+               p_rarch->audio_driver_context_audio_data,
+               settings->uints.audio_output_sample_rate,
+               audio_latency))
+         RARCH_WARN("[Audio]: Failed to start audio output thread,"
+               " writing to the audio driver directly.\n");
+   }
+#endif
 
    p_rarch->audio_driver_use_float    = false;
    if (     p_rarch->audio_driver_active
@@ -18880,6 +19727,7 @@ static bool audio_driver_init_internal(
 
    p_rarch->audio_driver_output_samples_buf = (float*)samples_buf;
    p_rarch->audio_driver_control            = false;
+   p_rarch->audio_driver_control_pi         = false;
 
    if (
          !audio_cb_inited
@@ -18895,6 +19743,17 @@ static bool audio_driver_init_internal(
             p_rarch->current_audio->buffer_size(
                   p_rarch->audio_driver_context_audio_data);
          p_rarch->audio_driver_control     = true;
+         p_rarch->audio_driver_control_pi  =
+            settings->bools.audio_rate_control_pi;
+
+         /* The controller derives its timing from
+          * the length of the output buffer */
+         audio_rate_control_init(&p_rarch->audio_driver_rate_control,
+               p_rarch->audio_driver_rate_control_delta,
+               (double)p_rarch->audio_driver_buffer_size
+               / (settings->uints.audio_output_sample_rate * 2
+                  * (p_rarch->audio_driver_use_float
+                     ? sizeof(float) : sizeof(int16_t))));
       }
       else
          RARCH_WARN("[Audio]: Rate control was desired, but driver does not support needed features.\n");
@@ -18937,44 +19796,37 @@ static void audio_driver_flush(
       const int16_t *data, size_t samples,
       bool is_slowmotion, bool is_fastmotion)
 {
-   struct resampler_data src_data;
+   double ratio;
+   size_t input_frames               = samples >> 1;
+   size_t output_frames              = 0;
+   float *output_samples             = p_rarch->audio_driver_output_samples_buf;
+   int16_t *output_samples_conv      = p_rarch->audio_driver_output_samples_conv_buf;
+   bool use_float                    = p_rarch->audio_driver_use_float;
+   /* Samples pushed one at a time are staged in the
+    * conversion buffer, so it can only be overwritten
+    * once all of them have been consumed */
+   bool convert_blocks               = !use_float &&
+         (data != output_samples_conv);
    float audio_volume_gain           = (p_rarch->audio_driver_mute_enable ||
          (audio_fastforward_mute && is_fastmotion)) ?
                0.0f : p_rarch->audio_driver_volume_gain;
+   bool is_perfcnt_enable            = runloop_state.perfcnt_enable;
+   static struct retro_perf_counter audio_flush_perf = {0};
+#ifdef HAVE_AUDIOMIXER
+   bool mixer_override               = true;
+   float mixer_gain                  = 0.0f;
 
-   src_data.data_out                 = NULL;
-   src_data.output_frames            = 0;
-
-   convert_s16_to_float(p_rarch->audio_driver_input_data, data, samples,
-         audio_volume_gain);
-
-   src_data.data_in                  = p_rarch->audio_driver_input_data;
-   src_data.input_frames             = samples >> 1;
-
-#ifdef HAVE_DSP_FILTER
-   if (p_rarch->audio_driver_dsp)
+   if (!p_rarch->audio_driver_mixer_mute_enable)
    {
-      struct retro_dsp_data dsp_data;
-
-      dsp_data.input                 = NULL;
-      dsp_data.input_frames          = 0;
-      dsp_data.output                = NULL;
-      dsp_data.output_frames         = 0;
-
-      dsp_data.input                 = p_rarch->audio_driver_input_data;
-      dsp_data.input_frames          = (unsigned)(samples >> 1);
-
-      retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
-
-      if (dsp_data.output)
-      {
-         src_data.data_in            = dsp_data.output;
-         src_data.input_frames       = dsp_data.output_frames;
-      }
+      if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
+         mixer_override              = false;
+      mixer_gain                     =
+         p_rarch->audio_driver_mixer_volume_gain;
    }
 #endif
 
-   src_data.data_out                 = p_rarch->audio_driver_output_samples_buf;
+   performance_counter_init(audio_flush_perf, "audio_flush");
+   performance_counter_start_plus(is_perfcnt_enable, audio_flush_perf);
 
    if (p_rarch->audio_driver_control)
    {
@@ -18994,6 +19846,28 @@ static void audio_driver_flush(
 
       p_rarch->audio_driver_free_samples_buf
          [write_idx]                        = avail;
+
+      if (p_rarch->audio_driver_control_pi)
+      {
+         size_t sample_size = use_float ? sizeof(float) : sizeof(int16_t);
+         size_t queued      = 0;
+         /* Size of the write this flush is about to make */
+         size_t pending     = (size_t)(input_frames
+               * p_rarch->audio_source_ratio_original) * 2 * sample_size;
+
+         /* Drivers that measure their output latency
+          * report the fill level more precisely */
+         if (p_rarch->current_audio->delay)
+            queued          = p_rarch->current_audio->delay(
+                  p_rarch->audio_driver_context_audio_data);
+         else if ((size_t)avail < p_rarch->audio_driver_buffer_size)
+            queued          = p_rarch->audio_driver_buffer_size - avail;
+
+         adjust             = audio_rate_control_update(
+               &p_rarch->audio_driver_rate_control,
+               queued, pending, p_rarch->audio_driver_buffer_size,
+               input_frames / p_rarch->audio_driver_input);
+      }
       p_rarch->audio_source_ratio_current   =
          p_rarch->audio_source_ratio_original * adjust;
 
@@ -19010,10 +19884,10 @@ static void audio_driver_flush(
 #endif
    }
 
-   src_data.ratio           = p_rarch->audio_source_ratio_current;
+   ratio                    = p_rarch->audio_source_ratio_current;
 
    if (is_slowmotion)
-      src_data.ratio       *= slowmotion_ratio;
+      ratio                *= slowmotion_ratio;
 
    /* Note: Ideally we would divide by the user-configured
     * 'fastforward_ratio' when fast forward is enabled,
@@ -19032,49 +19906,92 @@ static void audio_driver_flush(
     * trying to do anything. Just leave the ratio as-is,
     * and hope for the best... */
 
-   p_rarch->audio_driver_resampler->process(
-         p_rarch->audio_driver_resampler_data, &src_data);
-
-#ifdef HAVE_AUDIOMIXER
-   if (p_rarch->audio_mixer_active)
+   /* Run every stage on one small block of frames at a
+    * time, rather than making a pass over the whole input
+    * per stage. The DSP filter chain and the resampler are
+    * stateful, so their output does not depend on how the
+    * input is split up. */
+   while (input_frames)
    {
-      bool override                       = true;
-      float mixer_gain                    = 0.0f;
-      bool audio_driver_mixer_mute_enable =
-         p_rarch->audio_driver_mixer_mute_enable;
+      struct resampler_data src_data;
+      size_t block_frames   = (input_frames < AUDIO_DRIVER_BLOCK_FRAMES)
+         ? input_frames : AUDIO_DRIVER_BLOCK_FRAMES;
+      float *block_output   = output_samples + output_frames * 2;
+
+      convert_s16_to_float(p_rarch->audio_driver_input_data, data,
+            block_frames * 2, audio_volume_gain);
+
+      src_data.data_in      = p_rarch->audio_driver_input_data;
+      src_data.input_frames = block_frames;
 
-      if (!audio_driver_mixer_mute_enable)
+#ifdef HAVE_DSP_FILTER
+      if (p_rarch->audio_driver_dsp)
       {
-         if (p_rarch->audio_driver_mixer_volume_gain == 1.0f)
-            override                      = false;
-         mixer_gain                       =
-            p_rarch->audio_driver_mixer_volume_gain;
+         struct retro_dsp_data dsp_data;
+
+         dsp_data.input          = p_rarch->audio_driver_input_data;
+         dsp_data.input_frames   = (unsigned)block_frames;
+         dsp_data.output         = NULL;
+         dsp_data.output_frames  = 0;
+
+         retro_dsp_filter_process(p_rarch->audio_driver_dsp, &dsp_data);
+
+         if (dsp_data.output)
+         {
+            src_data.data_in      = dsp_data.output;
+            src_data.input_frames = dsp_data.output_frames;
+         }
       }
-      audio_mixer_mix(
-            p_rarch->audio_driver_output_samples_buf,
-            src_data.output_frames, mixer_gain, override);
-   }
 #endif
 
+      src_data.data_out      = block_output;
+      src_data.output_frames = 0;
+      src_data.ratio         = ratio;
+
+      p_rarch->audio_driver_resampler->process(
+            p_rarch->audio_driver_resampler_data, &src_data);
+
+#ifdef HAVE_AUDIOMIXER
+      if (p_rarch->audio_mixer_active)
+         audio_mixer_mix(block_output, src_data.output_frames,
+               mixer_gain, mixer_override);
+#endif
+
+      if (convert_blocks)
+         convert_float_to_s16(output_samples_conv + output_frames * 2,
+               block_output, src_data.output_frames * 2);
+
+      output_frames        += src_data.output_frames;
+      data                 += block_frames * 2;
+      input_frames         -= block_frames;
+   }
+
    {
-      const void *output_data = p_rarch->audio_driver_output_samples_buf;
-      unsigned output_frames  = (unsigned)src_data.output_frames;
+      const void *output_data = output_samples;
+      size_t output_size      = output_frames * 2;
 
-      if (p_rarch->audio_driver_use_float)
-         output_frames       *= sizeof(float);
+      if (use_float)
+         output_size         *= sizeof(float);
       else
       {
-         convert_float_to_s16(p_rarch->audio_driver_output_samples_conv_buf,
-               (const float*)output_data, output_frames * 2);
+         if (!convert_blocks)
+            convert_float_to_s16(output_samples_conv,
+                  output_samples, output_frames * 2);
 
-         output_data          = p_rarch->audio_driver_output_samples_conv_buf;
-         output_frames       *= sizeof(int16_t);
+         output_data          = output_samples_conv;
+         output_size         *= sizeof(int16_t);
       }
 
+      if (runloop_state.frame_hash_file)
+         frame_hash_add_output_audio(output_data, output_size,
+               output_frames);
+
       p_rarch->current_audio->write(
             p_rarch->audio_driver_context_audio_data,
-            output_data, output_frames * 2);
+            output_data, output_size);
    }
+
+   performance_counter_stop_plus(is_perfcnt_enable, audio_flush_perf);
 }
 
 /**
@@ -19092,6 +20009,10 @@ static void audio_driver_sample(int16_t left, int16_t right)
    p_rarch->audio_driver_output_samples_conv_buf[p_rarch->audio_driver_data_ptr++] = left;
    p_rarch->audio_driver_output_samples_conv_buf[p_rarch->audio_driver_data_ptr++] = right;
 
+   if (runloop_state.frame_hash_file)
+      frame_hash_add_audio(p_rarch->audio_driver_output_samples_conv_buf
+            + p_rarch->audio_driver_data_ptr - 2, 1);
+
    if (p_rarch->audio_driver_data_ptr < p_rarch->audio_driver_chunk_size)
       return;
 
@@ -19205,6 +20126,9 @@ static size_t audio_driver_sample_batch(const int16_t *data, size_t frames)
    if (p_rarch->audio_suspended)
       return frames;
 
+   if (runloop_state.frame_hash_file)
+      frame_hash_add_audio(data, frames);
+
    if (  p_rarch->recording_data   &&
          p_rarch->recording_driver &&
          p_rarch->recording_driver->push_audio)
@@ -20063,6 +20987,11 @@ static bool audio_driver_start(struct rarch_state *p_rarch,
             p_rarch->audio_driver_context_audio_data, is_shutdown))
       goto error;
 
+   /* The buffer drained while stopped; whatever the
+    * controller learned before no longer applies. */
+   if (p_rarch->audio_driver_control_pi)
+      audio_rate_control_reset(&p_rarch->audio_driver_rate_control);
+
    return true;
 
 error:
@@ -22454,6 +23383,8 @@ static void video_driver_frame(const void *data, unsigned width,
       video_driver_pix_fmt      = p_rarch->video_driver_pix_fmt;
    bool runloop_idle            = runloop_state.idle;
    bool video_driver_active     = p_rarch->video_driver_active;
+   bool is_perfcnt_enable       = runloop_state.perfcnt_enable;
+   static struct retro_perf_counter video_frame_perf = {0};
 #if defined(HAVE_GFX_WIDGETS)
    bool widgets_active          = p_rarch->widgets_active;
 #endif
@@ -22464,6 +23395,13 @@ static void video_driver_frame(const void *data, unsigned width,
    if (!video_driver_active)
       return;
 
+   if (runloop_state.frame_hash_file)
+      frame_hash_add_video(data, width, height, pitch,
+            video_driver_pix_fmt);
+
+   performance_counter_init(video_frame_perf, "video_frame");
+   performance_counter_start_plus(is_perfcnt_enable, video_frame_perf);
+
    new_time                     = cpu_features_get_time_usec();
 
    if (data)
@@ -22647,15 +23585,20 @@ static void video_driver_frame(const void *data, unsigned width,
       unsigned output_width                             = 0;
       unsigned output_height                            = 0;
       unsigned output_pitch                             = 0;
+      bool is_perfcnt_enable                            = runloop_state.perfcnt_enable;
+      static struct retro_perf_counter video_filter_perf = {0};
 
       rarch_softfilter_get_output_size(p_rarch->video_driver_state_filter,
             &output_width, &output_height, width, height);
 
       output_pitch = (output_width) * p_rarch->video_driver_state_out_bpp;
 
+      performance_counter_init(video_filter_perf, "video_filter");
+      performance_counter_start_plus(is_perfcnt_enable, video_filter_perf);
       rarch_softfilter_process(p_rarch->video_driver_state_filter,
             p_rarch->video_driver_state_buffer, output_pitch,
             data, width, height, pitch);
+      performance_counter_stop_plus(is_perfcnt_enable, video_filter_perf);
 
       if (video_info.post_filter_record
             && p_rarch->recording_data
@@ -22670,8 +23613,17 @@ static void video_driver_frame(const void *data, unsigned width,
       width  = output_width;
       height = output_height;
       pitch  = output_pitch;
+
+      if (runloop_state.frame_hash_file)
+         frame_hash_add_filtered_video(data, width, height, pitch,
+               p_rarch->video_driver_state_out_bpp);
    }
+   else
 #endif
+   if (runloop_state.frame_hash_file)
+      frame_hash_add_filtered_video(data, width, height, pitch,
+            (video_driver_pix_fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+            ? 4 : 2);
 
    if (runloop_state.msg_queue_size > 0)
    {
@@ -22862,6 +23814,8 @@ static void video_driver_frame(const void *data, unsigned width,
    else if (!video_info.crt_switch_resolution)
 #endif
       p_rarch->video_driver_crt_switching_active = false;
+
+   performance_counter_stop_plus(is_perfcnt_enable, video_frame_perf);
 }
 
 void crt_switch_driver_refresh(void)
@@ -25241,7 +26195,7 @@ static void retroarch_print_help(const char *arg0)
           "the device (1 to %d).\n", MAX_USERS);
 
    {
-      char buf[2560];
+      char buf[3584];
       buf[0] = '\0';
       strlcpy(buf, "                        Format is PORT:ID, where ID is a number "
             "corresponding to the particular device.\n", sizeof(buf));
@@ -25251,6 +26205,13 @@ static void retroarch_print_help(const char *arg0)
             "the beginning.\n", sizeof(buf));
       strlcat(buf, "      --eof-exit        Exit upon reaching the end of the "
             "BSV movie file.\n", sizeof(buf));
+      strlcat(buf, "      --bsv-seek=FRAME  Start BSV movie playback at FRAME, "
+            "resuming from the\n"
+            "                        nearest keyframe state if the movie has one.\n", sizeof(buf));
+      strlcat(buf, "      --bsv-keyframe-interval=FRAMES\n"
+            "                        Store a keyframe state every FRAMES frames "
+            "in recorded\n"
+            "                        BSV movies, so playback can seek.\n", sizeof(buf));
 #endif
       strlcat(buf, "  -M, --sram-mode=MODE  SRAM handling mode. MODE can be "
             "'noload-nosave',\n"
@@ -25307,6 +26268,15 @@ static void retroarch_print_help(const char *arg0)
 #endif
       strlcat(buf, "      --load-menu-on-error\n"
             "                        Open menu instead of quitting if specified core or content fails to load.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark       Runs content unthrottled with null video, audio and input\n"
+            "                        drivers for max-frames frames (default: 3600), then prints\n"
+            "                        a JSON timing report.\n", sizeof(buf));
+      strlcat(buf, "      --benchmark-report=FILE\n"
+            "                        Path to write the benchmark report to instead of stdout.\n", sizeof(buf));
+      strlcat(buf, "      --frame-hash-log=FILE\n"
+            "                        Logs hashes of every video frame and audio batch to FILE,\n"
+            "                        before and after filtering, for comparison with\n"
+            "                        tools/framehash_compare.\n", sizeof(buf));
       puts(buf);
    }
 }
@@ -25388,6 +26358,11 @@ static bool retroarch_parse_input_and_config(
       { "log-file",           1, NULL, RA_OPT_LOG_FILE },
       { "accessibility",      0, NULL, RA_OPT_ACCESSIBILITY},
       { "load-menu-on-error", 0, NULL, RA_OPT_LOAD_MENU_ON_ERROR },
+      { "benchmark",          0, NULL, RA_OPT_BENCHMARK },
+      { "benchmark-report",   1, NULL, RA_OPT_BENCHMARK_REPORT },
+      { "frame-hash-log",     1, NULL, RA_OPT_FRAME_HASH_LOG },
+      { "bsv-seek",           1, NULL, RA_OPT_BSV_SEEK },
+      { "bsv-keyframe-interval", 1, NULL, RA_OPT_BSV_KEYFRAME_INTERVAL },
       { NULL, 0, NULL, 0 }
    };
 
@@ -25948,6 +26923,20 @@ static bool retroarch_parse_input_and_config(
 #endif
                break;
 
+            case RA_OPT_BSV_SEEK:
+#ifdef HAVE_BSV_MOVIE
+               p_rarch->bsv_movie_state.seek_frame =
+                  (unsigned)strtoul(optarg, NULL, 10);
+#endif
+               break;
+
+            case RA_OPT_BSV_KEYFRAME_INTERVAL:
+#ifdef HAVE_BSV_MOVIE
+               p_rarch->bsv_movie_state.keyframe_interval =
+                  (unsigned)strtoul(optarg, NULL, 10);
+#endif
+               break;
+
             case RA_OPT_VERSION:
                retroarch_print_version();
                exit(0);
@@ -25974,6 +26963,17 @@ static bool retroarch_parse_input_and_config(
             case RA_OPT_LOAD_MENU_ON_ERROR:
                global->cli_load_menu_on_error = true;
                break;
+            case RA_OPT_BENCHMARK:
+               runloop_state.benchmark = true;
+               break;
+            case RA_OPT_BENCHMARK_REPORT:
+               strlcpy(runloop_state.benchmark_report_path, optarg,
+                     sizeof(runloop_state.benchmark_report_path));
+               break;
+            case RA_OPT_FRAME_HASH_LOG:
+               strlcpy(runloop_state.frame_hash_path, optarg,
+                     sizeof(runloop_state.frame_hash_path));
+               break;
             default:
                RARCH_ERR("%s\n", msg_hash_to_str(MSG_ERROR_PARSING_ARGUMENTS));
                retroarch_fail(p_rarch, 1, "retroarch_parse_input()");
@@ -25981,6 +26981,39 @@ static bool retroarch_parse_input_and_config(
       }
    }
 
+   if (runloop_state.benchmark)
+   {
+      settings_t *settings = p_rarch->configuration_settings;
+
+      /* Benchmarks measure the frontend and the core only,
+       * so nothing may wait on a display, an audio device
+       * or a controller. As overrides, these drivers are
+       * neither replaced by config files nor saved to them. */
+      strlcpy(settings->arrays.video_driver, "null",
+            sizeof(settings->arrays.video_driver));
+      retroarch_override_setting_set(
+            RARCH_OVERRIDE_SETTING_VIDEO_DRIVER, NULL);
+      strlcpy(settings->arrays.audio_driver, "null",
+            sizeof(settings->arrays.audio_driver));
+      retroarch_override_setting_set(
+            RARCH_OVERRIDE_SETTING_AUDIO_DRIVER, NULL);
+      strlcpy(settings->arrays.input_driver, "null",
+            sizeof(settings->arrays.input_driver));
+      retroarch_override_setting_set(
+            RARCH_OVERRIDE_SETTING_INPUT_DRIVER, NULL);
+      strlcpy(settings->arrays.input_joypad_driver, "null",
+            sizeof(settings->arrays.input_joypad_driver));
+      retroarch_override_setting_set(
+            RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER, NULL);
+
+      if (!runloop_state.max_frames)
+         runloop_state.max_frames   = BENCHMARK_DEFAULT_FRAMES;
+      runloop_state.benchmark_frames = 0;
+      runloop_state.perfcnt_enable   = true;
+   }
+
+   frame_hash_log_open();
+
 #ifdef HAVE_GIT_VERSION
    RARCH_LOG("RetroArch %s (Git %s)\n",
          PACKAGE_VERSION, retroarch_git_version);
@@ -27549,6 +28582,14 @@ bool retroarch_override_setting_is_set(
 #endif
       case RARCH_OVERRIDE_SETTING_LOG_TO_FILE:
          return p_rarch->has_set_log_to_file;
+      case RARCH_OVERRIDE_SETTING_VIDEO_DRIVER:
+         return p_rarch->has_set_video_driver;
+      case RARCH_OVERRIDE_SETTING_AUDIO_DRIVER:
+         return p_rarch->has_set_audio_driver;
+      case RARCH_OVERRIDE_SETTING_INPUT_DRIVER:
+         return p_rarch->has_set_input_driver;
+      case RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER:
+         return p_rarch->has_set_input_joypad_driver;
       case RARCH_OVERRIDE_SETTING_NONE:
       default:
          break;
@@ -28748,6 +29789,9 @@ static enum runloop_state runloop_check_state(
    /* Check if we have pressed the recording toggle button */
    HOTKEY_CHECK(RARCH_RECORDING_TOGGLE, CMD_EVENT_RECORDING_TOGGLE, true, NULL);
 
+   /* Check if we have pressed the replay buffer save button */
+   HOTKEY_CHECK(RARCH_REPLAY_SAVE, CMD_EVENT_RECORDING_REPLAY_SAVE, true, NULL);
+
    /* Check if we have pressed the streaming toggle button */
    HOTKEY_CHECK(RARCH_STREAMING_TOGGLE, CMD_EVENT_STREAMING_TOGGLE, true, NULL);
 
@@ -29009,15 +30053,21 @@ static enum runloop_state runloop_check_state(
          char s[128];
          bool rewinding = false;
          unsigned t     = 0;
+         static struct retro_perf_counter rewind_perf = {0};
 
          s[0]           = '\0';
 
+         performance_counter_init(rewind_perf, "rewind");
+         performance_counter_start_plus(runloop_state.perfcnt_enable,
+               rewind_perf);
          rewinding      = state_manager_check_rewind(
                &p_rarch->rewind_st,
                BIT256_GET(current_bits, RARCH_REWIND),
                settings->uints.rewind_granularity,
                runloop_state.paused,
                s, sizeof(s), &t);
+         performance_counter_stop_plus(runloop_state.perfcnt_enable,
+               rewind_perf);
 
 #if defined(HAVE_GFX_WIDGETS)
          if (widgets_active)
@@ -29292,6 +30342,8 @@ int runloop_iterate(void)
       case RUNLOOP_STATE_QUIT:
          p_rarch->frame_limit_last_time = 0.0;
          runloop_state.core_running  = false;
+         if (runloop_state.benchmark && runloop_state.benchmark_frames)
+            benchmark_write_report(p_rarch);
          command_event(CMD_EVENT_QUIT, NULL);
          return -1;
       case RUNLOOP_STATE_POLLED_AND_SLEEP:
@@ -29326,16 +30378,30 @@ int runloop_iterate(void)
          break;
    }
 
+   if (runloop_state.benchmark)
+   {
+      /* Time is taken from the first frame the core runs,
+       * so that content loading is not part of the result */
+      if (!runloop_state.benchmark_frames++)
+      {
+         runloop_state.perfcnt_enable        = true;
+         runloop_state.benchmark_start_time  = cpu_features_get_time_usec();
+         runloop_state.benchmark_start_ticks = cpu_features_get_perf_counter();
+      }
+   }
+
 #ifdef HAVE_THREADS
    if (runloop_state.autosave)
       autosave_lock();
 #endif
 
 #ifdef HAVE_BSV_MOVIE
-   /* Used for rewinding while playback/record. */
    if (p_rarch->bsv_movie_state_handle)
-      p_rarch->bsv_movie_state_handle->frame_pos[p_rarch->bsv_movie_state_handle->frame_ptr]
-         = intfstream_tell(p_rarch->bsv_movie_state_handle->file);
+   {
+      if (p_rarch->bsv_movie_state_handle->seek_pending)
+         bsv_movie_seek(p_rarch, p_rarch->bsv_movie_state_handle);
+      bsv_movie_frame_start(p_rarch, p_rarch->bsv_movie_state_handle);
+   }
 #endif
 
    if (  p_rarch->camera_cb.caps &&
@@ -29433,16 +30499,27 @@ int runloop_iterate(void)
 #endif
 
       if (want_runahead)
+      {
+         static struct retro_perf_counter runahead_perf = {0};
+         performance_counter_init(runahead_perf, "runahead");
+         performance_counter_start_plus(runloop_state.perfcnt_enable,
+               runahead_perf);
          do_runahead(
                p_rarch,
                run_ahead_num_frames,
                run_ahead_hide_warnings,
                run_ahead_secondary_instance);
+         performance_counter_stop_plus(runloop_state.perfcnt_enable,
+               runahead_perf);
+      }
       else
 #endif
          core_run();
    }
 
+   if (runloop_state.frame_hash_file)
+      frame_hash_write_line();
+
    /* Increment runtime tick counter after each call to
     * core_run() or run_ahead() */
    p_rarch->libretro_core_runtime_usec += rarch_core_runtime_tick(
@@ -29482,15 +30559,7 @@ int runloop_iterate(void)
 
 #ifdef HAVE_BSV_MOVIE
    if (p_rarch->bsv_movie_state_handle)
-   {
-      p_rarch->bsv_movie_state_handle->frame_ptr    =
-         (p_rarch->bsv_movie_state_handle->frame_ptr + 1)
-         & p_rarch->bsv_movie_state_handle->frame_mask;
-
-      p_rarch->bsv_movie_state_handle->first_rewind =
-         !p_rarch->bsv_movie_state_handle->did_rewind;
-      p_rarch->bsv_movie_state_handle->did_rewind   = false;
-   }
+      bsv_movie_frame_end(p_rarch->bsv_movie_state_handle);
 #endif
 
 #ifdef HAVE_THREADS
@@ -29544,8 +30613,9 @@ end:
                   1.0f);
    }
 
-   /* if there's a fast forward limit, inject sleeps to keep from going too fast. */
-   if (p_rarch->frame_limit_minimum_time)
+   /* if there's a fast forward limit, inject sleeps to keep from going too fast.
+    * Benchmarks always run unthrottled. */
+   if (p_rarch->frame_limit_minimum_time && !runloop_state.benchmark)
    {
       const retro_time_t end_frame_time = cpu_features_get_time_usec();
       const retro_time_t to_sleep_ms = (
@@ -30138,9 +31208,17 @@ bool core_run(void)
       : current_core->poll_type;
    bool early_polling          = new_poll_type == POLL_TYPE_EARLY;
    bool late_polling           = new_poll_type == POLL_TYPE_LATE;
+   bool is_perfcnt_enable      = runloop_state.perfcnt_enable;
+   static struct retro_perf_counter core_run_perf = {0};
 #ifdef HAVE_NETWORKING
-   bool netplay_preframe       = netplay_driver_ctl(
+   static struct retro_perf_counter netplay_perf  = {0};
+   bool netplay_preframe;
+
+   performance_counter_init(netplay_perf, "netplay");
+   performance_counter_start_plus(is_perfcnt_enable, netplay_perf);
+   netplay_preframe            = netplay_driver_ctl(
          RARCH_NETPLAY_CTL_PRE_FRAME, NULL);
+   performance_counter_stop_plus(is_perfcnt_enable, netplay_perf);
 
    if (!netplay_preframe)
    {
@@ -30157,13 +31235,18 @@ bool core_run(void)
    else if (late_polling)
       current_core->input_polled = false;
 
+   performance_counter_init(core_run_perf, "core_run");
+   performance_counter_start_plus(is_perfcnt_enable, core_run_perf);
    current_core->retro_run();
+   performance_counter_stop_plus(is_perfcnt_enable, core_run_perf);
 
    if (late_polling && !current_core->input_polled)
       input_driver_poll();
 
 #ifdef HAVE_NETWORKING
+   performance_counter_start_plus(is_perfcnt_enable, netplay_perf);
    netplay_driver_ctl(RARCH_NETPLAY_CTL_POST_FRAME, NULL);
+   performance_counter_stop_plus(is_perfcnt_enable, netplay_perf);
 #endif
 
    return true;
@@ -202,6 +202,10 @@ enum rarch_override_setting
    RARCH_OVERRIDE_SETTING_IPS_PREF,
    RARCH_OVERRIDE_SETTING_LIBRETRO_DEVICE,
    RARCH_OVERRIDE_SETTING_LOG_TO_FILE,
+   RARCH_OVERRIDE_SETTING_VIDEO_DRIVER,
+   RARCH_OVERRIDE_SETTING_AUDIO_DRIVER,
+   RARCH_OVERRIDE_SETTING_INPUT_DRIVER,
+   RARCH_OVERRIDE_SETTING_INPUT_JOYPAD_DRIVER,
    RARCH_OVERRIDE_SETTING_LAST
 };
 
@@ -327,6 +331,7 @@ typedef struct content_file_info
    char *meta; /* Unused at present */
    void *data;
    size_t data_size;
+   bool data_mapped; /* 'data' is a memory mapped view */
    bool file_in_archive;
    bool persistent_data;
 } content_file_info_t;
@@ -547,6 +552,11 @@ typedef struct audio_driver
    size_t (*write_avail)(void *data);
 
    size_t (*buffer_size)(void *data);
+
+   /* Optional. Measured output latency: bytes of audio written
+    * but not played yet. Preferred over write_avail() for rate
+    * control, as it follows the playback position more closely. */
+   size_t (*delay)(void *data);
 } audio_driver_t;
 
 bool audio_driver_enable_callback(void);
@@ -720,6 +730,14 @@ struct record_params
    unsigned video_record_threads;
    unsigned streaming_mode;
 
+   /* Seconds of encoded output kept in memory instead of
+    * being written to filename, until save_replay is called.
+    * 0 writes everything to filename. */
+   unsigned replay_buffer_seconds;
+   /* Seconds after which output continues in a new file.
+    * 0 writes a single file. */
+   unsigned segment_seconds;
+
    /* Aspect ratio of input video. Parameters are passed to the muxer,
     * the video itself is not scaled.
     */
@@ -755,6 +773,8 @@ typedef struct record_driver
    bool  (*push_video)(void *data, const struct record_video_data *video_data);
    bool  (*push_audio)(void *data, const struct record_audio_data *audio_data);
    bool  (*finalize)(void *data);
+   /* Writes out the replay buffer. Optional. */
+   bool  (*save_replay)(void *data);
    const char *ident;
 } record_driver_t;
 
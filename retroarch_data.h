@@ -65,9 +65,14 @@
 #define SERIALIZER_INDEX   1
 #define CRC_INDEX          2
 #define STATE_SIZE_INDEX   3
+/* BSV2 only */
+#define KEYFRAME_INTERVAL_INDEX 4
+#define FRAME_INDEX_INDEX  5
 
 #ifdef HAVE_BSV_MOVIE
 #define BSV_MAGIC          0x42535631
+#define BSV2_MAGIC         0x42535632
+#define BSV_KEYFRAME_COMPRESSION_LEVEL 1
 
 #define BSV_MOVIE_IS_PLAYBACK_ON() (p_rarch->bsv_movie_state_handle && p_rarch->bsv_movie_state.movie_playback)
 #define BSV_MOVIE_IS_PLAYBACK_OFF() (p_rarch->bsv_movie_state_handle && !p_rarch->bsv_movie_state.movie_playback)
@@ -79,6 +84,10 @@
 
 #define AUDIO_BUFFER_FREE_SAMPLES_COUNT (8 * 1024)
 
+/* Input frames run through the audio output pipeline at
+ * once, small enough for all stages to stay in L1 cache */
+#define AUDIO_DRIVER_BLOCK_FRAMES 256
+
 #define MENU_SOUND_FORMATS "ogg|mod|xm|s3m|mp3|flac|wav"
 
 /**
@@ -342,6 +351,10 @@
 #endif
 #endif
 
+/* Number of frames run by --benchmark when
+ * --max-frames is not given */
+#define BENCHMARK_DEFAULT_FRAMES 3600
+
 #ifdef _WIN32
 #define PERF_LOG_FMT "[PERF]: Avg (%s): %I64u ticks, %I64u runs.\n"
 #else
@@ -350,15 +363,37 @@
 
 /* DRIVERS */
 
+/* The null audio driver discards all samples, so that
+ * audio processing still runs for --benchmark. Outside of
+ * benchmarks, selecting it turns audio off instead */
+static void *audio_null_init(const char *device, unsigned rate,
+      unsigned latency, unsigned block_frames, unsigned *new_rate)
+{
+   *new_rate = rate;
+   return (void*)-1;
+}
+
+static ssize_t audio_null_write(void *data, const void *buf, size_t size)
+{
+   return size;
+}
+
+static bool audio_null_stop(void *data) { return true; }
+static bool audio_null_start(void *data, bool is_shutdown) { return true; }
+static bool audio_null_alive(void *data) { return true; }
+static void audio_null_set_nonblock_state(void *data, bool toggle) { }
+static void audio_null_free(void *data) { }
+static bool audio_null_use_float(void *data) { return false; }
+
 audio_driver_t audio_null = {
-   NULL, /* init */
-   NULL, /* write */
-   NULL, /* stop */
-   NULL, /* start */
-   NULL, /* alive */
-   NULL, /* set_nonblock_state */
-   NULL, /* free */
-   NULL, /* use_float */
+   audio_null_init,
+   audio_null_write,
+   audio_null_stop,
+   audio_null_start,
+   audio_null_alive,
+   audio_null_set_nonblock_state,
+   audio_null_free,
+   audio_null_use_float,
    "null",
    NULL,
    NULL,
@@ -831,6 +866,7 @@ static const record_driver_t record_null = {
    NULL, /* push_video */
    NULL, /* push_audio */
    NULL, /* finalize */
+   NULL, /* save_replay */
    "null",
 };
 
@@ -905,7 +941,12 @@ enum
    RA_OPT_MAX_FRAMES_SCREENSHOT_PATH,
    RA_OPT_SET_SHADER,
    RA_OPT_ACCESSIBILITY,
-   RA_OPT_LOAD_MENU_ON_ERROR
+   RA_OPT_LOAD_MENU_ON_ERROR,
+   RA_OPT_BENCHMARK,
+   RA_OPT_BENCHMARK_REPORT,
+   RA_OPT_FRAME_HASH_LOG,
+   RA_OPT_BSV_SEEK,
+   RA_OPT_BSV_KEYFRAME_INTERVAL
 };
 
 enum rarch_movie_type
@@ -1015,6 +1056,7 @@ struct rarch_state
 
    double audio_source_ratio_original;
    double audio_source_ratio_current;
+   audio_rate_control_t audio_driver_rate_control;   /* double alignment */
    struct retro_system_av_info video_driver_av_info; /* double alignment */
 #ifdef HAVE_CRTSWITCHRES
    videocrt_switch_t crt_switch_st;                  /* double alignment */
@@ -1357,7 +1399,7 @@ struct rarch_state
 
 
 #ifdef HAVE_BSV_MOVIE
-   struct bsv_state bsv_movie_state;            /* char alignment */
+   struct bsv_state bsv_movie_state;            /* uint32_t alignment */
 #endif
    char cached_video_driver[32];
    char video_driver_title_buf[64];
@@ -1424,6 +1466,10 @@ struct rarch_state
    bool qt_is_inited;
 #endif
    bool has_set_log_to_file;
+   bool has_set_video_driver;
+   bool has_set_audio_driver;
+   bool has_set_input_driver;
+   bool has_set_input_joypad_driver;
    bool rarch_is_inited;
    bool rarch_is_switching_display_mode;
    bool rarch_is_sram_load_disabled;
@@ -1503,6 +1549,7 @@ struct rarch_state
    bool video_started_fullscreen;
 
    bool audio_driver_control;
+   bool audio_driver_control_pi;
    bool audio_driver_mute_enable;
    bool audio_driver_use_float;
 
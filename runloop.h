@@ -33,6 +33,8 @@
 #include <rthreads/rthreads.h>
 #endif
 
+#include <streams/file_stream.h>
+
 #include "core_option_manager.h"
 
 enum  runloop_state
@@ -87,6 +89,10 @@ typedef struct core_options_callbacks
 struct runloop
 {
    retro_usec_t frame_time_last;        /* int64_t alignment */
+   retro_time_t benchmark_start_time;   /* int64_t alignment */
+   retro_perf_tick_t benchmark_start_ticks; /* uint64_t alignment */
+   uint64_t benchmark_frames;
+   uint64_t frame_hash_frames;
 
    msg_queue_t msg_queue;                        /* ptr alignment */
 #ifdef HAVE_THREADS
@@ -94,6 +100,8 @@ struct runloop
 #endif
    size_t msg_queue_size;
 
+   RFILE *frame_hash_file;                       /* ptr alignment */
+
    core_option_manager_t *core_options;
    core_options_callbacks_t core_options_callback; /* ptr alignment */
 
@@ -106,6 +114,14 @@ struct runloop
    unsigned pending_windowed_scale;
    unsigned max_frames;
    unsigned audio_latency;
+   unsigned frame_hash_width;
+   unsigned frame_hash_height;
+   unsigned frame_hash_audio_frames;
+   unsigned frame_hash_output_frames;
+   uint32_t frame_hash_video;
+   uint32_t frame_hash_filtered;
+   uint32_t frame_hash_audio;
+   uint32_t frame_hash_output;
 
    fastmotion_overrides_t fastmotion_override; /* float alignment */
 
@@ -129,10 +145,13 @@ struct runloop
    bool remaps_core_active;
    bool remaps_game_active;
    bool remaps_content_dir_active;
+   bool benchmark;
 #ifdef HAVE_SCREENSHOTS
    bool max_frames_screenshot;
    char max_frames_screenshot_path[PATH_MAX_LENGTH];
 #endif
+   char benchmark_report_path[PATH_MAX_LENGTH];
+   char frame_hash_path[PATH_MAX_LENGTH];
 };
 
 typedef struct runloop runloop_state_t;
@@ -45,6 +45,22 @@
 #include "../config.h"
 #endif
 
+#ifdef HAVE_MMAP
+#include <memmap.h>
+/* Content is only mapped where memmap.h provides
+ * POSIX mmap: the Win32 shim has no private
+ * copy-on-write mappings */
+#if defined(HAVE_MMAN) && !defined(_WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#define CONTENT_FILE_HAVE_MMAP
+#if !defined(MAP_ANONYMOUS) && defined(MAP_ANON)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
+#endif
+
 #include <boolean.h>
 
 #include <encodings/crc32.h>
@@ -283,6 +299,20 @@ bool content_file_override_set(
    return true;
 }
 
+static void content_file_data_free(void *data,
+      size_t data_size, bool data_mapped)
+{
+#ifdef CONTENT_FILE_HAVE_MMAP
+   /* Mapped views include a terminating NUL byte */
+   if (data_mapped)
+   {
+      munmap(data, data_size + 1);
+      return;
+   }
+#endif
+   free(data);
+}
+
 /* Frees any content data that is not flagged
  * as 'persistent'. Should be called after
  * content_file_load() */
@@ -301,10 +331,12 @@ static void content_file_list_free_transient_data(
       if (file_info->data &&
           !file_info->persistent_data)
       {
-         free((void*)file_info->data);
+         content_file_data_free(file_info->data,
+               file_info->data_size, file_info->data_mapped);
 
-         file_info->data      = NULL;
-         file_info->data_size = 0;
+         file_info->data        = NULL;
+         file_info->data_size   = 0;
+         file_info->data_mapped = false;
       }
    }
 }
@@ -359,10 +391,12 @@ static void content_file_list_free_entry(
 
    if (file_info->data)
    {
-      free((void*)file_info->data);
+      content_file_data_free(file_info->data,
+            file_info->data_size, file_info->data_mapped);
       file_info->data = NULL;
    }
-   file_info->data_size = 0;
+   file_info->data_size   = 0;
+   file_info->data_mapped = false;
 
    file_info->file_in_archive = false;
    file_info->persistent_data = false;
@@ -494,12 +528,15 @@ static const char *content_file_list_append_temporary(
    return NULL;
 }
 
-/* Note: Takes ownership of supplied 'data' buffer */
+/* Note: Takes ownership of supplied 'data' buffer,
+ * which is unmapped rather than freed if 'data_mapped'
+ * is set */
 static bool content_file_list_set_info(
       content_file_list_t *file_list,
       const char *path,
       void *data,
       size_t data_size,
+      bool data_mapped,
       bool persistent_data,
       size_t idx)
 {
@@ -550,6 +587,7 @@ static bool content_file_list_set_info(
 
    file_info->data            = data;
    file_info->data_size       = data_size;
+   file_info->data_mapped     = data_mapped;
    file_info->persistent_data = persistent_data;
 
    /* Assign paths
@@ -691,15 +729,115 @@ static bool content_file_list_set_info(
 #define CONTENT_FILE_ATTR_GET_REQUIRED(attr)      ((attr.i & 4) != 0)
 #define CONTENT_FILE_ATTR_GET_PERSISTENT(attr)    ((attr.i & 8) != 0)
 
+#ifdef CONTENT_FILE_HAVE_MMAP
+/**
+ * content_file_map:
+ * @content_path : path of the content file.
+ * @data         : mapped view of the content file.
+ * @data_size    : size of the mapped view.
+ *
+ * Maps an uncompressed content file into memory, so that
+ * its pages are read from the page cache as the core
+ * accesses them instead of being copied up front. The
+ * mapping is private: cores that modify their content
+ * buffer in place get copy-on-write pages, and the file
+ * itself is never written.
+ *
+ * Like filestream_read_file(), the view is followed by a
+ * NUL byte, for cores that parse their content as a
+ * string. The file is mapped over a zeroed anonymous
+ * mapping one byte larger, so that byte is readable even
+ * when the file size is a multiple of the page size. The
+ * view is @data_size + 1 bytes long and has to be unmapped
+ * as such.
+ *
+ * Note: pages not yet read come from the file, so if the
+ * file is truncated while the content is loaded, accessing
+ * them raises SIGBUS. Content is loaded once at startup,
+ * and replacing a file (rather than rewriting it in place)
+ * keeps the old contents mapped, so this only affects
+ * content that is truncated in place while running.
+ *
+ * Returns: true if successful, false if the file cannot
+ * be mapped (e.g. it is not a regular file reachable via
+ * standard I/O), in which case it should be read instead.
+ **/
+static bool content_file_map(const char *content_path,
+      uint8_t **data, size_t *data_size)
+{
+   struct stat st;
+   size_t size;
+   uint8_t *ptr = NULL;
+   int fd       = open(content_path, O_RDONLY);
+
+   if (fd < 0)
+      return false;
+
+   if (     fstat(fd, &st) != 0
+         || !S_ISREG(st.st_mode)
+         || st.st_size <= 0
+         || (uint64_t)st.st_size >= (uint64_t)SIZE_MAX)
+      goto error;
+
+   size = (size_t)st.st_size;
+
+   if ((ptr = (uint8_t*)mmap(NULL, size + 1, PROT_READ | PROT_WRITE,
+               MAP_PRIVATE | MAP_ANONYMOUS, -1, 0)) == MAP_FAILED)
+      goto error;
+
+   if (mmap(ptr, size, PROT_READ | PROT_WRITE,
+            MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+   {
+      munmap(ptr, size + 1);
+      goto error;
+   }
+
+   /* The mapping remains valid once the file is closed */
+   close(fd);
+
+   *data      = ptr;
+   *data_size = size;
+   return true;
+
+error:
+   close(fd);
+   return false;
+}
+
+/* Returns true if a soft patch would be applied to
+ * the first content file */
+static bool content_file_has_patch(
+      content_information_ctx_t *content_ctx)
+{
+#ifdef HAVE_PATCH
+   if (content_ctx->patch_is_blocked)
+      return false;
+
+   return
+         (  !string_is_empty(content_ctx->name_ips)
+          && path_is_valid(content_ctx->name_ips))
+      || (  !string_is_empty(content_ctx->name_bps)
+          && path_is_valid(content_ctx->name_bps))
+      || (  !string_is_empty(content_ctx->name_ups)
+          && path_is_valid(content_ctx->name_ups));
+#else
+   return false;
+#endif
+}
+#endif
+
 /**
  * content_file_load_into_memory:
  * @content_path : path of the content file.
  * @data         : buffer into which the content file will be read.
  * @data_size    : size of the resultant content buffer.
+ * @data_mapped  : set if @data is a mapped view of the file,
+ *                 which has to be unmapped rather than freed.
  *
  * Reads the content file into memory. Also performs soft patching
  * (see patch_content function) if soft patching has not been
- * blocked by the user.
+ * blocked by the user. Uncompressed content which is not patched
+ * is mapped instead of read, where supported.
  *
  * Returns: true if successful, false on error.
  **/
@@ -711,13 +849,18 @@ static bool content_file_load_into_memory(
       size_t idx,
       enum rarch_content_type first_content_type,
       uint8_t **data,
-      size_t *data_size)
+      size_t *data_size,
+      bool *data_mapped)
 {
    uint8_t *content_data = NULL;
    int64_t content_size  = 0;
+#ifdef CONTENT_FILE_HAVE_MMAP
+   size_t mapped_size    = 0;
+#endif
 
-   *data      = NULL;
-   *data_size = 0;
+   *data        = NULL;
+   *data_size   = 0;
+   *data_mapped = false;
 
    RARCH_LOG("[CONTENT LOAD]: %s: %s\n",
          msg_hash_to_str(MSG_LOADING_CONTENT_FILE), content_path);
@@ -731,10 +874,26 @@ static bool content_file_load_into_memory(
          return false;
    }
    else
+#endif
+   {
+#ifdef CONTENT_FILE_HAVE_MMAP
+      /* Patching replaces the content buffer, so
+       * only map content that will be used as is */
+      if (!(     idx == 0
+              && first_content_type == RARCH_CONTENT_NONE
+              && content_file_has_patch(content_ctx))
+            && content_file_map(content_path,
+                  &content_data, &mapped_size))
+      {
+         content_size = (int64_t)mapped_size;
+         *data_mapped = true;
+      }
+      else
 #endif
       if (!filestream_read_file(content_path,
             (void**)&content_data, &content_size))
          return false;
+   }
 
    if (content_size < 0)
       return false;
@@ -985,6 +1144,7 @@ static bool content_file_load(
       const char *content_path = NULL;
       uint8_t *content_data    = NULL;
       size_t content_size      = 0;
+      bool content_data_mapped = false;
       const char *valid_exts   = special ?
             special->roms[i].valid_extensions :
                   content_ctx->valid_extensions;
@@ -1022,7 +1182,7 @@ static bool content_file_load(
             if (!content_file_load_into_memory(
                   content_ctx, p_content, content_path,
                   content_compressed, i, first_content_type,
-                  &content_data, &content_size))
+                  &content_data, &content_size, &content_data_mapped))
             {
                snprintf(msg, sizeof(msg), "%s \"%s\"\n",
                      msg_hash_to_str(MSG_COULD_NOT_READ_CONTENT_FILE),
@@ -1131,11 +1291,13 @@ static bool content_file_load(
       if (!content_file_list_set_info(
             p_content->content_list,
             content_path, content_data, content_size,
+            content_data_mapped,
             CONTENT_FILE_ATTR_GET_PERSISTENT(content->elems[i].attr), i))
       {
          RARCH_LOG("[CONTENT LOAD]: Failed to process content file: %s\n", content_path);
          if (content_data)
-            free((void*)content_data);
+            content_file_data_free(content_data, content_size,
+                  content_data_mapped);
          *error_enum = MSG_FAILED_TO_LOAD_CONTENT;
          return false;
       }
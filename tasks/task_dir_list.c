@@ -0,0 +1,149 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2021 - The RetroArch team
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <boolean.h>
+#include <lists/dir_list.h>
+#include <lists/string_list.h>
+
+#include "tasks_internal.h"
+
+#include "../msg_hash.h"
+
+typedef struct dir_list_handle
+{
+   dir_list_stream_t *stream;
+   dir_list_batch_t *batch;
+   size_t max_entries;
+} dir_list_handle_t;
+
+void dir_list_batch_free(dir_list_batch_t *batch)
+{
+   if (!batch)
+      return;
+
+   dir_list_free(batch->list);
+   free(batch);
+}
+
+static void cb_task_dir_list_cleanup(retro_task_t *task)
+{
+   dir_list_handle_t *handle = NULL;
+
+   if (!task || !(handle = (dir_list_handle_t*)task->state))
+      return;
+
+   dir_list_batch_free(handle->batch);
+   free(handle);
+}
+
+static void task_dir_list_handler(retro_task_t *task)
+{
+   int ret;
+   dir_list_handle_t *handle = NULL;
+
+   if (!task)
+      return;
+
+   if (!(handle = (dir_list_handle_t*)task->state))
+      goto task_finished;
+
+   if (task_get_cancelled(task))
+      goto task_finished;
+
+   ret = dir_list_stream_read(handle->stream,
+         handle->batch->list, handle->max_entries);
+
+   if (ret < 0)
+   {
+      task_set_error(task, strdup(msg_hash_to_str(MSG_ERROR_READING_DIRECTORY)));
+      goto task_finished;
+   }
+
+   /* Ownership of the batch passes to the callback */
+   handle->batch->end = (ret == 0);
+   task_set_data(task, handle->batch);
+   handle->batch      = NULL;
+
+task_finished:
+   task_set_progress(task, 100);
+   task_set_finished(task, true);
+}
+
+/**
+ * task_push_dir_list:
+ * @stream      : directory stream to read.
+ * @max_entries : maximum number of directory entries to read.
+ * @cb          : callback, receiving the batch as task_data
+ *                (NULL on error or cancellation).
+ * @user_data   : user data passed to @cb.
+ *
+ * Reads the next batch of up to @max_entries entries of
+ * @stream on the task queue, so that large directories can
+ * be shown while they are being read. The entries of the
+ * batch are unsorted. @stream is not owned by the task and
+ * has to stay valid until the callback has run; push the
+ * next batch from the callback until the batch has 'end'
+ * set. The callback owns the batch passed to it and has to
+ * free it with dir_list_batch_free().
+ *
+ * Returns: true if the task was pushed, false otherwise.
+ **/
+bool task_push_dir_list(dir_list_stream_t *stream,
+      size_t max_entries, retro_task_callback_t cb, void *user_data)
+{
+   retro_task_t *task        = NULL;
+   dir_list_handle_t *handle = NULL;
+   dir_list_batch_t *batch   = NULL;
+
+   if (!stream)
+      return false;
+
+   if (!(batch = (dir_list_batch_t*)calloc(1, sizeof(*batch))))
+      return false;
+
+   if (!(batch->list = string_list_new()))
+      goto error;
+
+   if (!(handle = (dir_list_handle_t*)malloc(sizeof(*handle))))
+      goto error;
+
+   if (!(task = task_init()))
+      goto error;
+
+   handle->stream      = stream;
+   handle->batch       = batch;
+   handle->max_entries = max_entries;
+
+   task->handler    = task_dir_list_handler;
+   task->state      = handle;
+   task->title      = strdup(msg_hash_to_str(MSG_READING_DIRECTORY));
+   task->mute       = true;
+   task->callback   = cb;
+   task->user_data  = user_data;
+   task->cleanup    = cb_task_dir_list_cleanup;
+   task->progress   = -1;
+
+   task_queue_push(task);
+
+   return true;
+
+error:
+   free(handle);
+   dir_list_batch_free(batch);
+   return false;
+}
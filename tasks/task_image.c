@@ -19,42 +19,314 @@
 #include <errno.h>
 
 #include <file/nbio.h>
+#include <file/file_path.h>
+#include <lists/dir_list.h>
 #include <formats/image.h>
+#include <streams/file_stream.h>
+#include <encodings/crc32.h>
 #include <compat/strl.h>
 #include <string/stdstring.h>
 #include <retro_miscellaneous.h>
 #include <features/features_cpu.h>
+#include <lrc_hash.h>
+#ifdef HAVE_THREADS
+#include <rthreads/rthreads.h>
+#include <rthreads/tpool.h>
+#endif
 
 #include "task_file_transfer.h"
 #include "tasks_internal.h"
 
 #include "../configuration.h"
 
+/* Decoded thumbnails, scaled to the size the menu
+ * draws them at, are kept in this subdirectory of the
+ * cache directory, as a header followed by the raw
+ * ARGB8888 pixels */
+#define IMAGE_CACHE_DIR     "thumbnails"
+#define IMAGE_CACHE_EXT     "argb"
+#define IMAGE_CACHE_MAGIC   0x48544152 /* 'RATH' */
+#define IMAGE_CACHE_VERSION 2
+
+/* Images larger than this are not worth keeping
+ * on disk at full decoded size */
+#define IMAGE_CACHE_MAX_PIXELS (1024 * 1024)
+
+/* Once the cache directory grows past this size, the
+ * oldest entries are deleted until it is back under
+ * three quarters of it. The size is checked on the
+ * first write of a session, and then every time this
+ * much has been written since the last check. */
+#define IMAGE_CACHE_MAX_SIZE       (128 * 1024 * 1024)
+#define IMAGE_CACHE_TRIM_INTERVAL  (IMAGE_CACHE_MAX_SIZE / 8)
+
+/* Maximum number of images decoded at once */
+#define IMAGE_DECODE_MAX_THREADS 4
+
+typedef struct
+{
+   int64_t src_mtime;
+   uint32_t magic;
+   uint32_t version;
+   uint32_t src_size;
+   uint32_t upscale_threshold;
+   uint32_t max_width;
+   uint32_t max_height;
+   uint32_t width;
+   uint32_t height;
+} image_cache_header_t;
+
+typedef struct
+{
+   const char *path;
+   int64_t mtime;
+   int32_t size;
+} image_cache_file_t;
+
 enum image_status_enum
 {
    IMAGE_STATUS_WAIT = 0,
    IMAGE_STATUS_TRANSFER,
    IMAGE_STATUS_TRANSFER_PARSE,
    IMAGE_STATUS_PROCESS_TRANSFER,
-   IMAGE_STATUS_PROCESS_TRANSFER_PARSE
+   IMAGE_STATUS_PROCESS_TRANSFER_PARSE,
+   IMAGE_STATUS_DECODE
 };
 
 struct nbio_image_handle
 {
    void *handle;
    transfer_cb_t  cb;
+   char *cache_path;
    struct texture_image ti; /* ptr alignment */
    size_t size;
+   int64_t src_mtime;
+   int32_t src_size;
    int processing_final_state;
    unsigned frame_duration;
    unsigned upscale_threshold;
+   unsigned max_width;
+   unsigned max_height;
    enum image_type_enum type;
    enum image_status_enum status;
    bool is_blocking;
    bool is_blocking_on_processing;
    bool is_finished;
+   bool decode_pending;
+   bool decoded_threaded;
 };
 
+#ifdef HAVE_THREADS
+/* Images are decoded whole on this pool when the task
+ * queue is threaded, so that several can be decoded at
+ * once; 'decode_pending' is guarded by the lock */
+static tpool_t *image_decode_pool = NULL;
+static slock_t *image_decode_lock = NULL;
+static scond_t *image_decode_cond = NULL;
+/* Guards the cache trim bookkeeping below, since
+ * entries are written from the decode pool */
+static slock_t *image_cache_lock  = NULL;
+#endif
+
+static size_t image_cache_written = 0;
+static bool   image_cache_trimmed = false;
+
+/**
+ * task_image_cache_read:
+ * @image : image handle; 'src_size' and 'src_mtime' must
+ *          describe the source file.
+ *
+ * Loads the pixels of @image from its cache entry, if
+ * there is one that was made from a source file of the
+ * same size and modification time, for the same upscale
+ * threshold and maximum size.
+ *
+ * Returns: true if the image was read from the cache,
+ * otherwise false.
+ **/
+static bool task_image_cache_read(struct nbio_image_handle *image)
+{
+   image_cache_header_t header;
+   size_t pixels_size;
+   uint32_t *pixels = NULL;
+   RFILE *file      = filestream_open(image->cache_path,
+         RETRO_VFS_FILE_ACCESS_READ,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE);
+
+   if (!file)
+      return false;
+
+   if (filestream_read(file, &header, sizeof(header)) != sizeof(header))
+      goto error;
+
+   if (     (header.magic             != IMAGE_CACHE_MAGIC)
+         || (header.version           != IMAGE_CACHE_VERSION)
+         || (header.src_size          != (uint32_t)image->src_size)
+         || (header.src_mtime         != image->src_mtime)
+         || (header.upscale_threshold != image->upscale_threshold)
+         || (header.max_width         != image->max_width)
+         || (header.max_height        != image->max_height)
+         || (header.width  < 1) || (header.height < 1)
+         || (header.width  * header.height > IMAGE_CACHE_MAX_PIXELS))
+      goto error;
+
+   pixels_size = header.width * header.height * sizeof(uint32_t);
+
+   if (filestream_get_size(file) != (int64_t)(sizeof(header) + pixels_size))
+      goto error;
+
+   if (!(pixels = (uint32_t*)malloc(pixels_size)))
+      goto error;
+
+   if (filestream_read(file, pixels, pixels_size) != (int64_t)pixels_size)
+      goto error;
+
+   filestream_close(file);
+
+   image->ti.pixels = pixels;
+   image->ti.width  = header.width;
+   image->ti.height = header.height;
+
+   return true;
+
+error:
+   if (pixels)
+      free(pixels);
+   filestream_close(file);
+   return false;
+}
+
+static int task_image_cache_file_cmp(const void *a, const void *b)
+{
+   const image_cache_file_t *file_a = (const image_cache_file_t*)a;
+   const image_cache_file_t *file_b = (const image_cache_file_t*)b;
+
+   if (file_a->mtime < file_b->mtime)
+      return -1;
+   if (file_a->mtime > file_b->mtime)
+      return 1;
+   return 0;
+}
+
+/**
+ * task_image_cache_trim:
+ * @cache_dir : thumbnail cache directory.
+ *
+ * Deletes the least recently written entries of
+ * @cache_dir while it exceeds IMAGE_CACHE_MAX_SIZE.
+ **/
+static void task_image_cache_trim(const char *cache_dir)
+{
+   size_t i;
+   size_t total               = 0;
+   image_cache_file_t *files  = NULL;
+   struct string_list *list   = dir_list_new(cache_dir,
+         IMAGE_CACHE_EXT, false, true, false, false);
+
+   if (!list)
+      return;
+
+   if (!list->size || !(files = (image_cache_file_t*)
+            malloc(list->size * sizeof(*files))))
+      goto end;
+
+   for (i = 0; i < list->size; i++)
+   {
+      files[i].path  = list->elems[i].data;
+      files[i].size  = path_get_size(files[i].path);
+      files[i].mtime = path_get_mtime(files[i].path);
+      if (files[i].size > 0)
+         total      += (size_t)files[i].size;
+   }
+
+   if (total <= IMAGE_CACHE_MAX_SIZE)
+      goto end;
+
+   qsort(files, list->size, sizeof(*files), task_image_cache_file_cmp);
+
+   for (i = 0; i < list->size
+         && total > IMAGE_CACHE_MAX_SIZE / 4 * 3; i++)
+   {
+      if (filestream_delete(files[i].path) == 0 && files[i].size > 0)
+         total -= (size_t)files[i].size;
+   }
+
+end:
+   free(files);
+   string_list_free(list);
+}
+
+/**
+ * task_image_cache_write:
+ * @image : decoded and scaled image handle.
+ *
+ * Stores the pixels of @image in its cache entry,
+ * replacing any entry made from an older version of
+ * the source file, and trims the cache if it has
+ * grown past its size limit.
+ **/
+static void task_image_cache_write(struct nbio_image_handle *image)
+{
+   image_cache_header_t header;
+   char cache_dir[PATH_MAX_LENGTH];
+   size_t pixels_size = image->ti.width * image->ti.height * sizeof(uint32_t);
+   RFILE *file        = NULL;
+
+   if (     !image->ti.pixels
+         || (image->ti.width  < 1) || (image->ti.height < 1)
+         || (image->ti.width  * image->ti.height > IMAGE_CACHE_MAX_PIXELS))
+      return;
+
+   cache_dir[0] = '\0';
+   fill_pathname_basedir(cache_dir, image->cache_path, sizeof(cache_dir));
+
+   if (!path_is_directory(cache_dir) && !path_mkdir(cache_dir))
+      return;
+
+   if (!(file = filestream_open(image->cache_path,
+         RETRO_VFS_FILE_ACCESS_WRITE,
+         RETRO_VFS_FILE_ACCESS_HINT_NONE)))
+      return;
+
+   header.src_mtime         = image->src_mtime;
+   header.magic             = IMAGE_CACHE_MAGIC;
+   header.version           = IMAGE_CACHE_VERSION;
+   header.src_size          = (uint32_t)image->src_size;
+   header.upscale_threshold = image->upscale_threshold;
+   header.max_width         = image->max_width;
+   header.max_height        = image->max_height;
+   header.width             = image->ti.width;
+   header.height            = image->ti.height;
+
+   /* A partially written entry is rejected on read,
+    * since its size does not match the header */
+   if (     (filestream_write(file, &header, sizeof(header)) != sizeof(header))
+         || (filestream_write(file, image->ti.pixels, pixels_size)
+            != (int64_t)pixels_size))
+   {
+      filestream_close(file);
+      filestream_delete(image->cache_path);
+      return;
+   }
+
+   filestream_close(file);
+
+#ifdef HAVE_THREADS
+   slock_lock(image_cache_lock);
+#endif
+   image_cache_written += sizeof(header) + pixels_size;
+   if (     !image_cache_trimmed
+         || (image_cache_written >= IMAGE_CACHE_TRIM_INTERVAL))
+   {
+      image_cache_trimmed = true;
+      image_cache_written = 0;
+      task_image_cache_trim(cache_dir);
+   }
+#ifdef HAVE_THREADS
+   slock_unlock(image_cache_lock);
+#endif
+}
+
 static int cb_image_upload_generic(void *data, size_t len)
 {
    unsigned r_shift, g_shift, b_shift, a_shift;
@@ -160,10 +432,26 @@ static void task_image_cleanup(nbio_handle_t *nbio)
 
    if (image)
    {
+#ifdef HAVE_THREADS
+      /* The decode pool still uses the handle
+       * and the file buffer */
+      if (image_decode_lock)
+      {
+         slock_lock(image_decode_lock);
+         while (image->decode_pending)
+            scond_wait(image_decode_cond, image_decode_lock);
+         slock_unlock(image_decode_lock);
+      }
+#endif
+
       image_transfer_free(image->handle, image->type);
 
       image->handle                 = NULL;
       image->cb                     = NULL;
+
+      if (image->cache_path)
+         free(image->cache_path);
+      image->cache_path             = NULL;
    }
    if (!string_is_empty(nbio->path))
       free(nbio->path);
@@ -272,6 +560,292 @@ static bool upscale_image(
    return true;
 }
 
+/* Shrinks @image_src to fit within @max_width x @max_height,
+ * keeping its aspect ratio. Each output pixel is the average
+ * of the source pixels it covers, which avoids the aliasing
+ * of point sampling at the large ratios thumbnails need. */
+static bool downscale_image(
+      unsigned max_width, unsigned max_height,
+      struct texture_image *image_src,
+      struct texture_image *image_dst)
+{
+   unsigned x_dst, y_dst;
+
+   if (     !image_src->pixels
+         || (image_src->width < 1) || (image_src->height < 1)
+         || (max_width < 1) || (max_height < 1))
+      return false;
+
+   /* Get output dimensions */
+   if ((uint64_t)image_src->width * max_height
+         > (uint64_t)image_src->height * max_width)
+   {
+      image_dst->width  = max_width;
+      image_dst->height = (unsigned)((uint64_t)image_src->height
+            * max_width / image_src->width);
+   }
+   else
+   {
+      image_dst->height = max_height;
+      image_dst->width  = (unsigned)((uint64_t)image_src->width
+            * max_height / image_src->height);
+   }
+
+   if (image_dst->width < 1)
+      image_dst->width  = 1;
+   if (image_dst->height < 1)
+      image_dst->height = 1;
+
+   /* Allocate pixel buffer */
+   image_dst->pixels = (uint32_t*)malloc(
+         image_dst->width * image_dst->height * sizeof(uint32_t));
+   if (!image_dst->pixels)
+      return false;
+
+   for (y_dst = 0; y_dst < image_dst->height; y_dst++)
+   {
+      unsigned y_start = (unsigned)((uint64_t)y_dst
+            * image_src->height / image_dst->height);
+      unsigned y_end   = (unsigned)((uint64_t)(y_dst + 1)
+            * image_src->height / image_dst->height);
+
+      for (x_dst = 0; x_dst < image_dst->width; x_dst++)
+      {
+         unsigned x_src, y_src, count;
+         uint32_t sum[4]  = {0};
+         unsigned x_start = (unsigned)((uint64_t)x_dst
+               * image_src->width / image_dst->width);
+         unsigned x_end   = (unsigned)((uint64_t)(x_dst + 1)
+               * image_src->width / image_dst->width);
+
+         for (y_src = y_start; y_src < y_end; y_src++)
+         {
+            const uint32_t *src = image_src->pixels
+               + y_src * image_src->width;
+
+            for (x_src = x_start; x_src < x_end; x_src++)
+            {
+               uint32_t pixel = src[x_src];
+               sum[0]        += (pixel >> 24) & 0xFF;
+               sum[1]        += (pixel >> 16) & 0xFF;
+               sum[2]        += (pixel >>  8) & 0xFF;
+               sum[3]        +=  pixel        & 0xFF;
+            }
+         }
+
+         count = (y_end - y_start) * (x_end - x_start);
+         image_dst->pixels[(y_dst * image_dst->width) + x_dst] =
+              (((sum[0] + count / 2) / count) << 24)
+            | (((sum[1] + count / 2) / count) << 16)
+            | (((sum[2] + count / 2) / count) <<  8)
+            |  ((sum[3] + count / 2) / count);
+      }
+   }
+
+   return true;
+}
+
+/* Scales the decoded image to the size it is drawn at,
+ * if required, and stores it in the cache */
+static void task_image_finalize(struct nbio_image_handle *image)
+{
+   if (     (image->max_width  > 0)
+         && (image->max_height > 0)
+         && (  (image->ti.width  > image->max_width)
+            || (image->ti.height > image->max_height)))
+   {
+      struct texture_image img_resampled = {
+         NULL,
+         0,
+         0,
+         false
+      };
+
+      if (downscale_image(image->max_width, image->max_height,
+               &image->ti, &img_resampled))
+      {
+         image->ti.width  = img_resampled.width;
+         image->ti.height = img_resampled.height;
+
+         if (image->ti.pixels)
+            free(image->ti.pixels);
+         image->ti.pixels = img_resampled.pixels;
+      }
+   }
+
+   if (image->upscale_threshold > 0)
+   {
+      if (((image->ti.width > 0) && (image->ti.height > 0)) &&
+          ((image->ti.width  < image->upscale_threshold) ||
+           (image->ti.height < image->upscale_threshold)))
+      {
+         unsigned min_size                  = (image->ti.width < image->ti.height) ?
+                                                image->ti.width : image->ti.height;
+         float scale_factor                 = (float)image->upscale_threshold /
+                                                (float)min_size;
+         unsigned scale_factor_int          = (unsigned)scale_factor;
+         struct texture_image img_resampled = {
+            NULL,
+            0,
+            0,
+            false
+         };
+
+         if (scale_factor - (float)scale_factor_int > 0.0f)
+            scale_factor_int += 1;
+
+         if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
+         {
+            image->ti.width  = img_resampled.width;
+            image->ti.height = img_resampled.height;
+
+            if (image->ti.pixels)
+               free(image->ti.pixels);
+            image->ti.pixels = img_resampled.pixels;
+         }
+      }
+   }
+
+   if (image->cache_path)
+      task_image_cache_write(image);
+}
+
+#ifdef HAVE_THREADS
+static void task_image_decode_work(void *data)
+{
+   int retval;
+   unsigned width                  = 0;
+   unsigned height                 = 0;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)data;
+
+   while (image_transfer_iterate(image->handle, image->type));
+
+   do
+   {
+      retval = task_image_process(image, &width, &height);
+   } while (retval == IMAGE_PROCESS_NEXT);
+
+   image->processing_final_state = retval;
+
+   if (retval == IMAGE_PROCESS_END)
+   {
+      unsigned r_shift, g_shift, b_shift, a_shift;
+
+      image_texture_set_color_shifts(&r_shift, &g_shift, &b_shift,
+            &a_shift, &image->ti);
+      image_texture_color_convert(r_shift, g_shift, b_shift,
+            a_shift, &image->ti);
+
+      task_image_finalize(image);
+   }
+
+   slock_lock(image_decode_lock);
+   image->decode_pending = false;
+   scond_broadcast(image_decode_cond);
+   slock_unlock(image_decode_lock);
+}
+
+static bool task_image_decode_push(struct nbio_image_handle *image)
+{
+   if (!image_decode_pool || !task_queue_is_threaded())
+      return false;
+
+   image->decode_pending   = true;
+   image->decoded_threaded = true;
+   image->status           = IMAGE_STATUS_DECODE;
+
+   if (!tpool_add_work(image_decode_pool, task_image_decode_work, image))
+   {
+      image->decode_pending   = false;
+      image->decoded_threaded = false;
+      image->status           = IMAGE_STATUS_TRANSFER;
+      return false;
+   }
+
+   return true;
+}
+
+static bool task_image_decode_is_pending(struct nbio_image_handle *image)
+{
+   bool pending;
+
+   slock_lock(image_decode_lock);
+   pending = image->decode_pending;
+   slock_unlock(image_decode_lock);
+
+   return pending;
+}
+
+static void task_image_decode_init(void)
+{
+   unsigned threads;
+
+   if (image_decode_pool || !task_queue_is_threaded())
+      return;
+
+   threads = cpu_features_get_core_amount();
+   if (threads > IMAGE_DECODE_MAX_THREADS)
+      threads = IMAGE_DECODE_MAX_THREADS;
+   else if (threads < 1)
+      threads = 1;
+
+   if (!(image_decode_lock = slock_new()))
+      goto error;
+   if (!(image_decode_cond = scond_new()))
+      goto error;
+   if (!(image_cache_lock = slock_new()))
+      goto error;
+   if (!(image_decode_pool = tpool_create(threads)))
+      goto error;
+
+   return;
+
+error:
+   task_image_load_deinit();
+}
+#endif
+
+/**
+ * task_image_load_deinit:
+ *
+ * Stops the image decode threads. Has to be called
+ * after the task queue is deinitialised.
+ **/
+void task_image_load_deinit(void)
+{
+#ifdef HAVE_THREADS
+   if (image_decode_pool)
+      tpool_destroy(image_decode_pool);
+   if (image_decode_cond)
+      scond_free(image_decode_cond);
+   if (image_decode_lock)
+      slock_free(image_decode_lock);
+   if (image_cache_lock)
+      slock_free(image_cache_lock);
+   image_decode_pool = NULL;
+   image_decode_cond = NULL;
+   image_decode_lock = NULL;
+   image_cache_lock  = NULL;
+#endif
+}
+
+/* Hands the pixels of @image over to @task */
+static void task_image_set_data(retro_task_t *task,
+      struct nbio_image_handle *image)
+{
+   struct texture_image *img = (struct texture_image*)malloc(sizeof(struct texture_image));
+
+   if (img)
+   {
+      img->width         = image->ti.width;
+      img->height        = image->ti.height;
+      img->pixels        = image->ti.pixels;
+      img->supports_rgba = image->ti.supports_rgba;
+   }
+
+   task_set_data(task, img);
+}
+
 bool task_image_load_handler(retro_task_t *task)
 {
    nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
@@ -300,7 +874,12 @@ bool task_image_load_handler(retro_task_t *task)
          case IMAGE_STATUS_TRANSFER:
             if (!image->is_blocking && !image->is_finished)
             {
-               retro_time_t start_time = cpu_features_get_time_usec();
+               retro_time_t start_time;
+#ifdef HAVE_THREADS
+               if (task_image_decode_push(image))
+                  break;
+#endif
+               start_time = cpu_features_get_time_usec();
                do
                {
                   if (!image_transfer_iterate(image->handle, image->type))
@@ -319,8 +898,23 @@ bool task_image_load_handler(retro_task_t *task)
                if (image->cb(nbio, len) == -1)
                   return false;
             }
-            if (!image->is_finished)
-               break;
+            break;
+#ifdef HAVE_THREADS
+         case IMAGE_STATUS_DECODE:
+            if (task_image_decode_is_pending(image))
+               return true;
+            switch (image->processing_final_state)
+            {
+               case IMAGE_PROCESS_ERROR:
+               case IMAGE_PROCESS_ERROR_END:
+                  return false;
+               default:
+                  break;
+            }
+            image->is_blocking = true;
+            image->is_finished = true;
+            break;
+#endif
       }
    }
 
@@ -328,60 +922,60 @@ bool task_image_load_handler(retro_task_t *task)
          && (image && image->is_finished)
          && (!task_get_cancelled(task)))
    {
-      struct texture_image *img = (struct texture_image*)malloc(sizeof(struct texture_image));
+      /* Images decoded on the decode pool are already done */
+      if (!image->decoded_threaded)
+         task_image_finalize(image);
 
-      if (img)
-      {
-         /* Upscale image, if required */
-         if (image->upscale_threshold > 0)
-         {
-            if (((image->ti.width > 0) && (image->ti.height > 0)) &&
-                ((image->ti.width  < image->upscale_threshold) ||
-                 (image->ti.height < image->upscale_threshold)))
-            {
-               unsigned min_size                  = (image->ti.width < image->ti.height) ?
-                                                      image->ti.width : image->ti.height;
-               float scale_factor                 = (float)image->upscale_threshold /
-                                                      (float)min_size;
-               unsigned scale_factor_int          = (unsigned)scale_factor;
-               struct texture_image img_resampled = {
-                  NULL,
-                  0,
-                  0,
-                  false
-               };
-
-               if (scale_factor - (float)scale_factor_int > 0.0f)
-                  scale_factor_int += 1;
-
-               if (upscale_image(scale_factor_int, &image->ti, &img_resampled))
-               {
-                  image->ti.width  = img_resampled.width;
-                  image->ti.height = img_resampled.height;
+      task_image_set_data(task, image);
+      return false;
+   }
 
-                  if (image->ti.pixels)
-                     free(image->ti.pixels);
-                  image->ti.pixels = img_resampled.pixels;
-               }
-            }
-         }
+   return true;
+}
 
-         img->width         = image->ti.width;
-         img->height        = image->ti.height;
-         img->pixels        = image->ti.pixels;
-         img->supports_rgba = image->ti.supports_rgba;
-      }
+/**
+ * task_image_cache_load_handler:
+ *
+ * Task handler of cached image loads. Before the source
+ * file is opened, its size and modification time are
+ * checked against its cache entry. On a match the cached
+ * pixels are returned, otherwise the file is loaded and
+ * decoded as usual.
+ **/
+static void task_image_cache_load_handler(retro_task_t *task)
+{
+   nbio_handle_t            *nbio  = (nbio_handle_t*)task->state;
+   struct nbio_image_handle *image = (struct nbio_image_handle*)nbio->data;
 
-      task_set_data(task, img);
+   if (     (nbio->status == NBIO_STATUS_INIT)
+         && image
+         && image->cache_path
+         && !task_get_cancelled(task))
+   {
+      image->src_size  = path_get_size(nbio->path);
+      image->src_mtime = path_get_mtime(nbio->path);
 
-      return false;
+      /* Without a modification time, a changed
+       * source file could not be told apart */
+      if ((image->src_size < 0) || !image->src_mtime)
+      {
+         free(image->cache_path);
+         image->cache_path = NULL;
+      }
+      else if (task_image_cache_read(image))
+      {
+         task_image_set_data(task, image);
+         task_set_finished(task, true);
+         return;
+      }
    }
 
-   return true;
+   task_file_load_handler(task);
 }
 
-bool task_push_image_load(const char *fullpath, 
-      bool supports_rgba, unsigned upscale_threshold,
+static bool task_push_image_load_internal(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold, bool use_cache,
+      unsigned max_width, unsigned max_height,
       retro_task_callback_t cb, void *user_data)
 {
    nbio_handle_t             *nbio   = NULL;
@@ -430,7 +1024,14 @@ bool task_push_image_load(const char *fullpath,
    image->frame_duration             = 0;
    image->size                       = 0;
    image->upscale_threshold          = upscale_threshold;
+   image->max_width                  = max_width;
+   image->max_height                 = max_height;
    image->handle                     = NULL;
+   image->cache_path                 = NULL;
+   image->src_mtime                  = 0;
+   image->src_size                   = 0;
+   image->decode_pending             = false;
+   image->decoded_threaded           = false;
 
    image->ti.width                   = 0;
    image->ti.height                  = 0;
@@ -457,10 +1058,43 @@ bool task_push_image_load(const char *fullpath,
          break;
    }
 
+   /* Cache entries are named after the source path and
+    * the target size; the size and modification time of
+    * the source file are checked against the entry header
+    * before the file is read */
+   if (use_cache)
+   {
+      settings_t *settings = config_get_ptr();
+
+      if (settings && !string_is_empty(settings->paths.directory_cache))
+      {
+         char cache_file[64];
+         char cache_path[PATH_MAX_LENGTH];
+
+         snprintf(cache_file, sizeof(cache_file), "%08x%08x_%u_%ux%u",
+               (unsigned)encoding_crc32(0,
+                  (const uint8_t*)fullpath, strlen(fullpath)),
+               (unsigned)djb2_calculate(fullpath),
+               upscale_threshold, max_width, max_height);
+
+         cache_path[0] = '\0';
+         fill_pathname_join_special_ext(cache_path,
+               settings->paths.directory_cache, IMAGE_CACHE_DIR,
+               cache_file, "." IMAGE_CACHE_EXT, sizeof(cache_path));
+
+         image->cache_path = strdup(cache_path);
+      }
+   }
+
    nbio->data          = (struct nbio_image_handle*)image;
 
+#ifdef HAVE_THREADS
+   task_image_decode_init();
+#endif
+
    t->state           = nbio;
-   t->handler         = task_file_load_handler;
+   t->handler         = image->cache_path
+      ? task_image_cache_load_handler : task_file_load_handler;
    t->cleanup         = task_image_load_free;
    t->callback        = cb;
    t->user_data       = user_data;
@@ -469,3 +1103,20 @@ bool task_push_image_load(const char *fullpath,
 
    return true;
 }
+
+bool task_push_image_load(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_internal(fullpath, supports_rgba,
+         upscale_threshold, false, 0, 0, cb, user_data);
+}
+
+bool task_push_image_load_cached(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *user_data)
+{
+   return task_push_image_load_internal(fullpath, supports_rgba,
+         upscale_threshold, true, max_width, max_height, cb, user_data);
+}
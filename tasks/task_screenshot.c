@@ -31,6 +31,7 @@
 #include <string/stdstring.h>
 #include <gfx/scaler/scaler.h>
 #include <gfx/video_frame.h>
+#include <features/features_cpu.h>
 
 #ifdef HAVE_RBMP
 #include <formats/rbmp.h>
@@ -70,6 +71,7 @@ struct screenshot_task_state
    unsigned width;
    unsigned height;
    unsigned pixel_format_type;
+   unsigned compression_level;
 
    char filename[PATH_MAX_LENGTH];
    char shotname[256];
@@ -105,12 +107,14 @@ static bool screenshot_dump_direct(screenshot_task_state_t *state)
 
    scaler_ctx_gen_reset(&state->scaler);
 
-   ret = rpng_save_image_bgr24(
+   ret = rpng_save_image_bgr24_ext(
          state->filename,
          state->out_buffer,
          state->width,
          state->height,
-         state->width * 3
+         state->width * 3,
+         (int)state->compression_level,
+         cpu_features_get_core_amount()
          );
 
    free(state->out_buffer);
@@ -293,6 +297,7 @@ static bool screenshot_dump(
    state->silence                = savestate;
    state->history_list_enable    = settings->bools.history_list_enable;
    state->pixel_format_type      = pixel_format_type;
+   state->compression_level      = settings->uints.screenshot_compression_level;
 
    if (!fullpath)
    {
@@ -22,6 +22,7 @@
 #include <retro_common_api.h>
 #include <retro_miscellaneous.h>
 
+#include <lists/dir_list.h>
 #include <queues/task_queue.h>
 
 #ifdef HAVE_CONFIG_H
@@ -152,10 +153,37 @@ bool task_push_core_restore(const char *backup_path,
 bool task_push_pl_manager_reset_cores(const playlist_config_t *playlist_config);
 bool task_push_pl_manager_clean_playlist(const playlist_config_t *playlist_config);
 
+typedef struct dir_list_batch
+{
+   struct string_list *list;
+   /* End of the directory reached */
+   bool end;
+} dir_list_batch_t;
+
+/* Note: Reads one batch of 'stream', which is not owned
+ * by the task. Callback receives the batch as task_data
+ * and has to free it with dir_list_batch_free() */
+bool task_push_dir_list(dir_list_stream_t *stream,
+      size_t max_entries, retro_task_callback_t cb, void *user_data);
+
+void dir_list_batch_free(dir_list_batch_t *batch);
+
 bool task_push_image_load(const char *fullpath,
       bool supports_rgba, unsigned upscale_threshold,
       retro_task_callback_t cb, void *userdata);
 
+/* Same as task_push_image_load(), but first shrinks the
+ * image to fit within max_width x max_height (if non-zero),
+ * and keeps the result in the cache directory, so that
+ * later loads of an unchanged file skip reading and
+ * decoding it */
+bool task_push_image_load_cached(const char *fullpath,
+      bool supports_rgba, unsigned upscale_threshold,
+      unsigned max_width, unsigned max_height,
+      retro_task_callback_t cb, void *userdata);
+
+void task_image_load_deinit(void);
+
 #ifdef HAVE_LIBRETRODB
 bool task_push_dbscan(
       const char *playlist_directory,
@@ -0,0 +1,247 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compares two frame hash logs written with
+ * 'retroarch --frame-hash-log=FILE'.
+ *
+ * Record a baseline with one build or set of settings, and
+ * a candidate with another. Both runs should replay the same
+ * BSV movie (-P) so that input is identical. The logs are
+ * compared frame by frame. Mismatches are reported separately
+ * for the core's video and audio, the filtered video handed to
+ * the video driver, and the audio written to the audio driver
+ * after DSP and resampling. Logs written before the filtered
+ * columns existed only have the core output compared. If one
+ * log starts later (e.g. it was written with --bsv-seek), the
+ * leading frames of the other one are skipped.
+ *
+ * Returns 0 if both logs are identical, 1 if they differ and
+ * 2 on errors.
+ *
+ * Usage: framehash_compare [-n MAX_REPORTED] BASELINE CANDIDATE */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct
+{
+   unsigned long frame;
+   unsigned long audio_frames;
+   unsigned long video;
+   unsigned long audio;
+   unsigned long filtered;
+   unsigned long output_frames;
+   unsigned long output;
+   int has_output;
+   char size[32];
+} frame_hash_t;
+
+/* Reads the next frame line, skipping comments.
+ * Returns 1 on success, 0 at the end of the log
+ * and -1 on a malformed line. */
+static int read_frame(FILE *file, const char *path,
+      unsigned long *line_num, frame_hash_t *hash)
+{
+   char line[256];
+
+   while (fgets(line, sizeof(line), file))
+   {
+      (*line_num)++;
+
+      if (line[0] == '#' || line[0] == '\n')
+         continue;
+
+      hash->has_output = 1;
+      if (sscanf(line, "%lu %31s %lx %lx %lu %lx %lu %lx",
+               &hash->frame, hash->size, &hash->video, &hash->filtered,
+               &hash->audio_frames, &hash->audio,
+               &hash->output_frames, &hash->output) == 8)
+         return 1;
+
+      /* Older logs without the filtered columns */
+      hash->has_output = 0;
+      if (sscanf(line, "%lu %31s %lx %lu %lx",
+               &hash->frame, hash->size, &hash->video,
+               &hash->audio_frames, &hash->audio) != 5)
+      {
+         fprintf(stderr, "%s:%lu: malformed line.\n", path, *line_num);
+         return -1;
+      }
+
+      return 1;
+   }
+
+   return 0;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   FILE *base_file              = NULL;
+   FILE *cand_file              = NULL;
+   const char *base_path        = NULL;
+   const char *cand_path        = NULL;
+   unsigned long base_line      = 0;
+   unsigned long cand_line      = 0;
+   unsigned long compared       = 0;
+   unsigned long video_diffs    = 0;
+   unsigned long audio_diffs    = 0;
+   unsigned long filtered_diffs = 0;
+   unsigned long output_diffs   = 0;
+   unsigned long reported       = 0;
+   unsigned long max_reported   = 10;
+   unsigned long first_mismatch = 0;
+   int length_diff              = 0;
+   int started                  = 0;
+   int ret                      = 2;
+
+   for (i = 1; i < argc; i++)
+   {
+      if (!strcmp(argv[i], "-n") && i + 1 < argc)
+         max_reported = strtoul(argv[++i], NULL, 10);
+      else if (!base_path)
+         base_path    = argv[i];
+      else if (!cand_path)
+         cand_path    = argv[i];
+      else
+         base_path    = NULL;
+   }
+
+   if (!base_path || !cand_path)
+   {
+      fprintf(stderr,
+            "Usage: %s [-n MAX_REPORTED] BASELINE CANDIDATE\n", argv[0]);
+      return 2;
+   }
+
+   if (!(base_file = fopen(base_path, "r")))
+   {
+      fprintf(stderr, "Cannot open %s.\n", base_path);
+      goto end;
+   }
+
+   if (!(cand_file = fopen(cand_path, "r")))
+   {
+      fprintf(stderr, "Cannot open %s.\n", cand_path);
+      goto end;
+   }
+
+   for (;;)
+   {
+      frame_hash_t base, cand;
+      int video_diff, audio_diff;
+      int filtered_diff = 0;
+      int output_diff   = 0;
+      int base_ret = read_frame(base_file, base_path, &base_line, &base);
+      int cand_ret = read_frame(cand_file, cand_path, &cand_line, &cand);
+
+      if (base_ret < 0 || cand_ret < 0)
+         goto end;
+
+      if (!base_ret || !cand_ret)
+      {
+         if (base_ret != cand_ret)
+         {
+            printf("%s ends after %lu compared frames.\n",
+                  base_ret ? cand_path : base_path, compared);
+            length_diff = 1;
+         }
+         break;
+      }
+
+      /* Align logs that start at different frames. */
+      while (!started && base_ret > 0 && cand_ret > 0
+            && base.frame != cand.frame)
+      {
+         if (base.frame < cand.frame)
+            base_ret = read_frame(base_file, base_path, &base_line, &base);
+         else
+            cand_ret = read_frame(cand_file, cand_path, &cand_line, &cand);
+      }
+
+      if (base_ret < 0 || cand_ret < 0)
+         goto end;
+
+      if (!base_ret || !cand_ret)
+      {
+         printf("Logs have no frames in common.\n");
+         length_diff = 1;
+         break;
+      }
+
+      started = 1;
+
+      if (base.frame != cand.frame)
+      {
+         fprintf(stderr, "Frame numbers out of step (%lu and %lu).\n",
+               base.frame, cand.frame);
+         goto end;
+      }
+
+      compared++;
+
+      video_diff = strcmp(base.size, cand.size)
+         || base.video != cand.video;
+      audio_diff = base.audio_frames != cand.audio_frames
+         || base.audio != cand.audio;
+
+      if (base.has_output && cand.has_output)
+      {
+         filtered_diff = base.filtered != cand.filtered;
+         output_diff   = base.output_frames != cand.output_frames
+            || base.output != cand.output;
+      }
+
+      if (!video_diff && !audio_diff && !filtered_diff && !output_diff)
+         continue;
+
+      if (!video_diffs && !audio_diffs && !filtered_diffs && !output_diffs)
+         first_mismatch = base.frame;
+      if (video_diff)
+         video_diffs++;
+      if (audio_diff)
+         audio_diffs++;
+      if (filtered_diff)
+         filtered_diffs++;
+      if (output_diff)
+         output_diffs++;
+
+      if (reported++ < max_reported)
+         printf("Frame %lu:%s%s%s%s\n", base.frame,
+               video_diff    ? " video"    : "",
+               filtered_diff ? " filtered" : "",
+               audio_diff    ? " audio"    : "",
+               output_diff   ? " output"   : "");
+   }
+
+   printf("%lu frames compared, %lu video and %lu audio mismatches.\n",
+         compared, video_diffs, audio_diffs);
+   printf("Filtered video: %lu mismatches, output audio: %lu mismatches.\n",
+         filtered_diffs, output_diffs);
+
+   if (video_diffs || audio_diffs || filtered_diffs || output_diffs)
+      printf("First mismatch at frame %lu.\n", first_mismatch);
+
+   ret = (video_diffs || audio_diffs || filtered_diffs || output_diffs
+         || length_diff) ? 1 : 0;
+
+end:
+   if (base_file)
+      fclose(base_file);
+   if (cand_file)
+      fclose(cand_file);
+   return ret;
+}
@@ -0,0 +1,250 @@
+/*  RetroArch - A frontend for libretro.
+ *  Copyright (C) 2011-2021 - Daniel De Matteis
+ *
+ *  RetroArch is free software: you can redistribute it and/or modify it under the terms
+ *  of the GNU General Public License as published by the Free Software Found-
+ *  ation, either version 3 of the License, or (at your option) any later version.
+ *
+ *  RetroArch is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ *  without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ *  PURPOSE.  See the GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License along with RetroArch.
+ *  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Throughput benchmark for the CPU video filters.
+ *
+ * Every .filt given on the command line is loaded through
+ * rarch_softfilter_new(), with the filters built in, once
+ * for each input pixel format it supports. Each one is run
+ * on a single thread and on all threads, and reports frames
+ * per second and a CRC of its first output frame, so that
+ * results can be compared between builds.
+ *
+ * Returns failure if a filter gives a different result on
+ * several threads than on one. Filters whose output changes
+ * between runs on one thread (because they read outside of
+ * the frame) are reported as unstable instead.
+ *
+ * Usage: softfilter_bench [-s WIDTHxHEIGHT] [-t THREADS]
+ *                         [-d SECONDS] FILTER.filt... */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <boolean.h>
+#include <libretro.h>
+#include <encodings/crc32.h>
+#include <features/features_cpu.h>
+#include <file/file_path.h>
+
+#include "../../gfx/video_filter.h"
+
+typedef struct
+{
+   double fps;
+   uint32_t crc;
+   unsigned out_width;
+   unsigned out_height;
+} bench_result_t;
+
+/* video_filter.c logs through the frontend. Errors are
+ * expected, for formats a filter doesn't support. */
+void RARCH_LOG(const char *fmt, ...) { (void)fmt; }
+void RARCH_WARN(const char *fmt, ...) { (void)fmt; }
+void RARCH_ERR(const char *fmt, ...) { (void)fmt; }
+
+static double bench_time(void)
+{
+   struct timespec ts;
+   clock_gettime(CLOCK_MONOTONIC, &ts);
+   return ts.tv_sec + ts.tv_nsec / 1000000000.0;
+}
+
+/* Flat 8x8 tiles from a small palette, with the odd single
+ * pixel of detail, like the output of most 2D cores. */
+static void bench_fill(void *frame, enum retro_pixel_format fmt,
+      unsigned width, unsigned height)
+{
+   unsigned x, y;
+   uint32_t palette[16];
+   uint32_t seed = 1;
+
+   for (x = 0; x < 16; x++)
+   {
+      seed       = seed * 1103515245u + 12345u;
+      palette[x] = (seed >> 8) & 0xffffff;
+   }
+
+   for (y = 0; y < height; y++)
+   {
+      for (x = 0; x < width; x++)
+      {
+         uint32_t color = palette[(((x >> 3) * 7) ^ ((y >> 3) * 13)) & 15];
+
+         seed = seed * 1103515245u + 12345u;
+         if (((seed >> 16) & 31) == 0)
+            color = palette[(seed >> 24) & 15];
+
+         if (fmt == RETRO_PIXEL_FORMAT_XRGB8888)
+            ((uint32_t*)frame)[y * width + x] = color;
+         else
+            ((uint16_t*)frame)[y * width + x] =
+                 ((color >> 8) & 0xf800)
+               | ((color >> 5) & 0x07e0)
+               | ((color >> 3) & 0x001f);
+      }
+   }
+}
+
+static bool bench_filter(const char *path, enum retro_pixel_format fmt,
+      unsigned threads, unsigned width, unsigned height, double seconds,
+      bench_result_t *res)
+{
+   size_t in_pitch, out_pitch;
+   unsigned max_width, max_height;
+   unsigned frames = 0;
+   double start, elapsed;
+   void *input              = NULL;
+   void *output             = NULL;
+   unsigned bpp             = (fmt == RETRO_PIXEL_FORMAT_XRGB8888) ? 4 : 2;
+   rarch_softfilter_t *filt = rarch_softfilter_new(path,
+         threads, fmt, width, height);
+
+   if (!filt)
+      return false;
+
+   rarch_softfilter_get_max_output_size(filt, &max_width, &max_height);
+   rarch_softfilter_get_output_size(filt,
+         &res->out_width, &res->out_height, width, height);
+
+   /* Output format may differ from the input one */
+   if (rarch_softfilter_get_output_format(filt) == RETRO_PIXEL_FORMAT_XRGB8888)
+      out_pitch = max_width * 4;
+   else
+      out_pitch = max_width * 2;
+   in_pitch     = width * bpp;
+
+   input  = malloc(in_pitch * height);
+   output = calloc(out_pitch, max_height);
+
+   if (!input || !output)
+   {
+      free(input);
+      free(output);
+      rarch_softfilter_free(filt);
+      return false;
+   }
+
+   bench_fill(input, fmt, width, height);
+
+   /* First frame of a fresh filter is the reference;
+    * temporal filters change their output afterwards */
+   rarch_softfilter_process(filt, output, out_pitch,
+         input, width, height, in_pitch);
+   res->crc = encoding_crc32(0, (const uint8_t*)output,
+         out_pitch * res->out_height);
+
+   start = bench_time();
+   do
+   {
+      rarch_softfilter_process(filt, output, out_pitch,
+            input, width, height, in_pitch);
+      frames++;
+      elapsed = bench_time() - start;
+   } while (elapsed < seconds);
+
+   res->fps = frames / elapsed;
+
+   free(input);
+   free(output);
+   rarch_softfilter_free(filt);
+   return true;
+}
+
+int main(int argc, char *argv[])
+{
+   int i;
+   bool failed      = false;
+   unsigned width   = 320;
+   unsigned height  = 240;
+   double seconds   = 1.0;
+   unsigned threads = cpu_features_get_core_amount();
+
+   for (i = 1; i < argc && argv[i][0] == '-'; i += 2)
+   {
+      if (i + 1 >= argc)
+         break;
+      if (!strcmp(argv[i], "-s"))
+         sscanf(argv[i + 1], "%ux%u", &width, &height);
+      else if (!strcmp(argv[i], "-t"))
+         threads = (unsigned)strtoul(argv[i + 1], NULL, 10);
+      else if (!strcmp(argv[i], "-d"))
+         seconds = strtod(argv[i + 1], NULL);
+   }
+
+   if (i >= argc)
+   {
+      fprintf(stderr, "Usage: %s [-s WIDTHxHEIGHT] [-t THREADS] "
+            "[-d SECONDS] FILTER.filt...\n", argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   /* Always exercise the threaded path */
+   if (threads < 2)
+      threads = 2;
+
+   printf("%-36s %-8s %9s %10s %10s %8s\n", "filter", "format",
+         "output", "1 thread", "threads", "crc");
+
+   for (; i < argc; i++)
+   {
+      unsigned f;
+      static const enum retro_pixel_format fmts[] = {
+         RETRO_PIXEL_FORMAT_XRGB8888,
+         RETRO_PIXEL_FORMAT_RGB565
+      };
+
+      for (f = 0; f < sizeof(fmts) / sizeof(fmts[0]); f++)
+      {
+         char size[32];
+         bench_result_t single, rerun, threaded;
+
+         /* Not every filter supports every format */
+         if (!bench_filter(argv[i], fmts[f], 1,
+                  width, height, seconds, &single))
+            continue;
+         if (!bench_filter(argv[i], fmts[f], 1,
+                  width, height, 0.0, &rerun))
+            continue;
+         if (!bench_filter(argv[i], fmts[f], threads,
+                  width, height, seconds, &threaded))
+            continue;
+
+         snprintf(size, sizeof(size), "%ux%u",
+               single.out_width, single.out_height);
+         printf("%-36s %-8s %9s %10.1f %10.1f %08x",
+               path_basename(argv[i]),
+               fmts[f] == RETRO_PIXEL_FORMAT_XRGB8888 ? "XRGB8888" : "RGB565",
+               size, single.fps, threaded.fps, (unsigned)single.crc);
+
+         if (rerun.crc != single.crc)
+            printf("  unstable");
+         else if (threaded.crc != single.crc)
+         {
+            printf("  FAILED (%08x on %u threads)",
+                  (unsigned)threaded.crc, threads);
+            failed = true;
+         }
+         printf("\n");
+      }
+   }
+
+   printf("Frames per second on %ux%u input, %u threads.\n",
+         width, height, threads);
+
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}